@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gbpCommon.h>
+#include <gbpSID.h>
+
+// Record an allocation of allocation_size bytes at ptr against the
+//   memory tag in use (see SID_push_memory_tag()) and update the
+//   high-water marks.  Called by SID_malloc(), SID_calloc() and
+//   SID_realloc().
+void SID_add_allocation(void *ptr,size_t allocation_size){
+  SID_memory_info *memory=&(SID.memory);
+  if(ptr!=NULL){
+#if USE_OPENMP
+#pragma omp critical(SID_memory)
+#endif
+    {
+    size_t i_entry;
+
+    // Grow the table so that it is never more than half full
+    if(2*(memory->n_entries+1)>memory->table_size){
+      SID_memory_entry *table_old     =memory->table;
+      size_t            table_size_old=memory->table_size;
+      memory->table_size=MAX(SID_MEMORY_TABLE_SIZE_INIT,2*table_size_old);
+      memory->table     =(SID_memory_entry *)calloc(memory->table_size,sizeof(SID_memory_entry));
+      if(memory->table==NULL)
+        SID_trap_error("Could not allocate the memory accounting table.",ERROR_MEMORY);
+      for(i_entry=0;i_entry<table_size_old;i_entry++){
+        if(table_old[i_entry].ptr!=NULL){
+          size_t j_entry=SID_MEMORY_HASH(table_old[i_entry].ptr,memory->table_size);
+          while(memory->table[j_entry].ptr!=NULL)
+            j_entry=(j_entry+1)&(memory->table_size-1);
+          memory->table[j_entry]=table_old[i_entry];
+        }
+      }
+      free(table_old);
+    }
+
+    // Find the entry's slot.  If the address is already there, its
+    //   memory was released outside of SID, so drop the old entry.
+    i_entry=SID_MEMORY_HASH(ptr,memory->table_size);
+    while(memory->table[i_entry].ptr!=NULL && memory->table[i_entry].ptr!=ptr)
+      i_entry=(i_entry+1)&(memory->table_size-1);
+    if(memory->table[i_entry].ptr==ptr){
+      SID.RAM_local                                  -=memory->table[i_entry].size;
+      memory->tags[memory->table[i_entry].i_tag].RAM-=memory->table[i_entry].size;
+    }
+    else
+      memory->n_entries++;
+
+    // Add the allocation
+    int i_tag=0;
+    if(memory->n_tag_stack>0)
+      i_tag=memory->tag_stack[memory->n_tag_stack-1];
+    memory->table[i_entry].ptr  =ptr;
+    memory->table[i_entry].size =allocation_size;
+    memory->table[i_entry].i_tag=i_tag;
+    SID.RAM_local               +=allocation_size;
+    SID.max_RAM_local            =MAX(SID.max_RAM_local,SID.RAM_local);
+    memory->tags[i_tag].RAM     +=allocation_size;
+    memory->tags[i_tag].max_RAM  =MAX(memory->tags[i_tag].max_RAM,memory->tags[i_tag].RAM);
+    }
+  }
+}
+
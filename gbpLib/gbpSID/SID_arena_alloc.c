@@ -0,0 +1,49 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gbpCommon.h>
+#include <gbpSID.h>
+
+// Return allocation_size bytes (aligned to SID_ARENA_ALIGNMENT) from
+//   an arena.  The memory is not initialized and can not be released
+//   on its own; it lasts until the arena is reset or freed.  Requests
+//   larger than the arena's block size get a block of their own, which
+//   is released by the next reset.
+void *SID_arena_alloc(SID_arena *arena,size_t allocation_size){
+  void *r_val=NULL;
+  if(allocation_size>0){
+    allocation_size=((allocation_size+SID_ARENA_ALIGNMENT-1)/SID_ARENA_ALIGNMENT)*SID_ARENA_ALIGNMENT;
+
+    // Move on to a block with room, reusing those left by a reset
+    //   and adding a new one after the current block if needed
+    SID_arena_block *block=arena->current;
+    while(block!=NULL && (block->size-block->used)<allocation_size){
+      block=block->next;
+      if(block!=NULL)
+        block->used=0;
+    }
+    if(block==NULL){
+      block      =(SID_arena_block *)SID_malloc(sizeof(SID_arena_block));
+      block->size=MAX(arena->block_size_next,allocation_size);
+      if(allocation_size<=arena->block_size)
+        arena->block_size_next=MIN(2*arena->block_size_next,arena->block_size);
+      block->data=(char *)SID_malloc(block->size);
+      block->used=0;
+      if(arena->current==NULL){
+        block->next =arena->first;
+        arena->first=block;
+      }
+      else{
+        block->next          =arena->current->next;
+        arena->current->next=block;
+      }
+    }
+    arena->current=block;
+
+    r_val         =(void *)(&(block->data[block->used]));
+    block->used  +=allocation_size;
+    arena->n_bytes+=allocation_size;
+  }
+  return(r_val);
+}
+
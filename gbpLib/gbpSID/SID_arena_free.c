@@ -0,0 +1,22 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gbpCommon.h>
+#include <gbpSID.h>
+
+// Release an arena's blocks (and so everything allocated from it).
+//   The arena is left empty and may be used again.
+void SID_arena_free(SID_arena *arena){
+  SID_arena_block *block=arena->first;
+  while(block!=NULL){
+    SID_arena_block *next=block->next;
+    SID_free(SID_FARG block->data);
+    SID_free(SID_FARG block);
+    block=next;
+  }
+  arena->first          =NULL;
+  arena->current        =NULL;
+  arena->block_size_next=MIN(arena->block_size,SID_ARENA_BLOCK_SIZE_MIN);
+  arena->n_bytes        =0;
+}
+
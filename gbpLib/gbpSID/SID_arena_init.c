@@ -0,0 +1,22 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gbpCommon.h>
+#include <gbpSID.h>
+
+// Initialize an empty arena which will allocate its memory in blocks
+//   of up to block_size bytes (or SID_ARENA_BLOCK_SIZE_DEFAULT if
+//   block_size=0).  The first block is SID_ARENA_BLOCK_SIZE_MIN bytes
+//   (if smaller) and each one after is twice the size of the last, so
+//   arenas which see little use stay small.  Nothing is allocated
+//   until the first call to SID_arena_alloc().
+void SID_arena_init(SID_arena *arena,size_t block_size){
+  if(block_size==0)
+    block_size=SID_ARENA_BLOCK_SIZE_DEFAULT;
+  arena->first          =NULL;
+  arena->current        =NULL;
+  arena->block_size     =block_size;
+  arena->block_size_next=MIN(block_size,SID_ARENA_BLOCK_SIZE_MIN);
+  arena->n_bytes        =0;
+}
+
@@ -0,0 +1,26 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gbpCommon.h>
+#include <gbpSID.h>
+
+// Release everything allocated from an arena at once.  Ordinary
+//   blocks are kept so that they can be reused by later calls to
+//   SID_arena_alloc(); those made for oversized requests are freed.
+void SID_arena_reset(SID_arena *arena){
+  SID_arena_block **link=&(arena->first);
+  while((*link)!=NULL){
+    SID_arena_block *block=(*link);
+    if(block->size>arena->block_size){
+      (*link)=block->next;
+      SID_free(SID_FARG block->data);
+      SID_free(SID_FARG block);
+    }
+    else
+      link=&(block->next);
+  }
+  if(arena->first!=NULL)
+    arena->first->used=0;
+  arena->current=arena->first;
+  arena->n_bytes=0;
+}
@@ -10,8 +10,7 @@ void *SID_calloc(size_t allocation_size){
     r_val=calloc(allocation_size,1);
     if(r_val==NULL)
       SID_trap_error("Could not allocate %lld bytes of RAM!",ERROR_MEMORY,allocation_size);
-    SID.RAM_local   +=allocation_size;
-    SID.max_RAM_local=MAX(SID.max_RAM_local,SID.RAM_local);
+    SID_add_allocation(r_val,allocation_size);
   }
   else
     r_val=NULL;
@@ -116,6 +116,9 @@ void SID_exit(int status){
     else
       fprintf(SID.fp_log,"Peak total %s=%4.2lf kb\n",spacer,(float)max_RAM/(float)SIZE_OF_KILOBYTE);
   }
+
+  // Report memory usage by tag
+  SID_log_memory_tags();
   }
 
   // Free some arrays
@@ -125,6 +128,10 @@ void SID_exit(int status){
   SID_free(SID_FARG SID.flag_use_timer);
   SID_free(SID_FARG SID.IO_size);
   SID_free(SID_FARG SID.My_node);
+  free(SID.memory.table);
+  SID.memory.table     =NULL;
+  SID.memory.table_size=0;
+  SID.memory.n_entries =0;
 
   // Finalize MPI
   SID_Comm_free(&(SID.COMM_WORLD));
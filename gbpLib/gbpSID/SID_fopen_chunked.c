@@ -8,7 +8,6 @@ int SID_fopen_chunked(const char   *filename_root,
                       SID_fp *fp,
                       void   *header, ...){
   int     i_chunk;
-  int     i_group;
   int     n_chunk;
   int     r_val=TRUE;
   SID_fp  fp_temp;
@@ -17,29 +16,21 @@ int SID_fopen_chunked(const char   *filename_root,
   chunked_subheader_info read_subheader;
   chunked_header_info    read_header;
   va_start(vargs,header);
-  fp->header   =header;
-  fp->last_item=0;
+  fp->header           =header;
+  fp->last_item        =0;
+  fp->n_readers_chunked=SID_CHUNKED_READERS_ALL;
   strcpy(fp->filename_root,filename_root);
   if(!strcmp(mode,"r")){
     i_chunk=0;
     sprintf(filename_temp,"%s.%d",fp->filename_root,i_chunk);
-#if USE_MPI_IO
-    for(i_group=0;i_group<SID.n_groups;i_group++){
-      if(SID.My_group==i_group){
-#endif
-        SID_fopen(filename_temp,"r",&fp_temp);
-        SID_fread_all(&(fp->chunked_header),sizeof(chunked_header_info),1,&fp_temp);
-        if(fp->header!=NULL && fp->chunked_header.header_size>0)
-          SID_fread_all(fp->header,fp->chunked_header.header_size,1,&fp_temp);
-        else
-          fp->chunked_header.header_size=0;
-        SID_fread_all(&read_subheader,sizeof(chunked_subheader_info),1,&fp_temp);
-        SID_fclose(&fp_temp);
-#if USE_MPI_IO
-      }
-      SID_Barrier(SID.COMM_WORLD);
-    }
-#endif
+    SID_fopen(filename_temp,"r",&fp_temp);
+    SID_fread_all(&(fp->chunked_header),sizeof(chunked_header_info),1,&fp_temp);
+    if(fp->header!=NULL && fp->chunked_header.header_size>0)
+      SID_fread_all(fp->header,fp->chunked_header.header_size,1,&fp_temp);
+    else
+      fp->chunked_header.header_size=0;
+    SID_fread_all(&read_subheader,sizeof(chunked_subheader_info),1,&fp_temp);
+    SID_fclose(&fp_temp);
     fp->i_x_step_chunk =(size_t *)SID_malloc(sizeof(size_t)*fp->chunked_header.n_chunk);
     fp->i_x_start_chunk=(size_t *)SID_malloc(sizeof(size_t)*fp->chunked_header.n_chunk);
     fp->i_x_last_chunk =(size_t *)SID_malloc(sizeof(size_t)*fp->chunked_header.n_chunk);
@@ -50,18 +41,9 @@ int SID_fopen_chunked(const char   *filename_root,
     fp->header_offset[0]  =sizeof(chunked_header_info)+fp->chunked_header.header_size+sizeof(chunked_subheader_info);
     for(i_chunk=1;i_chunk<fp->chunked_header.n_chunk;i_chunk++){
       sprintf(filename_temp,"%s.%d",fp->filename_root,i_chunk);
-#if USE_MPI_IO
-      for(i_group=0;i_group<SID.n_groups;i_group++){
-        if(SID.My_group==i_group){
-#endif
-          SID_fopen(filename_temp,"r",&fp_temp);
-          SID_fread_all(&read_subheader,sizeof(chunked_subheader_info), 1,&fp_temp);
-          SID_fclose(&fp_temp);
-#if USE_MPI_IO
-        }
-        SID_Barrier(SID.COMM_WORLD);
-      }
-#endif
+      SID_fopen(filename_temp,"r",&fp_temp);
+      SID_fread_all(&read_subheader,sizeof(chunked_subheader_info), 1,&fp_temp);
+      SID_fclose(&fp_temp);
       fp->i_x_start_chunk[i_chunk]=fp->i_x_last_chunk[i_chunk-1]+1;
       fp->i_x_step_chunk[i_chunk] =read_subheader.n_items;
       fp->i_x_last_chunk[i_chunk] =fp->i_x_start_chunk[i_chunk]+fp->i_x_step_chunk[i_chunk]-1;
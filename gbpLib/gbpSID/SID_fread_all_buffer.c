@@ -5,6 +5,37 @@
 int SID_fread_all_buffer(void *rval,size_t dtype_size,size_t n_items,SID_fp_buffer *fp_buffer){
     // Set the requested total return size
     size_t data_size=dtype_size*n_items;
+    // In read-ahead mode, the next block is read while this one is processed
+    if(fp_buffer->flag_read_ahead){
+       while(data_size>0){
+          if((fp_buffer->n_bytes_buffer_unprocessed)==0){
+             // Wait for the next block (starting its read if need be) and swap buffers
+             if(!(fp_buffer->flag_next_pending)){
+                if((fp_buffer->n_bytes_unread)==0)
+                   SID_trap_error("Attempted to read past the end of a buffered file.",ERROR_LOGIC);
+                start_SID_fp_buffer_read(fp_buffer);
+             }
+             finish_SID_fp_buffer_read(fp_buffer);
+             char *buffer_swap                      =fp_buffer->buffer;
+             fp_buffer->buffer                      =fp_buffer->buffer_next;
+             fp_buffer->buffer_next                 =buffer_swap;
+             (fp_buffer->n_bytes_buffer)            =fp_buffer->n_bytes_next;
+             (fp_buffer->n_bytes_buffer_unprocessed)=fp_buffer->n_bytes_next;
+             (fp_buffer->n_bytes_buffer_processed)  =0;
+             // Start reading the block after it
+             if((fp_buffer->n_bytes_unread)>0)
+                start_SID_fp_buffer_read(fp_buffer);
+          }
+          // Copy as much as we can from the current block
+          size_t n_bytes_copy=MIN(data_size,fp_buffer->n_bytes_buffer_unprocessed);
+          memcpy(rval,&(fp_buffer->buffer[fp_buffer->n_bytes_buffer_processed]),n_bytes_copy);
+          rval=&(((char *)rval)[n_bytes_copy]);
+          data_size                              -=n_bytes_copy;
+          (fp_buffer->n_bytes_buffer_unprocessed)-=n_bytes_copy;
+          (fp_buffer->n_bytes_buffer_processed)  +=n_bytes_copy;
+       }
+       return(TRUE);
+    }
     // Check if we need to peroform the next read
     if((fp_buffer->n_bytes_buffer_unprocessed)<data_size){
        // Deal with any unfinished parts of the last-read chunk
@@ -36,5 +67,6 @@ int SID_fread_all_buffer(void *rval,size_t dtype_size,size_t n_items,SID_fp_buff
     // Adjust counters
     (fp_buffer->n_bytes_buffer_unprocessed)-=data_size;
     (fp_buffer->n_bytes_buffer_processed)  +=data_size;
+    return(TRUE);
 }
 
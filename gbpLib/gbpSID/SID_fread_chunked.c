@@ -1,64 +1,86 @@
 #include <gbpCommon.h>
 #include <gbpSID.h>
 
+// Read n_x_read_local items, starting i_x_offset_local items past the
+//   file's current position, from a chunked file.  The chunks (and the
+//   range of each) that this rank needs are worked out once, up-front,
+//   from the chunk boundaries.  Without MPI-IO, ranks then read their
+//   chunks independently, fp->n_readers_chunked at a time (all at once
+//   by default), with no collectives between chunks.  With MPI-IO the
+//   opens are collective, so the chunks needed by any rank are found
+//   with a single reduction.  Returns the number of items read.
 size_t SID_fread_chunked(void   *buffer,
                          size_t  n_x_read_local,
                          size_t  i_x_offset_local,
                          SID_fp *fp){
-  int    i_chunk;
-  int    i_test;
-  int    i_group;
-  size_t i_x_read_chunk;
-  size_t i_x_offset_global;
-  size_t i_x_chunk;
-  size_t n_skip;
-  size_t n_x_chunk;
-  size_t n_x_chunk_max;
-  size_t header_size;
-  size_t r_val=0;
-  char   filename_chunk[256];
-  i_x_offset_global=fp->last_item;
-  for(i_chunk=0,i_x_read_chunk=0,i_x_chunk=i_x_offset_local+i_x_offset_global;
-      i_chunk<fp->chunked_header.n_chunk;
+  int     i_chunk;
+  int     n_chunk=fp->chunked_header.n_chunk;
+  size_t  item_size=fp->chunked_header.item_size;
+  size_t  i_x_read_chunk;
+  size_t  i_x_chunk;
+  char    filename_chunk[256];
+
+  // Work out which part of each chunk this rank reads
+  size_t *n_skip   =(size_t *)SID_calloc(sizeof(size_t)*n_chunk);
+  size_t *n_x_chunk=(size_t *)SID_calloc(sizeof(size_t)*n_chunk);
+  int    *flag_read=(int    *)SID_calloc(sizeof(int)   *n_chunk);
+  for(i_chunk=0,i_x_read_chunk=0,i_x_chunk=i_x_offset_local+fp->last_item;
+      i_chunk<n_chunk && i_x_read_chunk<n_x_read_local;
       i_chunk++){
     if(fp->i_x_start_chunk[i_chunk]<=i_x_chunk && fp->i_x_last_chunk[i_chunk]>=i_x_chunk){
-      n_skip   =i_x_chunk-fp->i_x_start_chunk[i_chunk];
-      n_x_chunk=MIN(n_x_read_local-i_x_read_chunk,fp->i_x_step_chunk[i_chunk]-n_skip);
-    }
-    else{
-      n_x_chunk=0;
-      n_skip   =0;
+      n_skip[i_chunk]   =i_x_chunk-fp->i_x_start_chunk[i_chunk];
+      n_x_chunk[i_chunk]=MIN(n_x_read_local-i_x_read_chunk,fp->i_x_step_chunk[i_chunk]-n_skip[i_chunk]);
+      flag_read[i_chunk]=(n_x_chunk[i_chunk]>0);
+      i_x_chunk        +=n_x_chunk[i_chunk];
+      i_x_read_chunk   +=n_x_chunk[i_chunk];
     }
-    SID_Allreduce(&n_x_chunk,&n_x_chunk_max,1,SID_SIZE_T,SID_MAX,SID.COMM_WORLD);
-    if(n_x_chunk_max>0){
-      sprintf(filename_chunk,"%s.%d",fp->filename_root,i_chunk);
-#if !USE_MPI_IO
-      for(i_group=0;i_group<SID.n_proc;i_group++){
-        if(SID.My_group==i_group && n_x_chunk>0){
+  }
+
+#if USE_MPI_IO
+  // Opens are collective, so every rank opens any chunk that is read
+  SID_Allreduce(SID_IN_PLACE,flag_read,n_chunk,SID_INT,SID_MAX,SID.COMM_WORLD);
+  int n_rounds   =1;
+  int i_round_rank=0;
+#else
+  // Ranks read in rounds of n_readers
+  int n_readers=fp->n_readers_chunked;
+  if(n_readers<=0 || n_readers>SID.n_proc)
+    n_readers=SID.n_proc;
+  int n_rounds    =(SID.n_proc+n_readers-1)/n_readers;
+  int i_round_rank=SID.My_rank/n_readers;
 #endif
+  int i_round;
+  for(i_round=0;i_round<n_rounds;i_round++){
+    if(i_round==i_round_rank){
+      for(i_chunk=0,i_x_read_chunk=0;i_chunk<n_chunk;i_chunk++){
+        if(flag_read[i_chunk]){
+          sprintf(filename_chunk,"%s.%d",fp->filename_root,i_chunk);
           SID_fopen(filename_chunk,"r",fp);
-          if(n_x_chunk>0){
+          if(n_x_chunk[i_chunk]>0){
             SID_fseek(fp,
                       1,
-                      fp->header_offset[i_chunk]+n_skip*fp->chunked_header.item_size,
+                      fp->header_offset[i_chunk]+n_skip[i_chunk]*item_size,
                       SID_SEEK_SET);
-            SID_fread(&(((char *)buffer)[i_x_read_chunk*fp->chunked_header.item_size]),
-                      fp->chunked_header.item_size,
-                      n_x_chunk,
+            SID_fread(&(((char *)buffer)[i_x_read_chunk*item_size]),
+                      item_size,
+                      n_x_chunk[i_chunk],
                       fp);
-            i_x_chunk     +=n_x_chunk;
-            i_x_read_chunk+=n_x_chunk;
+            i_x_read_chunk+=n_x_chunk[i_chunk];
           }
           SID_fclose(fp);
-#if !USE_MPI_IO
         }
-        SID_Barrier(SID.COMM_WORLD);
       }
-#endif
     }
+    if(n_rounds>1)
+      SID_Barrier(SID.COMM_WORLD);
   }
+  SID_free(SID_FARG n_skip);
+  SID_free(SID_FARG n_x_chunk);
+  SID_free(SID_FARG flag_read);
+
+  // Advance the file position past the last item read by any rank
+  i_x_chunk=i_x_offset_local+fp->last_item+i_x_read_chunk;
   SID_Allreduce(&i_x_chunk,&(fp->last_item),1,SID_SIZE_T,SID_MAX,SID.COMM_WORLD);
-  //fp->last_item--;
-  return(r_val);
+  return(i_x_read_chunk);
 }
 
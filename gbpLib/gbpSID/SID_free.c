@@ -5,7 +5,7 @@
 
 void SID_free(void **ptr){
   if((*ptr)!=NULL){
-    SID.RAM_local-=sizeof((*ptr));
+    SID_remove_allocation((*ptr));
     free((*ptr));
     (*ptr)=NULL;
   }
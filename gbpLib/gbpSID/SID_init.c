@@ -15,6 +15,10 @@ void SID_init(int       *argc,
   int  flag_continue;
   int  flag_passed_comm;
 
+  // Allocations not made under a tag are counted against the default one
+  strcpy(SID.memory.tags[0].name,SID_MEMORY_TAG_DEFAULT);
+  SID.memory.n_tags=MAX(1,SID.memory.n_tags);
+
   // MPI-specific things
 #if USE_MPI
   int      n_keys;
@@ -33,7 +37,18 @@ void SID_init(int       *argc,
 
   if(mpi_comm_as_void == NULL){
     flag_passed_comm=FALSE;
+#if USE_PTHREADS || USE_OPENMP
+    // Read-ahead file buffers read from a second thread (see
+    //   start_SID_fp_buffer_read()) and some MPI exchanges are polled from
+    //   the master thread of OpenMP regions, though MPI is only ever called
+    //   from this thread
+    int thread_level;
+    MPI_Init_thread(argc,argv,MPI_THREAD_FUNNELED,&thread_level);
+    if(thread_level<MPI_THREAD_FUNNELED)
+      SID_trap_error("MPI does not support MPI_THREAD_FUNNELED.",ERROR_LOGIC);
+#else
     MPI_Init(argc,argv);
+#endif
     MPI_Comm_dup(MPI_COMM_WORLD, &mpi_comm);
   }
   else{
@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gbpCommon.h>
+#include <gbpSID.h>
+
+// Write a number of bytes to string in kb, Mb or Gb
+void format_RAM_local(size_t n_bytes,char *string);
+void format_RAM_local(size_t n_bytes,char *string){
+  if(n_bytes>=SIZE_OF_GIGIBYTE)
+    sprintf(string,"%7.2lf Gb",(double)n_bytes/(double)SIZE_OF_GIGIBYTE);
+  else if(n_bytes>=SIZE_OF_MEGABYTE)
+    sprintf(string,"%7.2lf Mb",(double)n_bytes/(double)SIZE_OF_MEGABYTE);
+  else
+    sprintf(string,"%7.2lf kb",(double)n_bytes/(double)SIZE_OF_KILOBYTE);
+}
+
+// Report the high-water mark of each memory tag: the largest on any
+//   rank and the sum of every rank's.  Tags are matched by name, so
+//   ranks need not have created them in the same order.  Called
+//   collectively by SID_exit().
+void SID_log_memory_tags(void){
+  SID_memory_tag  tags_all[SID_MEMORY_TAG_N_MAX];
+  SID_memory_tag *tags_rank=SID.memory.tags;
+  int            *n_tags_rank=&(SID.memory.n_tags);
+  int             n_tags_all=0;
+  int             i_rank;
+  int             i_tag;
+  int             j_tag;
+  char            max_string[32];
+  char            sum_string[32];
+
+  // Gather every rank's tags to the master.  Plain malloc() is used so
+  //   that the buffers do not show up in the statistics being reported.
+#if USE_MPI
+  SID_memory_tag *tags_gather  =NULL;
+  int            *n_tags_gather=NULL;
+  if(SID.I_am_Master){
+    tags_gather  =(SID_memory_tag *)malloc(sizeof(SID_memory_tag)*SID_MEMORY_TAG_N_MAX*SID.n_proc);
+    n_tags_gather=(int            *)malloc(sizeof(int)*SID.n_proc);
+  }
+  MPI_Gather(&(SID.memory.n_tags),1,MPI_INT,n_tags_gather,1,MPI_INT,MASTER_RANK,SID_COMM_WORLD);
+  MPI_Gather(SID.memory.tags,(int)(sizeof(SID_memory_tag)*SID_MEMORY_TAG_N_MAX),MPI_BYTE,
+             tags_gather,    (int)(sizeof(SID_memory_tag)*SID_MEMORY_TAG_N_MAX),MPI_BYTE,
+             MASTER_RANK,SID_COMM_WORLD);
+#endif
+
+  for(i_rank=0;i_rank<SID.n_proc && SID.I_am_Master;i_rank++){
+#if USE_MPI
+    tags_rank  =&(tags_gather[SID_MEMORY_TAG_N_MAX*i_rank]);
+    n_tags_rank=&(n_tags_gather[i_rank]);
+#endif
+    for(i_tag=0;i_tag<(*n_tags_rank);i_tag++){
+      const char *name_i=tags_rank[i_tag].name;
+      if(name_i[0]=='\0')
+        name_i=SID_MEMORY_TAG_DEFAULT;
+      for(j_tag=0;j_tag<n_tags_all;j_tag++){
+        if(!strcmp(tags_all[j_tag].name,name_i))
+          break;
+      }
+      // RAM holds the sum of the ranks' peaks
+      if(j_tag==n_tags_all){
+        if(n_tags_all>=SID_MEMORY_TAG_N_MAX)
+          continue;
+        strcpy(tags_all[j_tag].name,name_i);
+        tags_all[j_tag].RAM    =0;
+        tags_all[j_tag].max_RAM=0;
+        n_tags_all++;
+      }
+      tags_all[j_tag].RAM    +=tags_rank[i_tag].max_RAM;
+      tags_all[j_tag].max_RAM =MAX(tags_all[j_tag].max_RAM,tags_rank[i_tag].max_RAM);
+    }
+  }
+#if USE_MPI
+  if(SID.I_am_Master){
+    free(tags_gather);
+    free(n_tags_gather);
+  }
+#endif
+
+  if(SID.I_am_Master && n_tags_all>0){
+    fprintf(SID.fp_log,"\nPeak memory usage by tag (largest rank/sum over ranks):\n");
+    fprintf(SID.fp_log,"------------------------\n");
+    for(i_tag=0;i_tag<n_tags_all;i_tag++){
+      if(tags_all[i_tag].max_RAM>0){
+        format_RAM_local(tags_all[i_tag].max_RAM,max_string);
+        format_RAM_local(tags_all[i_tag].RAM,    sum_string);
+        fprintf(SID.fp_log,"%-*s=%s/%s\n",SID_MEMORY_TAG_NAME_LENGTH/2,tags_all[i_tag].name,max_string,sum_string);
+      }
+    }
+  }
+}
+
@@ -0,0 +1,14 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gbpCommon.h>
+#include <gbpSID.h>
+
+// Return to the memory tag in use before the last call to
+//   SID_push_memory_tag()
+void SID_pop_memory_tag(void){
+  if(SID.memory.n_tag_stack<=0)
+    SID_trap_error("SID_pop_memory_tag() called without a matching push.",ERROR_LOGIC);
+  SID.memory.n_tag_stack--;
+}
+
@@ -0,0 +1,31 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gbpCommon.h>
+#include <gbpSID.h>
+
+// Count subsequent allocations against the memory tag called name
+//   (eg. "trees" or "render") until the matching call to
+//   SID_pop_memory_tag().  Tags nest; each tag's high-water mark is
+//   reported by SID_exit().
+void SID_push_memory_tag(const char *name){
+  SID_memory_info *memory=&(SID.memory);
+  int              i_tag;
+  if(memory->n_tag_stack>=SID_MEMORY_TAG_STACK_MAX)
+    SID_trap_error("Memory tags nested more than %d deep when pushing {%s}.",ERROR_LOGIC,SID_MEMORY_TAG_STACK_MAX,name);
+  for(i_tag=1;i_tag<memory->n_tags;i_tag++){
+    if(!strncmp(memory->tags[i_tag].name,name,SID_MEMORY_TAG_NAME_LENGTH-1))
+      break;
+  }
+  if(i_tag>=memory->n_tags){
+    if(i_tag>=SID_MEMORY_TAG_N_MAX)
+      SID_trap_error("Too many memory tags (%d) when adding {%s}.",ERROR_LOGIC,SID_MEMORY_TAG_N_MAX,name);
+    strncpy(memory->tags[i_tag].name,name,SID_MEMORY_TAG_NAME_LENGTH-1);
+    memory->tags[i_tag].name[SID_MEMORY_TAG_NAME_LENGTH-1]='\0';
+    memory->tags[i_tag].RAM    =0;
+    memory->tags[i_tag].max_RAM=0;
+    memory->n_tags=i_tag+1;
+  }
+  memory->tag_stack[memory->n_tag_stack++]=i_tag;
+}
+
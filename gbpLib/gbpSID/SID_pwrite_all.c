@@ -0,0 +1,18 @@
+#include <unistd.h>
+#include <gbpCommon.h>
+#include <gbpSID.h>
+
+// Write n_bytes of buffer to file descriptor fd at byte offset, resuming
+//   after partial writes.  The file pointer is not moved, so ranks may
+//   write to different parts of a file at once.  Traps on failure.
+void SID_pwrite_all(int fd,const void *buffer,size_t n_bytes,size_t offset){
+   const char *buffer_i=(const char *)buffer;
+   while(n_bytes>0){
+      ssize_t n_written=pwrite(fd,buffer_i,n_bytes,(off_t)offset);
+      if(n_written<=0)
+         SID_trap_error("Could not write %zd bytes at offset %zd.",ERROR_IO_WRITE,n_bytes,offset);
+      buffer_i+=n_written;
+      offset  +=(size_t)n_written;
+      n_bytes -=(size_t)n_written;
+   }
+}
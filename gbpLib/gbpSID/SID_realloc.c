@@ -7,11 +7,11 @@
 void *SID_realloc(void *original_pointer,size_t allocation_size){
   void *r_val;
   if(allocation_size>0){
+    SID_remove_allocation(original_pointer);
     r_val=realloc(original_pointer,allocation_size);
     if(r_val==NULL)
       SID_trap_error("Could not re-allocate %lld bytes of RAM!",ERROR_MEMORY,allocation_size);
-    SID.RAM_local   +=allocation_size;
-    SID.max_RAM_local=MAX(SID.max_RAM_local,SID.RAM_local);
+    SID_add_allocation(r_val,allocation_size);
   }
   else
     r_val=NULL;
@@ -0,0 +1,47 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gbpCommon.h>
+#include <gbpSID.h>
+
+// Remove the allocation at ptr from the memory accounting and return
+//   its size.  Returns 0 (and does nothing) if ptr was not allocated
+//   by SID.  Called by SID_free() and SID_realloc().
+size_t SID_remove_allocation(void *ptr){
+  SID_memory_info *memory=&(SID.memory);
+  size_t           allocation_size=0;
+  if(ptr!=NULL && memory->n_entries>0){
+#if USE_OPENMP
+#pragma omp critical(SID_memory)
+#endif
+    {
+    size_t mask   =memory->table_size-1;
+    size_t i_entry=SID_MEMORY_HASH(ptr,memory->table_size);
+    while(memory->table[i_entry].ptr!=NULL && memory->table[i_entry].ptr!=ptr)
+      i_entry=(i_entry+1)&mask;
+    if(memory->table[i_entry].ptr==ptr){
+      allocation_size                                =memory->table[i_entry].size;
+      SID.RAM_local                                  -=allocation_size;
+      memory->tags[memory->table[i_entry].i_tag].RAM-=allocation_size;
+      memory->n_entries--;
+
+      // Close the gap, moving back any later entries of the run
+      //   that would otherwise no longer be found
+      size_t j_entry=i_entry;
+      while(TRUE){
+        j_entry=(j_entry+1)&mask;
+        if(memory->table[j_entry].ptr==NULL)
+          break;
+        size_t k_entry=SID_MEMORY_HASH(memory->table[j_entry].ptr,memory->table_size);
+        if(((j_entry-k_entry)&mask)>=((j_entry-i_entry)&mask)){
+          memory->table[i_entry]=memory->table[j_entry];
+          i_entry=j_entry;
+        }
+      }
+      memory->table[i_entry].ptr=NULL;
+    }
+    }
+  }
+  return(allocation_size);
+}
+
@@ -0,0 +1,54 @@
+#include <gbpCommon.h>
+#include <gbpSID.h>
+
+// Wait for the read started by start_SID_fp_buffer_read() to complete.
+//   Without MPI-IO, the master broadcasts the block in pieces of
+//   SID_FP_BUFFER_BCAST_SIZE bytes as they arrive, so the broadcasts
+//   are pipelined with the rest of the read.  Called collectively.
+void finish_SID_fp_buffer_read(SID_fp_buffer *fp_buffer){
+   if(!fp_buffer->flag_next_pending)
+      SID_trap_error("No buffered read is pending.",ERROR_LOGIC);
+#if USE_MPI_IO
+   MPI_Status status;
+   int        n_bytes_read;
+   MPI_Wait(&(fp_buffer->request),&status);
+   MPI_Get_count(&status,MPI_BYTE,&n_bytes_read);
+   if((size_t)n_bytes_read!=fp_buffer->n_bytes_next)
+      SID_trap_error("Failed to read %zd bytes (only %d returned).",ERROR_IO_READ,fp_buffer->n_bytes_next,n_bytes_read);
+#else
+   int    flag_read   =TRUE;
+   size_t n_bytes_done=0;
+#if USE_MPI
+   flag_read=SID.I_am_Master;
+#endif
+   while(n_bytes_done<fp_buffer->n_bytes_next){
+      size_t n_bytes_chunk=MIN(SID_FP_BUFFER_BCAST_SIZE,fp_buffer->n_bytes_next-n_bytes_done);
+      if(flag_read){
+#if USE_PTHREADS
+         // Wait for the reading thread to get through this piece
+         pthread_mutex_lock(&(fp_buffer->lock));
+         while(fp_buffer->n_bytes_next_done<(n_bytes_done+n_bytes_chunk) && !fp_buffer->flag_next_failed)
+            pthread_cond_wait(&(fp_buffer->cond_read),&(fp_buffer->lock));
+         int flag_failed=fp_buffer->flag_next_failed;
+         pthread_mutex_unlock(&(fp_buffer->lock));
+         if(flag_failed){
+            pthread_join(fp_buffer->thread,NULL);
+            SID_trap_error("Failed to read %zd bytes (only %zd returned).",ERROR_IO_READ,fp_buffer->n_bytes_next,fp_buffer->n_bytes_next_done);
+         }
+#else
+         fread_verify(&(fp_buffer->buffer_next[n_bytes_done]),1,n_bytes_chunk,fp_buffer->fp->fp);
+#endif
+      }
+#if USE_MPI
+      SID_Bcast(&(fp_buffer->buffer_next[n_bytes_done]),(int)n_bytes_chunk,MASTER_RANK,SID.COMM_WORLD);
+#endif
+      n_bytes_done+=n_bytes_chunk;
+   }
+#if USE_PTHREADS
+   if(flag_read)
+      pthread_join(fp_buffer->thread,NULL);
+#endif
+#endif
+   fp_buffer->n_bytes_next_done=fp_buffer->n_bytes_next;
+   fp_buffer->flag_next_pending=FALSE;
+}
@@ -3,11 +3,22 @@
 
 // Free the read buffer
 void free_SID_fp_buffer(SID_fp_buffer **fp_buffer){
+   // A pending read-ahead holds bytes which were never processed
+   if((*fp_buffer)->flag_next_pending){
+      finish_SID_fp_buffer_read((*fp_buffer));
+      (*fp_buffer)->n_bytes_unread+=(*fp_buffer)->n_bytes_next;
+   }
    if((*fp_buffer)->n_bytes_unread!=0)
       SID_trap_error("The file was not entirely processed.  %zd bytes left.",ERROR_LOGIC,(*fp_buffer)->n_bytes_unread);
    if((*fp_buffer)->n_bytes_buffer_unprocessed!=0)
       SID_trap_error("The file buffer was not entirely processed.  %zd of %zd bytes left.",ERROR_LOGIC,(*fp_buffer)->n_bytes_buffer_unprocessed,(*fp_buffer)->n_bytes_buffer);
+   if((*fp_buffer)->flag_read_ahead){
+      SID_free(SID_FARG (*fp_buffer)->buffer_next);
+#if USE_PTHREADS && !USE_MPI_IO
+      pthread_mutex_destroy(&((*fp_buffer)->lock));
+      pthread_cond_destroy (&((*fp_buffer)->cond_read));
+#endif
+   }
    SID_free(SID_FARG (*fp_buffer)->buffer);
    SID_free(SID_FARG (*fp_buffer));
 }
-
@@ -13,6 +13,10 @@
   #endif
 #endif 
 
+#if USE_PTHREADS
+  #include <pthread.h>
+#endif
+
 #ifndef _FILE_H
 #define _FILE_H
 #if _FILE_C
@@ -73,6 +77,19 @@ _FILE_C_CLASS int b;
 #define SID_CAT_DEFAULT 0
 #define SID_CAT_CLEAN   2
 
+#define SID_CHUNKED_READERS_ALL 0
+
+#define SID_MEMORY_TAG_DEFAULT      "untagged"
+#define SID_MEMORY_TAG_N_MAX        32
+#define SID_MEMORY_TAG_STACK_MAX    32
+#define SID_MEMORY_TAG_NAME_LENGTH  32
+#define SID_MEMORY_TABLE_SIZE_INIT  1024
+#define SID_ARENA_ALIGNMENT         16
+#define SID_ARENA_BLOCK_SIZE_DEFAULT SIZE_OF_MEGABYTE
+#define SID_ARENA_BLOCK_SIZE_MIN    (4*SIZE_OF_KILOBYTE)
+#define SID_FP_BUFFER_BCAST_SIZE    (256*SIZE_OF_KILOBYTE)
+#define SID_MEMORY_HASH(ptr,table_size) ((((((size_t)(ptr))>>4)*((size_t)2654435761U))^(((size_t)(ptr))>>20))&((table_size)-1))
+
 #if USE_MPI
   #define SID_MAXLENGTH_PROCESSOR_NAME MPI_MAX_PROCESSOR_NAME
 #else
@@ -177,6 +194,54 @@ struct SID_Comm{
   int        My_rank;
 };
 
+// Structures for tracking the size of each allocation made with
+//   SID_malloc(), SID_calloc() and SID_realloc() and the memory used
+//   by each subsystem (tag).  Sizes are kept in a hash table indexed
+//   by the allocation's address, so memory from (or handed to) the
+//   standard library is simply not counted.
+typedef struct SID_memory_entry SID_memory_entry;
+struct SID_memory_entry{
+  void   *ptr;
+  size_t  size;
+  int     i_tag;
+};
+typedef struct SID_memory_tag SID_memory_tag;
+struct SID_memory_tag{
+  char    name[SID_MEMORY_TAG_NAME_LENGTH];
+  size_t  RAM;
+  size_t  max_RAM;
+};
+typedef struct SID_memory_info SID_memory_info;
+struct SID_memory_info{
+  SID_memory_entry *table;
+  size_t            table_size;
+  size_t            n_entries;
+  SID_memory_tag    tags[SID_MEMORY_TAG_N_MAX];
+  int               n_tags;
+  int               tag_stack[SID_MEMORY_TAG_STACK_MAX];
+  int               n_tag_stack;
+};
+
+// Structures for arena allocation: many small objects are carved out
+//   of large blocks so that they sit together in memory and can all
+//   be released at once with SID_arena_reset() or SID_arena_free().
+//   Blocks start small and double in size up to block_size.
+typedef struct SID_arena_block SID_arena_block;
+struct SID_arena_block{
+  char            *data;
+  size_t           size;
+  size_t           used;
+  SID_arena_block *next;
+};
+typedef struct SID_arena SID_arena;
+struct SID_arena{
+  SID_arena_block *first;
+  SID_arena_block *current;
+  size_t           block_size;      // Largest size of an ordinary block
+  size_t           block_size_next; // Size of the next block to be added
+  size_t           n_bytes;
+};
+
 // Structure to store SID info 
 typedef struct SID_info SID_info;
 struct SID_info{
@@ -218,6 +283,7 @@ struct SID_info{
   char      My_binary[MAX_FILENAME_LENGTH];
   int      *arg_set;
   int      *arg_alloc;
+  SID_memory_info memory;
 };
 
 // Default values
@@ -270,6 +336,7 @@ struct SID_fp{
   size_t              *i_x_last_chunk;
   size_t              *header_offset;
   size_t               last_item;
+  int                  n_readers_chunked; // Ranks reading chunks at once (SID_CHUNKED_READERS_ALL for all)
 };
 
 // This is used with SID_fp to perform buffered reads
@@ -283,6 +350,20 @@ struct SID_fp_buffer{
    size_t  n_bytes_buffer_unprocessed;
    size_t  n_bytes_buffer_processed;
    size_t  n_bytes_buffer;
+   // Used only in read-ahead mode (see init_SID_fp_buffer_read_ahead())
+   int     flag_read_ahead;
+   int     flag_next_pending; // A read into buffer_next has been started
+   char   *buffer_next;
+   size_t  n_bytes_next;      // Size of the block being read into buffer_next
+   size_t  n_bytes_next_done; // Bytes of that block read so far
+#if USE_MPI_IO
+   MPI_Request     request;
+#elif USE_PTHREADS
+   pthread_t       thread;
+   pthread_mutex_t lock;
+   pthread_cond_t  cond_read;
+   int             flag_next_failed; // Set by the reading thread on a short read
+#endif
 };
 
 // Function declarations 
@@ -357,6 +438,9 @@ size_t SID_fread_chunked_all(void   *buffer,
 void init_SID_fp_buffer(SID_fp *fp,size_t n_bytes_to_read,size_t n_bytes_buffer_max,SID_fp_buffer **fp_buffer);
 void reset_SID_fp_buffer(SID_fp_buffer **fp_buffer);
 void free_SID_fp_buffer(SID_fp_buffer **fp_buffer);
+void init_SID_fp_buffer_read_ahead(SID_fp *fp,size_t n_bytes_to_read,size_t n_bytes_buffer_max,SID_fp_buffer **fp_buffer);
+void start_SID_fp_buffer_read(SID_fp_buffer *fp_buffer);
+void finish_SID_fp_buffer_read(SID_fp_buffer *fp_buffer);
 int  SID_fread_all_buffer(void *rval,size_t dtype_size,size_t n_items,SID_fp_buffer *fp_buffer);
 
 void SID_fskip_chunked(size_t  n_x_skip_local,
@@ -379,6 +463,7 @@ void SID_cat_files(const char *filename_out,
                    int   n_files, ...);
 size_t SID_fwrite_all(void *buffer,size_t size_per_item, size_t n_items,SID_fp *fp);
 size_t SID_fwrite_ordered(void *buffer,size_t size_per_item, size_t n_items,SID_fp *fp);
+void   SID_pwrite_all(int fd,const void *buffer,size_t n_bytes,size_t offset);
 size_t SID_fwrite(void *buffer,size_t size_per_item, size_t n_items,SID_fp *fp);
 size_t SID_fwrite_chunked(void   *buffer,
                           size_t  n_x_write_local,
@@ -412,6 +497,15 @@ void *SID_realloc(void *original_pointer,size_t allocation_size);
 void *SID_malloc_array(size_t allocation_size_i,int n_D,...);
 void *SID_calloc(size_t allocation_size);
 void SID_free_array(void **ptr,int n_D,...);
+void   SID_add_allocation(void *ptr,size_t allocation_size);
+size_t SID_remove_allocation(void *ptr);
+void   SID_push_memory_tag(const char *name);
+void   SID_pop_memory_tag(void);
+void   SID_log_memory_tags(void);
+void   SID_arena_init(SID_arena *arena,size_t block_size);
+void  *SID_arena_alloc(SID_arena *arena,size_t allocation_size);
+void   SID_arena_reset(SID_arena *arena);
+void   SID_arena_free(SID_arena *arena);
 
 void calc_max(void   *data,
               void   *result,
@@ -6,8 +6,19 @@
 void init_SID_fp_buffer(SID_fp *fp,size_t n_bytes_to_read,size_t n_bytes_buffer_max,SID_fp_buffer **fp_buffer){
    if((*fp_buffer)==NULL)
       (*fp_buffer)=(SID_fp_buffer *)SID_malloc(sizeof(SID_fp_buffer));
-   else
+   else{
       SID_free(SID_FARG (*fp_buffer)->buffer);
+      // Clean-up anything left by a read-ahead buffer
+      if((*fp_buffer)->flag_read_ahead){
+         if((*fp_buffer)->flag_next_pending)
+            finish_SID_fp_buffer_read((*fp_buffer));
+         SID_free(SID_FARG (*fp_buffer)->buffer_next);
+#if USE_PTHREADS && !USE_MPI_IO
+         pthread_mutex_destroy(&((*fp_buffer)->lock));
+         pthread_cond_destroy (&((*fp_buffer)->cond_read));
+#endif
+      }
+   }
    (*fp_buffer)->fp                        =fp;
    (*fp_buffer)->buffer                    =(char *)SID_malloc(n_bytes_buffer_max);
    (*fp_buffer)->n_bytes_buffer_max        =n_bytes_buffer_max;
@@ -16,5 +27,9 @@ void init_SID_fp_buffer(SID_fp *fp,size_t n_bytes_to_read,size_t n_bytes_buffer_
    (*fp_buffer)->n_bytes_buffer_unprocessed=0; // This way we will perform a read right away
    (*fp_buffer)->n_bytes_buffer_processed  =0;
    (*fp_buffer)->n_bytes_buffer            =0;
+   (*fp_buffer)->flag_read_ahead           =FALSE;
+   (*fp_buffer)->flag_next_pending         =FALSE;
+   (*fp_buffer)->buffer_next               =NULL;
+   (*fp_buffer)->n_bytes_next              =0;
+   (*fp_buffer)->n_bytes_next_done         =0;
 }
-
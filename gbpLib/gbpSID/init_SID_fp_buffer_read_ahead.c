@@ -0,0 +1,19 @@
+#include <gbpCommon.h>
+#include <gbpSID.h>
+
+// Inititialize a read buffer which reads the next block of the file
+//   while the current one is being processed.  Two buffers of
+//   n_bytes_buffer_max bytes are allocated.  The first read is not
+//   started until the first call to SID_fread_all_buffer(), so the
+//   file may still be positioned after this is called.
+// IMPORTANT: the file must not be read or positioned directly while a
+//   read is pending.  Call reset_SID_fp_buffer() first.
+void init_SID_fp_buffer_read_ahead(SID_fp *fp,size_t n_bytes_to_read,size_t n_bytes_buffer_max,SID_fp_buffer **fp_buffer){
+   init_SID_fp_buffer(fp,n_bytes_to_read,n_bytes_buffer_max,fp_buffer);
+   (*fp_buffer)->flag_read_ahead=TRUE;
+   (*fp_buffer)->buffer_next    =(char *)SID_malloc(n_bytes_buffer_max);
+#if USE_PTHREADS && !USE_MPI_IO
+   pthread_mutex_init(&((*fp_buffer)->lock),NULL);
+   pthread_cond_init (&((*fp_buffer)->cond_read),NULL);
+#endif
+}
@@ -0,0 +1,68 @@
+#include <gbpCommon.h>
+#include <gbpSID.h>
+
+#if USE_PTHREADS && !USE_MPI_IO
+// Read the next block of a read-ahead buffer in pieces of
+//   SID_FP_BUFFER_BCAST_SIZE bytes, reporting progress as it goes so
+//   that each piece can be broadcast while the next is read.  Only
+//   stdio is used here; all MPI calls stay on the calling thread.
+void *read_SID_fp_buffer_local(void *fp_buffer_in);
+void *read_SID_fp_buffer_local(void *fp_buffer_in){
+   SID_fp_buffer *fp_buffer   =(SID_fp_buffer *)fp_buffer_in;
+   size_t         n_bytes_done=0;
+   while(n_bytes_done<fp_buffer->n_bytes_next){
+      size_t n_bytes_chunk=MIN(SID_FP_BUFFER_BCAST_SIZE,fp_buffer->n_bytes_next-n_bytes_done);
+      size_t n_bytes_read =fread(&(fp_buffer->buffer_next[n_bytes_done]),1,n_bytes_chunk,fp_buffer->fp->fp);
+      n_bytes_done+=n_bytes_read;
+      pthread_mutex_lock(&(fp_buffer->lock));
+      fp_buffer->n_bytes_next_done=n_bytes_done;
+      if(n_bytes_read!=n_bytes_chunk)
+         fp_buffer->flag_next_failed=TRUE;
+      pthread_cond_signal(&(fp_buffer->cond_read));
+      pthread_mutex_unlock(&(fp_buffer->lock));
+      if(n_bytes_read!=n_bytes_chunk)
+         break;
+   }
+   return(NULL);
+}
+#endif
+
+// Start reading the next block of a read-ahead buffer into its second
+//   buffer.  With MPI-IO this is a non-blocking read; otherwise the
+//   block is read by a background thread if POSIX threads are enabled
+//   (and when finish_SID_fp_buffer_read() is called if not).  Must be
+//   matched by a call to finish_SID_fp_buffer_read() on all ranks.
+void start_SID_fp_buffer_read(SID_fp_buffer *fp_buffer){
+   if(fp_buffer->flag_next_pending)
+      SID_trap_error("A buffered read is already pending.",ERROR_LOGIC);
+
+   // Set the size of the next block
+   fp_buffer->n_bytes_next        =MIN(fp_buffer->n_bytes_unread,fp_buffer->n_bytes_buffer_max);
+   fp_buffer->n_bytes_next_done   =0;
+   fp_buffer->n_bytes_unread     -=fp_buffer->n_bytes_next;
+   fp_buffer->flag_next_pending   =TRUE;
+
+   // Start the read
+#if USE_MPI_IO
+   MPI_File_iread(fp_buffer->fp->fp,
+                  fp_buffer->buffer_next,
+                  (int)fp_buffer->n_bytes_next,
+                  MPI_BYTE,
+                  &(fp_buffer->request));
+#elif USE_MPI || USE_PTHREADS
+   int flag_read=TRUE;
+#if USE_MPI
+   // Only the master reads; the rest just move past the block
+   flag_read=SID.I_am_Master;
+   if(!flag_read)
+      fseek(fp_buffer->fp->fp,fp_buffer->n_bytes_next,SEEK_CUR);
+#endif
+#if USE_PTHREADS
+   if(flag_read){
+      fp_buffer->flag_next_failed=FALSE;
+      if(pthread_create(&(fp_buffer->thread),NULL,read_SID_fp_buffer_local,(void *)fp_buffer)!=0)
+         SID_trap_error("Failed to start the read-ahead thread.",ERROR_LOGIC);
+   }
+#endif
+#endif
+}
@@ -0,0 +1,15 @@
+#include <stdlib.h>
+#include <gbpCommon.h>
+#include <gbpSID.h>
+#include <gbpDomain.h>
+
+// Wait for an exchange started with start_exchange_slab_buffers()
+//   to complete
+void finish_exchange_slab_buffers(slab_exchange_info *exchange){
+#if USE_MPI
+  if(!exchange->flag_complete)
+    MPI_Waitall(exchange->n_request,exchange->request,MPI_STATUSES_IGNORE);
+#endif
+  exchange->flag_complete=TRUE;
+}
+
@@ -3,6 +3,9 @@
 #include <stdlib.h>
 #include <gbpLib.h>
 #include <gbpDomain.h>
+#if USE_FFTW
+#include <gbpFFT.h>
+#endif
 
 void free_field(field_info *FFT){
   int i_d;
@@ -16,15 +19,20 @@ void free_field(field_info *FFT){
 
   // Free FFTs
   #if USE_FFTW
-    #if USE_MPI
-      rfftwnd_mpi_destroy_plan(FFT->plan);
-      rfftwnd_mpi_destroy_plan(FFT->iplan);
-    #else
-      rfftwnd_destroy_plan(FFT->plan);
-      rfftwnd_destroy_plan(FFT->iplan);
-    #endif
+    free_FFT_plans(FFT);
   #endif
 
+  // Free the pencil decomposition
+  if(FFT->flag_pencil){
+    for(i_d=0;i_d<2;i_d++){
+      SID_Comm_free(&(FFT->pencil.comm[i_d]));
+      SID_free(SID_FARG FFT->pencil.i_R_start[i_d]);
+      SID_free(SID_FARG FFT->pencil.n_R[i_d]);
+      SID_free(SID_FARG FFT->pencil.i_k_start[i_d]);
+      SID_free(SID_FARG FFT->pencil.n_k[i_d]);
+    }
+  }
+
   // Free field arrays
   for(i_d=0;i_d<FFT->n_d;i_d++){
     SID_free(SID_FARG FFT->k_field[i_d]);
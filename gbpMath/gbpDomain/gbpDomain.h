@@ -3,7 +3,13 @@
 #ifndef GBPFFTW_AWAKE
   #define GBPFFTW_AWAKE
   #if USE_FFTW
-    #if USE_MPI
+    #if USE_FFTW3
+      #if USE_MPI
+        #include <fftw3-mpi.h>
+      #else
+        #include <fftw3.h>
+      #endif
+    #elif USE_MPI
       #if USE_DOUBLE
         #include <drfftw_mpi.h>
       #else
@@ -20,22 +26,111 @@
 #endif
 #include <gbpLib.h> // Needed for GBPREAL definition
 
+// FFTW3 names its routines by precision (fftw_ vs. fftwf_) and stores
+//   complex numbers as arrays.  Give it the FFTW2 names that the rest
+//   of the code uses so that either version can be compiled against.
+#if USE_FFTW && USE_FFTW3
+  #if USE_DOUBLE
+    #define FFTW3_NAME(name) fftw_ ## name
+  #else
+    #define FFTW3_NAME(name) fftwf_ ## name
+  #endif
+  typedef GBPREAL fftw_real;
+  typedef struct FFT_complex FFT_complex;
+  struct FFT_complex{
+    fftw_real re;
+    fftw_real im;
+  };
+
+  // FFTW3 plans are cached (see init_FFT_plans()) and shared by
+  //   all fields with the same shape, decomposition and alignment
+  typedef struct FFT_plan_info FFT_plan_info;
+  struct FFT_plan_info{
+    int                n_d;
+    int               *n;
+    int                n_proc;
+    int                i_R_start_local;
+    int                n_R_local;
+    int                i_k_start_local;
+    int                n_k_local;
+    int                alignment;
+    int                n_threads;
+    int                n_references;
+    FFTW3_NAME(plan)   plan;
+    FFTW3_NAME(plan)   iplan;
+    // Pencil decompositions (see init_field()) are transformed one axis
+    //   at a time by serial plans, with transposes in between
+    int                flag_pencil;
+    int                n_R_local_y;
+    int                n_k_local_z;
+    FFTW3_NAME(plan)   plan_pencil[3];
+    FFTW3_NAME(plan)   iplan_pencil[3];
+    FFT_plan_info     *next;
+  };
+#endif
+
+// Field decompositions (see init_field())
+#define FIELD_MODE_DEFAULT 0
+#define FIELD_MODE_PENCIL  2
+
+// The local part of a decomposed field.  Slabs span all of y; pencils
+//   are also split in y and have neighbours in that direction too.
 typedef struct slab_info slab_info;
 struct slab_info{
   double x_min_local;
   double x_max_local;
   double x_max;
+  double y_min_local;
+  double y_max_local;
+  double y_max;
   int    n_x_local;
   int    i_x_start_local;
   int    i_x_stop_local;
+  int    n_y_local;
+  int    i_y_start_local;
+  int    i_y_stop_local;
   int    rank_to_left;
   int    rank_to_right;
+  int    rank_to_left_y;
+  int    rank_to_right_y;
+};
+
+// Pencil decomposition of a 3-d field.  Ranks form an n_proc[0] x
+//   n_proc[1] grid (rank=i_rank[0]*n_proc[1]+i_rank[1]).  comm[0] holds
+//   the ranks in this rank's column of the grid (the same y block) and
+//   comm[1] those in its row (the same x block).  For the ranks of
+//   comm[0], i_R_start[0]/n_R[0] give their x blocks and i_k_start[0]/
+//   n_k[0] their k_y blocks; for those of comm[1], i_R_start[1]/n_R[1]
+//   give their y blocks and i_k_start[1]/n_k[1] their k_z blocks.
+typedef struct pencil_info pencil_info;
+struct pencil_info{
+  int       n_proc[2];
+  int       i_rank[2];
+  SID_Comm *comm[2];
+  int      *i_R_start[2];
+  int      *n_R[2];
+  int      *i_k_start[2];
+  int      *n_k[2];
+};
+
+// State of a non-blocking exchange of slab buffers
+//   (see start_exchange_slab_buffers())
+typedef struct slab_exchange_info slab_exchange_info;
+struct slab_exchange_info{
+  #if USE_MPI
+    MPI_Request request[4];
+  #endif
+  int         n_request;
+  int         flag_complete;
 };
 
 typedef struct field_info field_info;
 struct field_info{
   // Array storing the field
-  #if USE_FFTW
+  #if USE_FFTW && USE_FFTW3
+    fftw_real    *field_local;
+    FFT_complex  *cfield_local;
+  #elif USE_FFTW
     fftw_real    *field_local;
     fftw_complex *cfield_local;
   #else
@@ -66,8 +161,13 @@ struct field_info{
   int               pad_size_k;
   // flags
   int               flag_padded;
+  int               flag_pencil;
+  // Pencil decomposition (set if flag_pencil is)
+  pencil_info       pencil;
   // FFTW plans
-  #if USE_FFTW
+  #if USE_FFTW && USE_FFTW3
+    FFT_plan_info    *plans;
+  #elif USE_FFTW
     #if USE_MPI
       rfftwnd_mpi_plan  plan;
       rfftwnd_mpi_plan  iplan;
@@ -84,10 +184,11 @@ struct field_info{
 #ifdef __cplusplus
 extern "C" {
 #endif
-void init_field(int       n_d,
-                int      *n,
-                double   *L,
-                field_info *FFT);
+void init_field(int         n_d,
+                int        *n,
+                double     *L,
+                field_info *FFT,
+                int         mode);
 void free_field(field_info *FFT);
 void clear_field(field_info *FFT);
 void set_exchange_ring_ranks(int *rank_to,
@@ -109,6 +210,19 @@ void exchange_slab_buffer_right(void      *send_buffer,
                                 void      *receive_buffer,
                                 size_t    *receive_buffer_size,
                                 slab_info *slab);
+void start_exchange_slab_buffers(void               *send_left,
+                                 size_t              send_left_size,
+                                 void               *receive_right,
+                                 size_t              receive_right_size,
+                                 void               *send_right,
+                                 size_t              send_right_size,
+                                 void               *receive_left,
+                                 size_t              receive_left_size,
+                                 int                 i_d,
+                                 slab_info          *slab,
+                                 slab_exchange_info *exchange);
+int  test_exchange_slab_buffers(slab_exchange_info *exchange);
+void finish_exchange_slab_buffers(slab_exchange_info *exchange);
 #ifdef __cplusplus
 }
 #endif
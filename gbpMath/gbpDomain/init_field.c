@@ -3,11 +3,91 @@
 #include <stdlib.h>
 #include <gbpLib.h>
 #include <gbpDomain.h>
+#if USE_FFTW
+#include <gbpFFT.h>
+#endif
+
+#if USE_MPI && USE_FFTW && USE_FFTW3
+// Split n elements into n_proc blocks as evenly as possible
+void split_pencil_local(int n,int n_proc,int *i_start,int *n_local);
+void split_pencil_local(int n,int n_proc,int *i_start,int *n_local){
+  int i_proc;
+  for(i_proc=0;i_proc<n_proc;i_proc++){
+    n_local[i_proc]=n/n_proc+(i_proc<(n%n_proc));
+    i_start[i_proc]=i_proc*(n/n_proc)+MIN(i_proc,n%n_proc);
+  }
+}
+
+// Set the pencil decomposition of a field: the most nearly square grid
+//   of ranks that leaves every rank some of each axis it splits.  x and
+//   k_y are split amongst the ranks of a column of the grid and y and
+//   k_z amongst those of a row.
+void init_pencil_local(field_info *FFT);
+void init_pencil_local(field_info *FFT){
+  pencil_info *pencil=&(FFT->pencil);
+  int          n_k_z =FFT->n[2]/2+1;
+  int          n_proc_x;
+  int          i_d;
+  pencil->n_proc[0]=0;
+  for(n_proc_x=1;n_proc_x<=SID.n_proc;n_proc_x++){
+    int n_proc_y=SID.n_proc/n_proc_x;
+    if((SID.n_proc%n_proc_x)==0                      &&
+       n_proc_x<=MIN(FFT->n[0],FFT->n[1])            &&
+       n_proc_y<=MIN(FFT->n[1],n_k_z)                &&
+       (pencil->n_proc[0]==0 || abs(n_proc_x-n_proc_y)<abs(pencil->n_proc[0]-pencil->n_proc[1]))){
+      pencil->n_proc[0]=n_proc_x;
+      pencil->n_proc[1]=n_proc_y;
+    }
+  }
+  if(pencil->n_proc[0]==0)
+    SID_trap_error("A %dx%dx%d grid can not be split into pencils for %d ranks.",ERROR_LOGIC,
+                   FFT->n[0],FFT->n[1],FFT->n[2],SID.n_proc);
+  pencil->i_rank[0]=SID.My_rank/pencil->n_proc[1];
+  pencil->i_rank[1]=SID.My_rank%pencil->n_proc[1];
+  SID_Comm_init(&(pencil->comm[0]));
+  SID_Comm_init(&(pencil->comm[1]));
+  SID_Comm_split(SID.COMM_WORLD,pencil->i_rank[1],pencil->i_rank[0],pencil->comm[0]);
+  SID_Comm_split(SID.COMM_WORLD,pencil->i_rank[0],pencil->i_rank[1],pencil->comm[1]);
+  for(i_d=0;i_d<2;i_d++){
+    pencil->i_R_start[i_d]=(int *)SID_malloc(sizeof(int)*pencil->n_proc[i_d]);
+    pencil->n_R[i_d]      =(int *)SID_malloc(sizeof(int)*pencil->n_proc[i_d]);
+    pencil->i_k_start[i_d]=(int *)SID_malloc(sizeof(int)*pencil->n_proc[i_d]);
+    pencil->n_k[i_d]      =(int *)SID_malloc(sizeof(int)*pencil->n_proc[i_d]);
+  }
+  split_pencil_local(FFT->n[0],pencil->n_proc[0],pencil->i_R_start[0],pencil->n_R[0]);
+  split_pencil_local(FFT->n[1],pencil->n_proc[0],pencil->i_k_start[0],pencil->n_k[0]);
+  split_pencil_local(FFT->n[1],pencil->n_proc[1],pencil->i_R_start[1],pencil->n_R[1]);
+  split_pencil_local(n_k_z,    pencil->n_proc[1],pencil->i_k_start[1],pencil->n_k[1]);
 
-void init_field(int        n_d,
+  // Real space is split in x and y; k-space in k_y and k_z (and
+  //   stored with the first two axes transposed, as for slabs)
+  FFT->i_R_start_local[0]=pencil->i_R_start[0][pencil->i_rank[0]];
+  FFT->n_R_local[0]      =pencil->n_R[0][pencil->i_rank[0]];
+  FFT->i_R_start_local[1]=pencil->i_R_start[1][pencil->i_rank[1]];
+  FFT->n_R_local[1]      =pencil->n_R[1][pencil->i_rank[1]];
+  FFT->i_k_start_local[1]=pencil->i_k_start[0][pencil->i_rank[0]];
+  FFT->n_k_local[1]      =pencil->n_k[0][pencil->i_rank[0]];
+  FFT->i_k_start_local[2]=pencil->i_k_start[1][pencil->i_rank[1]];
+  FFT->n_k_local[2]      =pencil->n_k[1][pencil->i_rank[1]];
+
+  // The field must hold each stage of the transform (see compute_FFT())
+  size_t size_R =(size_t)FFT->n_R_local[0]*(size_t)FFT->n_R_local[1]*(size_t)n_k_z;
+  size_t size_xz=(size_t)FFT->n_R_local[0]*(size_t)FFT->n[1]*(size_t)FFT->n_k_local[2];
+  size_t size_k =(size_t)FFT->n_k_local[1]*(size_t)FFT->n[0]*(size_t)FFT->n_k_local[2];
+  FFT->total_local_size=2*MAX(size_R,MAX(size_xz,size_k));
+}
+#endif
+
+// Initialize a field.  Fields are decomposed into slabs in x by
+//   default.  With mode=FIELD_MODE_PENCIL, 3-d fields are instead
+//   decomposed into pencils split in both x and y, which lets many
+//   more ranks share a grid.  Pencils need FFTW3; without MPI the
+//   flag is ignored.
+void init_field(int         n_d,
                 int        *n,
                 double     *L,
-                field_info *FFT){
+                field_info *FFT,
+                int         mode){
   int  i_d;
   int  i_i;
   int  n_x_local;
@@ -63,33 +143,81 @@ void init_field(int        n_d,
     FFT->n_k_local[i_d]      =FFT->n[i_d];
   }
   FFT->n_k_local[FFT->n_d-1]=FFT->n[FFT->n_d-1]/2+1;
+  FFT->flag_pencil=FALSE;
+  for(i_d=0;i_d<2;i_d++){
+    FFT->pencil.n_proc[i_d]   =1;
+    FFT->pencil.i_rank[i_d]   =0;
+    FFT->pencil.comm[i_d]     =NULL;
+    FFT->pencil.i_R_start[i_d]=NULL;
+    FFT->pencil.n_R[i_d]      =NULL;
+    FFT->pencil.i_k_start[i_d]=NULL;
+    FFT->pencil.n_k[i_d]      =NULL;
+  }
+  #if USE_MPI
+    if(check_mode_for_flag(mode,FIELD_MODE_PENCIL)){
+      #if USE_FFTW && USE_FFTW3
+        if(FFT->n_d!=3)
+          SID_trap_error("Pencil decompositions need 3 dimensions.",ERROR_LOGIC);
+        FFT->flag_pencil=TRUE;
+      #else
+        SID_trap_error("Pencil decompositions need FFTW3.",ERROR_LOGIC);
+      #endif
+    }
+  #endif
 
-  // Initialize FFTW
+  // Initialize FFTW.  FFTW2 gives the slab decomposition from its
+  //   plans; FFTW3 gives it first and is planned once the field has
+  //   been allocated (below).
   #if USE_MPI
-    #if USE_FFTW
-      FFT->plan =rfftwnd_mpi_create_plan(SID.COMM_WORLD->comm,
-                                         FFT->n_d,FFT->n,
-                                         FFTW_REAL_TO_COMPLEX,
-                                         FFTW_ESTIMATE);
-      FFT->iplan=rfftwnd_mpi_create_plan(SID.COMM_WORLD->comm,
-                                         FFT->n_d,FFT->n,
-                                         FFTW_COMPLEX_TO_REAL,
-                                         FFTW_ESTIMATE);
+    #if USE_FFTW && USE_FFTW3
+      init_FFT_backend();
+      if(FFT->flag_pencil){
+        init_pencil_local(FFT);
+        n_x_local                =FFT->n_R_local[0];
+        i_x_start_local          =FFT->i_R_start_local[0];
+        n_y_transpose_local      =FFT->n_k_local[1];
+        i_y_start_transpose_local=FFT->i_k_start_local[1];
+      }
+      else{
+        if(FFT->n_d<2)
+          SID_trap_error("Parallel FFTW3 transforms need at least 2 dimensions.",ERROR_LOGIC);
+        ptrdiff_t *n_complex=(ptrdiff_t *)SID_malloc(sizeof(ptrdiff_t)*FFT->n_d);
+        ptrdiff_t  n_x_local_FFTW3;
+        ptrdiff_t  i_x_start_local_FFTW3;
+        ptrdiff_t  n_y_transpose_local_FFTW3;
+        ptrdiff_t  i_y_start_transpose_local_FFTW3;
+        for(i_d=0;i_d<FFT->n_d;i_d++)
+          n_complex[i_d]=(ptrdiff_t)FFT->n[i_d];
+        n_complex[FFT->n_d-1]=(ptrdiff_t)(FFT->n[FFT->n_d-1]/2+1);
+        FFT->total_local_size=2*(size_t)FFTW3_NAME(mpi_local_size_transposed)(FFT->n_d,n_complex,
+                                                                              SID.COMM_WORLD->comm,
+                                                                              &n_x_local_FFTW3,
+                                                                              &i_x_start_local_FFTW3,
+                                                                              &n_y_transpose_local_FFTW3,
+                                                                              &i_y_start_transpose_local_FFTW3);
+        n_x_local                =(int)n_x_local_FFTW3;
+        i_x_start_local          =(int)i_x_start_local_FFTW3;
+        n_y_transpose_local      =(int)n_y_transpose_local_FFTW3;
+        i_y_start_transpose_local=(int)i_y_start_transpose_local_FFTW3;
+        SID_free(SID_FARG n_complex);
+      }
+    #elif USE_FFTW
+      init_FFT_plans(FFT);
       rfftwnd_mpi_local_sizes(FFT->plan,
           		      &(n_x_local), 
           		      &(i_x_start_local),
           		      &(n_y_transpose_local),
           		      &(i_y_start_transpose_local),
           		      &total_local_size_int);
+      FFT->total_local_size=(size_t)total_local_size_int;
     #else
       n_x_local                =0;
       i_x_start_local          =0;
       n_y_transpose_local      =0;
       i_y_start_transpose_local=0;
-      total_local_size_int     =0;
+      FFT->total_local_size    =0;
       SID_trap_error("Parallel FFTs are not supported without FFTW support.",ERROR_LOGIC);
     #endif
-    FFT->total_local_size=(size_t)total_local_size_int;
     // Set empty slabs to start at 0 to make ignoring them simple.
     if(n_x_local==0)
       i_x_start_local=0;
@@ -109,9 +237,8 @@ void init_field(int        n_d,
       else
         FFT->total_local_size*=2*(FFT->n[i_d]/2+1);
     }
-    #if USE_FFTW
-      FFT->plan =rfftwnd_create_plan(FFT->n_d,FFT->n,FFTW_REAL_TO_COMPLEX,FFTW_ESTIMATE|FFTW_IN_PLACE);
-      FFT->iplan=rfftwnd_create_plan(FFT->n_d,FFT->n,FFTW_COMPLEX_TO_REAL,FFTW_ESTIMATE|FFTW_IN_PLACE);
+    #if USE_FFTW && !USE_FFTW3
+      init_FFT_plans(FFT);
     #endif
   #endif
   #if USE_FFTW
@@ -144,11 +271,18 @@ void init_field(int        n_d,
   }
 
   // A pointer for referencing the field as a complex array
-  #if USE_FFTW
+  #if USE_FFTW && USE_FFTW3
+     FFT->cfield_local=(FFT_complex  *)FFT->field_local;
+  #elif USE_FFTW
      FFT->cfield_local=(fftw_complex *)FFT->field_local;
   #else
      FFT->cfield_local=(GBPREAL      *)FFT->field_local;
   #endif
+
+  // FFTW3 plans need the field (which they may overwrite)
+  #if USE_FFTW && USE_FFTW3
+     init_FFT_plans(FFT);
+  #endif
   clear_field(FFT);
 
   // Initialize the FFT's real-space grid
@@ -192,43 +326,74 @@ void init_field(int        n_d,
     FFT->slab.x_max_local  =FFT->slab.x_min_local;
   //FFT->slab.x_max          =FFT->R_field[0][FFT->n[0]];
   SID_Allreduce(&(FFT->slab.x_max_local),&(FFT->slab.x_max),1,SID_DOUBLE,SID_MAX,SID.COMM_WORLD);
+  if(FFT->n_d>1){
+    FFT->slab.n_y_local      =FFT->n_R_local[1];
+    FFT->slab.i_y_start_local=FFT->i_R_start_local[1];
+    FFT->slab.i_y_stop_local =FFT->i_R_stop_local[1];
+    FFT->slab.y_min_local    =FFT->R_field[1][FFT->i_R_start_local[1]];
+    FFT->slab.y_max_local    =FFT->R_field[1][FFT->i_R_stop_local[1]+1];
+    FFT->slab.y_max          =FFT->R_field[1][FFT->n[1]];
+  }
+  else{
+    FFT->slab.n_y_local      =1;
+    FFT->slab.i_y_start_local=0;
+    FFT->slab.i_y_stop_local =0;
+    FFT->slab.y_min_local    =0.;
+    FFT->slab.y_max_local    =0.;
+    FFT->slab.y_max          =0.;
+  }
+  FFT->slab.rank_to_left_y =SID.My_rank;
+  FFT->slab.rank_to_right_y=SID.My_rank;
 
 #if USE_MPI
-
-  // All ranks are not necessarily assigned any slices, so
-  //   we need to figure out what ranks are to the right and the left for
-  //   buffer exchanges
-  n_x_rank=(int *)SID_malloc(sizeof(int)*SID.n_proc);
-  n_x_rank[SID.My_rank]=FFT->slab.n_x_local;
-  if(n_x_rank[SID.My_rank]>0)
-    flag_active=TRUE;
-  else
-    flag_active=FALSE;
-  SID_Allreduce(&flag_active,          &n_active,1,SID_INT,SID_SUM,SID.COMM_WORLD);
-  SID_Allreduce(&n_x_rank[SID.My_rank],&min_size,1,SID_INT,SID_MIN,SID.COMM_WORLD);
-  SID_Allreduce(&n_x_rank[SID.My_rank],&max_size,1,SID_INT,SID_MAX,SID.COMM_WORLD);
-  for(i_rank=0;i_rank<SID.n_proc;i_rank++)
-    SID_Bcast(&(n_x_rank[i_rank]),sizeof(int),i_rank,SID.COMM_WORLD);
-  FFT->slab.rank_to_right=-1;
-  for(i_rank=SID.My_rank+1;i_rank<SID.My_rank+SID.n_proc && FFT->slab.rank_to_right<0;i_rank++){
-    j_rank=i_rank%SID.n_proc;
-    if(n_x_rank[j_rank]>0) 
-      FFT->slab.rank_to_right=j_rank;
-  }
-  if(FFT->slab.rank_to_right<0)
-    FFT->slab.rank_to_right=SID.My_rank;
-  FFT->slab.rank_to_left=-1;
-  for(i_rank=SID.My_rank-1;i_rank>SID.My_rank-SID.n_proc && FFT->slab.rank_to_left<0;i_rank--){
-    if(i_rank<0)
-      j_rank=i_rank+SID.n_proc;
+  if(FFT->flag_pencil){
+    // Every rank has a pencil, and its neighbours are those beside it in the grid of ranks
+    pencil_info *pencil=&(FFT->pencil);
+    FFT->slab.rank_to_left   =((pencil->i_rank[0]+pencil->n_proc[0]-1)%pencil->n_proc[0])*pencil->n_proc[1]+pencil->i_rank[1];
+    FFT->slab.rank_to_right  =((pencil->i_rank[0]+1)%pencil->n_proc[0])*pencil->n_proc[1]+pencil->i_rank[1];
+    FFT->slab.rank_to_left_y =pencil->i_rank[0]*pencil->n_proc[1]+(pencil->i_rank[1]+pencil->n_proc[1]-1)%pencil->n_proc[1];
+    FFT->slab.rank_to_right_y=pencil->i_rank[0]*pencil->n_proc[1]+(pencil->i_rank[1]+1)%pencil->n_proc[1];
+    SID_log("(%dx%d pencils of %dx%d to %dx%d)...",SID_LOG_CONTINUE,
+            pencil->n_proc[0],pencil->n_proc[1],
+            pencil->n_R[0][pencil->n_proc[0]-1],pencil->n_R[1][pencil->n_proc[1]-1],
+            pencil->n_R[0][0],pencil->n_R[1][0]);
+  }
+  else{
+    // All ranks are not necessarily assigned any slices, so
+    //   we need to figure out what ranks are to the right and the left for
+    //   buffer exchanges
+    n_x_rank=(int *)SID_malloc(sizeof(int)*SID.n_proc);
+    n_x_rank[SID.My_rank]=FFT->slab.n_x_local;
+    if(n_x_rank[SID.My_rank]>0)
+      flag_active=TRUE;
     else
-      j_rank=i_rank;
-    if(n_x_rank[j_rank]>0) FFT->slab.rank_to_left=j_rank;
-  }  
-  if(FFT->slab.rank_to_left<0)
-    FFT->slab.rank_to_left=SID.My_rank;
-  free(n_x_rank);
-  SID_log("(%d cores unused, min/max slab size=%d/%d)...",SID_LOG_CONTINUE,SID.n_proc-n_active,min_size,max_size);
+      flag_active=FALSE;
+    SID_Allreduce(&flag_active,          &n_active,1,SID_INT,SID_SUM,SID.COMM_WORLD);
+    SID_Allreduce(&n_x_rank[SID.My_rank],&min_size,1,SID_INT,SID_MIN,SID.COMM_WORLD);
+    SID_Allreduce(&n_x_rank[SID.My_rank],&max_size,1,SID_INT,SID_MAX,SID.COMM_WORLD);
+    for(i_rank=0;i_rank<SID.n_proc;i_rank++)
+      SID_Bcast(&(n_x_rank[i_rank]),sizeof(int),i_rank,SID.COMM_WORLD);
+    FFT->slab.rank_to_right=-1;
+    for(i_rank=SID.My_rank+1;i_rank<SID.My_rank+SID.n_proc && FFT->slab.rank_to_right<0;i_rank++){
+      j_rank=i_rank%SID.n_proc;
+      if(n_x_rank[j_rank]>0) 
+        FFT->slab.rank_to_right=j_rank;
+    }
+    if(FFT->slab.rank_to_right<0)
+      FFT->slab.rank_to_right=SID.My_rank;
+    FFT->slab.rank_to_left=-1;
+    for(i_rank=SID.My_rank-1;i_rank>SID.My_rank-SID.n_proc && FFT->slab.rank_to_left<0;i_rank--){
+      if(i_rank<0)
+        j_rank=i_rank+SID.n_proc;
+      else
+        j_rank=i_rank;
+      if(n_x_rank[j_rank]>0) FFT->slab.rank_to_left=j_rank;
+    }  
+    if(FFT->slab.rank_to_left<0)
+      FFT->slab.rank_to_left=SID.My_rank;
+    free(n_x_rank);
+    SID_log("(%d cores unused, min/max slab size=%d/%d)...",SID_LOG_CONTINUE,SID.n_proc-n_active,min_size,max_size);
+  }
 #else
   FFT->slab.rank_to_right=SID.My_rank;
   FFT->slab.rank_to_left =SID.My_rank;
@@ -0,0 +1,66 @@
+#include <stdlib.h>
+#include <string.h>
+#include <gbpCommon.h>
+#include <gbpSID.h>
+#include <gbpDomain.h>
+
+// Start sending slab buffers to the neighbouring slabs without waiting
+//   for them to arrive: send_left goes to the rank to the left (and
+//   arrives in its receive_right) and send_right to the rank to the
+//   right.  The neighbours are those along x (i_d=0) or, for pencil
+//   decompositions, along y (i_d=1).  Unlike exchange_slab_buffer_left/
+//   right(), the sizes are not exchanged; all four must be known from
+//   the slab geometry.  The buffers must not be touched until
+//   test_exchange_slab_buffers() returns TRUE or
+//   finish_exchange_slab_buffers() returns.  Ranks with empty slabs
+//   take no part.
+void start_exchange_slab_buffers(void               *send_left,
+                                 size_t              send_left_size,
+                                 void               *receive_right,
+                                 size_t              receive_right_size,
+                                 void               *send_right,
+                                 size_t              send_right_size,
+                                 void               *receive_left,
+                                 size_t              receive_left_size,
+                                 int                 i_d,
+                                 slab_info          *slab,
+                                 slab_exchange_info *exchange){
+  int rank_to_left =slab->rank_to_left;
+  int rank_to_right=slab->rank_to_right;
+  int n_local      =slab->n_x_local;
+  int tag          =127;
+  if(i_d==1){
+    rank_to_left =slab->rank_to_left_y;
+    rank_to_right=slab->rank_to_right_y;
+    n_local      =MIN(n_local,slab->n_y_local);
+    tag          =131;
+  }
+  else if(i_d!=0)
+    SID_trap_error("Slab buffers can not be exchanged along axis %d.",ERROR_LOGIC,i_d);
+  exchange->n_request    =0;
+  exchange->flag_complete=TRUE;
+  if(n_local>0){
+#if USE_MPI
+    if(receive_right_size>0)
+      MPI_Irecv(receive_right,(int)receive_right_size,MPI_BYTE,rank_to_right,tag,
+                SID.COMM_WORLD->comm,&(exchange->request[exchange->n_request++]));
+    if(receive_left_size>0)
+      MPI_Irecv(receive_left, (int)receive_left_size, MPI_BYTE,rank_to_left, tag+2,
+                SID.COMM_WORLD->comm,&(exchange->request[exchange->n_request++]));
+    if(send_left_size>0)
+      MPI_Isend(send_left,    (int)send_left_size,    MPI_BYTE,rank_to_left, tag,
+                SID.COMM_WORLD->comm,&(exchange->request[exchange->n_request++]));
+    if(send_right_size>0)
+      MPI_Isend(send_right,   (int)send_right_size,   MPI_BYTE,rank_to_right,tag+2,
+                SID.COMM_WORLD->comm,&(exchange->request[exchange->n_request++]));
+    exchange->flag_complete=(exchange->n_request==0);
+#else
+    // Without MPI the slab wraps onto itself
+    if(send_left!=NULL && send_left_size>0)
+      memcpy(receive_right,send_left,MIN(send_left_size,receive_right_size));
+    if(send_right!=NULL && send_right_size>0)
+      memcpy(receive_left,send_right,MIN(send_right_size,receive_left_size));
+#endif
+  }
+}
+
@@ -0,0 +1,19 @@
+#include <stdlib.h>
+#include <gbpCommon.h>
+#include <gbpSID.h>
+#include <gbpDomain.h>
+
+// Check (without blocking) whether an exchange started with
+//   start_exchange_slab_buffers() has completed.  Calling this now and
+//   then also lets MPI make progress on the exchange.
+int test_exchange_slab_buffers(slab_exchange_info *exchange){
+#if USE_MPI
+  if(!exchange->flag_complete){
+    int flag_complete;
+    MPI_Testall(exchange->n_request,exchange->request,&flag_complete,MPI_STATUSES_IGNORE);
+    exchange->flag_complete=flag_complete;
+  }
+#endif
+  return(exchange->flag_complete);
+}
+
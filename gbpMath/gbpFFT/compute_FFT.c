@@ -11,8 +11,22 @@ void compute_FFT(field_info *FFT){
      flag_log_message=TRUE;
   }
 
-  // Perform the FFT
-  #if USE_MPI
+  // Perform the FFT.  Pencils are transformed along z, y and then x,
+  //   with transposes in between that leave each axis local in turn.
+  #if USE_FFTW3 && USE_MPI
+    if(FFT->flag_pencil){
+      FFTW3_NAME(complex) *cfield=(FFTW3_NAME(complex) *)FFT->cfield_local;
+      FFTW3_NAME(execute_dft_r2c)(FFT->plans->plan_pencil[2],FFT->field_local,cfield);
+      transpose_FFT_pencil(FFT,1,FFTW_FORWARD);
+      FFTW3_NAME(execute_dft)(FFT->plans->plan_pencil[1],cfield,cfield);
+      transpose_FFT_pencil(FFT,0,FFTW_FORWARD);
+      FFTW3_NAME(execute_dft)(FFT->plans->plan_pencil[0],cfield,cfield);
+    }
+    else
+      FFTW3_NAME(mpi_execute_dft_r2c)(FFT->plans->plan,FFT->field_local,(FFTW3_NAME(complex) *)FFT->cfield_local);
+  #elif USE_FFTW3
+    FFTW3_NAME(execute_dft_r2c)(FFT->plans->plan,FFT->field_local,(FFTW3_NAME(complex) *)FFT->cfield_local);
+  #elif USE_MPI
     rfftwnd_mpi(FFT->plan,1,FFT->field_local,NULL,FFTW_TRANSPOSED_ORDER);
   #else
     rfftwnd_one_real_to_complex(FFT->plan,FFT->field_local,NULL);
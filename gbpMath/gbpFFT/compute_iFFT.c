@@ -6,8 +6,21 @@ void compute_iFFT(field_info *FFT){
 
   SID_log("Performing iFFT...",SID_LOG_OPEN|SID_LOG_TIMER);
 
-  // Perform the inverse FFT
-  #if USE_MPI
+  // Perform the inverse FFT (undoing the stages of compute_FFT() for pencils)
+  #if USE_FFTW3 && USE_MPI
+    if(FFT->flag_pencil){
+      FFTW3_NAME(complex) *cfield=(FFTW3_NAME(complex) *)FFT->cfield_local;
+      FFTW3_NAME(execute_dft)(FFT->plans->iplan_pencil[0],cfield,cfield);
+      transpose_FFT_pencil(FFT,0,FFTW_BACKWARD);
+      FFTW3_NAME(execute_dft)(FFT->plans->iplan_pencil[1],cfield,cfield);
+      transpose_FFT_pencil(FFT,1,FFTW_BACKWARD);
+      FFTW3_NAME(execute_dft_c2r)(FFT->plans->iplan_pencil[2],cfield,FFT->field_local);
+    }
+    else
+      FFTW3_NAME(mpi_execute_dft_c2r)(FFT->plans->iplan,(FFTW3_NAME(complex) *)FFT->cfield_local,FFT->field_local);
+  #elif USE_FFTW3
+    FFTW3_NAME(execute_dft_c2r)(FFT->plans->iplan,(FFTW3_NAME(complex) *)FFT->cfield_local,FFT->field_local);
+  #elif USE_MPI
     rfftwnd_mpi(FFT->iplan,1,FFT->field_local,NULL,FFTW_TRANSPOSED_ORDER);
   #else
     rfftwnd_one_complex_to_real(FFT->iplan,FFT->cfield_local,NULL);
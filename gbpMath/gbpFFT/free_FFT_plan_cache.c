@@ -0,0 +1,32 @@
+#include <gbpLib.h>
+#include <gbpFFT.h>
+
+// Destroy the cached FFTW3 plans that no field is using.  Must be
+//   called collectively.  Does nothing for FFTW2.
+void free_FFT_plan_cache(void){
+#if USE_FFTW3
+  FFT_plan_info **plans=&FFT_plan_cache;
+  while((*plans)!=NULL){
+     FFT_plan_info *plans_i=(*plans);
+     if(plans_i->n_references>0)
+        plans=&(plans_i->next);
+     else{
+        (*plans)=plans_i->next;
+        if(plans_i->flag_pencil){
+           int i_d;
+           for(i_d=0;i_d<3;i_d++){
+              FFTW3_NAME(destroy_plan)(plans_i->plan_pencil[i_d]);
+              FFTW3_NAME(destroy_plan)(plans_i->iplan_pencil[i_d]);
+           }
+        }
+        else{
+           FFTW3_NAME(destroy_plan)(plans_i->plan);
+           FFTW3_NAME(destroy_plan)(plans_i->iplan);
+        }
+        SID_free(SID_FARG plans_i->n);
+        SID_free(SID_FARG plans_i);
+     }
+  }
+#endif
+}
+
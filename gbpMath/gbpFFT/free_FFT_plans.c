@@ -0,0 +1,20 @@
+#include <gbpLib.h>
+#include <gbpFFT.h>
+
+// Release the FFTW plans of a field.  FFTW3 plans stay in the cache
+//   for later fields to use until free_FFT_plan_cache() is called.
+void free_FFT_plans(field_info *FFT){
+#if USE_FFTW3
+  if(FFT->plans!=NULL){
+     FFT->plans->n_references--;
+     FFT->plans=NULL;
+  }
+#elif USE_MPI
+  rfftwnd_mpi_destroy_plan(FFT->plan);
+  rfftwnd_mpi_destroy_plan(FFT->iplan);
+#else
+  rfftwnd_destroy_plan(FFT->plan);
+  rfftwnd_destroy_plan(FFT->iplan);
+#endif
+}
+
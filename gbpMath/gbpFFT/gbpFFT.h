@@ -3,7 +3,13 @@
 #include <gbpDomain.h>
 #ifndef GBPFFTW_AWAKE
   #define GBPFFTW_AWAKE
-  #if USE_MPI
+  #if USE_FFTW3
+    #if USE_MPI
+      #include <fftw3-mpi.h>
+    #else
+      #include <fftw3.h>
+    #endif
+  #elif USE_MPI
     #if USE_DOUBLE
       #include <drfftw_mpi.h>
     #else
@@ -18,12 +24,33 @@
   #endif
 #endif
 
+// How FFTW3 plans are made (see set_FFT_plan_mode())
+#define FFT_PLAN_ESTIMATE 0
+#define FFT_PLAN_MEASURE  1
+extern int FFT_plan_mode;
+
+// Where drivers keep FFTW3 wisdom between runs
+#define FFT_WISDOM_FILENAME_DEFAULT "gbpFFT_wisdom.dat"
+
+// Cache of FFTW3 plans (see init_FFT_plans())
+#if USE_FFTW3
+extern FFT_plan_info *FFT_plan_cache;
+#endif
+
 // Function definitions
 #ifdef __cplusplus
 extern "C" {
 #endif
+void   init_FFT_backend(void);
+void   init_FFT_plans(field_info *FFT);
+void   free_FFT_plans(field_info *FFT);
+void   free_FFT_plan_cache(void);
+void   set_FFT_plan_mode(int mode);
+void   read_FFT_wisdom(const char *filename);
+void   write_FFT_wisdom(const char *filename);
 void   compute_FFT(field_info *FFT);
 void   compute_iFFT(field_info *FFT);
+void   transpose_FFT_pencil(field_info *FFT,int i_d,int direction);
 int    add_buffer_FFT_R(field_info *FFT);
 void   remove_buffer_FFT_R(field_info *FFT);
 size_t index_FFT_R(field_info *FFT,int *i_R);
@@ -1,6 +1,8 @@
 #include <gbpLib.h>
 #include <gbpFFT.h>
 
+// Index in the local array of the real-space element with global
+//   indices i_R, which must lie in the local slab (or pencil)
 size_t index_local_FFT_R(field_info *FFT,int *i_R){
   int    i_d;
   size_t index;
@@ -13,7 +15,7 @@ size_t index_local_FFT_R(field_info *FFT,int *i_R){
         index*=2*(FFT->n_R_local[i_d]/2+1);
         break;
     }
-    if(i_R[i_d]<0 || i_R[i_d]>FFT->i_R_stop_local[i_d])
+    if(i_R[i_d]<FFT->i_R_start_local[i_d] || i_R[i_d]>FFT->i_R_stop_local[i_d])
       SID_trap_error("Index (%d;i_d=%d) out of local slab's range (%d->%d).",ERROR_LOGIC,
                      i_R[i_d],i_d,FFT->i_R_start_local[i_d],FFT->i_R_stop_local[i_d]);
     index+=(i_R[i_d]-FFT->i_R_start_local[i_d]);
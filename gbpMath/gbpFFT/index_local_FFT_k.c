@@ -1,6 +1,8 @@
 #include <gbpLib.h>
 #include <gbpFFT.h>
 
+// Index in the local array of the k-space element with global
+//   indices i_k, which must lie in the local slab (or pencil)
 size_t index_local_FFT_k(field_info *FFT,int *i_k){
   int    i_d,j_d;
   size_t index;
@@ -19,7 +21,7 @@ size_t index_local_FFT_k(field_info *FFT,int *i_k){
         index*=(FFT->n_k_local[i_d]+1);
         break;
     }
-    if(i_k[i_d]<0 || i_k[i_d]>FFT->i_k_stop_local[i_d])
+    if(i_k[i_d]<FFT->i_k_start_local[i_d] || i_k[i_d]>FFT->i_k_stop_local[i_d])
       SID_trap_error("Index (%d;i_d=%d) out of local slab's range (%d->%d).",ERROR_LOGIC,
                      i_k[i_d],i_d,FFT->i_k_start_local[i_d],FFT->i_k_stop_local[i_d]);
     index+=(i_k[i_d]-FFT->i_k_start_local[i_d]);
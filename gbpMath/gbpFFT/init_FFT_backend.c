@@ -0,0 +1,22 @@
+#include <gbpLib.h>
+#include <gbpFFT.h>
+
+// Initialize the FFT library (threads and MPI).  Only FFTW3 needs
+//   this; it is done once, on the first call, and init_field() and
+//   read_FFT_wisdom() call it before doing anything else.
+void init_FFT_backend(void){
+#if USE_FFTW3
+  static int flag_initialized=FALSE;
+  if(!flag_initialized){
+     #if USE_OPENMP
+       if(!FFTW3_NAME(init_threads)())
+          SID_trap_error("Could not initialize FFTW threads.",ERROR_LOGIC);
+     #endif
+     #if USE_MPI
+       FFTW3_NAME(mpi_init)();
+     #endif
+     flag_initialized=TRUE;
+  }
+#endif
+}
+
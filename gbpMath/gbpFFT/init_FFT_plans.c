@@ -0,0 +1,186 @@
+#include <gbpLib.h>
+#include <gbpFFT.h>
+#if USE_OPENMP
+#include <omp.h>
+#endif
+
+int FFT_plan_mode=FFT_PLAN_ESTIMATE;
+#if USE_FFTW3
+FFT_plan_info *FFT_plan_cache=NULL;
+#endif
+
+// Set the FFTW plans of a field.  FFTW2 plans are made for every
+//   field.  FFTW3 plans are shared by all fields with the same shape,
+//   decomposition, array alignment and thread count; they are taken
+//   from a cache and only made if none match, with FFTW_ESTIMATE or
+//   (see set_FFT_plan_mode()) FFTW_MEASURE.  Pencil
+//   decompositions get serial plans for each axis in turn (see
+//   compute_FFT()).  Called collectively by init_field().  For FFTW3
+//   the field must already be allocated, and is overwritten if new
+//   plans are made.
+void init_FFT_plans(field_info *FFT){
+#if USE_FFTW3
+  FFT_plan_info *plans;
+  int            i_d;
+  int            n_threads=1;
+  int            alignment;
+  int            i_k_start_local;
+  int            n_k_local;
+  int            n_R_local_y;
+  int            n_k_local_z;
+  int            flag_found;
+  unsigned       plan_rigor=(FFT_plan_mode==FFT_PLAN_MEASURE?FFTW_MEASURE:FFTW_ESTIMATE);
+
+  init_FFT_backend();
+
+  // Set the cache key
+  #if USE_OPENMP
+    n_threads=omp_get_max_threads();
+  #endif
+  alignment=FFTW3_NAME(alignment_of)(FFT->field_local);
+  if(FFT->n_d>1){
+     i_k_start_local=FFT->i_k_start_local[1];
+     n_k_local      =FFT->n_k_local[1];
+  }
+  else{
+     i_k_start_local=0;
+     n_k_local      =FFT->n_k_local[0];
+  }
+  n_R_local_y=FFT->n_R_local[MIN(1,FFT->n_d-1)];
+  n_k_local_z=FFT->n_k_local[FFT->n_d-1];
+
+  // Look for matching plans
+  for(plans=FFT_plan_cache;plans!=NULL;plans=plans->next){
+     int flag_match=(plans->n_d            ==FFT->n_d              &&
+                     plans->n_proc         ==SID.n_proc            &&
+                     plans->i_R_start_local==FFT->i_R_start_local[0] &&
+                     plans->n_R_local      ==FFT->n_R_local[0]     &&
+                     plans->i_k_start_local==i_k_start_local       &&
+                     plans->n_k_local      ==n_k_local             &&
+                     plans->alignment      ==alignment             &&
+                     plans->n_threads      ==n_threads             &&
+                     plans->flag_pencil    ==FFT->flag_pencil      &&
+                     plans->n_R_local_y    ==n_R_local_y           &&
+                     plans->n_k_local_z    ==n_k_local_z);
+     for(i_d=0;i_d<FFT->n_d && flag_match;i_d++)
+        flag_match=(plans->n[i_d]==FFT->n[i_d]);
+     if(flag_match)
+        break;
+  }
+
+  // Plans are made collectively, so every rank needs to have found a match
+  flag_found=(plans!=NULL);
+  SID_Allreduce(SID_IN_PLACE,&flag_found,1,SID_INT,SID_MIN,SID.COMM_WORLD);
+  if(!flag_found){
+     SID_log("Making FFTW plans (%d thread(s))...",SID_LOG_OPEN|SID_LOG_TIMER,n_threads);
+     plans                 =(FFT_plan_info *)SID_malloc(sizeof(FFT_plan_info));
+     plans->n_d            =FFT->n_d;
+     plans->n              =(int *)SID_malloc(sizeof(int)*FFT->n_d);
+     for(i_d=0;i_d<FFT->n_d;i_d++)
+        plans->n[i_d]=FFT->n[i_d];
+     plans->n_proc         =SID.n_proc;
+     plans->i_R_start_local=FFT->i_R_start_local[0];
+     plans->n_R_local      =FFT->n_R_local[0];
+     plans->i_k_start_local=i_k_start_local;
+     plans->n_k_local      =n_k_local;
+     plans->alignment      =alignment;
+     plans->n_threads      =n_threads;
+     plans->n_references   =0;
+     plans->flag_pencil    =FFT->flag_pencil;
+     plans->n_R_local_y    =n_R_local_y;
+     plans->n_k_local_z    =n_k_local_z;
+     plans->plan           =NULL;
+     plans->iplan          =NULL;
+     for(i_d=0;i_d<3;i_d++){
+        plans->plan_pencil[i_d] =NULL;
+        plans->iplan_pencil[i_d]=NULL;
+     }
+     #if USE_OPENMP
+       FFTW3_NAME(plan_with_nthreads)(n_threads);
+     #endif
+     if(FFT->flag_pencil){
+       // Along z, for each local (x,y) ...
+       FFTW3_NAME(complex) *cfield     =(FFTW3_NAME(complex) *)FFT->cfield_local;
+       int                  n_z_complex=FFT->n[2]/2+1;
+       int                  n_xy_local =FFT->n_R_local[0]*FFT->n_R_local[1];
+       plans->plan_pencil[2] =FFTW3_NAME(plan_many_dft_r2c)(1,&(FFT->n[2]),n_xy_local,
+                                                            FFT->field_local,NULL,1,2*n_z_complex,
+                                                            cfield,NULL,1,n_z_complex,
+                                                            plan_rigor);
+       plans->iplan_pencil[2]=FFTW3_NAME(plan_many_dft_c2r)(1,&(FFT->n[2]),n_xy_local,
+                                                            cfield,NULL,1,n_z_complex,
+                                                            FFT->field_local,NULL,1,2*n_z_complex,
+                                                            plan_rigor);
+       // ... then along y, for each local (x,k_z) ...
+       FFTW3_NAME(iodim) dims;
+       FFTW3_NAME(iodim) howmany_dims[2];
+       dims.n           =FFT->n[1];
+       dims.is          =n_k_local_z;
+       dims.os          =n_k_local_z;
+       howmany_dims[0].n =FFT->n_R_local[0];
+       howmany_dims[0].is=FFT->n[1]*n_k_local_z;
+       howmany_dims[0].os=FFT->n[1]*n_k_local_z;
+       howmany_dims[1].n =n_k_local_z;
+       howmany_dims[1].is=1;
+       howmany_dims[1].os=1;
+       plans->plan_pencil[1] =FFTW3_NAME(plan_guru_dft)(1,&dims,2,howmany_dims,cfield,cfield,FFTW_FORWARD, plan_rigor);
+       plans->iplan_pencil[1]=FFTW3_NAME(plan_guru_dft)(1,&dims,2,howmany_dims,cfield,cfield,FFTW_BACKWARD,plan_rigor);
+       // ... and along x, for each local (k_y,k_z)
+       dims.n           =FFT->n[0];
+       howmany_dims[0].n =n_k_local;
+       howmany_dims[0].is=FFT->n[0]*n_k_local_z;
+       howmany_dims[0].os=FFT->n[0]*n_k_local_z;
+       plans->plan_pencil[0] =FFTW3_NAME(plan_guru_dft)(1,&dims,2,howmany_dims,cfield,cfield,FFTW_FORWARD, plan_rigor);
+       plans->iplan_pencil[0]=FFTW3_NAME(plan_guru_dft)(1,&dims,2,howmany_dims,cfield,cfield,FFTW_BACKWARD,plan_rigor);
+       for(i_d=0;i_d<3;i_d++){
+          if(plans->plan_pencil[i_d]==NULL || plans->iplan_pencil[i_d]==NULL)
+             SID_trap_error("Could not make FFTW pencil plans.",ERROR_LOGIC);
+       }
+     }
+     else{
+       #if USE_MPI
+         // The k-space layout is transposed, as it is for FFTW2
+         ptrdiff_t *n_plan=(ptrdiff_t *)SID_malloc(sizeof(ptrdiff_t)*FFT->n_d);
+         for(i_d=0;i_d<FFT->n_d;i_d++)
+            n_plan[i_d]=(ptrdiff_t)FFT->n[i_d];
+         plans->plan =FFTW3_NAME(mpi_plan_dft_r2c)(FFT->n_d,n_plan,
+                                                   FFT->field_local,(FFTW3_NAME(complex) *)FFT->cfield_local,
+                                                   SID.COMM_WORLD->comm,
+                                                   plan_rigor|FFTW_MPI_TRANSPOSED_OUT);
+         plans->iplan=FFTW3_NAME(mpi_plan_dft_c2r)(FFT->n_d,n_plan,
+                                                   (FFTW3_NAME(complex) *)FFT->cfield_local,FFT->field_local,
+                                                   SID.COMM_WORLD->comm,
+                                                   plan_rigor|FFTW_MPI_TRANSPOSED_IN);
+         SID_free(SID_FARG n_plan);
+       #else
+         plans->plan =FFTW3_NAME(plan_dft_r2c)(FFT->n_d,FFT->n,
+                                               FFT->field_local,(FFTW3_NAME(complex) *)FFT->cfield_local,
+                                               plan_rigor);
+         plans->iplan=FFTW3_NAME(plan_dft_c2r)(FFT->n_d,FFT->n,
+                                               (FFTW3_NAME(complex) *)FFT->cfield_local,FFT->field_local,
+                                               plan_rigor);
+       #endif
+       if(plans->plan==NULL || plans->iplan==NULL)
+          SID_trap_error("Could not make FFTW plans.",ERROR_LOGIC);
+     }
+     plans->next   =FFT_plan_cache;
+     FFT_plan_cache=plans;
+     SID_log("Done.",SID_LOG_CLOSE);
+  }
+  plans->n_references++;
+  FFT->plans=plans;
+#elif USE_MPI
+  FFT->plan =rfftwnd_mpi_create_plan(SID.COMM_WORLD->comm,
+                                     FFT->n_d,FFT->n,
+                                     FFTW_REAL_TO_COMPLEX,
+                                     FFTW_ESTIMATE);
+  FFT->iplan=rfftwnd_mpi_create_plan(SID.COMM_WORLD->comm,
+                                     FFT->n_d,FFT->n,
+                                     FFTW_COMPLEX_TO_REAL,
+                                     FFTW_ESTIMATE);
+#else
+  FFT->plan =rfftwnd_create_plan(FFT->n_d,FFT->n,FFTW_REAL_TO_COMPLEX,FFTW_ESTIMATE|FFTW_IN_PLACE);
+  FFT->iplan=rfftwnd_create_plan(FFT->n_d,FFT->n,FFTW_COMPLEX_TO_REAL,FFTW_ESTIMATE|FFTW_IN_PLACE);
+#endif
+}
+
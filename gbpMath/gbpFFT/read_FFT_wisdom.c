@@ -0,0 +1,29 @@
+#include <gbpLib.h>
+#include <gbpFFT.h>
+
+// Import FFTW3 wisdom written by write_FFT_wisdom(), so that plans
+//   made afterwards are quick to make.  The file is read by the master
+//   rank and the wisdom is broadcast.  If wisdom is found, plans are
+//   measured from then on (see set_FFT_plan_mode()); a missing file is
+//   not an error and leaves the plan mode as it is.  Does nothing for
+//   FFTW2.
+void read_FFT_wisdom(const char *filename){
+#if USE_FFTW3
+  int flag_success=FALSE;
+  init_FFT_backend();
+  SID_log("Reading FFTW wisdom from {%s}...",SID_LOG_OPEN,filename);
+  if(SID.I_am_Master)
+     flag_success=FFTW3_NAME(import_wisdom_from_filename)(filename);
+  SID_Bcast(&flag_success,sizeof(int),MASTER_RANK,SID.COMM_WORLD);
+  #if USE_MPI
+    FFTW3_NAME(mpi_broadcast_wisdom)(SID.COMM_WORLD->comm);
+  #endif
+  if(flag_success){
+     set_FFT_plan_mode(FFT_PLAN_MEASURE);
+     SID_log("Done.",SID_LOG_CLOSE);
+  }
+  else
+     SID_log("not found.",SID_LOG_CLOSE);
+#endif
+}
+
@@ -0,0 +1,14 @@
+#include <gbpLib.h>
+#include <gbpFFT.h>
+
+// Set how FFTW3 plans made from now on are chosen: FFT_PLAN_ESTIMATE
+//   (the default) makes them at once from heuristics, and
+//   FFT_PLAN_MEASURE times candidate plans.  Measuring is slow unless
+//   wisdom has been read (read_FFT_wisdom() does this itself when it
+//   finds some), but gives faster transforms and wisdom worth keeping
+//   with write_FFT_wisdom().  Does nothing for FFTW2.
+void set_FFT_plan_mode(int mode){
+  if(mode!=FFT_PLAN_ESTIMATE && mode!=FFT_PLAN_MEASURE)
+     SID_trap_error("Invalid FFT plan mode {%d}.",ERROR_LOGIC,mode);
+  FFT_plan_mode=mode;
+}
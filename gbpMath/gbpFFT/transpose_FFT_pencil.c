@@ -0,0 +1,145 @@
+#include <string.h>
+#include <gbpLib.h>
+#include <gbpFFT.h>
+
+#if USE_FFTW3 && USE_MPI
+// Set the block of a pencil field's complex array that is exchanged
+//   with rank i_peer of a transpose's communicator.  Blocks are sent as
+//   [n_a][n_b][n_c] arrays; stride_a and stride_b separate the rows of
+//   the block in the field.  Layout 0 is the field's layout before a
+//   forward transpose and layout 1 its layout after.
+void set_pencil_block_local(field_info *FFT,int i_d,int i_layout,int i_peer,
+                            size_t *offset,size_t *stride_a,size_t *stride_b,
+                            int *n_a,int *n_b,int *n_c);
+void set_pencil_block_local(field_info *FFT,int i_d,int i_layout,int i_peer,
+                            size_t *offset,size_t *stride_a,size_t *stride_b,
+                            int *n_a,int *n_b,int *n_c){
+  pencil_info *pencil     =&(FFT->pencil);
+  size_t       n_k_z_local=(size_t)FFT->n_k_local[2];
+  if(i_d==1){
+    if(i_layout==0){
+      // [x local][y local][k_z]: the peer's k_z
+      size_t n_z_complex=(size_t)(FFT->n[2]/2+1);
+      (*offset)  =(size_t)pencil->i_k_start[1][i_peer];
+      (*stride_a)=(size_t)FFT->n_R_local[1]*n_z_complex;
+      (*stride_b)=n_z_complex;
+      (*n_a)     =FFT->n_R_local[0];
+      (*n_b)     =FFT->n_R_local[1];
+      (*n_c)     =pencil->n_k[1][i_peer];
+    }
+    else{
+      // [x local][y][k_z local]: the peer's y
+      (*offset)  =(size_t)pencil->i_R_start[1][i_peer]*n_k_z_local;
+      (*stride_a)=(size_t)FFT->n[1]*n_k_z_local;
+      (*stride_b)=n_k_z_local;
+      (*n_a)     =FFT->n_R_local[0];
+      (*n_b)     =pencil->n_R[1][i_peer];
+      (*n_c)     =FFT->n_k_local[2];
+    }
+  }
+  else{
+    if(i_layout==0){
+      // [x local][k_y][k_z local]: the peer's k_y
+      (*offset)  =(size_t)pencil->i_k_start[0][i_peer]*n_k_z_local;
+      (*stride_a)=(size_t)FFT->n[1]*n_k_z_local;
+      (*stride_b)=n_k_z_local;
+      (*n_a)     =FFT->n_R_local[0];
+      (*n_b)     =pencil->n_k[0][i_peer];
+      (*n_c)     =FFT->n_k_local[2];
+    }
+    else{
+      // [k_y local][x][k_z local]: the peer's x (sent x first)
+      (*offset)  =(size_t)pencil->i_R_start[0][i_peer]*n_k_z_local;
+      (*stride_a)=n_k_z_local;
+      (*stride_b)=(size_t)FFT->n[0]*n_k_z_local;
+      (*n_a)     =pencil->n_R[0][i_peer];
+      (*n_b)     =FFT->n_k_local[1];
+      (*n_c)     =FFT->n_k_local[2];
+    }
+  }
+}
+#endif
+
+// Transpose a pencil-decomposed field between the 1-d transforms of
+//   compute_FFT() and compute_iFFT().  With i_d=1, the ranks of each
+//   row of the grid of ranks (pencil.comm[1]) trade their local y for
+//   a local k_z; with i_d=0, those of each column (pencil.comm[0])
+//   trade their local x for a local k_y.  direction=FFTW_BACKWARD
+//   undoes the FFTW_FORWARD transpose.  Called collectively.
+void transpose_FFT_pencil(field_info *FFT,int i_d,int direction){
+#if USE_FFTW3 && USE_MPI
+  pencil_info *pencil         =&(FFT->pencil);
+  int          n_peers        =pencil->n_proc[i_d];
+  int          i_layout_from  =(direction==FFTW_FORWARD?0:1);
+  int          i_layout_to    =1-i_layout_from;
+  int         *n_send         =(int *)SID_malloc(sizeof(int)*n_peers);
+  int         *i_send         =(int *)SID_malloc(sizeof(int)*n_peers);
+  int         *n_receive      =(int *)SID_malloc(sizeof(int)*n_peers);
+  int         *i_receive      =(int *)SID_malloc(sizeof(int)*n_peers);
+  size_t       n_send_total   =0;
+  size_t       n_receive_total=0;
+  size_t       offset;
+  size_t       stride_a;
+  size_t       stride_b;
+  int          n_a;
+  int          n_b;
+  int          n_c;
+  int          i_a;
+  int          i_b;
+  int          i_peer;
+
+  // Set the size and place of each peer's block in the buffers
+  for(i_peer=0;i_peer<n_peers;i_peer++){
+    set_pencil_block_local(FFT,i_d,i_layout_from,i_peer,&offset,&stride_a,&stride_b,&n_a,&n_b,&n_c);
+    n_send[i_peer]   =n_a*n_b*n_c;
+    i_send[i_peer]   =(int)n_send_total;
+    n_send_total    +=(size_t)n_send[i_peer];
+    set_pencil_block_local(FFT,i_d,i_layout_to,  i_peer,&offset,&stride_a,&stride_b,&n_a,&n_b,&n_c);
+    n_receive[i_peer]=n_a*n_b*n_c;
+    i_receive[i_peer]=(int)n_receive_total;
+    n_receive_total +=(size_t)n_receive[i_peer];
+  }
+  FFT_complex *send_buffer   =(FFT_complex *)SID_malloc(sizeof(FFT_complex)*MAX(1,n_send_total));
+  FFT_complex *receive_buffer=(FFT_complex *)SID_malloc(sizeof(FFT_complex)*MAX(1,n_receive_total));
+
+  // Gather the blocks ...
+  for(i_peer=0;i_peer<n_peers;i_peer++){
+    set_pencil_block_local(FFT,i_d,i_layout_from,i_peer,&offset,&stride_a,&stride_b,&n_a,&n_b,&n_c);
+    for(i_a=0;i_a<n_a;i_a++){
+      for(i_b=0;i_b<n_b;i_b++)
+        memcpy(&(send_buffer[(size_t)i_send[i_peer]+((size_t)i_a*(size_t)n_b+(size_t)i_b)*(size_t)n_c]),
+               &(FFT->cfield_local[offset+(size_t)i_a*stride_a+(size_t)i_b*stride_b]),
+               sizeof(FFT_complex)*(size_t)n_c);
+    }
+  }
+
+  // ... exchange them ...
+  MPI_Datatype complex_type;
+  MPI_Type_contiguous((int)sizeof(FFT_complex),MPI_BYTE,&complex_type);
+  MPI_Type_commit(&complex_type);
+  MPI_Alltoallv(send_buffer,   n_send,   i_send,   complex_type,
+                receive_buffer,n_receive,i_receive,complex_type,
+                pencil->comm[i_d]->comm);
+  MPI_Type_free(&complex_type);
+
+  // ... and scatter them into the new layout
+  for(i_peer=0;i_peer<n_peers;i_peer++){
+    set_pencil_block_local(FFT,i_d,i_layout_to,i_peer,&offset,&stride_a,&stride_b,&n_a,&n_b,&n_c);
+    for(i_a=0;i_a<n_a;i_a++){
+      for(i_b=0;i_b<n_b;i_b++)
+        memcpy(&(FFT->cfield_local[offset+(size_t)i_a*stride_a+(size_t)i_b*stride_b]),
+               &(receive_buffer[(size_t)i_receive[i_peer]+((size_t)i_a*(size_t)n_b+(size_t)i_b)*(size_t)n_c]),
+               sizeof(FFT_complex)*(size_t)n_c);
+    }
+  }
+
+  SID_free(SID_FARG send_buffer);
+  SID_free(SID_FARG receive_buffer);
+  SID_free(SID_FARG n_send);
+  SID_free(SID_FARG i_send);
+  SID_free(SID_FARG n_receive);
+  SID_free(SID_FARG i_receive);
+#else
+  SID_trap_error("Pencil transposes need FFTW3 and MPI.",ERROR_LOGIC);
+#endif
+}
@@ -0,0 +1,26 @@
+#include <gbpLib.h>
+#include <gbpFFT.h>
+
+// Write the FFTW3 wisdom gathered so far (from all ranks) to a file
+//   that read_FFT_wisdom() can read in later runs.  Nothing is written
+//   unless plans are being measured, since estimated plans gather no
+//   wisdom.  Must be called collectively.  Does nothing for FFTW2.
+void write_FFT_wisdom(const char *filename){
+#if USE_FFTW3
+  int flag_success=TRUE;
+  if(FFT_plan_mode!=FFT_PLAN_MEASURE)
+     return;
+  init_FFT_backend();
+  SID_log("Writing FFTW wisdom to {%s}...",SID_LOG_OPEN,filename);
+  #if USE_MPI
+    FFTW3_NAME(mpi_gather_wisdom)(SID.COMM_WORLD->comm);
+  #endif
+  if(SID.I_am_Master)
+     flag_success=FFTW3_NAME(export_wisdom_to_filename)(filename);
+  SID_Bcast(&flag_success,sizeof(int),MASTER_RANK,SID.COMM_WORLD);
+  if(!flag_success)
+     SID_trap_error("Could not write FFTW wisdom to {%s}.",ERROR_IO_OPEN,filename);
+  SID_log("Done.",SID_LOG_CLOSE);
+#endif
+}
+
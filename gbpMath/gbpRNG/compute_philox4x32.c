@@ -0,0 +1,33 @@
+#include <gbpLib.h>
+#include <gbpRNG.h>
+
+#define PHILOX_M0 0xD2511F53U
+#define PHILOX_M1 0xCD9E8D57U
+#define PHILOX_W0 0x9E3779B9U
+#define PHILOX_W1 0xBB67AE85U
+
+// Compute the 4x32-bit block of the Philox4x32-10 generator for a
+//   given 4x32-bit counter and 2x32-bit key (Salmon et al. 2011)
+void compute_philox4x32(const uint32_t *counter,const uint32_t *key,uint32_t *block){
+  uint32_t c0=counter[0];
+  uint32_t c1=counter[1];
+  uint32_t c2=counter[2];
+  uint32_t c3=counter[3];
+  uint32_t k0=key[0];
+  uint32_t k1=key[1];
+  int      i_round;
+  for(i_round=0;i_round<10;i_round++){
+    uint64_t p0=(uint64_t)PHILOX_M0*(uint64_t)c0;
+    uint64_t p1=(uint64_t)PHILOX_M1*(uint64_t)c2;
+    c0=(uint32_t)(p1>>32)^c1^k0;
+    c1=(uint32_t)p1;
+    c2=(uint32_t)(p0>>32)^c3^k1;
+    c3=(uint32_t)p0;
+    k0+=PHILOX_W0;
+    k1+=PHILOX_W1;
+  }
+  block[0]=c0;
+  block[1]=c1;
+  block[2]=c2;
+  block[3]=c3;
+}
@@ -1,5 +1,6 @@
 #ifndef GBPRNG_AWAKE
 #define GBPRNG_AWAKE
+#include <stdint.h>
 
 #if USE_SPRNG
   #if USE_MPI == 0
@@ -29,6 +30,21 @@ struct RNG_info{
   int     global;
 };
 
+// Counter-based generator (Philox4x32-10).  Block i of a stream is a
+//   pure function of (seed,stream,i), so every rank and thread can take
+//   its own stream, any part of a stream can be produced directly, and
+//   the results do not depend on how the work is divided up.
+#define RNG_COUNTER_BLOCK_SIZE 4 // Number of 32-bit values in a block
+
+typedef struct RNG_counter_info RNG_counter_info;
+struct RNG_counter_info{
+  int      seed;
+  uint32_t key[2];
+  uint64_t stream;
+  uint64_t counter; // Next block of the stream
+  int      initialized;
+};
+
 // Function definitions
 void    init_RNG(int *seed,RNG_info *RNG,int mode);
 void    free_RNG(RNG_info *RNG);
@@ -38,5 +54,10 @@ GBPREAL random_gaussian(RNG_info *RNG);
 GBPREAL random_lognormal(RNG_info *RNG,double mu,double sigma);
 float   ran1(long *idum);
 void    add_gaussian_noise(double *data,int n_data,int *seed,double sigma,double *covariance);
+void    init_RNG_counter(int *seed,RNG_counter_info *RNG,uint64_t stream);
+void    compute_philox4x32(const uint32_t *counter,const uint32_t *key,uint32_t *block);
+void    random_uniform_array(RNG_counter_info *RNG,GBPREAL *array,size_t n);
+void    random_uint32_array(RNG_counter_info *RNG,uint32_t *array,size_t n);
+size_t  random_binomial(RNG_counter_info *RNG,size_t n,double p);
 
 #endif
@@ -0,0 +1,18 @@
+#include <gbpLib.h>
+#include <gbpRNG.h>
+
+// Initialize a counter-based generator at the start of the given
+//   stream.  Streams with the same seed are independent of each other;
+//   use, for example, SID.My_rank*n_threads+i_thread to give each rank
+//   and thread its own.  A seed<=0 is set from the clock, as it is for
+//   init_RNG().
+void init_RNG_counter(int *seed,RNG_counter_info *RNG,uint64_t stream){
+  if((*seed)<=0)
+    init_seed_from_clock(seed);
+  RNG->seed       =(*seed);
+  RNG->key[0]     =(uint32_t)(*seed);
+  RNG->key[1]     =0;
+  RNG->stream     =stream;
+  RNG->counter    =0;
+  RNG->initialized=TRUE;
+}
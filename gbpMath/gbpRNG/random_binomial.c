@@ -0,0 +1,143 @@
+#include <math.h>
+#include <float.h>
+#include <gbpLib.h>
+#include <gbpRNG.h>
+
+#define RANDOM_BINOMIAL_M_INVERSION 11 // Use inversion if the mode is below this
+
+// Draw a double in [0,1) with 53 random bits (one block of the stream)
+double random_binomial_uniform_local(RNG_counter_info *RNG);
+double random_binomial_uniform_local(RNG_counter_info *RNG){
+  uint32_t bits[2];
+  random_uint32_array(RNG,bits,2);
+  return(((double)(bits[0]>>5)*67108864.+(double)(bits[1]>>6))*(1./9007199254740992.));
+}
+
+// Stirling series correction log(k!)-log(sqrt(2 pi)k^(k+1/2)e^-k)
+double random_binomial_fc_local(double k);
+double random_binomial_fc_local(double k){
+  static const double fc_table[10]={0.08106146679532726,0.04134069595540929,0.02767792568499834,
+                                    0.02079067210376509,0.01664469118982119,0.01387612882307075,
+                                    0.01189670994589177,0.01041126526197209,0.009255462182712733,
+                                    0.008330563433362871};
+  double ikp1;
+  if(k<10.)
+    return(fc_table[(int)k]);
+  ikp1=1./(k+1.);
+  return((1./12.-(1./360.-(1./1260.)*(ikp1*ikp1))*(ikp1*ikp1))*ikp1);
+}
+
+// Draw a binomial deviate (the number of successes in n trials with
+//   probability p) from a counter-based generator.  The expected cost
+//   does not depend on n: inversion is used when n*min(p,1-p) is small
+//   and transformed rejection with decomposition (BTRD; Hormann 1993,
+//   J. Stat. Comput. Simul. 46, 101) otherwise.  The result is a pure
+//   function of the stream's state, so ranks drawing from the same
+//   stream get the same value.
+size_t random_binomial(RNG_counter_info *RNG,size_t n,double p){
+  double p_small;
+  double r;
+  double x;
+  double m;
+  double n_d=(double)n;
+  if(!RNG->initialized)
+    SID_trap_error("RNG_counter_info not initialized in call to random_binomial.",ERROR_LOGIC);
+  if(n==0 || p<=0.)
+    return(0);
+  if(p>=1.)
+    return(n);
+
+  // Draw for p<=1/2 and use the symmetry of the distribution for p>1/2
+  p_small=MIN(p,1.-p);
+  r      =p_small/(1.-p_small);
+  m      =floor((n_d+1.)*p_small);
+
+  // Inversion: walk up the CDF from k=0
+  if(m<(double)RANDOM_BINOMIAL_M_INVERSION){
+     double a  =(n_d+1.)*r;
+     double f  =pow(1.-p_small,n_d);
+     double u  =random_binomial_uniform_local(RNG);
+     x=0.;
+     while(u>f && x<n_d){
+        double f_next;
+        u-=f;
+        x+=1.;
+        f_next=(a/x-r)*f;
+        if(f_next<DBL_EPSILON && f_next<f)
+           break;
+        f=f_next;
+     }
+  }
+  // BTRD
+  else{
+     double npq     =n_d*p_small*(1.-p_small);
+     double sqrt_npq=sqrt(npq);
+     double nr      =(n_d+1.)*r;
+     double b       =1.15+2.53*sqrt_npq;
+     double a       =-0.0873+0.0248*b+0.01*p_small;
+     double c       =n_d*p_small+0.5;
+     double alpha   =(2.83+5.1/b)*sqrt_npq;
+     double v_r     =0.92-4.2/b;
+     double u_rv_r  =0.86*v_r;
+     int    flag_done=FALSE;
+     while(!flag_done){
+        double u;
+        double us;
+        double v;
+        double km;
+        v=random_binomial_uniform_local(RNG);
+        // Most draws are accepted straight from the triangular centre
+        if(v<=u_rv_r){
+           u=v/v_r-0.43;
+           x=floor((2.*a/(0.5-fabs(u))+b)*u+c);
+           flag_done=TRUE;
+           continue;
+        }
+        if(v>=v_r)
+           u=random_binomial_uniform_local(RNG)-0.5;
+        else{
+           u=v/v_r-0.93;
+           u=(u<0.?-0.5:0.5)-u;
+           v=random_binomial_uniform_local(RNG)*v_r;
+        }
+        us=0.5-fabs(u);
+        x =floor((2.*a/us+b)*u+c);
+        if(x<0. || x>n_d)
+           continue;
+        v *=alpha/(a/(us*us)+b);
+        km =fabs(x-m);
+        // Close to the mode, evaluate the ratio of probabilities directly ...
+        if(km<=15.){
+           double f=1.;
+           double i;
+           if(m<x){
+              for(i=m+1.;i<=x;i+=1.)
+                 f*=(nr/i-r);
+           }
+           else if(m>x){
+              for(i=x+1.;i<=m;i+=1.)
+                 v*=(nr/i-r);
+           }
+           flag_done=(v<=f);
+        }
+        // ... otherwise squeeze and then compare with its logarithm
+        else{
+           double rho=(km/npq)*(((km/3.+0.625)*km+1./6.)/npq+0.5);
+           double t  =-km*km/(2.*npq);
+           v=log(v);
+           if(v<t-rho)
+              flag_done=TRUE;
+           else if(v<=t+rho){
+              double nm=n_d-m+1.;
+              double nk=n_d-x+1.;
+              double h =(m+0.5)*log((m+1.)/(r*nm))+random_binomial_fc_local(m)+random_binomial_fc_local(n_d-m);
+              flag_done=(v<=h+(n_d+1.)*log(nm/nk)+(x+0.5)*log(nk*r/(x+1.))
+                              -random_binomial_fc_local(x)-random_binomial_fc_local(n_d-x));
+           }
+        }
+     }
+  }
+  if(p>0.5)
+     x=n_d-x;
+  return((size_t)x);
+}
@@ -0,0 +1,32 @@
+#include <gbpLib.h>
+#include <gbpRNG.h>
+
+// Fill an array with n uniformly distributed 32-bit integers from a
+//   counter-based generator.  Blocks of RNG_COUNTER_BLOCK_SIZE values
+//   are produced independently (and in parallel with USE_OPENMP) and
+//   the stream is advanced past all of them, so any values left over
+//   in the last block are skipped.
+void random_uint32_array(RNG_counter_info *RNG,uint32_t *array,size_t n){
+  size_t n_blocks=(n+RNG_COUNTER_BLOCK_SIZE-1)/RNG_COUNTER_BLOCK_SIZE;
+  size_t i_block;
+  if(!RNG->initialized)
+    SID_trap_error("RNG_counter_info not initialized in call to random_uint32_array.",ERROR_LOGIC);
+#if USE_OPENMP
+  #pragma omp parallel for schedule(static) if(n_blocks>4096)
+#endif
+  for(i_block=0;i_block<n_blocks;i_block++){
+    uint64_t counter_i=RNG->counter+(uint64_t)i_block;
+    uint32_t counter[4];
+    uint32_t block[RNG_COUNTER_BLOCK_SIZE];
+    size_t   i_start=i_block*RNG_COUNTER_BLOCK_SIZE;
+    size_t   i_value;
+    counter[0]=(uint32_t)counter_i;
+    counter[1]=(uint32_t)(counter_i>>32);
+    counter[2]=(uint32_t)RNG->stream;
+    counter[3]=(uint32_t)(RNG->stream>>32);
+    compute_philox4x32(counter,RNG->key,block);
+    for(i_value=0;i_value<RNG_COUNTER_BLOCK_SIZE && (i_start+i_value)<n;i_value++)
+      array[i_start+i_value]=block[i_value];
+  }
+  RNG->counter+=(uint64_t)n_blocks;
+}
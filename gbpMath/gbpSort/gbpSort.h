@@ -42,6 +42,10 @@ void merge_sort(void    *data_in,
                 SID_Datatype      data_type,
                 int      flag_compute_index,
                 int      flag_in_place);
+void merge_sort_presorted(void         *data_in,
+                          size_t        n_data,
+                          size_t       *index,
+                          SID_Datatype  data_type);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <gbpCommon.h>
+#include <gbpSID.h>
+#include <gbpSort.h>
+
+// Runs shorter than this are extended with an insertion sort before merging
+#define MERGE_SORT_PRESORTED_MIN_RUN 32
+
+// Generates a routine which repairs the sort index of an array of type TYPE.
+//   Entries are ordered by value and then by index, which reproduces the
+//   (stable) ordering generated by merge_sort().
+#define MERGE_SORT_PRESORTED_FUNCTION(NAME,TYPE) \
+static void NAME(TYPE *data,size_t n_data,size_t *index,size_t *scratch,size_t *run_start){ \
+  size_t i_run; \
+  size_t n_run; \
+  size_t i; \
+  size_t j; \
+  /* Find runs of already-ordered entries, extending short ones with an insertion sort */ \
+  for(i=0,n_run=0;i<n_data;n_run++){ \
+    size_t i_start=i; \
+    for(i++;i<n_data && MERGE_SORT_PRESORTED_LESS(data,index[i-1],index[i]);i++); \
+    if(i<n_data && (i-i_start)<MERGE_SORT_PRESORTED_MIN_RUN){ \
+      size_t i_stop=MIN(n_data,i_start+MERGE_SORT_PRESORTED_MIN_RUN); \
+      for(;i<i_stop;i++){ \
+        size_t index_i=index[i]; \
+        for(j=i;j>i_start && MERGE_SORT_PRESORTED_LESS(data,index_i,index[j-1]);j--) \
+          index[j]=index[j-1]; \
+        index[j]=index_i; \
+      } \
+    } \
+    run_start[n_run]=i_start; \
+  } \
+  run_start[n_run]=n_data; \
+  /* Merge neighbouring runs until only one remains */ \
+  while(n_run>1){ \
+    size_t n_run_new=0; \
+    for(i_run=0;i_run<n_run;i_run+=2,n_run_new++){ \
+      run_start[n_run_new]=run_start[i_run]; \
+      if(i_run+1<n_run){ \
+        size_t lo =run_start[i_run]; \
+        size_t mid=run_start[i_run+1]; \
+        size_t hi =run_start[i_run+2]; \
+        /* Skip the merge if the runs are already in order */ \
+        if(MERGE_SORT_PRESORTED_LESS(data,index[mid-1],index[mid])) \
+          continue; \
+        /* Trim the parts of each run that are already in their final place */ \
+        size_t l_lo=lo; \
+        size_t l_hi=mid; \
+        while(l_lo<l_hi){ \
+          size_t l_mid=l_lo+(l_hi-l_lo)/2; \
+          if(MERGE_SORT_PRESORTED_LESS(data,index[l_mid],index[mid])) l_lo=l_mid+1; \
+          else                                                        l_hi=l_mid; \
+        } \
+        size_t r_lo=mid; \
+        size_t r_hi=hi; \
+        while(r_lo<r_hi){ \
+          size_t r_mid=r_lo+(r_hi-r_lo)/2; \
+          if(MERGE_SORT_PRESORTED_LESS(data,index[r_mid],index[mid-1])) r_lo=r_mid+1; \
+          else                                                          r_hi=r_mid; \
+        } \
+        /* Merge [l_lo,mid) and [mid,r_lo) using scratch for the left part */ \
+        size_t n_left=mid-l_lo; \
+        size_t i_left =0; \
+        size_t i_right=mid; \
+        size_t i_out  =l_lo; \
+        memcpy(scratch,&(index[l_lo]),sizeof(size_t)*n_left); \
+        while(i_left<n_left && i_right<r_lo){ \
+          if(MERGE_SORT_PRESORTED_LESS(data,index[i_right],scratch[i_left])) \
+            index[i_out++]=index[i_right++]; \
+          else \
+            index[i_out++]=scratch[i_left++]; \
+        } \
+        while(i_left<n_left) \
+          index[i_out++]=scratch[i_left++]; \
+      } \
+    } \
+    run_start[n_run_new]=n_data; \
+    n_run=n_run_new; \
+  } \
+}
+#define MERGE_SORT_PRESORTED_LESS(data,a,b) ((data)[a]<(data)[b] || ((data)[a]==(data)[b] && (a)<(b)))
+
+MERGE_SORT_PRESORTED_FUNCTION(merge_sort_presorted_int,   int)
+MERGE_SORT_PRESORTED_FUNCTION(merge_sort_presorted_size_t,size_t)
+MERGE_SORT_PRESORTED_FUNCTION(merge_sort_presorted_float, float)
+MERGE_SORT_PRESORTED_FUNCTION(merge_sort_presorted_double,double)
+
+// Update a sort index (previously generated by eg. merge_sort()) after the data
+//   it sorts has changed.  The cost is nearly linear when the data remains
+//   nearly sorted by the old index (eg. particle depths between two frames
+//   of a movie) and is never much worse than that of merge_sort().  The
+//   result is identical to that of merge_sort() with SORT_COMPUTE_INDEX.
+void merge_sort_presorted(void         *data_in,
+                          size_t        n_data,
+                          size_t       *index,
+                          SID_Datatype  data_type){
+  size_t *scratch;
+  size_t *run_start;
+
+  if(n_data<2)
+    return;
+
+  scratch  =(size_t *)SID_malloc(sizeof(size_t)*n_data);
+  run_start=(size_t *)SID_malloc(sizeof(size_t)*(n_data/MERGE_SORT_PRESORTED_MIN_RUN+2));
+  if(data_type==SID_INT)
+    merge_sort_presorted_int((int *)data_in,n_data,index,scratch,run_start);
+  else if(data_type==SID_SIZE_T)
+    merge_sort_presorted_size_t((size_t *)data_in,n_data,index,scratch,run_start);
+  else if(data_type==SID_FLOAT)
+    merge_sort_presorted_float((float *)data_in,n_data,index,scratch,run_start);
+  else if(data_type==SID_DOUBLE)
+    merge_sort_presorted_double((double *)data_in,n_data,index,scratch,run_start);
+  else
+    SID_trap_error("Unsupported data type {%d}",ERROR_LOGIC,data_type);
+  SID_free(SID_FARG scratch);
+  SID_free(SID_FARG run_start);
+}
@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <gbpLib.h>
+#include <gbpMath.h>
+#include <gbpCosmo.h>
+#include <gbpSPH.h>
+#include <gbpClustering.h>
+
+// Displace a species' particles into redshift space along one axis
+//   (i_coord=0,1,2 for x,y,z), in place, using the velocities stored
+//   in the plist.  This lets several redshift-space frames be built
+//   from a single read.  The positions are wrapped periodically.  If
+//   the displacement is along x (or along y for a pencil decomposition)
+//   and a slab is given, particles are then moved to the ranks whose
+//   slabs or pencils hold them; otherwise the decomposition is left as
+//   it is.  The real-space coordinates are kept in the plist so that
+//   restore_zspace_plist() can undo this exactly.  The Hubble parameter
+//   is taken from the plist if it is stored there and from the cosmology
+//   if not.
+void apply_zspace_plist(plist_info *plist,
+                        const char *species_name,
+                        int         i_coord,
+                        double      box_size,
+                        double      redshift,
+                        cosmo_info *cosmo,
+                        slab_info  *slab){
+  const char *x_names[]={"x_%s","y_%s","z_%s"};
+  const char *v_names[]={"vx_%s","vy_%s","vz_%s"};
+  size_t      n_particles_local;
+  size_t      n_particles;
+  size_t      i_particle;
+  GBPREAL    *x_particles_local;
+  GBPREAL    *v_particles_local;
+  double      h_Hubble;
+  double      d_bar=0.;
+
+  if(i_coord<0 || i_coord>2)
+    SID_trap_error("Invalid redshift-space axis {%d}.",ERROR_LOGIC,i_coord);
+  if(ADaPS_exist(plist->data,"i_zspace_%s",species_name))
+    SID_trap_error("The %s particles are already in redshift space.",ERROR_LOGIC,species_name);
+  SID_log("Applying redshift-space displacements to the %s particles...",SID_LOG_OPEN|SID_LOG_TIMER,species_name);
+
+  // Fetch the needed information
+  if(ADaPS_exist(plist->data,"h_Hubble"))
+    h_Hubble=((double *)ADaPS_fetch(plist->data,"h_Hubble"))[0];
+  else
+    h_Hubble=((double *)ADaPS_fetch(cosmo,"h_Hubble"))[0];
+  n_particles_local=((size_t *)ADaPS_fetch(plist->data,"n_%s",species_name))[0];
+  n_particles      =((size_t *)ADaPS_fetch(plist->data,"n_all_%s",species_name))[0];
+  if(n_particles_local>0){
+    x_particles_local=(GBPREAL *)ADaPS_fetch(plist->data,x_names[i_coord],species_name);
+    v_particles_local=(GBPREAL *)ADaPS_fetch(plist->data,v_names[i_coord],species_name);
+  }
+
+  // Keep the real-space coordinates
+  GBPREAL *x_real_local=(GBPREAL *)SID_malloc(sizeof(GBPREAL)*MAX(1,n_particles_local));
+  if(n_particles_local>0)
+    memcpy(x_real_local,x_particles_local,sizeof(GBPREAL)*n_particles_local);
+  ADaPS_store(&(plist->data),(void *)x_real_local,"zspace_real_%s",ADaPS_DEFAULT,species_name);
+  ADaPS_store(&(plist->data),(void *)(&i_coord),  "i_zspace_%s",   ADaPS_SCALAR_INT,species_name);
+
+  // Apply the displacements
+  double v_to_x=1e3*h_Hubble/(a_of_z(redshift)*M_PER_MPC*H_convert(H_z(redshift,cosmo)));
+  for(i_particle=0;i_particle<n_particles_local;i_particle++){
+    double d=v_to_x*(double)v_particles_local[i_particle];
+    x_particles_local[i_particle]=(GBPREAL)((double)x_particles_local[i_particle]+d);
+    force_periodic(&(x_particles_local[i_particle]),0.,(GBPREAL)box_size);
+    d_bar+=fabs(d);
+  }
+  SID_Allreduce(SID_IN_PLACE,&d_bar,1,SID_DOUBLE,SID_SUM,SID.COMM_WORLD);
+  if(n_particles>0)
+    d_bar/=(double)n_particles;
+  SID_log("(d_bar=%.2lf [Mpc/h])...",SID_LOG_CONTINUE,d_bar);
+
+  // Displacements along x move particles between slabs, and those
+  //   along y between pencils
+  if(slab!=NULL && SID.n_proc>1 && (i_coord==0 || (i_coord==1 && (slab->y_max_local-slab->y_min_local)<slab->y_max)))
+    exchange_slab_plist(plist,species_name,slab);
+
+  SID_log("Done.",SID_LOG_CLOSE);
+}
@@ -0,0 +1,16 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <gbpLib.h>
+#include <gbpMath.h>
+#include <gbpClustering.h>
+
+// Unmap any slab still mapped from a grid file and close it
+void close_grid_file(grid_file_info *grid_file){
+  if(grid_file->map!=NULL)
+     munmap(grid_file->map,grid_file->map_size);
+  grid_file->map     =NULL;
+  grid_file->map_size=0;
+  close(grid_file->fd);
+  SID_free(SID_FARG grid_file->offset);
+}
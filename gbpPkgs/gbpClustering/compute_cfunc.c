@@ -6,6 +6,9 @@
 #include <gbpCosmo.h>
 #include <gbpSPH.h>
 #include <gbpClustering.h>
+#if USE_OPENMP
+  #include <omp.h>
+#endif
 
 #define CFUNC_ADD_PAIR_DD   2
 #define CFUNC_ADD_PAIR_DR   4
@@ -28,6 +31,41 @@ double calc_CFUNC_local(double DD,double DR,double RR,cfunc_info *cfunc){
     return(0.);
 }
 
+// Add a pair to a histogram and to its jack-knife histograms.  Jack-knife
+//   region i_jack (1..n_jack_total) leaves out zone i_jack-1.  With
+//   CFUNC_JACK_ZONES, region i_jack instead counts the pairs touching
+//   zone i_jack-1 and finalize_jack_local() converts it afterwards.
+void add_pair_jack_local(long long **array,int bin,int zone_i,int zone_j,cfunc_info *cfunc);
+void add_pair_jack_local(long long **array,int bin,int zone_i,int zone_j,cfunc_info *cfunc){
+   array[0][bin]++; // Add to the non-jack-knife array
+   if(cfunc->jack_mode==CFUNC_JACK_ZONES){
+      array[zone_i+1][bin]++;
+      if(zone_j!=zone_i)
+         array[zone_j+1][bin]++;
+   }
+   else{
+      int i_jack;
+      for(i_jack=1;i_jack<=cfunc->n_jack_total;i_jack++){
+         if(zone_i!=(i_jack-1) && zone_j!=(i_jack-1))
+            array[i_jack][bin]++; // Add to all but one jack-knife region
+      }
+   }
+}
+
+// Turn the per-zone counts made with CFUNC_JACK_ZONES into jack-knife
+//   histograms (the total less the pairs touching each zone)
+void finalize_jack_local(long long **array,int n_bins,cfunc_info *cfunc);
+void finalize_jack_local(long long **array,int n_bins,cfunc_info *cfunc){
+   int i_jack;
+   int i_bin;
+   if(cfunc->jack_mode==CFUNC_JACK_ZONES){
+      for(i_jack=1;i_jack<=cfunc->n_jack_total;i_jack++){
+         for(i_bin=0;i_bin<n_bins;i_bin++)
+            array[i_jack][i_bin]=array[0][i_bin]-array[i_jack][i_bin];
+      }
+   }
+}
+
 int add_pair_CFUNC_local(double x_i,double y_i,double z_i,
                          double x_j,double y_j,double z_j,
                          int zone_i,int zone_j,
@@ -70,12 +108,7 @@ int add_pair_CFUNC_local(double x_i,double y_i,double z_i,
         int bin_1D;
         bin_1D=(int)((sep_1D)/cfunc->dr_1D); //r_min=0 in this case
         if(bin_1D>=0 && bin_1D<cfunc->n_1D){
-          int i_jack=0;
-          array[i_jack++][bin_1D]++; // Add to the non-jack-knife array
-          for(;i_jack<=cfunc->n_jack_total;i_jack++){
-            if(zone_i!=i_jack && zone_j!=i_jack)
-              array[i_jack][bin_1D]++; // Add to all but one jack-knife region
-          }
+          add_pair_jack_local(array,bin_1D,zone_i,zone_j,cfunc);
           flag_used=TRUE;
         }
 
@@ -83,12 +116,7 @@ int add_pair_CFUNC_local(double x_i,double y_i,double z_i,
         int bin_l1D;
         bin_l1D=(int)((take_log10(sep_1D)-cfunc->lr_min_l1D)/cfunc->dr_l1D);
         if(bin_l1D>=0 && bin_l1D<cfunc->n_1D){
-          int i_jack=0;
-          larray[i_jack++][bin_l1D]++; // Add to the non-jack-knife array
-          for(;i_jack<=cfunc->n_jack_total;i_jack++){
-            if(zone_i!=i_jack && zone_j!=i_jack)
-              larray[i_jack][bin_l1D]++; // Add to all but one jack-knife region;
-          }
+          add_pair_jack_local(larray,bin_l1D,zone_i,zone_j,cfunc);
           flag_used=TRUE;
         }
       }
@@ -105,7 +133,7 @@ int add_pair_CFUNC_local(double x_i,double y_i,double z_i,
       bin_2D_x=(int)((sep_2D_x-cfunc->r_min_2D)/cfunc->dr_2D);
       if(bin_2D_x>=0 && bin_2D_x<cfunc->n_2D){
          sep_2D_y=sqrt(dz*dz);
-         bin_2D_y=(int)((sep_2D_x-cfunc->r_min_2D)/cfunc->dr_2D);
+         bin_2D_y=(int)((sep_2D_y-cfunc->r_min_2D)/cfunc->dr_2D);
          if(bin_2D_y>=0 && bin_2D_y<cfunc->n_2D){
 
             // Compute bin
@@ -128,14 +156,8 @@ int add_pair_CFUNC_local(double x_i,double y_i,double z_i,
             } 
 
             // Add to the array if we are within bounds
-            if(bin_2D>=0 && bin_2D<cfunc->n_2D){
-               int i_jack=0;
-               array[i_jack++][bin_2D]++;
-               for(;i_jack<=cfunc->n_jack_total;i_jack++){
-                  if(zone_i!=i_jack && zone_j!=i_jack)
-                     array[i_jack][bin_2D]++;
-               }
-            }
+            if(bin_2D>=0 && bin_2D<cfunc->n_2D_total)
+               add_pair_jack_local(array,bin_2D,zone_i,zone_j,cfunc);
             flag_used=TRUE;
          }
       }
@@ -143,6 +165,383 @@ int add_pair_CFUNC_local(double x_i,double y_i,double z_i,
    return(flag_used);
 }
 
+// Number of candidate pairs whose separations are computed together (in a
+//   loop the compiler can vectorize) before they are binned
+#define CFUNC_PAIR_BLOCK 256
+
+// Bins described by their squared edges, with a table (indexed by squared
+//   separation) giving the first bin each separation could fall in.  This
+//   lets pairs be binned without computing sqrt() or log10().
+typedef struct cfunc_bins_local_info cfunc_bins_local_info;
+struct cfunc_bins_local_info{
+   int     n_bins;
+   double *edge2;       // Squared edges; bin i is [edge2[i],edge2[i+1])
+   int     n_table;
+   double  table_scale; // Table entry of r2 is (int)(r2*table_scale)
+   int    *table;
+};
+
+void init_cfunc_bins_local(cfunc_bins_local_info *bins,int n_bins,double *edge);
+void init_cfunc_bins_local(cfunc_bins_local_info *bins,int n_bins,double *edge){
+   int i_bin;
+   int i_table;
+   bins->n_bins =n_bins;
+   bins->edge2  =(double *)SID_malloc(sizeof(double)*(n_bins+1));
+   for(i_bin=0;i_bin<=n_bins;i_bin++)
+      bins->edge2[i_bin]=edge[i_bin]*edge[i_bin];
+   bins->n_table    =64*MAX(1,n_bins);
+   bins->table_scale=(double)bins->n_table/bins->edge2[n_bins];
+   bins->table      =(int *)SID_malloc(sizeof(int)*bins->n_table);
+   for(i_table=0,i_bin=0;i_table<bins->n_table;i_table++){
+      double r2_table=(double)i_table/bins->table_scale;
+      while(i_bin<(n_bins-1) && bins->edge2[i_bin+1]<=r2_table)
+         i_bin++;
+      bins->table[i_table]=i_bin;
+   }
+}
+
+void free_cfunc_bins_local(cfunc_bins_local_info *bins);
+void free_cfunc_bins_local(cfunc_bins_local_info *bins){
+   SID_free(SID_FARG bins->edge2);
+   SID_free(SID_FARG bins->table);
+}
+
+// Returns the bin of a squared separation, or -1 if it is out of range
+int find_cfunc_bin_local(cfunc_bins_local_info *bins,double r2);
+int find_cfunc_bin_local(cfunc_bins_local_info *bins,double r2){
+   if(r2<bins->edge2[0] || r2>=bins->edge2[bins->n_bins])
+      return(-1);
+   int i_table=MIN((int)(r2*bins->table_scale),bins->n_table-1);
+   int i_bin  =bins->table[i_table];
+   while(i_bin<(bins->n_bins-1) && r2>=bins->edge2[i_bin+1])
+      i_bin++;
+   return(i_bin);
+}
+
+// As add_pair_jack_local(), but for histograms whose jack-knife
+//   regions are stored every n_stride elements
+void add_pair_cells_local(long long *histogram,int n_stride,int bin,int zone_i,int zone_j,int n_jack_total,int jack_mode);
+void add_pair_cells_local(long long *histogram,int n_stride,int bin,int zone_i,int zone_j,int n_jack_total,int jack_mode){
+   histogram[bin]++; // Add to the non-jack-knife array
+   if(jack_mode==CFUNC_JACK_ZONES){
+      histogram[(zone_i+1)*n_stride+bin]++;
+      if(zone_j!=zone_i)
+         histogram[(zone_j+1)*n_stride+bin]++;
+   }
+   else{
+      int i_jack;
+      for(i_jack=1;i_jack<=n_jack_total;i_jack++){
+         if(zone_i!=(i_jack-1) && zone_j!=(i_jack-1))
+            histogram[i_jack*n_stride+bin]++; // Add to all but one jack-knife region
+      }
+   }
+}
+
+// Sort a set of objects into a grid of cells.  Cell indices are clamped to
+//   the grid.  Returns the start of each cell's objects in the sorted arrays.
+void sort_cells_local(GBPREAL *x,GBPREAL *y,GBPREAL *z,int *zone,size_t n,
+                      double *x_min,double inv_d_cell,int *n_cell,
+                      size_t *cell_start,double *x_sort,double *y_sort,double *z_sort,int *zone_sort);
+void sort_cells_local(GBPREAL *x,GBPREAL *y,GBPREAL *z,int *zone,size_t n,
+                      double *x_min,double inv_d_cell,int *n_cell,
+                      size_t *cell_start,double *x_sort,double *y_sort,double *z_sort,int *zone_sort){
+   size_t  i_obj;
+   size_t  n_cells=(size_t)n_cell[0]*(size_t)n_cell[1]*(size_t)n_cell[2];
+   size_t  i_cell;
+   size_t *cell=(size_t *)SID_malloc(sizeof(size_t)*n);
+   for(i_cell=0;i_cell<=n_cells;i_cell++)
+      cell_start[i_cell]=0;
+   for(i_obj=0;i_obj<n;i_obj++){
+      int i_x=MAX(0,MIN(n_cell[0]-1,(int)floor(((double)x[i_obj]-x_min[0])*inv_d_cell)));
+      int i_y=MAX(0,MIN(n_cell[1]-1,(int)floor(((double)y[i_obj]-x_min[1])*inv_d_cell)));
+      int i_z=MAX(0,MIN(n_cell[2]-1,(int)floor(((double)z[i_obj]-x_min[2])*inv_d_cell)));
+      cell[i_obj]=((size_t)i_x*(size_t)n_cell[1]+(size_t)i_y)*(size_t)n_cell[2]+(size_t)i_z;
+      cell_start[cell[i_obj]+1]++;
+   }
+   for(i_cell=0;i_cell<n_cells;i_cell++)
+      cell_start[i_cell+1]+=cell_start[i_cell];
+   for(i_obj=0;i_obj<n;i_obj++){
+      size_t i_sort=cell_start[cell[i_obj]]++;
+      x_sort[i_sort]   =(double)x[i_obj];
+      y_sort[i_sort]   =(double)y[i_obj];
+      z_sort[i_sort]   =(double)z[i_obj];
+      zone_sort[i_sort]=zone[i_obj];
+   }
+   // The previous loop shifted each cell's start to the next cell's
+   for(i_cell=n_cells;i_cell>0;i_cell--)
+      cell_start[i_cell]=cell_start[i_cell-1];
+   cell_start[0]=0;
+   SID_free(SID_FARG cell);
+}
+
+// Count all pairs between two sets of objects using sorted cell lists.  If
+//   flag_same_set is set, the two sets are the same and each pair is only
+//   counted once.  The binning reproduces that of add_pair_CFUNC_local().
+void calc_pairs_cells_local(GBPREAL *x_1,GBPREAL *y_1,GBPREAL *z_1,int *zone_1,size_t n_1,
+                            GBPREAL *x_2,GBPREAL *y_2,GBPREAL *z_2,int *zone_2,size_t n_2,
+                            int flag_same_set,int flag_pair_type,cfunc_info *cfunc);
+void calc_pairs_cells_local(GBPREAL *x_1,GBPREAL *y_1,GBPREAL *z_1,int *zone_1,size_t n_1,
+                            GBPREAL *x_2,GBPREAL *y_2,GBPREAL *z_2,int *zone_2,size_t n_2,
+                            int flag_same_set,int flag_pair_type,cfunc_info *cfunc){
+   int    n_1D        =cfunc->n_1D;
+   int    n_2D        =cfunc->n_2D;
+   int    n_2D_total  =cfunc->n_2D_total;
+   int    n_jack_total=cfunc->n_jack_total;
+   int    jack_mode   =cfunc->jack_mode;
+   int    i_bin;
+   int    i_jack;
+   size_t i_cell;
+
+   if(n_1<1 || n_2<1)
+      return;
+
+   // Set the bins.  add_pair_CFUNC_local() truncates (rather than floors) bin
+   //   indices, so the first log and 2D bins extend one bin width lower.
+   cfunc_bins_local_info bins_1D;
+   cfunc_bins_local_info bins_l1D;
+   cfunc_bins_local_info bins_2D;
+   double *edge=(double *)SID_malloc(sizeof(double)*(MAX(n_1D,n_2D)+1));
+   for(i_bin=0;i_bin<=n_1D;i_bin++)
+      edge[i_bin]=(double)i_bin*cfunc->dr_1D;
+   edge[n_1D]=MIN(edge[n_1D],cfunc->r_max_1D);
+   init_cfunc_bins_local(&bins_1D,n_1D,edge);
+   edge[0]=take_alog10(cfunc->lr_min_l1D-cfunc->dr_l1D);
+   for(i_bin=1;i_bin<=n_1D;i_bin++)
+      edge[i_bin]=take_alog10(cfunc->lr_min_l1D+(double)i_bin*cfunc->dr_l1D);
+   edge[n_1D]=MIN(edge[n_1D],cfunc->r_max_1D);
+   init_cfunc_bins_local(&bins_l1D,n_1D,edge);
+   edge[0]=MAX(0.,cfunc->r_min_2D-cfunc->dr_2D);
+   for(i_bin=1;i_bin<=n_2D;i_bin++)
+      edge[i_bin]=cfunc->r_min_2D+(double)i_bin*cfunc->dr_2D;
+   init_cfunc_bins_local(&bins_2D,n_2D,edge);
+   SID_free(SID_FARG edge);
+   double r2_max_1D=cfunc->r_max_1D*cfunc->r_max_1D;
+   double r2_max_2D=cfunc->r_max_2D*cfunc->r_max_2D;
+
+   // Set a grid of cells over the second set.  Cells must be at least as
+   //   wide as the largest separation that can be binned (plus a little
+   //   slack for rounding).  Objects past the last cell are clamped into it.
+   double x_min[3];
+   double x_max[3];
+   double d_cell=1.0001*MAX(cfunc->r_max_1D,MAX(cfunc->r_max_2D,sqrt(bins_2D.edge2[n_2D])));
+   int    n_cell[3];
+   int    i_dim;
+   size_t i_obj;
+   x_min[0]=x_max[0]=(double)x_2[0];
+   x_min[1]=x_max[1]=(double)y_2[0];
+   x_min[2]=x_max[2]=(double)z_2[0];
+   for(i_obj=1;i_obj<n_2;i_obj++){
+      x_min[0]=MIN(x_min[0],(double)x_2[i_obj]);x_max[0]=MAX(x_max[0],(double)x_2[i_obj]);
+      x_min[1]=MIN(x_min[1],(double)y_2[i_obj]);x_max[1]=MAX(x_max[1],(double)y_2[i_obj]);
+      x_min[2]=MIN(x_min[2],(double)z_2[i_obj]);x_max[2]=MAX(x_max[2],(double)z_2[i_obj]);
+   }
+   // ... but don't use more cells than there are objects
+   double n_cell_d[3];
+   while(TRUE){
+      for(i_dim=0;i_dim<3;i_dim++)
+         n_cell_d[i_dim]=MAX(1.,floor((x_max[i_dim]-x_min[i_dim])/d_cell));
+      if(n_cell_d[0]*n_cell_d[1]*n_cell_d[2]<=(double)MAX(n_1,n_2))
+         break;
+      d_cell*=1.25;
+   }
+   for(i_dim=0;i_dim<3;i_dim++)
+      n_cell[i_dim]=(int)n_cell_d[i_dim];
+   size_t n_cells   =(size_t)n_cell[0]*(size_t)n_cell[1]*(size_t)n_cell[2];
+   double inv_d_cell=1./d_cell;
+
+   // Sort both sets into the cells
+   size_t *cell_start_1;
+   size_t *cell_start_2;
+   double *x_1_sort;
+   double *y_1_sort;
+   double *z_1_sort;
+   int    *zone_1_sort;
+   double *x_2_sort;
+   double *y_2_sort;
+   double *z_2_sort;
+   int    *zone_2_sort;
+   cell_start_2=(size_t *)SID_malloc(sizeof(size_t)*(n_cells+1));
+   x_2_sort    =(double *)SID_malloc(sizeof(double)*n_2);
+   y_2_sort    =(double *)SID_malloc(sizeof(double)*n_2);
+   z_2_sort    =(double *)SID_malloc(sizeof(double)*n_2);
+   zone_2_sort =(int    *)SID_malloc(sizeof(int)   *n_2);
+   sort_cells_local(x_2,y_2,z_2,zone_2,n_2,x_min,inv_d_cell,n_cell,cell_start_2,x_2_sort,y_2_sort,z_2_sort,zone_2_sort);
+   if(flag_same_set){
+      cell_start_1=cell_start_2;
+      x_1_sort    =x_2_sort;
+      y_1_sort    =y_2_sort;
+      z_1_sort    =z_2_sort;
+      zone_1_sort =zone_2_sort;
+   }
+   else{
+      cell_start_1=(size_t *)SID_malloc(sizeof(size_t)*(n_cells+1));
+      x_1_sort    =(double *)SID_malloc(sizeof(double)*n_1);
+      y_1_sort    =(double *)SID_malloc(sizeof(double)*n_1);
+      z_1_sort    =(double *)SID_malloc(sizeof(double)*n_1);
+      zone_1_sort =(int    *)SID_malloc(sizeof(int)   *n_1);
+      sort_cells_local(x_1,y_1,z_1,zone_1,n_1,x_min,inv_d_cell,n_cell,cell_start_1,x_1_sort,y_1_sort,z_1_sort,zone_1_sort);
+   }
+
+   // Allocate a set of histograms for each thread
+   int n_threads=1;
+#if USE_OPENMP
+   n_threads=omp_get_max_threads();
+#endif
+   int        n_stride  =2*n_1D+n_2D_total; // l1D, 1D and 2D bins ...
+   size_t     n_hist    =(size_t)n_stride*(size_t)(n_jack_total+1); // ... for each jack-knife region
+   long long *histograms=(long long *)SID_calloc(sizeof(long long)*n_hist*(size_t)n_threads);
+
+   // Count pairs.  The object loop runs over the first set in cell order so
+   //   that neighbouring iterations reuse the same cells of the second set.
+   double r_max_2D=cfunc->r_max_2D;
+#if USE_OPENMP
+   #pragma omp parallel num_threads(n_threads)
+#endif
+   {
+      int        i_thread=0;
+#if USE_OPENMP
+      i_thread=omp_get_thread_num();
+#endif
+      long long *hist_l1D=&(histograms[n_hist*(size_t)i_thread]);
+      long long *hist_1D =&(hist_l1D[n_1D]);
+      long long *hist_2D =&(hist_l1D[2*n_1D]);
+      double     r2_xy[CFUNC_PAIR_BLOCK];
+      double     dz2[CFUNC_PAIR_BLOCK];
+      int        flag_2D[CFUNC_PAIR_BLOCK];
+#if USE_OPENMP
+      #pragma omp for schedule(dynamic,64)
+#endif
+      for(size_t i_1=0;i_1<n_1;i_1++){
+         double x_i   =x_1_sort[i_1];
+         double y_i   =y_1_sort[i_1];
+         double z_i   =z_1_sort[i_1];
+         int    zone_i=zone_1_sort[i_1];
+         int    i_cell[3];
+         int    j_cell_lo[3];
+         int    j_cell_hi[3];
+         int    flag_skip=FALSE;
+         i_cell[0]=(int)floor((x_i-x_min[0])*inv_d_cell);
+         i_cell[1]=(int)floor((y_i-x_min[1])*inv_d_cell);
+         i_cell[2]=(int)floor((z_i-x_min[2])*inv_d_cell);
+         // Find the range of cells holding neighbours.  Objects of the second set
+         //   have (unclamped) cell indices in [0,n_cell] because n_cell is rounded down.
+         for(int i_dim_i=0;i_dim_i<3;i_dim_i++){
+            if(i_cell[i_dim_i]<-1 || i_cell[i_dim_i]>n_cell[i_dim_i]+1)
+               flag_skip=TRUE;
+            j_cell_lo[i_dim_i]=MIN(MAX(0,i_cell[i_dim_i]-1),n_cell[i_dim_i]-1);
+            j_cell_hi[i_dim_i]=MIN(i_cell[i_dim_i]+1,n_cell[i_dim_i]-1);
+            i_cell[i_dim_i]   =MAX(0,MIN(n_cell[i_dim_i]-1,i_cell[i_dim_i]));
+         }
+         if(flag_skip)
+            continue;
+         size_t i_cell_i=((size_t)i_cell[0]*(size_t)n_cell[1]+(size_t)i_cell[1])*(size_t)n_cell[2]+(size_t)i_cell[2];
+         for(int j_x=j_cell_lo[0];j_x<=j_cell_hi[0];j_x++){
+            for(int j_y=j_cell_lo[1];j_y<=j_cell_hi[1];j_y++){
+               for(int j_z=j_cell_lo[2];j_z<=j_cell_hi[2];j_z++){
+                  size_t j_cell=((size_t)j_x*(size_t)n_cell[1]+(size_t)j_y)*(size_t)n_cell[2]+(size_t)j_z;
+                  size_t j_lo  =cell_start_2[j_cell];
+                  size_t j_hi  =cell_start_2[j_cell+1];
+                  // When counting a set against itself, only count pairs with j>i
+                  if(flag_same_set){
+                     if(j_cell<i_cell_i)
+                        continue;
+                     else if(j_cell==i_cell_i)
+                        j_lo=i_1+1;
+                  }
+                  for(size_t j_block=j_lo;j_block<j_hi;j_block+=CFUNC_PAIR_BLOCK){
+                     int n_block=(int)MIN((size_t)CFUNC_PAIR_BLOCK,j_hi-j_block);
+                     int k_pair;
+                     // Compute squared separations ...
+                     for(k_pair=0;k_pair<n_block;k_pair++){
+                        double dx=x_i-x_2_sort[j_block+k_pair];
+                        double dy=y_i-y_2_sort[j_block+k_pair];
+                        double dz=z_i-z_2_sort[j_block+k_pair];
+                        r2_xy[k_pair]  =dx*dx+dy*dy;
+                        dz2[k_pair]    =dz*dz;
+                        flag_2D[k_pair]=(fabs(dx)<=r_max_2D && fabs(dy)<=r_max_2D);
+                     }
+                     // ... and bin them
+                     for(k_pair=0;k_pair<n_block;k_pair++){
+                        double r2    =r2_xy[k_pair]+dz2[k_pair];
+                        int    zone_j=zone_2_sort[j_block+k_pair];
+                        int    bin;
+                        if(r2<r2_max_1D){
+                           if((bin=find_cfunc_bin_local(&bins_1D,r2))>=0)
+                              add_pair_cells_local(hist_1D,n_stride,bin,zone_i,zone_j,n_jack_total,jack_mode);
+                           if((bin=find_cfunc_bin_local(&bins_l1D,r2))>=0)
+                              add_pair_cells_local(hist_l1D,n_stride,bin,zone_i,zone_j,n_jack_total,jack_mode);
+                        }
+                        if(flag_2D[k_pair]){
+                           int bin_x=find_cfunc_bin_local(&bins_2D,r2_xy[k_pair]);
+                           int bin_y=find_cfunc_bin_local(&bins_2D,dz2[k_pair]);
+                           if(bin_x>=0 && bin_y>=0)
+                              add_pair_cells_local(hist_2D,n_stride,bin_y*n_2D+bin_x,zone_i,zone_j,n_jack_total,jack_mode);
+                        }
+                     }
+                  }
+               }
+            }
+         }
+      }
+   }
+
+   // Set the arrays we are adding to
+   long long **array_l1D;
+   long long **array_1D;
+   long long **array_2D;
+   switch(flag_pair_type){
+      case CFUNC_ADD_PAIR_DD:
+         array_l1D=cfunc->DD_l1D;
+         array_1D =cfunc->DD_1D;
+         array_2D =cfunc->DD_2D;
+         break;
+      case CFUNC_ADD_PAIR_DR:
+         array_l1D=cfunc->DR_l1D;
+         array_1D =cfunc->DR_1D;
+         array_2D =cfunc->DR_2D;
+         break;
+      case CFUNC_ADD_PAIR_RR:
+         array_l1D=cfunc->RR_l1D;
+         array_1D =cfunc->RR_1D;
+         array_2D =cfunc->RR_2D;
+         break;
+      default:
+         SID_trap_error("Unsupported pair type specified.",ERROR_LOGIC);
+         break;
+   }
+
+   // Add the threads' histograms to them
+   for(int i_thread=0;i_thread<n_threads;i_thread++){
+      for(i_jack=0;i_jack<=n_jack_total;i_jack++){
+         long long *hist=&(histograms[n_hist*(size_t)i_thread+(size_t)i_jack*(size_t)n_stride]);
+         for(i_bin=0;i_bin<n_1D;i_bin++){
+            array_l1D[i_jack][i_bin]+=hist[i_bin];
+            array_1D[i_jack][i_bin] +=hist[n_1D+i_bin];
+         }
+         for(i_bin=0;i_bin<n_2D_total;i_bin++)
+            array_2D[i_jack][i_bin]+=hist[2*n_1D+i_bin];
+      }
+   }
+
+   // Clean-up
+   SID_free(SID_FARG histograms);
+   if(!flag_same_set){
+      SID_free(SID_FARG cell_start_1);
+      SID_free(SID_FARG x_1_sort);
+      SID_free(SID_FARG y_1_sort);
+      SID_free(SID_FARG z_1_sort);
+      SID_free(SID_FARG zone_1_sort);
+   }
+   SID_free(SID_FARG cell_start_2);
+   SID_free(SID_FARG x_2_sort);
+   SID_free(SID_FARG y_2_sort);
+   SID_free(SID_FARG z_2_sort);
+   SID_free(SID_FARG zone_2_sort);
+   free_cfunc_bins_local(&bins_1D);
+   free_cfunc_bins_local(&bins_l1D);
+   free_cfunc_bins_local(&bins_2D);
+}
+
 void calc_pairs_local(const char *species_name1,
                       const char *species_name2,
                       int         i_rank,
@@ -271,6 +670,20 @@ void calc_pairs_local(const char *species_name1,
         break;
    }
 
+   // Use sorted cell lists if asked to.  These don't need the PHK sort indices
+   //   because boundary objects are stored at the start of the local arrays.
+   if(cfunc->pair_engine==CFUNC_PAIRS_CELLS){
+      // Avoid double counting pairs between ranks
+      if(!flag_self_match || i_rank==0 || SID.My_rank<((SID.My_rank+i_rank)%SID.n_proc))
+         calc_pairs_cells_local(x_data1_local,y_data1_local,z_data1_local,zone_data1_local,n_data1_local,
+                                x_data2_rank, y_data2_rank, z_data2_rank, zone_data2_rank, n_data2_rank,
+                                flag_self_match && i_rank==0,
+                                flag_pair_type,
+                                cfunc);
+      SID_log("Done.",SID_LOG_CLOSE);
+      return;
+   }
+
    PHK_t  *PHK_volume=NULL;
    size_t *index_PHK_volume=NULL;
    int     n_PHK_volume;
@@ -453,6 +866,7 @@ void compute_cfunc(plist_info  *plist,
   int         n_PHK_volume;
 
   SID_log("Computing correlation function (%d 1D bins and %d 2D bins)...",SID_LOG_OPEN|SID_LOG_TIMER,cfunc->n_1D,cfunc->n_2D);
+  SID_push_memory_tag("cfunc");
 
   // Parse some stuff from the cfunc structure
   int          n_2D_total;
@@ -763,6 +1177,19 @@ void compute_cfunc(plist_info  *plist,
       SID_log("Done.",SID_LOG_CLOSE);
   } // i_rank
 
+  // Convert per-zone pair counts to jack-knife histograms
+  if(cfunc->flag_compute_RR){
+    finalize_jack_local(RR_l1D,n_1D,      cfunc);
+    finalize_jack_local(RR_1D, n_1D,      cfunc);
+    finalize_jack_local(RR_2D, n_2D_total,cfunc);
+  }
+  finalize_jack_local(DD_l1D,n_1D,      cfunc);
+  finalize_jack_local(DD_1D, n_1D,      cfunc);
+  finalize_jack_local(DD_2D, n_2D_total,cfunc);
+  finalize_jack_local(DR_l1D,n_1D,      cfunc);
+  finalize_jack_local(DR_1D, n_1D,      cfunc);
+  finalize_jack_local(DR_2D, n_2D_total,cfunc);
+
   if(SID.n_proc>1){
     SID_log("Combining results from separate ranks...",SID_LOG_OPEN);
     for(i_jack=0;i_jack<=n_jack_total;i_jack++){
@@ -925,6 +1352,7 @@ void compute_cfunc(plist_info  *plist,
   cfunc->flag_compute_RR=FALSE;  
 
   SID_set_verbosity(SID_SET_VERBOSITY_DEFAULT);
+  SID_pop_memory_tag();
   SID_log("Done.",SID_LOG_CLOSE);
 }
 
@@ -1,9 +1,325 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
 #include <gbpLib.h>
 #include <gbpCosmo.h>
 #include <gbpSPH.h>
 #include <gbpClustering.h>
+#if USE_OPENMP
+#include <omp.h>
+#endif
+
+// Average a transformed field with the transform of the same particles
+//   assigned to a grid shifted by half a cell.  The shifted transform is
+//   multiplied by exp(i k.dR/2) to align it with the first, which cancels
+//   the aliased power of all images k+2k_N*n with n_x+n_y+n_z odd.
+void interlace_FFT_local(field_info *FFT,field_info *FFT_interlace);
+void interlace_FFT_local(field_info *FFT,field_info *FFT_interlace){
+  int    i_i[3];
+  int    j_i[3];
+  int    i_d;
+  double k_i[3];
+  for(i_i[0]=FFT->i_k_start_local[0],j_i[0]=0;i_i[0]<=FFT->i_k_stop_local[0];i_i[0]++,j_i[0]++){
+    for(i_i[1]=FFT->i_k_start_local[1],j_i[1]=0;i_i[1]<=FFT->i_k_stop_local[1];i_i[1]++,j_i[1]++){
+      for(i_i[2]=FFT->i_k_start_local[2],j_i[2]=0;i_i[2]<=FFT->i_k_stop_local[2];i_i[2]++,j_i[2]++){
+        size_t index=index_FFT_k(FFT,j_i);
+        double phase;
+        k_field_FFT(FFT,i_i,k_i);
+        for(i_d=0,phase=0.;i_d<3;i_d++)
+          phase+=0.5*k_i[i_d]*FFT->dR[i_d];
+        double re_shift=(double)FFT_interlace->cfield_local[index].re;
+        double im_shift=(double)FFT_interlace->cfield_local[index].im;
+        FFT->cfield_local[index].re=0.5*((double)FFT->cfield_local[index].re+re_shift*cos(phase)-im_shift*sin(phase));
+        FFT->cfield_local[index].im=0.5*((double)FFT->cfield_local[index].im+re_shift*sin(phase)+im_shift*cos(phase));
+      }
+    }
+  }
+}
+
+// Per-axis factors of the shot noise (in units of 1/N) of an interlaced
+//   mode with k.dR=x along that axis.  Only images with n_x+n_y+n_z even
+//   survive interlacing, so the shot noise is half the sum of the
+//   products over the axes of the 1D alias sums taken over all images
+//   (C_all) and with alternating signs (C_alt).  The Daubechies kernels
+//   are treated as in the non-interlaced case.
+void shot_noise_interlaced_factors_local(double x,int distribution_scheme,double *C_all,double *C_alt);
+void shot_noise_interlaced_factors_local(double x,int distribution_scheme,double *C_all,double *C_alt){
+  double s=sin(0.5*x);
+  double c=cos(0.5*x);
+  switch(distribution_scheme){
+  case MAP2GRID_DIST_CIC:
+    (*C_all)=1.-2.*s*s/3.;
+    (*C_alt)=c*(5.+c*c)/6.;
+    break;
+  case MAP2GRID_DIST_TSC:
+    (*C_all)=1.-s*s+2.*s*s*s*s/15.;
+    (*C_alt)=c*(61.+58.*c*c+c*c*c*c)/120.;
+    break;
+  case MAP2GRID_DIST_NGP:
+    (*C_all)=1.;
+    (*C_alt)=c;
+    break;
+  case MAP2GRID_DIST_DWT12:
+  case MAP2GRID_DIST_DWT20:
+  default:
+    (*C_all)=1.;
+    (*C_alt)=1.;
+  }
+}
+
+// Sums accumulated by bin_pspec_local()
+typedef struct pspec_bins_local_info pspec_bins_local_info;
+struct pspec_bins_local_info{
+  double *k_1D;
+  double *P_k_1D;
+  double *P_k_l2_1D;
+  double *P_k_l4_1D;
+  double *shot_noise_1D;
+  int    *n_modes_1D;
+  double *k_2D;
+  double *P_k_2D;
+  double *shot_noise_2D;
+  int    *n_modes_2D;
+};
+
+void init_pspec_bins_local(pspec_bins_local_info *bins,int n_k_1D,int n_k_2D);
+void init_pspec_bins_local(pspec_bins_local_info *bins,int n_k_1D,int n_k_2D){
+  bins->k_1D         =(double *)SID_calloc(sizeof(double)*n_k_1D);
+  bins->P_k_1D       =(double *)SID_calloc(sizeof(double)*n_k_1D);
+  bins->P_k_l2_1D    =(double *)SID_calloc(sizeof(double)*n_k_1D);
+  bins->P_k_l4_1D    =(double *)SID_calloc(sizeof(double)*n_k_1D);
+  bins->shot_noise_1D=(double *)SID_calloc(sizeof(double)*n_k_1D);
+  bins->n_modes_1D   =(int    *)SID_calloc(sizeof(int)*n_k_1D);
+  bins->k_2D         =(double *)SID_calloc(sizeof(double)*n_k_2D*n_k_2D);
+  bins->P_k_2D       =(double *)SID_calloc(sizeof(double)*n_k_2D*n_k_2D);
+  bins->shot_noise_2D=(double *)SID_calloc(sizeof(double)*n_k_2D*n_k_2D);
+  bins->n_modes_2D   =(int    *)SID_calloc(sizeof(int)*n_k_2D*n_k_2D);
+}
+
+void free_pspec_bins_local(pspec_bins_local_info *bins);
+void free_pspec_bins_local(pspec_bins_local_info *bins){
+  SID_free(SID_FARG bins->k_1D);
+  SID_free(SID_FARG bins->P_k_1D);
+  SID_free(SID_FARG bins->P_k_l2_1D);
+  SID_free(SID_FARG bins->P_k_l4_1D);
+  SID_free(SID_FARG bins->shot_noise_1D);
+  SID_free(SID_FARG bins->n_modes_1D);
+  SID_free(SID_FARG bins->k_2D);
+  SID_free(SID_FARG bins->P_k_2D);
+  SID_free(SID_FARG bins->shot_noise_2D);
+  SID_free(SID_FARG bins->n_modes_2D);
+}
+
+// Bin the power of the local modes in a single sweep of the transformed
+//   field: shells of |k| (with the quadrupole and hexadecapole moments
+//   if pspec->flag_multipoles is set) and bins of (k_perp,|k_par|) with
+//   axis i_los as the line of sight.  The field is swept row-by-row in
+//   memory order.  The k components (and interlaced shot noise factors)
+//   of each axis are tabulated once, and the bins of a row are found in
+//   one pass before its power is accumulated in a second.  Threads
+//   accumulate separately and are summed at the end.
+void bin_pspec_local(field_info *FFT,pspec_info *pspec,int i_los,pspec_bins_local_info *bins);
+void bin_pspec_local(field_info *FFT,pspec_info *pspec,int i_los,pspec_bins_local_info *bins){
+  int     n_k_1D         =pspec->n_k_1D;
+  int     n_k_2D         =pspec->n_k_2D;
+  double  k_min_1D       =pspec->k_min_1D;
+  double  k_min_2D       =pspec->k_min_2D;
+  double  dk_1D          =(pspec->k_max_1D-k_min_1D)/(double)(n_k_1D);
+  double  dk_2D          =(pspec->k_max_2D-k_min_2D)/(double)(n_k_2D);
+  int     flag_interlace =pspec->flag_interlace;
+  int     flag_multipoles=pspec->flag_multipoles;
+  double *k_axis[3];
+  double *C_all_axis[3];
+  double *C_alt_axis[3];
+  int     i_d;
+  int     j_d;
+
+  // Rows run along the last axis; the first two axes are transposed in k-space for MPI
+#if USE_MPI
+  int     i_a0=1;
+  int     i_a1=0;
+#else
+  int     i_a0=0;
+  int     i_a1=1;
+#endif
+  int     n_a1  =FFT->n_k_local[i_a1];
+  int     n_row =FFT->n_k_local[2];
+  size_t  n_rows=(size_t)FFT->n_k_local[i_a0]*(size_t)n_a1;
+
+  // Tabulate each axis
+  for(i_d=0;i_d<3;i_d++){
+    k_axis[i_d]    =(double *)SID_malloc(sizeof(double)*MAX(1,FFT->n_k_local[i_d]));
+    C_all_axis[i_d]=(double *)SID_malloc(sizeof(double)*MAX(1,FFT->n_k_local[i_d]));
+    C_alt_axis[i_d]=(double *)SID_malloc(sizeof(double)*MAX(1,FFT->n_k_local[i_d]));
+    for(j_d=0;j_d<FFT->n_k_local[i_d];j_d++){
+      k_axis[i_d][j_d]=FFT->k_field[i_d][FFT->i_k_start_local[i_d]+j_d];
+      shot_noise_interlaced_factors_local(k_axis[i_d][j_d]*FFT->dR[i_d],
+                                          pspec->mass_assignment_scheme,
+                                          &(C_all_axis[i_d][j_d]),
+                                          &(C_alt_axis[i_d][j_d]));
+    }
+  }
+
+  // Each thread accumulates into its own bins (the first uses the caller's)
+  int n_threads=1;
+#if USE_OPENMP
+  n_threads=omp_get_max_threads();
+#endif
+  int                    i_thread;
+  pspec_bins_local_info *bins_thread=(pspec_bins_local_info *)SID_malloc(sizeof(pspec_bins_local_info)*n_threads);
+  bins_thread[0]=(*bins);
+  for(i_thread=1;i_thread<n_threads;i_thread++)
+    init_pspec_bins_local(&(bins_thread[i_thread]),n_k_1D,n_k_2D);
+
+  // Each thread also needs scratch space for a row.  It is allocated
+  //   here, since SID_malloc() is not thread safe.
+  size_t  n_row_alloc      =(size_t)MAX(1,n_row);
+  double *k_mag_row_thread =(double *)SID_malloc(sizeof(double)*n_row_alloc*n_threads);
+  double *mu2_row_thread   =(double *)SID_malloc(sizeof(double)*n_row_alloc*n_threads);
+  int    *bin_1D_row_thread=(int    *)SID_malloc(sizeof(int)   *n_row_alloc*n_threads);
+  int    *bin_2D_row_thread=(int    *)SID_malloc(sizeof(int)   *n_row_alloc*n_threads);
+
+#if USE_OPENMP
+  #pragma omp parallel num_threads(n_threads)
+#endif
+  {
+    int i_thread_local=0;
+#if USE_OPENMP
+    i_thread_local=omp_get_thread_num();
+#endif
+    pspec_bins_local_info *bins_i    =&(bins_thread[i_thread_local]);
+    double                *k_mag_row =&(k_mag_row_thread [n_row_alloc*i_thread_local]);
+    double                *mu2_row   =&(mu2_row_thread   [n_row_alloc*i_thread_local]);
+    int                   *bin_1D_row=&(bin_1D_row_thread[n_row_alloc*i_thread_local]);
+    int                   *bin_2D_row=&(bin_2D_row_thread[n_row_alloc*i_thread_local]);
+    size_t                 i_row;
+#if USE_OPENMP
+    #pragma omp for schedule(static)
+#endif
+    for(i_row=0;i_row<n_rows;i_row++){
+      int    j_i[3];
+      int    i_z;
+      j_i[i_a0]=(int)(i_row/(size_t)n_a1);
+      j_i[i_a1]=(int)(i_row%(size_t)n_a1);
+      j_i[2]   =0;
+      size_t index_row    =index_FFT_k(FFT,j_i);
+      double k_x          =k_axis[0][j_i[0]];
+      double k_y          =k_axis[1][j_i[1]];
+      double k2_row       =k_x*k_x+k_y*k_y;
+      double k_par_row    =0.;
+      double k2_perp_row  =k2_row;
+      if(i_los==0){
+        k_par_row  =k_x;
+        k2_perp_row=k_y*k_y;
+      }
+      else if(i_los==1){
+        k_par_row  =k_y;
+        k2_perp_row=k_x*k_x;
+      }
+      double C_all_row=C_all_axis[0][j_i[0]]*C_all_axis[1][j_i[1]];
+      double C_alt_row=C_alt_axis[0][j_i[0]]*C_alt_axis[1][j_i[1]];
+
+      // Find the bins of the row
+      for(i_z=0;i_z<n_row;i_z++){
+        double k_z    =k_axis[2][i_z];
+        double k2     =k2_row+k_z*k_z;
+        double k_par  =k_par_row;
+        double k2_perp=k2_perp_row+k_z*k_z;
+        if(i_los==2){
+          k_par  =k_z;
+          k2_perp=k2_row;
+        }
+        k_mag_row[i_z]=sqrt(k2);
+        mu2_row[i_z]  =(k2>0.?k_par*k_par/k2:0.);
+        int mode_1D=(int)((k_mag_row[i_z]-k_min_1D)/dk_1D);
+        int mode_x =(int)((sqrt(k2_perp)-k_min_2D)/dk_2D);
+        int mode_y =(int)((fabs(k_par)  -k_min_2D)/dk_2D);
+        bin_1D_row[i_z]=(mode_1D>=0 && mode_1D<n_k_1D)?mode_1D:-1;
+        bin_2D_row[i_z]=(mode_x>=0 && mode_x<n_k_2D && mode_y>=0 && mode_y<n_k_2D)?mode_y*n_k_2D+mode_x:-1;
+      }
+
+      // Accumulate the row's power
+      for(i_z=0;i_z<n_row;i_z++){
+        double re         =(double)FFT->cfield_local[index_row+i_z].re;
+        double im         =(double)FFT->cfield_local[index_row+i_z].im;
+        double P          =re*re+im*im;
+        double shot_noise =0.;
+        int    mode_1D    =bin_1D_row[i_z];
+        int    mode_2D    =bin_2D_row[i_z];
+        if(flag_interlace)
+          shot_noise=0.5*(C_all_row*C_all_axis[2][i_z]+C_alt_row*C_alt_axis[2][i_z]);
+        if(mode_1D>=0){
+          bins_i->k_1D[mode_1D]         +=k_mag_row[i_z];
+          bins_i->P_k_1D[mode_1D]       +=P;
+          bins_i->shot_noise_1D[mode_1D]+=shot_noise;
+          bins_i->n_modes_1D[mode_1D]++;
+          if(flag_multipoles){
+            double mu2=mu2_row[i_z];
+            bins_i->P_k_l2_1D[mode_1D]+=P*0.5*(3.*mu2-1.);
+            bins_i->P_k_l4_1D[mode_1D]+=P*0.125*((35.*mu2-30.)*mu2+3.);
+          }
+        }
+        if(mode_2D>=0){
+          bins_i->k_2D[mode_2D]         +=k_mag_row[i_z];
+          bins_i->P_k_2D[mode_2D]       +=P;
+          bins_i->shot_noise_2D[mode_2D]+=shot_noise;
+          bins_i->n_modes_2D[mode_2D]++;
+        }
+      }
+    }
+  }
+
+  // Sum the threads' bins
+  int i_k;
+  for(i_thread=1;i_thread<n_threads;i_thread++){
+    pspec_bins_local_info *bins_i=&(bins_thread[i_thread]);
+    for(i_k=0;i_k<n_k_1D;i_k++){
+      bins->k_1D[i_k]         +=bins_i->k_1D[i_k];
+      bins->P_k_1D[i_k]       +=bins_i->P_k_1D[i_k];
+      bins->P_k_l2_1D[i_k]    +=bins_i->P_k_l2_1D[i_k];
+      bins->P_k_l4_1D[i_k]    +=bins_i->P_k_l4_1D[i_k];
+      bins->shot_noise_1D[i_k]+=bins_i->shot_noise_1D[i_k];
+      bins->n_modes_1D[i_k]   +=bins_i->n_modes_1D[i_k];
+    }
+    for(i_k=0;i_k<n_k_2D*n_k_2D;i_k++){
+      bins->k_2D[i_k]         +=bins_i->k_2D[i_k];
+      bins->P_k_2D[i_k]       +=bins_i->P_k_2D[i_k];
+      bins->shot_noise_2D[i_k]+=bins_i->shot_noise_2D[i_k];
+      bins->n_modes_2D[i_k]   +=bins_i->n_modes_2D[i_k];
+    }
+    free_pspec_bins_local(bins_i);
+  }
+  SID_free(SID_FARG bins_thread);
+  SID_free(SID_FARG k_mag_row_thread);
+  SID_free(SID_FARG mu2_row_thread);
+  SID_free(SID_FARG bin_1D_row_thread);
+  SID_free(SID_FARG bin_2D_row_thread);
+  for(i_d=0;i_d<3;i_d++){
+    SID_free(SID_FARG k_axis[i_d]);
+    SID_free(SID_FARG C_all_axis[i_d]);
+    SID_free(SID_FARG C_alt_axis[i_d]);
+  }
+}
+
+// Shot noise (in units of 1/N) of a bin with mean |k|=k_mag for
+//   the isotropic (non-interlaced) case (see Cui et al 2008)
+double shot_noise_isotropic_local(double k_mag,double k_Nyquist,int distribution_scheme);
+double shot_noise_isotropic_local(double k_mag,double k_Nyquist,int distribution_scheme){
+  double shot_noise_arg;
+  switch(distribution_scheme){
+  case MAP2GRID_DIST_CIC:
+    shot_noise_arg=sin(M_PI*k_mag/(2.*k_Nyquist));
+    return(1.-2.*shot_noise_arg*shot_noise_arg/3.);
+  case MAP2GRID_DIST_TSC:
+    shot_noise_arg=sin(M_PI*k_mag/(2.*k_Nyquist));
+    return(1.-shot_noise_arg*shot_noise_arg+2.*pow(shot_noise_arg,4.)/15.);
+  case MAP2GRID_DIST_DWT12:
+  case MAP2GRID_DIST_DWT20:
+  case MAP2GRID_DIST_NGP:
+  default:
+    return(1.);
+  }
+}
 
 void compute_pspec(plist_info  *plist,
                    const char  *species_name,
@@ -39,21 +355,10 @@ void compute_pspec(plist_info  *plist,
   GBPREAL       *vz_particles_local;
   GBPREAL       *m_particles_local;
   double      m_p;
-  double     *k_2D;
-  double     *k_2D_local;
   int         flag_multimass;
   int         flag_active;
-  double      k_mag;
   double      dk;
-  double      k_mag_x,k_mag_y;
   int         n_k;
-  int         mode_powspec;
-  int         mode_x,mode_y;
-  int        *n_modes_1D_local;
-  int        *n_modes_2D_local;
-  double     *k_1D_local;
-  double     *P_k_1D_local;
-  double     *P_k_2D_local;
   double     *sigma_P_powspec;
   double     *sigma_P_powspec_local;
   double     *dP_powspec;
@@ -79,7 +384,6 @@ void compute_pspec(plist_info  *plist,
   interp_info *P_k_interp;
   double      *r_Daub;
   double      *W_Daub;
-  double       shot_noise_arg;
   int          n_Daub;
   interp_info *W_r_Daub_interp;
   FILE        *fp_test;
@@ -174,149 +478,88 @@ void compute_pspec(plist_info  *plist,
   compute_FFT(FFT);
   SID_log("Done.",SID_LOG_CLOSE);
 
-  // Allocate local arrays; Initialize them and global arrays where results are stores
-  k_1D_local      =(double *)SID_calloc(sizeof(double)*(n_k_1D)); 
-  P_k_1D_local    =(double *)SID_calloc(sizeof(double)*(n_k_1D)); 
-  n_modes_1D_local=(int    *)SID_calloc(sizeof(int)*(n_k_1D)); 
-  for(i_k=0;i_k<n_k_1D;i_k++){
-    P_k_1D[i_k]    =0.;
-    dP_k_1D[i_k]   =0.;
-    n_modes_1D[i_k]=0;
-  }
-
-  P_k_2D_local    =(double *)SID_calloc(sizeof(double)*(n_k_2D)*(n_k_2D));
-  n_modes_2D_local=(int    *)SID_calloc(sizeof(int)*(n_k_2D)*(n_k_2D));
-  for(i_k=0;i_k<n_k_2D*n_k_2D;i_k++){
-    P_k_2D[i_k]    =0.;
-    dP_k_2D[i_k]   =0.;
-    n_modes_2D[i_k]=0;
-  }
-
-  // Perform binning for 1D power spectrum
-  SID_log("Performing 1-d bining of power spectrum...",SID_LOG_OPEN|SID_LOG_TIMER);
-  for(i_i[0]=FFT->i_k_start_local[0],j_i[0]=0;i_i[0]<=FFT->i_k_stop_local[0];i_i[0]++,j_i[0]++){
-    for(i_i[1]=FFT->i_k_start_local[1],j_i[1]=0;i_i[1]<=FFT->i_k_stop_local[1];i_i[1]++,j_i[1]++){
-      for(i_i[2]=FFT->i_k_start_local[2],j_i[2]=0;i_i[2]<=FFT->i_k_stop_local[2];i_i[2]++,j_i[2]++){
-        k_mag       =k_mag_field_FFT(FFT,i_i);
-        mode_powspec=(int)((k_mag-k_min_1D)/dk_1D);
-        if(mode_powspec<(n_k_1D) && mode_powspec>=0){
-          k_1D_local[mode_powspec]  +=k_mag;
-          P_k_1D_local[mode_powspec]+=(pow((double)FFT->cfield_local[index_FFT_k(FFT,j_i)].re,2.)+
-                                       pow((double)FFT->cfield_local[index_FFT_k(FFT,j_i)].im,2.));
-          n_modes_1D_local[mode_powspec]++;
-        }
-      }
+  // If interlacing, assign the particles again to a grid shifted by half
+  //   a cell and combine the two transforms
+  if(pspec->flag_interlace){
+    if(pspec->FFT_interlace==NULL){
+      pspec->FFT_interlace=(field_info *)SID_malloc(sizeof(field_info));
+      init_field(3,FFT->n,FFT->L,pspec->FFT_interlace,(FFT->flag_pencil?FIELD_MODE_PENCIL:FIELD_MODE_DEFAULT));
     }
+    map_to_grid(n_particles_local, 
+                x_particles_local,
+                y_particles_local,
+                z_particles_local,
+                NULL,
+                m_particles_local,
+                cosmo,
+                redshift,
+                distribution_scheme,
+                (double)n_particles,
+                pspec->FFT_interlace,NULL,
+                MAP2GRID_MODE_DEFAULT|MAP2GRID_MODE_INTERLACE);
+    SID_log("Computing interlaced FFT...",SID_LOG_OPEN|SID_LOG_TIMER);
+    compute_FFT(pspec->FFT_interlace);
+    interlace_FFT_local(FFT,pspec->FFT_interlace);
+    SID_log("Done.",SID_LOG_CLOSE);
   }
 
-  // Normalize the quantities we are averaging
-  for(i_k=0;i_k<n_k_1D;i_k++){
-    calc_sum_global(&(n_modes_1D_local[i_k]),&(n_modes_1D[i_k]),1,SID_INT,   CALC_MODE_DEFAULT,SID.COMM_WORLD);
-    calc_sum_global(&(k_1D_local[i_k]),      &(k_1D[i_k]),      1,SID_DOUBLE,CALC_MODE_DEFAULT,SID.COMM_WORLD);
-    calc_sum_global(&(P_k_1D_local[i_k]),    &(P_k_1D[i_k]),    1,SID_DOUBLE,CALC_MODE_DEFAULT,SID.COMM_WORLD);
-    k_1D[i_k]  /=(double)((n_modes_1D)[i_k]);
-    P_k_1D[i_k]/=(double)((n_modes_1D)[i_k]);
-  }
-
-  // Deal with shot noise.  This differs, depending on the
-  //   mass-assignment scheme we used (see Cui et al 2008).
-  for(i_k=0;i_k<(n_k_1D);i_k++){
-    P_k_1D[i_k] *=FFT->L[0]*FFT->L[1]*FFT->L[2]/pow((double)n_particles,2.);
-    dP_k_1D[i_k] =(P_k_1D)[i_k]/sqrt(n_modes_1D[i_k]);
-    switch(distribution_scheme){
-    case MAP2GRID_DIST_CIC:
-      shot_noise_arg=sin(M_PI*(k_1D)[i_k]/(2.*FFT->k_Nyquist[0]));
-      shot_noise    =(1.-2.*pow(shot_noise_arg,2.)/3.)/(double)n_particles;
-      break;
-    case MAP2GRID_DIST_TSC:
-      shot_noise_arg=sin(M_PI*(k_1D)[i_k]/(2.*FFT->k_Nyquist[0]));
-      shot_noise    =(1.-pow(shot_noise_arg,2.)+2.*pow(shot_noise_arg,4.)/15.)/(double)n_particles;
-      break;
-    case MAP2GRID_DIST_DWT12:
-    case MAP2GRID_DIST_DWT20:
-    case MAP2GRID_DIST_NGP:
-    default:
-      shot_noise=1./(double)n_particles;
-    }
-    shot_noise  *=FFT->L[0]*FFT->L[1]*FFT->L[2];
-    P_k_1D[i_k] -=shot_noise;
-  }
+  // Bin the modes.  The line of sight of the 2D spectra and the
+  //   multipoles is the redshift-space axis (z for real space).
+  int                   i_los=(i_run>0?i_run-1:2);
+  pspec_bins_local_info bins_local;
+  pspec_bins_local_info bins;
+  SID_log("Binning power spectrum...",SID_LOG_OPEN|SID_LOG_TIMER);
+  init_pspec_bins_local(&bins_local,n_k_1D,n_k_2D);
+  init_pspec_bins_local(&bins,      n_k_1D,n_k_2D);
+  bin_pspec_local(FFT,pspec,i_los,&bins_local);
+  SID_Allreduce(bins_local.k_1D,         bins.k_1D,         n_k_1D,       SID_DOUBLE,SID_SUM,SID.COMM_WORLD);
+  SID_Allreduce(bins_local.P_k_1D,       bins.P_k_1D,       n_k_1D,       SID_DOUBLE,SID_SUM,SID.COMM_WORLD);
+  SID_Allreduce(bins_local.P_k_l2_1D,    bins.P_k_l2_1D,    n_k_1D,       SID_DOUBLE,SID_SUM,SID.COMM_WORLD);
+  SID_Allreduce(bins_local.P_k_l4_1D,    bins.P_k_l4_1D,    n_k_1D,       SID_DOUBLE,SID_SUM,SID.COMM_WORLD);
+  SID_Allreduce(bins_local.shot_noise_1D,bins.shot_noise_1D,n_k_1D,       SID_DOUBLE,SID_SUM,SID.COMM_WORLD);
+  SID_Allreduce(bins_local.n_modes_1D,   bins.n_modes_1D,   n_k_1D,       SID_INT,   SID_SUM,SID.COMM_WORLD);
+  SID_Allreduce(bins_local.k_2D,         bins.k_2D,         n_k_2D*n_k_2D,SID_DOUBLE,SID_SUM,SID.COMM_WORLD);
+  SID_Allreduce(bins_local.P_k_2D,       bins.P_k_2D,       n_k_2D*n_k_2D,SID_DOUBLE,SID_SUM,SID.COMM_WORLD);
+  SID_Allreduce(bins_local.shot_noise_2D,bins.shot_noise_2D,n_k_2D*n_k_2D,SID_DOUBLE,SID_SUM,SID.COMM_WORLD);
+  SID_Allreduce(bins_local.n_modes_2D,   bins.n_modes_2D,   n_k_2D*n_k_2D,SID_INT,   SID_SUM,SID.COMM_WORLD);
+  free_pspec_bins_local(&bins_local);
   SID_log("Done.",SID_LOG_CLOSE);
 
-  // Perform binning for 2D power spectrum
-//  SID_log("Performing 2-d bining of power spectrum...",SID_LOG_OPEN|SID_LOG_TIMER);
-  k_2D_local=(double *)SID_malloc(sizeof(double)*((n_k_2D)*(n_k_2D)));
-  k_2D      =(double *)SID_malloc(sizeof(double)*((n_k_2D)*(n_k_2D)));
-/*
-  for(i_k=0;i_k<(n_k_2D)*(n_k_2D);i_k++){
-    k_2D_local[i_k]=0.;
-    k_2D[i_k]      =0.;
-  }
-  for(i_i[0]=FFT->i_k_start_local[0],j_i[0]=0;i_i[0]<=FFT->i_k_stop_local[0];i_i[0]++,j_i[0]++){
-    for(i_i[1]=FFT->i_k_start_local[1],j_i[1]=0;i_i[1]<=FFT->i_k_stop_local[1];i_i[1]++,j_i[1]++){
-      for(i_i[2]=FFT->i_k_start_local[2],j_i[2]=0;i_i[2]<=FFT->i_k_stop_local[2];i_i[2]++,j_i[2]++){
-        if(check_mode_for_flag(mode,PSPEC_ADD_VX)){
-          k_mag_x=sqrt(FFT->k_field[1][i_i[1]]*FFT->k_field[1][i_i[1]]+FFT->k_field[2][i_i[2]]*FFT->k_field[2][i_i[2]]);
-          k_mag_y=FFT->k_field[0][i_i[0]];
-        }
-        else if(check_mode_for_flag(mode,PSPEC_ADD_VY)){
-          k_mag_x=sqrt(FFT->k_field[0][i_i[0]]*FFT->k_field[0][i_i[0]]+FFT->k_field[2][i_i[2]]*FFT->k_field[2][i_i[2]]);
-          k_mag_y=FFT->k_field[1][i_i[1]];
-        }
-        else{
-          k_mag_x=sqrt(FFT->k_field[0][i_i[0]]*FFT->k_field[0][i_i[0]]+FFT->k_field[1][i_i[1]]*FFT->k_field[1][i_i[1]]);
-          k_mag_y=FFT->k_field[2][i_i[2]];
-        }
-        mode_x =(int)((k_mag_x-k_min_2D)/dk_2D);
-        mode_y =(int)((k_mag_y-k_min_2D)/dk_2D);
-        if(mode_x<(n_k_2D) && mode_x>=0 && mode_y<(n_k_2D) && mode_y>=0){
-          mode_powspec=mode_y*(n_k_2D)+mode_x;
-          k_2D_local[mode_powspec]  +=k_mag_field_FFT(FFT,i_i);
-          P_k_2D_local[mode_powspec]+=(pow((double)FFT->cfield_local[index_FFT_k(FFT,j_i)].re,2.)+
-                                       pow((double)FFT->cfield_local[index_FFT_k(FFT,j_i)].im,2.));
-          n_modes_2D_local[mode_powspec]++;
-        }
-      }
+  // Normalize the 1D results and deal with shot noise.  This
+  //   differs, depending on the mass-assignment scheme we used.
+  //   Shot noise only affects the monopole.
+  double volume=FFT->L[0]*FFT->L[1]*FFT->L[2];
+  double P_norm=volume/((double)n_particles*(double)n_particles);
+  for(i_k=0;i_k<n_k_1D;i_k++){
+    n_modes_1D[i_k]=bins.n_modes_1D[i_k];
+    k_1D[i_k]      =bins.k_1D[i_k]  /(double)(n_modes_1D[i_k]);
+    P_k_1D[i_k]    =bins.P_k_1D[i_k]/(double)(n_modes_1D[i_k])*P_norm;
+    dP_k_1D[i_k]   =P_k_1D[i_k]/sqrt(n_modes_1D[i_k]);
+    if(pspec->flag_interlace)
+      shot_noise=bins.shot_noise_1D[i_k]/(double)(n_modes_1D[i_k]);
+    else
+      shot_noise=shot_noise_isotropic_local(k_1D[i_k],FFT->k_Nyquist[0],distribution_scheme);
+    P_k_1D[i_k]-=shot_noise*volume/(double)n_particles;
+    if(pspec->flag_multipoles){
+      pspec->P_k_l2_1D[i_run][i_k]=5.*bins.P_k_l2_1D[i_k]/(double)(n_modes_1D[i_k])*P_norm;
+      pspec->P_k_l4_1D[i_run][i_k]=9.*bins.P_k_l4_1D[i_k]/(double)(n_modes_1D[i_k])*P_norm;
     }
   }
-  for(i_k=0;i_k<(n_k_2D)*(n_k_2D);i_k++){
-    calc_sum_global(&(n_modes_2D_local[i_k]),&(n_modes_2D[i_k]),1,SID_INT,   CALC_MODE_DEFAULT,SID.COMM_WORLD);
-    calc_sum_global(&(k_2D_local[i_k]),      &(k_2D[i_k]),      1,SID_DOUBLE,CALC_MODE_DEFAULT,SID.COMM_WORLD);
-    calc_sum_global(&(P_k_2D_local[i_k]),    &(P_k_2D[i_k]),    1,SID_DOUBLE,CALC_MODE_DEFAULT,SID.COMM_WORLD);
-    k_2D[i_k]  /=(double)((n_modes_2D)[i_k]);
-    P_k_2D[i_k]/=(double)((n_modes_2D)[i_k]);
-  }
-  for(i_k=0;i_k<(n_k_2D)*(n_k_2D);i_k++){
-    P_k_2D[i_k] *=FFT->L[0]*FFT->L[1]*FFT->L[2]/pow(n_particles,2.);
-    dP_k_2D[i_k] =(P_k_2D)[i_k]/sqrt(n_modes_2D[i_k]);
-    switch(distribution_scheme){
-    case MAP2GRID_DIST_CIC:
-      shot_noise_arg=sin(M_PI*k_2D[i_k]/(2.*FFT->k_Nyquist[0]));
-      shot_noise    =(1.-2.*pow(shot_noise_arg,2.)/3.)/(double)n_particles;
-      break;
-    case MAP2GRID_DIST_TSC:
-      shot_noise_arg=sin(M_PI*k_2D[i_k]/(2.*FFT->k_Nyquist[0]));
-      shot_noise    =(1.-pow(shot_noise_arg,2.)+2.*pow(shot_noise_arg,4.)/15.)/(double)n_particles;
-      break;
-    case MAP2GRID_DIST_DWT12:
-    case MAP2GRID_DIST_DWT20:
-    case MAP2GRID_DIST_NGP:
-    default:
-      shot_noise=1./(double)n_particles;
-    }
-    shot_noise *=FFT->L[0]*FFT->L[1]*FFT->L[2];
-    P_k_2D[i_k] -=shot_noise;
+
+  // Normalize the 2D results
+  for(i_k=0;i_k<n_k_2D*n_k_2D;i_k++){
+    double k_2D_i;
+    n_modes_2D[i_k]=bins.n_modes_2D[i_k];
+    k_2D_i         =bins.k_2D[i_k]  /(double)(n_modes_2D[i_k]);
+    P_k_2D[i_k]    =bins.P_k_2D[i_k]/(double)(n_modes_2D[i_k])*P_norm;
+    dP_k_2D[i_k]   =P_k_2D[i_k]/sqrt(n_modes_2D[i_k]);
+    if(pspec->flag_interlace)
+      shot_noise=bins.shot_noise_2D[i_k]/(double)(n_modes_2D[i_k]);
+    else
+      shot_noise=shot_noise_isotropic_local(k_2D_i,FFT->k_Nyquist[0],distribution_scheme);
+    P_k_2D[i_k]-=shot_noise*volume/(double)n_particles;
   }
-  SID_log("Done.",SID_LOG_CLOSE);
-*/
-  
-  SID_free(SID_FARG k_1D_local);
-  SID_free(SID_FARG k_2D);
-  SID_free(SID_FARG k_2D_local);
-  SID_free(SID_FARG P_k_1D_local);
-  SID_free(SID_FARG n_modes_1D_local);
-  SID_free(SID_FARG P_k_2D_local);
-  SID_free(SID_FARG n_modes_2D_local);
+  free_pspec_bins_local(&bins);
 
   // Tell the datastructure that the calculation is done
   pspec->flag_processed[i_run]=TRUE;
@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <gbpLib.h>
+#include <gbpMath.h>
+#include <gbpCosmo.h>
+#include <gbpSPH.h>
+#include <gbpClustering.h>
+
+// Move a species' particles to the ranks whose slabs (or pencils) now
+//   hold them.  Every GBPREAL per-particle array stored for the species
+//   (including any real-space coordinates saved by apply_zspace_plist())
+//   is moved with them.
+void exchange_slab_plist(plist_info *plist,const char *species_name,slab_info *slab){
+  const char *array_names[]={"x_%s","y_%s","z_%s","vx_%s","vy_%s","vz_%s","M_%s","zspace_real_%s"};
+  int         n_array_names=8;
+  int         i_array;
+  int         i_rank;
+  int         rank_to;
+  int         rank_from;
+  size_t      i_particle;
+
+  // Fetch the extent of every rank's slab
+  double *x_min_rank=(double *)SID_malloc(sizeof(double)*SID.n_proc);
+  double *x_max_rank=(double *)SID_malloc(sizeof(double)*SID.n_proc);
+  double *y_min_rank=(double *)SID_malloc(sizeof(double)*SID.n_proc);
+  double *y_max_rank=(double *)SID_malloc(sizeof(double)*SID.n_proc);
+  for(i_rank=0;i_rank<SID.n_proc;i_rank++){
+    x_min_rank[i_rank]=slab->x_min_local;
+    x_max_rank[i_rank]=slab->x_max_local;
+    y_min_rank[i_rank]=slab->y_min_local;
+    y_max_rank[i_rank]=slab->y_max_local;
+    SID_Bcast(&(x_min_rank[i_rank]),sizeof(double),i_rank,SID.COMM_WORLD);
+    SID_Bcast(&(x_max_rank[i_rank]),sizeof(double),i_rank,SID.COMM_WORLD);
+    SID_Bcast(&(y_min_rank[i_rank]),sizeof(double),i_rank,SID.COMM_WORLD);
+    SID_Bcast(&(y_max_rank[i_rank]),sizeof(double),i_rank,SID.COMM_WORLD);
+  }
+
+  // Ranks hold n_x_blocks blocks in x, each split into n_y_blocks blocks
+  //   in y (rank=i_x_block*n_y_blocks+i_y_block).  Slabs span all of y,
+  //   so n_y_blocks=1 for them.
+  int n_y_blocks=1;
+  while(n_y_blocks<SID.n_proc && y_min_rank[n_y_blocks]>y_min_rank[n_y_blocks-1])
+    n_y_blocks++;
+  int n_x_blocks=SID.n_proc/n_y_blocks;
+
+  // Decide where each particle goes.  Blocks are ordered by rank, so start
+  //   from a uniform guess and step to the block that holds it.
+  size_t   n_particles_local=((size_t *)ADaPS_fetch(plist->data,"n_%s",species_name))[0];
+  GBPREAL *x_particles_local=NULL;
+  GBPREAL *y_particles_local=NULL;
+  if(n_particles_local>0){
+    x_particles_local=(GBPREAL *)ADaPS_fetch(plist->data,"x_%s",species_name);
+    y_particles_local=(GBPREAL *)ADaPS_fetch(plist->data,"y_%s",species_name);
+  }
+  int     *rank_particle    =(int     *)SID_malloc(sizeof(int)*MAX(1,n_particles_local));
+  size_t  *n_send           =(size_t  *)SID_calloc(sizeof(size_t)*SID.n_proc);
+  double   box_size         =slab->x_max;
+  for(i_particle=0;i_particle<n_particles_local;i_particle++){
+    double x_i=(double)x_particles_local[i_particle];
+    int    j_x=MAX(0,MIN(n_x_blocks-1,(int)(x_i*(double)n_x_blocks/box_size)));
+    while(j_x>0 && x_i<x_min_rank[j_x*n_y_blocks])
+      j_x--;
+    while(j_x<(n_x_blocks-1) && x_i>=x_max_rank[j_x*n_y_blocks])
+      j_x++;
+    int j_y=0;
+    if(n_y_blocks>1){
+      double y_i=(double)y_particles_local[i_particle];
+      j_y=MAX(0,MIN(n_y_blocks-1,(int)(y_i*(double)n_y_blocks/box_size)));
+      while(j_y>0 && y_i<y_min_rank[j_y])
+        j_y--;
+      while(j_y<(n_y_blocks-1) && y_i>=y_max_rank[j_y])
+        j_y++;
+    }
+    int j_rank=j_x*n_y_blocks+j_y;
+    rank_particle[i_particle]=j_rank;
+    n_send[j_rank]++;
+  }
+
+  // Exchange counts
+  size_t *n_receive        =(size_t *)SID_malloc(sizeof(size_t)*SID.n_proc);
+  size_t  n_particles_new  =n_send[SID.My_rank];
+  n_receive[0]=n_send[SID.My_rank];
+  for(i_rank=1;i_rank<SID.n_proc;i_rank++){
+    set_exchange_ring_ranks(&rank_to,&rank_from,i_rank);
+    exchange_ring_buffer(&(n_send[rank_to]),sizeof(size_t),1,&(n_receive[i_rank]),NULL,i_rank);
+    n_particles_new+=n_receive[i_rank];
+  }
+
+  // Exchange each array in turn
+  size_t   n_send_max=0;
+  for(i_rank=0;i_rank<SID.n_proc;i_rank++)
+    n_send_max=MAX(n_send_max,n_send[i_rank]);
+  GBPREAL *send_buffer=(GBPREAL *)SID_malloc(sizeof(GBPREAL)*MAX(1,n_send_max));
+  for(i_array=0;i_array<n_array_names;i_array++){
+    // Ranks without particles may not have stored the array, so decide
+    //   collectively whether it is to be exchanged
+    int flag_exist=ADaPS_exist(plist->data,array_names[i_array],species_name);
+    SID_Allreduce(SID_IN_PLACE,&flag_exist,1,SID_INT,SID_MAX,SID.COMM_WORLD);
+    if(!flag_exist)
+      continue;
+    GBPREAL *array_old=NULL;
+    if(n_particles_local>0)
+      array_old=(GBPREAL *)ADaPS_fetch(plist->data,array_names[i_array],species_name);
+    GBPREAL *array_new=(GBPREAL *)SID_malloc(sizeof(GBPREAL)*MAX(1,n_particles_new));
+    size_t   i_new    =0;
+    for(i_particle=0;i_particle<n_particles_local;i_particle++){
+      if(rank_particle[i_particle]==SID.My_rank)
+        array_new[i_new++]=array_old[i_particle];
+    }
+    for(i_rank=1;i_rank<SID.n_proc;i_rank++){
+      size_t i_send=0;
+      set_exchange_ring_ranks(&rank_to,&rank_from,i_rank);
+      for(i_particle=0;i_particle<n_particles_local;i_particle++){
+        if(rank_particle[i_particle]==rank_to)
+          send_buffer[i_send++]=array_old[i_particle];
+      }
+      exchange_ring_buffer(send_buffer,sizeof(GBPREAL),i_send,&(array_new[i_new]),NULL,i_rank);
+      i_new+=n_receive[i_rank];
+    }
+    ADaPS_store(&(plist->data),(void *)array_new,array_names[i_array],ADaPS_DEFAULT,species_name);
+  }
+  ADaPS_store(&(plist->data),(void *)(&n_particles_new),"n_%s",ADaPS_SCALAR_SIZE_T,species_name);
+
+  SID_free(SID_FARG send_buffer);
+  SID_free(SID_FARG n_receive);
+  SID_free(SID_FARG n_send);
+  SID_free(SID_FARG rank_particle);
+  SID_free(SID_FARG x_min_rank);
+  SID_free(SID_FARG x_max_rank);
+  SID_free(SID_FARG y_min_rank);
+  SID_free(SID_FARG y_max_rank);
+}
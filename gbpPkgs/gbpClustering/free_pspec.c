@@ -12,6 +12,10 @@ void free_pspec(pspec_info *pspec){
   SID_log("Freeing power spectrum...",SID_LOG_OPEN);
   free_cosmo(&(pspec->cosmo));
   free_field(&(pspec->FFT));
+  if(pspec->FFT_interlace!=NULL){
+     free_field(pspec->FFT_interlace);
+     SID_free(SID_FARG pspec->FFT_interlace);
+  }
   SID_free(SID_FARG (pspec->k_1D));
   SID_free(SID_FARG (pspec->n_modes_1D));
   SID_free(SID_FARG (pspec->n_modes_2D));
@@ -21,11 +25,15 @@ void free_pspec(pspec_info *pspec){
       SID_free(SID_FARG (pspec->dP_k_1D[i_run]));
       SID_free(SID_FARG (pspec->P_k_2D[i_run]));
       SID_free(SID_FARG (pspec->dP_k_2D[i_run]));
+      SID_free(SID_FARG (pspec->P_k_l2_1D[i_run]));
+      SID_free(SID_FARG (pspec->P_k_l4_1D[i_run]));
   }
   SID_free(SID_FARG pspec->P_k_1D);
   SID_free(SID_FARG pspec->dP_k_1D);
   SID_free(SID_FARG pspec->P_k_2D);
   SID_free(SID_FARG pspec->dP_k_2D);
+  SID_free(SID_FARG pspec->P_k_l2_1D);
+  SID_free(SID_FARG pspec->P_k_l4_1D);
   SID_log("Done.",SID_LOG_CLOSE);
 }
 
@@ -17,8 +17,11 @@
 #define MAP2GRID_MODE_NONORM        4
 #define MAP2GRID_MODE_FORCENORM     8
 #define MAP2GRID_MODE_APPLYFACTOR  16
+#define MAP2GRID_MODE_INTERLACE    32  // Assign to a grid shifted by half a cell (see compute_pspec())
 
 #define GRID_IDENTIFIER_SIZE 32
+#define GRID_HEADER_SIZE     (3*sizeof(int)+3*sizeof(double)+2*sizeof(int))
+#define GRID_MAP_SIZE        (256*1024*1024) // Default size of the slabs mapped by make_diff_grid
 
 #define PSPEC_ADD_VX     256   // Must start at 256 to allow for MAP2GRID flags
 #define PSPEC_ADD_VY     512
@@ -30,6 +33,14 @@
 #define CFUNC_ADD_VZ     128
 #define CFUNC_DEFAULT    256
 
+#define CFUNC_PAIRS_PHK     1  // Find pairs with Peano-Hilbert key volumes
+#define CFUNC_PAIRS_CELLS   2  // Find pairs with sorted cell lists (threaded if USE_OPENMP is on)
+#define CFUNC_PAIRS_DEFAULT CFUNC_PAIRS_CELLS
+
+#define CFUNC_JACK_PER_PAIR 1  // Add each pair to every jack-knife histogram it belongs to
+#define CFUNC_JACK_ZONES    2  // Count the pairs touching each zone and derive the jack-knife histograms afterwards
+#define CFUNC_JACK_DEFAULT  CFUNC_JACK_ZONES
+
 #define READ_GROUPING_SLAB    1
 #define READ_GROUPING_ADD_VX  2
 #define READ_GROUPING_ADD_VY  4
@@ -61,9 +72,31 @@ struct pspec_info {
    double    **dP_k_1D;
    double    **P_k_2D;
    double    **dP_k_2D;
+   double    **P_k_l2_1D;       // Quadrupole      (set if flag_multipoles is)
+   double    **P_k_l4_1D;       // Hexadecapole    (set if flag_multipoles is)
    int         flag_processed[4];
+   int         flag_interlace;  // Combine with a grid shifted by half a cell to cancel the leading aliases
+   int         flag_multipoles; // Compute the quadrupole and hexadecapole too
    cosmo_info *cosmo;
    field_info  FFT;
+   field_info *FFT_interlace;   // Allocated by compute_pspec() when interlacing
+};
+
+// An open grid file (see write_grid()).  Grids are stored one after
+//   another, each as an identifier followed by its x planes; offset[i]
+//   gives the position of grid i's first plane.  Slabs of planes are
+//   mapped into memory one at a time with map_grid_slab().
+typedef struct grid_file_info grid_file_info;
+struct grid_file_info {
+   int     fd;
+   int     n[3];
+   double  L[3];
+   int     n_grids;
+   int     mass_assignment_scheme;
+   size_t  plane_size;
+   size_t *offset;
+   void   *map;
+   size_t  map_size;
 };
 
 // This structure stores everything pertaining to a
@@ -111,6 +144,8 @@ struct cfunc_info {
    double       box_size;
    int          n_bits_PHK;
    int          PHK_width;
+   int          pair_engine;
+   int          jack_mode;
    cosmo_info  *cosmo;
 };
 
@@ -124,6 +159,15 @@ void read_atable(const char *filename_in,plist_info *plist,
                  int x_column,int y_column,int z_column,int vx_column,int vy_column,int vz_column,
                  const char *species_name,int mode,...);
 void generate_randoms(cfunc_info *cfunc,plist_info *plist,const char *species_name,const char *random_name,const char *filename_out_randoms);
+void apply_zspace_plist(plist_info *plist,
+                        const char *species_name,
+                        int         i_coord,
+                        double      box_size,
+                        double      redshift,
+                        cosmo_info *cosmo,
+                        slab_info  *slab);
+void restore_zspace_plist(plist_info *plist,const char *species_name,slab_info *slab);
+void exchange_slab_plist(plist_info *plist,const char *species_name,slab_info *slab);
 void map_to_grid(size_t      n_particles_local,
                  GBPREAL    *x_particles_local,
                  GBPREAL    *y_particles_local,
@@ -157,7 +201,8 @@ void init_pspec(pspec_info *pspec,const char *filename_cosmology,cosmo_info *cos
                 int mass_assignment_scheme,
                 double redshift,double box_size,int grid_size,
                 double k_min_1D,double k_max_1D,double dk_1D,
-                double k_min_2D,double k_max_2D,double dk_2D);
+                double k_min_2D,double k_max_2D,double dk_2D,
+                int field_mode);
 void free_pspec(pspec_info *pspec);
 void compute_pspec(plist_info  *plist,
                    const char  *species_name,
@@ -170,6 +215,9 @@ void write_grid(field_info *field,
                 int         mass_assignment_scheme,
                 const char *grid_identifier,
                 double      box_size);
+void open_grid_file(const char *filename,grid_file_info *grid_file);
+GBPREAL *map_grid_slab(grid_file_info *grid_file,int i_grid,int i_x_start,int n_x,char *grid_identifier);
+void close_grid_file(grid_file_info *grid_file);
 void write_pspec(pspec_info *pspec,const char *filename_out_root,plist_info *plist,const char *species_name);
 
 #ifdef __cplusplus
@@ -2,6 +2,115 @@
 #include <gbpLib.h>
 #include <gbpClustering.h>
 
+#define RANDOMS_CHUNK_SIZE 1048576 // Randoms generated at a time
+
+// A range of PHK keys lying wholly in the local domain and the
+//   number of randoms that fall in it
+typedef struct random_node_info random_node_info;
+struct random_node_info{
+   PHK_t    key_start;
+   PHK_t    n_keys;
+   uint64_t i_node;
+   size_t   n_random;
+};
+
+// Draw how many of n randoms in node i_node fall in its first half
+//   (a binomial deviate with p=1/2, drawn from the node's own stream)
+size_t split_randoms_local(int seed,uint64_t i_node,size_t n);
+size_t split_randoms_local(int seed,uint64_t i_node,size_t n){
+   RNG_counter_info RNG;
+   init_RNG_counter(&seed,&RNG,i_node);
+   return(random_binomial(&RNG,n,0.5));
+}
+
+// Split the n_random randoms of node i_node (keys key_start to
+//   key_start+n_keys-1) between the halves of the node until each
+//   part lies wholly in or out of the local domain.  Every rank draws
+//   the same splits, so the randoms are shared out exactly between
+//   the ranks without any communication.
+void split_random_nodes_local(int seed,PHK_t key_start,PHK_t n_keys,uint64_t i_node,size_t n_random,
+                              PHK_t key_min,PHK_t key_max,random_node_info *nodes,int *n_nodes);
+void split_random_nodes_local(int seed,PHK_t key_start,PHK_t n_keys,uint64_t i_node,size_t n_random,
+                              PHK_t key_min,PHK_t key_max,random_node_info *nodes,int *n_nodes){
+   PHK_t key_stop=key_start+n_keys-1;
+   if(n_random==0 || key_start>key_max || key_stop<key_min)
+      return;
+   if(key_start>=key_min && key_stop<=key_max){
+      nodes[*n_nodes].key_start=key_start;
+      nodes[*n_nodes].n_keys   =n_keys;
+      nodes[*n_nodes].i_node   =i_node;
+      nodes[*n_nodes].n_random =n_random;
+      (*n_nodes)++;
+      return;
+   }
+   size_t n_left=split_randoms_local(seed,i_node,n_random);
+   split_random_nodes_local(seed,key_start,         n_keys/2,2*i_node,  n_left,         key_min,key_max,nodes,n_nodes);
+   split_random_nodes_local(seed,key_start+n_keys/2,n_keys/2,2*i_node+1,n_random-n_left,key_min,key_max,nodes,n_nodes);
+}
+
+// Place a node's randoms uniformly in its keys' cells.  Positions
+//   are drawn from the node's own streams, so a second call returns
+//   the same randoms.  Boundary randoms are stored from i_boundary
+//   and the rest from i_interior; if x_random is NULL they are only
+//   counted.
+void generate_random_node_local(int seed,random_node_info *node,int n_bits_PHK,double box_size,
+                                PHK_t *keys_boundary,int n_keys_boundary,
+                                GBPREAL *x_random,GBPREAL *y_random,GBPREAL *z_random,size_t *PHK_random,
+                                size_t *i_boundary,size_t *i_interior);
+void generate_random_node_local(int seed,random_node_info *node,int n_bits_PHK,double box_size,
+                                PHK_t *keys_boundary,int n_keys_boundary,
+                                GBPREAL *x_random,GBPREAL *y_random,GBPREAL *z_random,size_t *PHK_random,
+                                size_t *i_boundary,size_t *i_interior){
+   RNG_counter_info RNG_keys;
+   RNG_counter_info RNG_positions;
+   int              seed_keys     =seed+1;
+   int              seed_positions=seed+2;
+   double           cell_size     =box_size/(double)PHK_DIM_SIZE(n_bits_PHK);
+   size_t           n_chunk       =MIN(RANDOMS_CHUNK_SIZE,node->n_random);
+   uint32_t        *key_buffer    =(uint32_t *)SID_malloc(sizeof(uint32_t)*2*n_chunk);
+   GBPREAL         *offset_buffer =(GBPREAL  *)SID_malloc(sizeof(GBPREAL)*3*n_chunk);
+   size_t           i_random;
+   size_t           j_random;
+   init_RNG_counter(&seed_keys,     &RNG_keys,     node->i_node);
+   init_RNG_counter(&seed_positions,&RNG_positions,node->i_node);
+   for(i_random=0;i_random<node->n_random;i_random+=n_chunk){
+      n_chunk=MIN(n_chunk,node->n_random-i_random);
+      random_uint32_array (&RNG_keys,     key_buffer,   2*n_chunk);
+      random_uniform_array(&RNG_positions,offset_buffer,3*n_chunk);
+      for(j_random=0;j_random<n_chunk;j_random++){
+         PHK_t PHK_i=node->key_start+
+                     ((((PHK_t)key_buffer[2*j_random+1]<<32)|(PHK_t)key_buffer[2*j_random])&(node->n_keys-1));
+         int   flag_boundary=FALSE;
+         if(n_keys_boundary>0)
+            flag_boundary=(keys_boundary[find_index(keys_boundary,PHK_i,n_keys_boundary,NULL)]==PHK_i);
+         size_t i_store=(flag_boundary?(*i_boundary)++:(*i_interior)++);
+         if(x_random!=NULL){
+            int i_x;
+            int i_y;
+            int i_z;
+            compute_PHK_to_Cartesian(n_bits_PHK,PHK_i,&i_x,&i_y,&i_z);
+            x_random[i_store]  =(GBPREAL)(((double)i_x+(double)offset_buffer[3*j_random+0])*cell_size);
+            y_random[i_store]  =(GBPREAL)(((double)i_y+(double)offset_buffer[3*j_random+1])*cell_size);
+            z_random[i_store]  =(GBPREAL)(((double)i_z+(double)offset_buffer[3*j_random+2])*cell_size);
+            force_periodic(&(x_random[i_store]),0.,(GBPREAL)box_size);
+            force_periodic(&(y_random[i_store]),0.,(GBPREAL)box_size);
+            force_periodic(&(z_random[i_store]),0.,(GBPREAL)box_size);
+            PHK_random[i_store]=(size_t)PHK_i;
+         }
+      }
+   }
+   SID_free(SID_FARG key_buffer);
+   SID_free(SID_FARG offset_buffer);
+}
+
+// Set up randoms for the correlation function of a species.  They are
+//   read from filename_out_randoms if it holds the right number;
+//   otherwise they are generated and written there.  Generated randoms
+//   are placed directly in each rank's PHK domain: the number falling
+//   in it is drawn by splitting the key range in halves (identically
+//   on every rank) and they are then placed in its cells with the
+//   counter-based generator.  The results depend on the seed and the
+//   decomposition but not on the number of threads.
 void generate_randoms(cfunc_info *cfunc,plist_info *plist,const char *species_name,const char *random_name,const char *filename_out_randoms){
 
    // Fetch the number of objects and set the number of random
@@ -41,12 +150,15 @@ void generate_randoms(cfunc_info *cfunc,plist_info *plist,const char *species_na
    PHK_t *keys_boundary;
    compute_PHK_boundary_keys(cfunc->n_bits_PHK,PHK_min_local,PHK_max_local,cfunc->PHK_width,&n_keys_boundary,&keys_boundary);
 
-   // Initialize the random number generator
-   RNG_info  RNG;
-   int       seed=1327621;
-   init_RNG(&seed,&RNG,RNG_GLOBAL);
+   // Sort the boundary keys so that they can be searched quickly
+   if(n_keys_boundary>0)
+      merge_sort(keys_boundary,(size_t)n_keys_boundary,NULL,SID_PHK_T,SORT_INPLACE_ONLY,SORT_COMPUTE_INPLACE);
 
-   // Generate the random and determine how many belong to this rank's boundary/interior
+   // Determine how many randoms belong to this rank's boundary/interior
+   int               seed   =1327621;
+   random_node_info *nodes  =NULL;
+   int               n_nodes=0;
+   int               i_node;
    GBPREAL x_i;
    GBPREAL y_i;
    GBPREAL z_i;
@@ -57,8 +169,8 @@ void generate_randoms(cfunc_info *cfunc,plist_info *plist,const char *species_na
    size_t  n_boundary    =0;
    char   *line=NULL;
    size_t  line_length=0;
-   for(i_random=0;i_random<n_random_target;i_random++){
-      if(flag_read_randoms){
+   if(flag_read_randoms){
+      for(i_random=0;i_random<n_random_target;i_random++){
          grab_next_line_data(fp_randoms,&line,&line_length);
          grab_real(line,1,&x_i);
          grab_real(line,2,&y_i);
@@ -66,21 +178,29 @@ void generate_randoms(cfunc_info *cfunc,plist_info *plist,const char *species_na
          x_i/=cfunc->box_size;
          y_i/=cfunc->box_size;
          z_i/=cfunc->box_size;
+         PHK_i=compute_PHK_from_Cartesian(cfunc->n_bits_PHK,3,(double)x_i,(double)y_i,(double)z_i);
+         if(PHK_i>=(PHK_t)PHK_min_local && PHK_i<=(PHK_t)PHK_max_local){
+            n_random_local++;
+            if(is_a_member(&PHK_i,keys_boundary,n_keys_boundary,SID_PHK_T))
+               n_boundary++;
+         }
       }
-      else{
-         x_i=random_number(&RNG);force_periodic(&x_i,0.,1.);if(x_i==1.) x_i=0.;
-         y_i=random_number(&RNG);force_periodic(&y_i,0.,1.);if(y_i==1.) y_i=0.;
-         z_i=random_number(&RNG);force_periodic(&z_i,0.,1.);if(z_i==1.) z_i=0.;
-      }
-      PHK_i=compute_PHK_from_Cartesian(cfunc->n_bits_PHK,3,(double)x_i,(double)y_i,(double)z_i);
-      if(PHK_i>=(PHK_t)PHK_min_local && PHK_i<=(PHK_t)PHK_max_local){
-         n_random_local++;
-         if(is_a_member(&PHK_i,keys_boundary,n_keys_boundary,SID_PHK_T))
-            n_boundary++;
+      rewind(fp_randoms);
+   }
+   else{
+      // At most two nodes per level of the key tree lie wholly in the domain
+      nodes=(random_node_info *)SID_malloc(sizeof(random_node_info)*(2*3*cfunc->n_bits_PHK+2));
+      split_random_nodes_local(seed,0,(PHK_t)PHK_N_KEYS_3D(cfunc->n_bits_PHK),1,n_random_target,
+                               (PHK_t)PHK_min_local,(PHK_t)PHK_max_local,nodes,&n_nodes);
+      for(i_node=0;i_node<n_nodes;i_node++){
+         size_t i_boundary=0;
+         size_t i_interior=0;
+         generate_random_node_local(seed,&(nodes[i_node]),cfunc->n_bits_PHK,cfunc->box_size,
+                                    keys_boundary,n_keys_boundary,NULL,NULL,NULL,NULL,&i_boundary,&i_interior);
+         n_random_local+=nodes[i_node].n_random;
+         n_boundary    +=i_boundary;
       }
    }
-   if(flag_read_randoms)
-     rewind(fp_randoms);
    SID_Allreduce(&n_random_local,&n_random,1,SID_SIZE_T,SID_SUM,SID.COMM_WORLD);
 
    // Sanity check
@@ -97,16 +217,11 @@ void generate_randoms(cfunc_info *cfunc,plist_info *plist,const char *species_na
    z_random  =(GBPREAL *)SID_malloc(sizeof(GBPREAL)*n_random_local);
    PHK_random=(size_t  *)SID_malloc(sizeof(size_t) *n_random_local);
 
-   // Reinitialize the RNG so we generate the same stream as above
-   init_RNG(&seed,&RNG,RNG_GLOBAL);
-
-   // Generate the random again and store them in the arrays
-   size_t j_random=0;
-   size_t i_store;
+   // Read or generate the randoms again and store them in the arrays
    size_t i_boundary=0;
    size_t i_interior=n_boundary;
-   for(i_random=0;i_random<n_random_target;i_random++){
-      if(flag_read_randoms){
+   if(flag_read_randoms){
+      for(i_random=0;i_random<n_random_target;i_random++){
          grab_next_line_data(fp_randoms,&line,&line_length);
          grab_real(line,1,&x_i);
          grab_real(line,2,&y_i);
@@ -114,24 +229,25 @@ void generate_randoms(cfunc_info *cfunc,plist_info *plist,const char *species_na
          x_i/=cfunc->box_size;
          y_i/=cfunc->box_size;
          z_i/=cfunc->box_size;
+         PHK_i=compute_PHK_from_Cartesian(cfunc->n_bits_PHK,3,(double)x_i,(double)y_i,(double)z_i);
+         if(PHK_i>=(PHK_t)PHK_min_local && PHK_i<=(PHK_t)PHK_max_local){
+            size_t i_store;
+            if(is_a_member(&PHK_i,keys_boundary,n_keys_boundary,SID_PHK_T))
+               i_store=i_boundary++;
+            else
+               i_store=i_interior++;
+            x_random[i_store]  =x_i*cfunc->box_size;
+            y_random[i_store]  =y_i*cfunc->box_size;
+            z_random[i_store]  =z_i*cfunc->box_size;
+            PHK_random[i_store]=PHK_i;
+         }
       }
-      else{
-         x_i=random_number(&RNG);force_periodic(&x_i,0.,1.);
-         y_i=random_number(&RNG);force_periodic(&y_i,0.,1.);
-         z_i=random_number(&RNG);force_periodic(&z_i,0.,1.);
-      }
-      PHK_i=compute_PHK_from_Cartesian(cfunc->n_bits_PHK,3,(double)x_i,(double)y_i,(double)z_i);
-      if(PHK_i>=(PHK_t)PHK_min_local && PHK_i<=(PHK_t)PHK_max_local){
-         int i_store;
-         if(is_a_member(&PHK_i,keys_boundary,n_keys_boundary,SID_PHK_T))
-            i_store=i_boundary++;
-         else
-            i_store=i_interior++;
-         x_random[i_store]  =x_i*cfunc->box_size;
-         y_random[i_store]  =y_i*cfunc->box_size;
-         z_random[i_store]  =z_i*cfunc->box_size;
-         PHK_random[i_store]=PHK_i;
-      }
+   }
+   else{
+      for(i_node=0;i_node<n_nodes;i_node++)
+         generate_random_node_local(seed,&(nodes[i_node]),cfunc->n_bits_PHK,cfunc->box_size,
+                                    keys_boundary,n_keys_boundary,x_random,y_random,z_random,PHK_random,&i_boundary,&i_interior);
+      SID_free(SID_FARG nodes);
    }
 
    // Report decomposition results
@@ -13,10 +13,13 @@ void init_cfunc(cfunc_info *cfunc,const char *filename_cosmology,int    n_data,
                 double r_min_l1D, double r_max_1D,double dr_1D,
                 double r_min_2D,  double r_max_2D,double dr_2D){
   SID_log("Initializing correlation function...",SID_LOG_OPEN);
+  SID_push_memory_tag("cfunc");
 
   // Initialize flags
   cfunc->initialized    =TRUE;
   cfunc->flag_compute_RR=TRUE;
+  cfunc->pair_engine    =CFUNC_PAIRS_DEFAULT;
+  cfunc->jack_mode      =CFUNC_JACK_DEFAULT;
 
   // Initialize constants
   cfunc->n_data    =n_data;
@@ -103,6 +106,7 @@ void init_cfunc(cfunc_info *cfunc,const char *filename_cosmology,int    n_data,
   else
      read_gbpCosmo_file(&(cfunc->cosmo),filename_cosmology);
 
+  SID_pop_memory_tag();
   SID_log("Done.",SID_LOG_CLOSE);
 }
 
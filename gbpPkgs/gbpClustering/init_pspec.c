@@ -12,13 +12,16 @@ void init_pspec(pspec_info *pspec,const char *filename_cosmology,cosmo_info *cos
 	            int    mass_assignment_scheme,
                 double redshift,double box_size,int grid_size,
                 double k_min_1D,double k_max_1D,double dk_1D,
-                double k_min_2D,double k_max_2D,double dk_2D){
+                double k_min_2D,double k_max_2D,double dk_2D,
+                int field_mode){
 
   SID_log("Initializing power spectrum...",SID_LOG_OPEN);
 
   // Initialize flags
   pspec->mass_assignment_scheme=mass_assignment_scheme;
   pspec->initialized           =TRUE;
+  pspec->flag_interlace        =FALSE;
+  pspec->flag_multipoles       =FALSE;
 
   // Initialize constants
   pspec->redshift =redshift;
@@ -41,6 +44,8 @@ void init_pspec(pspec_info *pspec,const char *filename_cosmology,cosmo_info *cos
   pspec->dP_k_1D   =(double **)SID_calloc(4*sizeof(double *)); 
   pspec->P_k_2D    =(double **)SID_calloc(4*sizeof(double *));
   pspec->dP_k_2D   =(double **)SID_calloc(4*sizeof(double *));
+  pspec->P_k_l2_1D =(double **)SID_calloc(4*sizeof(double *)); 
+  pspec->P_k_l4_1D =(double **)SID_calloc(4*sizeof(double *)); 
   int i;
   for(i=0;i<4;i++){
       pspec->flag_processed[i]=FALSE;
@@ -48,6 +53,8 @@ void init_pspec(pspec_info *pspec,const char *filename_cosmology,cosmo_info *cos
       pspec->dP_k_1D[i]=(double *)SID_calloc(sizeof(double)*(pspec->n_k_1D)); 
       pspec->P_k_2D[i] =(double *)SID_calloc(sizeof(double)*(pspec->n_k_2D)*(pspec->n_k_2D));
       pspec->dP_k_2D[i]=(double *)SID_calloc(sizeof(double)*(pspec->n_k_2D)*(pspec->n_k_2D));
+      pspec->P_k_l2_1D[i]=(double *)SID_calloc(sizeof(double)*(pspec->n_k_1D)); 
+      pspec->P_k_l4_1D[i]=(double *)SID_calloc(sizeof(double)*(pspec->n_k_1D)); 
   }
 
   // Initialize the grid
@@ -59,7 +66,8 @@ void init_pspec(pspec_info *pspec,const char *filename_cosmology,cosmo_info *cos
   L[0]=box_size;
   L[1]=L[0];
   L[2]=L[0];
-  init_field(3,n,L,&(pspec->FFT));
+  init_field(3,n,L,&(pspec->FFT),field_mode);
+  pspec->FFT_interlace=NULL;
 
   // Initialize the cosmology
   if(cosmo!=NULL)
@@ -76,6 +76,9 @@ int main(int argc, char *argv[]){
    vy_column        =(int)   atoi(argv[11]);
    vz_column        =(int)   atoi(argv[12]);
 
+   // FFT plans are measured (and quick to make) if wisdom from earlier runs is found
+   read_FFT_wisdom(FFT_WISDOM_FILENAME_DEFAULT);
+
    SID_log("Producing power spectra for ascii file {%s}...",SID_LOG_OPEN|SID_LOG_TIMER,filename_in);
  
    // Set the k ranges
@@ -98,7 +101,8 @@ int main(int argc, char *argv[]){
     	      MAP2GRID_DIST_DWT20,
               redshift,box_size,grid_size,
               k_min_1D,k_max_1D,dk_1D,
-              k_min_2D,k_max_2D,dk_2D);
+              k_min_2D,k_max_2D,dk_2D,
+              FIELD_MODE_DEFAULT);
   
    // Loop over ithe real-space and 3 redshift-space frames
    int i_run;
@@ -136,6 +140,9 @@ int main(int argc, char *argv[]){
  
    // Clean-up
    free_pspec(&pspec);
+   // Keep any wisdom gathered for later runs
+   write_FFT_wisdom(FFT_WISDOM_FILENAME_DEFAULT);
+   free_FFT_plan_cache();
  
    SID_log("Done.",SID_LOG_CLOSE);
    SID_exit(ERROR_NONE);
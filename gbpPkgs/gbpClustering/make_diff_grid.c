@@ -17,31 +17,16 @@ int main(int argc, char *argv[]){
 
   SID_log("Writing the difference between the grids in {%s} and {%s} to stdout...",SID_LOG_OPEN,argv[1],argv[2]);
 
-  FILE   *fp1;
-  int     nx1,ny1,nz1,ng1,as1;
-  double  Lx1,Ly1,Lz1;
-  fp1=fopen(argv[1],"r");
-  fread_verify(&nx1,sizeof(int),   1,fp1);
-  fread_verify(&ny1,sizeof(int),   1,fp1);
-  fread_verify(&nz1,sizeof(int),   1,fp1);
-  fread_verify(&Lx1,sizeof(double),1,fp1);
-  fread_verify(&Ly1,sizeof(double),1,fp1);
-  fread_verify(&Lz1,sizeof(double),1,fp1);
-  fread_verify(&ng1,sizeof(int),   1,fp1);
-  fread_verify(&as1,sizeof(int),   1,fp1);
-
-  FILE   *fp2;
-  int     nx2,ny2,nz2,ng2,as2;
-  double  Lx2,Ly2,Lz2;
-  fp2=fopen(argv[2],"r");
-  fread_verify(&nx2,sizeof(int),   1,fp2);
-  fread_verify(&ny2,sizeof(int),   1,fp2);
-  fread_verify(&nz2,sizeof(int),   1,fp2);
-  fread_verify(&Lx2,sizeof(double),1,fp2);
-  fread_verify(&Ly2,sizeof(double),1,fp2);
-  fread_verify(&Lz2,sizeof(double),1,fp2);
-  fread_verify(&ng2,sizeof(int),   1,fp2);
-  fread_verify(&as2,sizeof(int),   1,fp2);
+  // Only the headers are read here; the grids are streamed through
+  //   a slab at a time, so they need not fit in memory
+  grid_file_info grid_file_1;
+  grid_file_info grid_file_2;
+  open_grid_file(argv[1],&grid_file_1);
+  open_grid_file(argv[2],&grid_file_2);
+  int    nx1=grid_file_1.n[0],ny1=grid_file_1.n[1],nz1=grid_file_1.n[2],ng1=grid_file_1.n_grids;
+  int    nx2=grid_file_2.n[0],ny2=grid_file_2.n[1],nz2=grid_file_2.n[2],ng2=grid_file_2.n_grids;
+  double Lx1=grid_file_1.L[0],Ly1=grid_file_1.L[1],Lz1=grid_file_1.L[2];
+  double Lx2=grid_file_2.L[0],Ly2=grid_file_2.L[1],Lz2=grid_file_2.L[2];
 
   if(nx1!=nx2) SID_trap_error("nx's don't match (ie. %d!=%d)",ERROR_LOGIC,nx1,nx2);
   if(ny1!=ny2) SID_trap_error("ny's don't match (ie. %d!=%d)",ERROR_LOGIC,ny1,ny2);
@@ -51,26 +36,36 @@ int main(int argc, char *argv[]){
   if(Lz1!=Lz2) SID_trap_error("Lz's don't match (ie. %le!=%le)",ERROR_LOGIC,Lz1,Lz2);
   if(ng1!=ng2) SID_trap_error("The number of grids don't match (ie. %d!=%d)",ERROR_LOGIC,ng1,ng2);
 
+  // Set how many planes to map at a time
+  int n_x_step=(int)MAX(1,MIN((size_t)nx1,GRID_MAP_SIZE/grid_file_1.plane_size));
+
   int i_x,i_y,i_z;
-  fftw_real d1,d2;
+  int i_x_start;
+  int n_x;
   int i_grid;
   char *grid_identifier_1;
   char *grid_identifier_2;
   grid_identifier_1=(char *)SID_malloc(GRID_IDENTIFIER_SIZE*sizeof(char));
   grid_identifier_2=(char *)SID_malloc(GRID_IDENTIFIER_SIZE*sizeof(char));
   for(i_grid=0;i_grid<ng1;i_grid++){
-     fread_verify(grid_identifier_1,sizeof(char),GRID_IDENTIFIER_SIZE,fp1);
-     fread_verify(grid_identifier_2,sizeof(char),GRID_IDENTIFIER_SIZE,fp2);
-     if(strcmp(grid_identifier_1,grid_identifier_2))
-        SID_log_warning("grid identifiers don't match (ie. {%s}!={%s})",ERROR_LOGIC,grid_identifier_1,grid_identifier_2);
-     SID_log("Processing {%s} ...",SID_LOG_OPEN,grid_identifier_1);
-     for(i_x=0;i_x<nx1;i_x++){
-        for(i_y=0;i_y<ny1;i_y++){
-           for(i_z=0;i_z<nz1;i_z++){
-                fread_verify(&d1,sizeof(fftw_real),1,fp1);
-                fread_verify(&d2,sizeof(fftw_real),1,fp2);
-                if(d2!=d1)
-                   fprintf(stdout,"%3d %4d %4d %4d %le %le %le\n",i_grid,i_x,i_y,i_z,(double)d1,(double)d2,(double)(d2-d1));
+     for(i_x_start=0;i_x_start<nx1;i_x_start+=n_x){
+        n_x=MIN(n_x_step,nx1-i_x_start);
+        GBPREAL *slab_1=map_grid_slab(&grid_file_1,i_grid,i_x_start,n_x,grid_identifier_1);
+        GBPREAL *slab_2=map_grid_slab(&grid_file_2,i_grid,i_x_start,n_x,grid_identifier_2);
+        if(i_x_start==0){
+           if(strcmp(grid_identifier_1,grid_identifier_2))
+              SID_log_warning("grid identifiers don't match (ie. {%s}!={%s})",ERROR_LOGIC,grid_identifier_1,grid_identifier_2);
+           SID_log("Processing {%s} ...",SID_LOG_OPEN,grid_identifier_1);
+        }
+        size_t index=0;
+        for(i_x=i_x_start;i_x<(i_x_start+n_x);i_x++){
+           for(i_y=0;i_y<ny1;i_y++){
+              for(i_z=0;i_z<nz1;i_z++,index++){
+                 GBPREAL d1=slab_1[index];
+                 GBPREAL d2=slab_2[index];
+                 if(d2!=d1)
+                    fprintf(stdout,"%3d %4d %4d %4d %le %le %le\n",i_grid,i_x,i_y,i_z,(double)d1,(double)d2,(double)(d2-d1));
+              }
            }
         }
      }
@@ -78,8 +73,8 @@ int main(int argc, char *argv[]){
   }
   SID_free(SID_FARG grid_identifier_1);
   SID_free(SID_FARG grid_identifier_2);
-  fclose(fp1); 
-  fclose(fp2); 
+  close_grid_file(&grid_file_1);
+  close_grid_file(&grid_file_2);
 
   SID_log("Done.",SID_LOG_CLOSE);
 
@@ -456,6 +456,9 @@ int main(int argc, char *argv[]){
   else
      SID_trap_error("Invalid distribution scheme {%s} specified.",ERROR_SYNTAX,argv[5]);
 
+  // FFT plans are measured (and quick to make) if wisdom from earlier runs is found
+  read_FFT_wisdom(FFT_WISDOM_FILENAME_DEFAULT);
+
   SID_log("Smoothing Gadget file {%s;snapshot=#%d} to a %dx%dx%d grid with %s kernel...",SID_LOG_OPEN|SID_LOG_TIMER,
           filename_in_root,snapshot_number,grid_size,grid_size,grid_size,argv[5]);
 
@@ -602,8 +605,8 @@ int main(int argc, char *argv[]){
               if(flag_used[i_species]){
                  field[i_species]     =(field_info *)SID_malloc(sizeof(field_info));
                  field_norm[i_species]=(field_info *)SID_malloc(sizeof(field_info));
-                 init_field(3,n,L,field[i_species]);
-                 init_field(3,n,L,field_norm[i_species]);
+                 init_field(3,n,L,field[i_species],     FIELD_MODE_DEFAULT);
+                 init_field(3,n,L,field_norm[i_species],FIELD_MODE_DEFAULT);
                  i_init=i_species;
               }
               else{
@@ -778,6 +781,9 @@ int main(int argc, char *argv[]){
   free_cosmo(&cosmo);
   SID_free(SID_FARG grid_identifier);
   SID_free(SID_FARG n_all);
+  // Keep any wisdom gathered for later runs
+  write_FFT_wisdom(FFT_WISDOM_FILENAME_DEFAULT);
+  free_FFT_plan_cache();
 
   SID_log("Done.",SID_LOG_CLOSE);
 
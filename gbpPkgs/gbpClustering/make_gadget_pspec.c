@@ -13,20 +13,16 @@
 #define READ_BUFFER_SIZE_LOCAL    (1024*1024)
 #define READ_BUFFER_ALLOC_LOCAL 3*(1024*1024)
 
-GBPREAL x_vspace_local(GBPREAL x,GBPREAL vx,double h_Hubble,double redshift,cosmo_info *cosmo);
-GBPREAL x_vspace_local(GBPREAL x,GBPREAL vx,double h_Hubble,double redshift,cosmo_info *cosmo){
-   return((GBPREAL)((double)x+1e3*h_Hubble*((double)vx/(a_of_z(redshift)*M_PER_MPC*H_convert(H_z(redshift,cosmo))))));
-}
-
+// Read the positions and velocities of the particles in a GADGET
+//   snapshot that fall in the local slab (or pencil).  Redshift-space frames are
+//   built from these afterwards with apply_zspace_plist().
 void read_gadget_binary_local(char       *filename_root_in,
                               int         snapshot_number,
-                              int         i_coord,
                               slab_info  *slab,
                               cosmo_info *cosmo,
                               plist_info *plist);
 void read_gadget_binary_local(char       *filename_root_in,
                               int         snapshot_number,
-                              int         i_coord,
                               slab_info  *slab,
                               cosmo_info *cosmo,
                               plist_info *plist){
@@ -36,6 +32,9 @@ void read_gadget_binary_local(char       *filename_root_in,
   GBPREAL   *x_array[N_GADGET_TYPE];
   GBPREAL   *y_array[N_GADGET_TYPE];
   GBPREAL   *z_array[N_GADGET_TYPE];
+  GBPREAL   *vx_array[N_GADGET_TYPE];
+  GBPREAL   *vy_array[N_GADGET_TYPE];
+  GBPREAL   *vz_array[N_GADGET_TYPE];
   int        i_type;
 
   // Determine file format and read the header
@@ -160,7 +159,6 @@ void read_gadget_binary_local(char       *filename_root_in,
 
       // Read header and move to the positions
       FILE *fp_pos;
-      FILE *fp_vel;
       fp_pos=fopen(filename,"r");
       fread_verify(&record_length_open,4,1,fp_pos);
       fread_verify(&header,sizeof(gadget_header_info),1,fp_pos);
@@ -169,61 +167,29 @@ void read_gadget_binary_local(char       *filename_root_in,
         SID_log_warning("Problem with GADGET record size (close of header)",ERROR_LOGIC);
       fread_verify(&record_length_open,4,1,fp_pos);
 
-      // Create a file pointer to the velocities
-      fp_vel=fopen(filename,"r");
-      fread_verify(&record_length_open,4,1,fp_vel);
-      fseeko(fp_vel,(off_t)(record_length_open),SEEK_CUR);
-      fread_verify(&record_length_close,4,1,fp_vel);
-      fread_verify(&record_length_open,4,1,fp_vel);
-      fseeko(fp_vel,(off_t)(record_length_open),SEEK_CUR);
-      fread_verify(&record_length_close,4,1,fp_vel);
-      if(record_length_open!=record_length_close)
-        SID_log_warning("Problem with GADGET record size (close of header)",ERROR_LOGIC);
-      fread_verify(&record_length_open,4,1,fp_vel);
-
-      // We only have to worry about z-space effects for domain decomposition in this one case.
-      if(i_coord==1){
-         for(i_type=0;i_type<N_GADGET_TYPE;i_type++){
-            for(i_particle=0;i_particle<header.n_file[i_type];i_particle+=i_step){
-               i_step=MIN(READ_BUFFER_SIZE_LOCAL,header.n_file[i_type]-i_particle);
-               if(SID.I_am_Master){
-                  fread_verify(pos_buffer,sizeof(GBPREAL),3*i_step,fp_pos);
-                  fread_verify(vel_buffer,sizeof(GBPREAL),3*i_step,fp_vel);
-               }
-               SID_Bcast(pos_buffer,sizeof(GBPREAL)*3*i_step,MASTER_RANK,SID.COMM_WORLD);
-               SID_Bcast(vel_buffer,sizeof(GBPREAL)*3*i_step,MASTER_RANK,SID.COMM_WORLD);
-               for(i_buffer=0;i_buffer<i_step;i_buffer++){
-                  index=3*i_buffer;
-                  pos_test=x_vspace_local(pos_buffer[index],vel_buffer[index],h_Hubble,redshift,cosmo);
-                  if(pos_test<0)         pos_test+=box_size;
-                  if(pos_test>=box_size) pos_test-=box_size;
-                  if(pos_test>=slab->x_min_local && pos_test<slab->x_max_local)
-                     n_of_type_local[i_type]++;
-               }
-            }
-         }
-      }
-      else{
-         for(i_type=0;i_type<N_GADGET_TYPE;i_type++){
-            for(i_particle=0;i_particle<header.n_file[i_type];i_particle+=i_step){
-               i_step=MIN(READ_BUFFER_SIZE_LOCAL,header.n_file[i_type]-i_particle);
-               if(SID.I_am_Master)
-                  fread_verify(pos_buffer,sizeof(GBPREAL),3*i_step,fp_pos);
-               SID_Bcast(pos_buffer,sizeof(GBPREAL)*3*i_step,MASTER_RANK,SID.COMM_WORLD);
-               for(i_buffer=0;i_buffer<i_step;i_buffer++){
-                  pos_test=pos_buffer[3*i_buffer];
-                  if(pos_test<0)         pos_test+=box_size;
-                  if(pos_test>=box_size) pos_test-=box_size;
-                  if(pos_test>=slab->x_min_local && pos_test<slab->x_max_local)
-                    n_of_type_local[i_type]++;
-               }
+      for(i_type=0;i_type<N_GADGET_TYPE;i_type++){
+         for(i_particle=0;i_particle<header.n_file[i_type];i_particle+=i_step){
+            i_step=MIN(READ_BUFFER_SIZE_LOCAL,header.n_file[i_type]-i_particle);
+            if(SID.I_am_Master)
+               fread_verify(pos_buffer,sizeof(GBPREAL),3*i_step,fp_pos);
+            SID_Bcast(pos_buffer,sizeof(GBPREAL)*3*i_step,MASTER_RANK,SID.COMM_WORLD);
+            for(i_buffer=0;i_buffer<i_step;i_buffer++){
+               double y_test;
+               pos_test=pos_buffer[3*i_buffer];
+               y_test  =pos_buffer[3*i_buffer+1];
+               if(pos_test<0)         pos_test+=box_size;
+               if(pos_test>=box_size) pos_test-=box_size;
+               if(y_test<0)           y_test+=box_size;
+               if(y_test>=box_size)   y_test-=box_size;
+               if(pos_test>=slab->x_min_local && pos_test<slab->x_max_local &&
+                  y_test  >=slab->y_min_local && y_test  <slab->y_max_local)
+                 n_of_type_local[i_type]++;
             }
          }
       }
       if(n_files>1)
          SID_log("Done.",SID_LOG_CLOSE);
       fclose(fp_pos);
-      fclose(fp_vel);
     }
     size_t n_local;
     for(i_type=0,n_local=0;i_type<N_GADGET_TYPE;i_type++) 
@@ -247,11 +213,13 @@ void read_gadget_binary_local(char       *filename_root_in,
           x_array[i_type]=(GBPREAL *)SID_malloc(sizeof(GBPREAL)*n_of_type_local[i_type]);
           y_array[i_type]=(GBPREAL *)SID_malloc(sizeof(GBPREAL)*n_of_type_local[i_type]);
           z_array[i_type]=(GBPREAL *)SID_malloc(sizeof(GBPREAL)*n_of_type_local[i_type]);
+          vx_array[i_type]=(GBPREAL *)SID_malloc(sizeof(GBPREAL)*n_of_type_local[i_type]);
+          vy_array[i_type]=(GBPREAL *)SID_malloc(sizeof(GBPREAL)*n_of_type_local[i_type]);
+          vz_array[i_type]=(GBPREAL *)SID_malloc(sizeof(GBPREAL)*n_of_type_local[i_type]);
        }
     }
 
     // Perform read
-    double d_bar=0.;
     SID_log("Performing read...",SID_LOG_OPEN|SID_LOG_TIMER);
     for(i_file=0;i_file<n_files;i_file++){
 
@@ -291,53 +259,32 @@ void read_gadget_binary_local(char       *filename_root_in,
             i_step=MIN(READ_BUFFER_SIZE_LOCAL,header.n_file[i_type]-i_particle);
             if(SID.I_am_Master){
                fread_verify(pos_buffer,sizeof(GBPREAL),3*i_step,fp_pos);
-               if(i_coord>0)
-                  fread_verify(vel_buffer,sizeof(GBPREAL),3*i_step,fp_vel);
+               fread_verify(vel_buffer,sizeof(GBPREAL),3*i_step,fp_vel);
             }
             SID_Bcast(pos_buffer,sizeof(GBPREAL)*3*i_step,MASTER_RANK,SID.COMM_WORLD);
-            if(i_coord>0)
-               SID_Bcast(vel_buffer,sizeof(GBPREAL)*3*i_step,MASTER_RANK,SID.COMM_WORLD);
+            SID_Bcast(vel_buffer,sizeof(GBPREAL)*3*i_step,MASTER_RANK,SID.COMM_WORLD);
             for(i_buffer=0;i_buffer<i_step;i_buffer++){
                double x_test;
                double y_test;
                double z_test;
-               double d;
                index=3*i_buffer;
-               switch(i_coord){
-                  case 0:
-                     x_test=pos_buffer[index+0];
-                     y_test=pos_buffer[index+1];
-                     z_test=pos_buffer[index+2];
-                     break;
-                  case 1:
-                     x_test=x_vspace_local(pos_buffer[index+0],vel_buffer[index+0],h_Hubble,redshift,cosmo);
-                     d     =(double)pos_buffer[index+0]-(double)x_test;
-                     d_bar+=fabs(d);
-                     break;
-                  case 2:
-                     y_test=x_vspace_local(pos_buffer[index+1],vel_buffer[index+1],h_Hubble,redshift,cosmo);
-                     d     =(double)pos_buffer[index+1]-(double)y_test;
-                     d_bar+=fabs(d);
-                     break;
-                  case 3:
-                     z_test=x_vspace_local(pos_buffer[index+2],vel_buffer[index+2],h_Hubble,redshift,cosmo);
-                     d     =(double)pos_buffer[index+2]-(double)z_test;
-                     d_bar+=fabs(d);
-                     break;
-                  default:
-                     SID_trap_error("Invalid i_coord=%d in read_gadget()",ERROR_LOGIC,i_coord);
-                     break;
-               }
+               x_test=pos_buffer[index+0];
+               y_test=pos_buffer[index+1];
+               z_test=pos_buffer[index+2];
                if(x_test<0)         x_test+=box_size;
                if(x_test>=box_size) x_test-=box_size;
                if(y_test<0)         y_test+=box_size;
                if(y_test>=box_size) y_test-=box_size;
                if(z_test<0)         z_test+=box_size;
                if(z_test>=box_size) z_test-=box_size;
-               if(x_test>=slab->x_min_local && x_test<slab->x_max_local){
-                  x_array[i_type][type_counter[i_type]]=x_test;
-                  y_array[i_type][type_counter[i_type]]=y_test;
-                  z_array[i_type][type_counter[i_type]]=z_test;
+               if(x_test>=slab->x_min_local && x_test<slab->x_max_local &&
+                  y_test>=slab->y_min_local && y_test<slab->y_max_local){
+                  x_array[i_type][type_counter[i_type]] =x_test;
+                  y_array[i_type][type_counter[i_type]] =y_test;
+                  z_array[i_type][type_counter[i_type]] =z_test;
+                  vx_array[i_type][type_counter[i_type]]=vel_buffer[index+0];
+                  vy_array[i_type][type_counter[i_type]]=vel_buffer[index+1];
+                  vz_array[i_type][type_counter[i_type]]=vel_buffer[index+2];
                   type_counter[i_type]++;
                }
             }
@@ -351,11 +298,6 @@ void read_gadget_binary_local(char       *filename_root_in,
       if(n_files>1)
          SID_log("Done.",SID_LOG_CLOSE);
     }
-    if(i_coord>0){
-       SID_Allreduce(SID_IN_PLACE,&d_bar,1,SID_DOUBLE,SID_SUM,SID.COMM_WORLD);
-       d_bar/=(double)n_particles_all;
-       SID_log("(d_bar=%.2lf [Mpc/h])...",SID_LOG_CONTINUE,d_bar);
-    }
     SID_free(SID_FARG pos_buffer);
     SID_free(SID_FARG vel_buffer);
     SID_log("Done.",SID_LOG_CLOSE);
@@ -390,6 +332,9 @@ void read_gadget_binary_local(char       *filename_root_in,
         ADaPS_store(&(plist->data),(void *)x_array[i_type],"x_%s",ADaPS_DEFAULT,pname[i_type]);
         ADaPS_store(&(plist->data),(void *)y_array[i_type],"y_%s",ADaPS_DEFAULT,pname[i_type]);
         ADaPS_store(&(plist->data),(void *)z_array[i_type],"z_%s",ADaPS_DEFAULT,pname[i_type]);
+        ADaPS_store(&(plist->data),(void *)vx_array[i_type],"vx_%s",ADaPS_DEFAULT,pname[i_type]);
+        ADaPS_store(&(plist->data),(void *)vy_array[i_type],"vy_%s",ADaPS_DEFAULT,pname[i_type]);
+        ADaPS_store(&(plist->data),(void *)vz_array[i_type],"vz_%s",ADaPS_DEFAULT,pname[i_type]);
       }
     }
     SID_log("Done.",SID_LOG_CLOSE);
@@ -454,7 +399,7 @@ int main(int argc, char *argv[]){
   strcpy(filename_out_root, argv[3]);
   grid_size      =(int)atoi(argv[4]);
   strcpy(cosmo_name,        argv[5]);
-  if(argc==7){
+  if(argc>=7){
      if(!strcmp(argv[6],"ngp") || !strcmp(argv[6],"NGP"))
         distribution_scheme=MAP2GRID_DIST_NGP;
      else if(!strcmp(argv[6],"cic") || !strcmp(argv[6],"CIC"))
@@ -468,6 +413,25 @@ int main(int argc, char *argv[]){
      else
         SID_trap_error("Invalid distribution scheme {%s} specified.",ERROR_SYNTAX,argv[6]);
   }
+  int flag_interlace =FALSE;
+  int flag_multipoles=FALSE;
+  int field_mode     =FIELD_MODE_DEFAULT;
+  int i_arg;
+  for(i_arg=7;i_arg<argc;i_arg++){
+     if(!strcmp(argv[i_arg],"interlace"))
+        flag_interlace=TRUE;
+     else if(!strcmp(argv[i_arg],"multipoles"))
+        flag_multipoles=TRUE;
+     else if(!strcmp(argv[i_arg],"pencil"))
+        field_mode=FIELD_MODE_PENCIL;
+     else if(!strcmp(argv[i_arg],"measure"))
+        set_FFT_plan_mode(FFT_PLAN_MEASURE);
+     else
+        SID_trap_error("Invalid option {%s} specified.",ERROR_SYNTAX,argv[i_arg]);
+  }
+
+  // FFT plans are measured (and quick to make) if wisdom from earlier runs is found
+  read_FFT_wisdom(FFT_WISDOM_FILENAME_DEFAULT);
   SID_log("Processing the power spectra of {%s}, snapshot #%d...",SID_LOG_OPEN|SID_LOG_TIMER,filename_in_root,snapshot_number);
 
   // Initialization -- fetch header info
@@ -528,7 +492,10 @@ int main(int argc, char *argv[]){
                 distribution_scheme,
                 redshift,box_size,grid_size,
                 k_min_1D,k_max_1D,dk_1D,
-                k_min_2D,k_max_2D,dk_2D);
+                k_min_2D,k_max_2D,dk_2D,
+                field_mode);
+     pspec[i_species].flag_interlace =flag_interlace;
+     pspec[i_species].flag_multipoles=flag_multipoles;
      if(i_species>0) SID_set_verbosity(SID_SET_VERBOSITY_DEFAULT);
      n_total+=n_all[i_species];
   }
@@ -536,11 +503,25 @@ int main(int argc, char *argv[]){
   // Only process a species if there are >0 particles present
   if(n_total>0){
 
-     // Loop over ithe real-space and 3 redshift-space frames
-     int i_run;
-     for(i_run=0;i_run<4;i_run++){
-
-        // Read catalog
+     // Initialization -- data structure which holds all   
+     //                   the (local) particle information  
+     init_plist(&plist,&(pspec[0].FFT.slab),GADGET_LENGTH,GADGET_MASS,GADGET_VELOCITY);
+
+     // Initialization -- read gadget file (once, for all four frames)
+     read_gadget_binary_local(filename_in_root,
+                              snapshot_number,
+                              &(pspec[0].FFT.slab),
+                              cosmo,
+                              &plist);
+
+     // Loop over the real-space and 3 redshift-space frames.  Each
+     //   redshift-space frame is displaced in place and then restored.
+     //   The x frame moves particles between slabs, so it is done last
+     //   and left displaced.
+     int i_run_order[]={0,2,3,1};
+     int i_order;
+     for(i_order=0;i_order<4;i_order++){
+        int i_run=i_run_order[i_order];
         switch(i_run){
         case 0:
            SID_log("Processing real-space ...",SID_LOG_OPEN|SID_LOG_TIMER);
@@ -556,38 +537,34 @@ int main(int argc, char *argv[]){
            break;
         }
 
-        // Initialization -- data structure which holds all   
-        //                   the (local) particle information  
-        init_plist(&plist,&(pspec[0].FFT.slab),GADGET_LENGTH,GADGET_MASS,GADGET_VELOCITY);
-
-        // Initialization -- read gadget file
-        char filename_root[MAX_FILENAME_LENGTH];
-        read_gadget_binary_local(filename_in_root,
-                                 snapshot_number,
-                                 i_run,
-                                 &(pspec[0].FFT.slab),
-                                 cosmo,
-                                 &plist);
-
         // Generate power spectra
         for(i_species=0;i_species<plist.n_species;i_species++){
-
-           // Compute power spectrum and write results
            if(n_all[i_species]>0){
-              compute_pspec(&plist,plist.species[i_species],&(pspec[i_species]),i_run);
-              char filename_out_species[MAX_FILENAME_LENGTH];
-              SID_log("Writing results for the %s particles...",SID_LOG_OPEN,plist.species[i_species]);
-              sprintf(filename_out_species,"%s_%s",filename_out_root,plist.species[i_species]);
-              write_pspec(&(pspec[i_species]),filename_out_species,&plist,plist.species[i_species]);
-              SID_log("Done.",SID_LOG_CLOSE);
+              char *species_i=plist.species[i_species];
+              if(i_run>0)
+                 apply_zspace_plist(&plist,species_i,i_run-1,box_size,redshift,cosmo,&(pspec[0].FFT.slab));
+              compute_pspec(&plist,species_i,&(pspec[i_species]),i_run);
+              if(i_run>0 && i_order<3)
+                 restore_zspace_plist(&plist,species_i,&(pspec[0].FFT.slab));
            }
         }
 
-        // Clean-up
-        free_plist(&plist);
-
         SID_log("Done.",SID_LOG_CLOSE);
      }
+
+     // Write results
+     for(i_species=0;i_species<plist.n_species;i_species++){
+        if(n_all[i_species]>0){
+           char filename_out_species[MAX_FILENAME_LENGTH];
+           SID_log("Writing results for the %s particles...",SID_LOG_OPEN,plist.species[i_species]);
+           sprintf(filename_out_species,"%s_%s",filename_out_root,plist.species[i_species]);
+           write_pspec(&(pspec[i_species]),filename_out_species,&plist,plist.species[i_species]);
+           SID_log("Done.",SID_LOG_CLOSE);
+        }
+     }
+
+     // Clean-up
+     free_plist(&plist);
   } 
 
   // Clean-up
@@ -596,6 +573,9 @@ int main(int argc, char *argv[]){
   for(i_species=0;i_species<N_GADGET_TYPE;i_species++)
      free_pspec(&(pspec[i_species]));
   SID_free(SID_FARG pspec);
+  // Keep any wisdom gathered for later runs
+  write_FFT_wisdom(FFT_WISDOM_FILENAME_DEFAULT);
+  free_FFT_plan_cache();
   SID_log("Done.",SID_LOG_CLOSE);
 
   SID_log("Done.",SID_LOG_CLOSE);
@@ -70,6 +70,9 @@ int main(int argc, char *argv[]){
    i_grouping_start =(int)   atoi(argv[7]);
    i_grouping_stop  =(int)   atoi(argv[8]);
 
+   // FFT plans are measured (and quick to make) if wisdom from earlier runs is found
+   read_FFT_wisdom(FFT_WISDOM_FILENAME_DEFAULT);
+
    // Sanity check
    int n_groupings;
    n_groupings=i_grouping_stop-i_grouping_start+1;
@@ -98,38 +101,41 @@ int main(int argc, char *argv[]){
  	         MAP2GRID_DIST_DWT20,
              redshift,box_size,grid_size,
              k_min_1D,k_max_1D,dk_1D,
-             k_min_2D,k_max_2D,dk_2D);
+             k_min_2D,k_max_2D,dk_2D,
+             FIELD_MODE_DEFAULT);
  
    // Process each grouping in turn
    for(i_grouping=i_grouping_start;i_grouping<=i_grouping_stop;i_grouping++){
       SID_log("Processing grouping #%03d...",SID_LOG_OPEN|SID_LOG_TIMER,i_grouping);
   
-      // Loop over ithe real-space and 3 redshift-space frames
+      // Read catalog (once, for all four frames)
+      read_groupings(filename_in_root,i_grouping,&plist,READ_GROUPING_DEFAULT,&(pspec.FFT.slab));
+
+      // Loop over the real-space and 3 redshift-space frames.  Each
+      //   redshift-space frame is displaced in place and then restored.
       int i_run;
       for(i_run=0;i_run<4;i_run++){
-  
-         // Read catalog
          switch(i_run){
          case 0:
             SID_log("Processing real-space ...",SID_LOG_OPEN|SID_LOG_TIMER);
-            read_groupings(filename_in_root,i_grouping,&plist,READ_GROUPING_DEFAULT,&(pspec.FFT.slab));
             break;
          case 1:
             SID_log("Processing v_x redshift space...",SID_LOG_OPEN|SID_LOG_TIMER);
-            read_groupings(filename_in_root,i_grouping,&plist,READ_GROUPING_DEFAULT|READ_GROUPING_ADD_VX,&(pspec.FFT.slab),box_size,redshift,pspec.cosmo);
             break;
          case 2:
             SID_log("Processing v_y redshift space...",SID_LOG_OPEN|SID_LOG_TIMER);
-            read_groupings(filename_in_root,i_grouping,&plist,READ_GROUPING_DEFAULT|READ_GROUPING_ADD_VY,&(pspec.FFT.slab),box_size,redshift,pspec.cosmo);
             break;
          case 3:
             SID_log("Processing v_z redsift space...",SID_LOG_OPEN|SID_LOG_TIMER);
-            read_groupings(filename_in_root,i_grouping,&plist,READ_GROUPING_DEFAULT|READ_GROUPING_ADD_VZ,&(pspec.FFT.slab),box_size,redshift,pspec.cosmo);
             break;
          }
+         if(i_run>0)
+            apply_zspace_plist(&plist,"halos",i_run-1,box_size,redshift,pspec.cosmo,&(pspec.FFT.slab));
   
          // Compute power spectrum
          compute_pspec(&plist,"halos",&pspec,i_run);
+         if(i_run>0)
+            restore_zspace_plist(&plist,"halos",&(pspec.FFT.slab));
   
          SID_log("Done.",SID_LOG_CLOSE);
       } // Loop over 4 P(k)'s
@@ -144,6 +150,9 @@ int main(int argc, char *argv[]){
  
    // Clean-up
    free_pspec(&pspec);
+   // Keep any wisdom gathered for later runs
+   write_FFT_wisdom(FFT_WISDOM_FILENAME_DEFAULT);
+   free_FFT_plan_cache();
  
    SID_log("Done.",SID_LOG_CLOSE);
    SID_exit(ERROR_NONE);
@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <gbpLib.h>
+#include <gbpMath.h>
+#include <gbpClustering.h>
+
+// Map planes i_x_start to i_x_start+n_x-1 of grid i_grid of a file
+//   opened with open_grid_file() into memory (read-only) and return
+//   a pointer to the first.  Any slab mapped by a previous call is
+//   unmapped, so only one slab of a file is held at a time and grids
+//   much larger than memory can be streamed through.  The grid's
+//   identifier is returned too if grid_identifier is not NULL.
+GBPREAL *map_grid_slab(grid_file_info *grid_file,int i_grid,int i_x_start,int n_x,char *grid_identifier){
+  if(i_grid<0 || i_grid>=grid_file->n_grids)
+     SID_trap_error("Invalid grid {%d} requested from a file with %d grids.",ERROR_LOGIC,i_grid,grid_file->n_grids);
+  if(i_x_start<0 || n_x<1 || (i_x_start+n_x)>grid_file->n[0])
+     SID_trap_error("Invalid slab {%d,%d} requested from a grid with %d planes.",ERROR_LOGIC,i_x_start,n_x,grid_file->n[0]);
+
+  if(grid_identifier!=NULL){
+     if(pread(grid_file->fd,grid_identifier,GRID_IDENTIFIER_SIZE,(off_t)(grid_file->offset[i_grid]-GRID_IDENTIFIER_SIZE))!=GRID_IDENTIFIER_SIZE)
+        SID_trap_error("Could not read the identifier of grid {%d}.",ERROR_IO_READ,i_grid);
+     grid_identifier[GRID_IDENTIFIER_SIZE-1]='\0';
+  }
+
+  // Mappings must start on a page boundary
+  if(grid_file->map!=NULL)
+     munmap(grid_file->map,grid_file->map_size);
+  size_t offset     =grid_file->offset[i_grid]+(size_t)i_x_start*grid_file->plane_size;
+  size_t page_size  =(size_t)sysconf(_SC_PAGESIZE);
+  size_t offset_page=offset-(offset%page_size);
+  grid_file->map_size=(offset-offset_page)+(size_t)n_x*grid_file->plane_size;
+  grid_file->map     =mmap(NULL,grid_file->map_size,PROT_READ,MAP_SHARED,grid_file->fd,(off_t)offset_page);
+  if(grid_file->map==MAP_FAILED){
+     grid_file->map=NULL;
+     SID_trap_error("Could not map planes %d to %d of grid {%d}.",ERROR_IO_READ,i_x_start,i_x_start+n_x-1,i_grid);
+  }
+  madvise(grid_file->map,grid_file->map_size,MADV_SEQUENTIAL);
+  return((GBPREAL *)((char *)grid_file->map+(offset-offset_page)));
+}
@@ -1,10 +1,414 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <gbpLib.h>
 #include <gbpMath.h>
 #include <gbpCosmo.h>
 #include <gbpSPH.h>
 #include <gbpClustering.h>
+#if USE_OPENMP
+  #include <omp.h>
+#endif
+
+// Largest number of grid points (per dimension) spanned by any assignment
+//   kernel (D20, with one more for interlacing)
+#define MAP2GRID_N_STENCIL_MAX 11
+
+// Everything needed to assign a particle to the grid
+typedef struct map_to_grid_kernel_local_info map_to_grid_kernel_local_info;
+struct map_to_grid_kernel_local_info{
+  int         distribution_scheme;
+  int         W_search_lo;
+  int         W_search_hi;
+  double      kernal_offset;
+  GBPREAL     grid_shift;   // Shift (in cells) applied to particle positions
+  GBPREAL    *x_particles_local;
+  GBPREAL    *y_particles_local;
+  GBPREAL    *z_particles_local;
+  GBPREAL    *v_particles_local;
+  GBPREAL    *w_particles_local;
+  field_info *field;
+  field_info *field_norm;
+  GBPREAL    *send_left;
+  GBPREAL    *send_right;
+  GBPREAL    *send_left_norm;
+  GBPREAL    *send_right_norm;
+  // Pencils are assigned to a grid with n_x_grid x n_y_grid rows,
+  //   starting at global indices (i_x_grid,i_y_grid), which holds the
+  //   pencil and the ghost planes and rows either side of it
+  int         flag_pencil;
+  int         i_x_grid;
+  int         i_y_grid;
+  int         n_x_grid;
+  int         n_y_grid;
+  GBPREAL    *grid;
+  GBPREAL    *grid_norm;
+};
+
+// Compute a particle's 1D kernel weights W[j] at the grid points
+//   i_i-W_search_lo+j.  The points with support are [*j_start,*j_stop].
+void map_to_grid_weights_local(map_to_grid_kernel_local_info *kernel,interp_info *W_r_Daub_interp,
+                               GBPREAL x_particle,int i_i,double *W,int *j_start,int *j_stop);
+void map_to_grid_weights_local(map_to_grid_kernel_local_info *kernel,interp_info *W_r_Daub_interp,
+                               GBPREAL x_particle,int i_i,double *W,int *j_start,int *j_stop){
+  int     n_W=kernel->W_search_lo+kernel->W_search_hi+1;
+  int     j;
+  GBPREAL x_i;
+  (*j_start)=n_W;
+  (*j_stop) =-1;
+  switch(kernel->distribution_scheme){
+    // Distribute with a Daubechies wavelet transform of 12th or 20th order a la Cui et al '08
+    case MAP2GRID_DIST_DWT12:
+    case MAP2GRID_DIST_DWT20:
+      for(j=0;j<n_W;j++){
+        x_i=(GBPREAL)(i_i+j-kernel->W_search_lo)-x_particle;
+        double x_i_effective=x_i+kernel->kernal_offset;
+        if(x_i_effective>0.){
+          W[j]=interpolate(W_r_Daub_interp,x_i_effective);
+          (*j_start)=MIN(*j_start,j);
+          (*j_stop) =j;
+        }
+      }
+      break;
+    // Distribute using the triangular shaped cloud (TSC) method
+    case MAP2GRID_DIST_TSC:
+      for(j=0;j<n_W;j++){
+        x_i=(GBPREAL)(i_i+j-kernel->W_search_lo)-x_particle;
+        if(fabs(x_i)<0.5)
+          W[j]=(0.75-x_i*x_i);
+        else if(fabs(x_i)<1.5)
+          W[j]=0.5*(1.5-fabs(x_i))*(1.5-fabs(x_i));
+        else
+          continue;
+        (*j_start)=MIN(*j_start,j);
+        (*j_stop) =j;
+      }
+      break;
+    // Distribute using the cloud-in-cell (CIC) method
+    case MAP2GRID_DIST_CIC:
+      for(j=0;j<n_W;j++){
+        x_i=(GBPREAL)(i_i+j-kernel->W_search_lo)-x_particle;
+        if(fabs(x_i)<1.){
+          W[j]=(1.-fabs(x_i));
+          (*j_start)=MIN(*j_start,j);
+          (*j_stop) =j;
+        }
+      }
+      break;
+    // Distribute using "nearest grid point" (NGP; ie. the simplest and default) method
+    case MAP2GRID_DIST_NGP:
+    default:
+      for(j=0;j<n_W;j++){
+        x_i=(GBPREAL)(i_i+j-kernel->W_search_lo)-x_particle;
+        if(fabs(x_i)<=0.5){
+          W[j]      =1.;
+          (*j_start)=j;
+          (*j_stop) =j;
+          break;
+        }
+      }
+      break;
+  }
+}
+
+// Add the kernel-weighted contribution of one particle to a plane of
+//   the grid (or of a slab buffer)
+#define MAP2GRID_ADD_PLANE_LOCAL(array,array_norm,i_plane) \
+  for(j_y=j_start[1];j_y<=j_stop[1];j_y++){ \
+    double W_xy   =W_x*W[1][j_y]; \
+    size_t index_y=((size_t)(i_plane)*n_y+k_y[j_y])*n_z; \
+    for(j_z=j_start[2];j_z<=j_stop[2];j_z++){ \
+      double W_i=W_xy*W[2][j_z]; \
+      (array)[index_y+k_z[j_z]]+=W_i*value_i; \
+      if(field_norm!=NULL) \
+        (array_norm)[index_y+k_z[j_z]]+=W_i*norm_i; \
+    } \
+  }
+
+// Assign particle i_p to the grid.  The 1D kernel weights are computed
+//   once per dimension and their products are scattered to the grid
+//   points with support.  Points beyond the local slab go to the slab
+//   buffers; for pencils, everything goes to the ghost-padded grid.
+void map_to_grid_particle_local(map_to_grid_kernel_local_info *kernel,interp_info *W_r_Daub_interp,size_t i_p);
+void map_to_grid_particle_local(map_to_grid_kernel_local_info *kernel,interp_info *W_r_Daub_interp,size_t i_p){
+  field_info *field     =kernel->field;
+  field_info *field_norm=kernel->field_norm;
+  int         W_search_lo=kernel->W_search_lo;
+  int         W_search_hi=kernel->W_search_hi;
+  double      W[3][MAP2GRID_N_STENCIL_MAX];
+  int         j_start[3];
+  int         j_stop[3];
+  int         i_i[3];
+  GBPREAL     x_particle_i[3];
+  size_t      k_y[MAP2GRID_N_STENCIL_MAX];
+  size_t      k_z[MAP2GRID_N_STENCIL_MAX];
+  size_t      n_y=(size_t)(kernel->flag_pencil?kernel->n_y_grid:field->n_R_local[1]);
+  size_t      n_z=(size_t)field->n_R_local[2];
+  int         i_coord;
+  int         j_x;
+  int         j_y;
+  int         j_z;
+  double      v_p=1.;
+  double      w_p=1.;
+  double      norm_i;
+  double      value_i;
+  if(kernel->v_particles_local!=NULL)
+    v_p=(double)(kernel->v_particles_local[i_p]);
+  if(kernel->w_particles_local!=NULL)
+    w_p=(double)(kernel->w_particles_local[i_p]);
+  norm_i =w_p;
+  value_i=v_p*norm_i;
+
+  // Quantize the particle's position onto the grid
+  x_particle_i[0]=(GBPREAL)kernel->x_particles_local[i_p]/(GBPREAL)field->dR[0]+kernel->grid_shift;
+  x_particle_i[1]=(GBPREAL)kernel->y_particles_local[i_p]/(GBPREAL)field->dR[1]+kernel->grid_shift;
+  x_particle_i[2]=(GBPREAL)kernel->z_particles_local[i_p]/(GBPREAL)field->dR[2]+kernel->grid_shift;
+  for(i_coord=0;i_coord<3;i_coord++){
+    i_i[i_coord]=(int)x_particle_i[i_coord]; // position in grid-coordinates
+    map_to_grid_weights_local(kernel,W_r_Daub_interp,x_particle_i[i_coord],i_i[i_coord],W[i_coord],&(j_start[i_coord]),&(j_stop[i_coord]));
+    if(j_start[i_coord]>j_stop[i_coord])
+      return;
+  }
+
+  // Set the periodic y and z grid indices (y is not periodic within a pencil's grid)
+  for(j_y=j_start[1];j_y<=j_stop[1];j_y++){
+    int k_i=i_i[1]+j_y-W_search_lo;
+    if(kernel->flag_pencil){
+      k_i-=kernel->i_y_grid;
+      if(k_i<0 || k_i>=kernel->n_y_grid)
+        SID_trap_error("Pencil buffer limit exceeded in y by %d element(s).",ERROR_LOGIC,
+                       (k_i<0?-k_i:k_i-kernel->n_y_grid+1));
+    }
+    else if(k_i<0)
+      k_i+=field->n[1];
+    else
+      k_i=k_i%field->n[1];
+    k_y[j_y]=(size_t)k_i;
+  }
+  for(j_z=j_start[2];j_z<=j_stop[2];j_z++){
+    int k_i=i_i[2]+j_z-W_search_lo;
+    if(k_i<0)
+      k_i+=field->n[2];
+    else
+      k_i=k_i%field->n[2];
+    k_z[j_z]=(size_t)k_i;
+  }
+
+  // Pencils take every contribution in their grid ...
+  if(kernel->flag_pencil){
+    for(j_x=j_start[0];j_x<=j_stop[0];j_x++){
+      double W_x=W[0][j_x];
+      int    k_x=i_i[0]+j_x-W_search_lo-kernel->i_x_grid;
+      if(k_x<0 || k_x>=kernel->n_x_grid)
+        SID_trap_error("Pencil buffer limit exceeded in x by %d element(s).",ERROR_LOGIC,
+                       (k_x<0?-k_x:k_x-kernel->n_x_grid+1));
+      MAP2GRID_ADD_PLANE_LOCAL(kernel->grid,kernel->grid_norm,k_x);
+    }
+    return;
+  }
+
+  // ... and slabs add it to the local array or to the slab buffers, depending on x-index
+  for(j_x=j_start[0];j_x<=j_stop[0];j_x++){
+    double W_x=W[0][j_x];
+    int    k_x=i_i[0]+j_x-W_search_lo;
+    if(k_x<field->i_R_start_local[0]){
+      k_x-=(field->i_R_start_local[0]-W_search_lo);
+      if(k_x<0)
+        SID_trap_error("Left slab buffer limit exceeded by %d element(s).",ERROR_LOGIC,-k_x);
+      MAP2GRID_ADD_PLANE_LOCAL(kernel->send_left,kernel->send_left_norm,k_x);
+    }
+    else if(k_x>field->i_R_stop_local[0]){
+      k_x-=(field->i_R_stop_local[0]+1);
+      if(k_x>=W_search_hi)
+        SID_trap_error("Right slab buffer limit exceeded by %d element(s).",ERROR_LOGIC,k_x-W_search_hi+1);
+      MAP2GRID_ADD_PLANE_LOCAL(kernel->send_right,kernel->send_right_norm,k_x);
+    }
+    else{
+      k_x-=field->i_R_start_local[0];
+      MAP2GRID_ADD_PLANE_LOCAL(field->field_local,field_norm->field_local,k_x);
+    }
+  }
+}
+#undef MAP2GRID_ADD_PLANE_LOCAL
+
+// Returns the block of x-planes holding particle i_p
+int map_to_grid_block_local(map_to_grid_kernel_local_info *kernel,size_t i_p,int i_plane_lo,int n_block,int n_blocks);
+int map_to_grid_block_local(map_to_grid_kernel_local_info *kernel,size_t i_p,int i_plane_lo,int n_block,int n_blocks){
+  int i_plane=(int)((GBPREAL)kernel->x_particles_local[i_p]/(GBPREAL)kernel->field->dR[0]+kernel->grid_shift)-i_plane_lo;
+  return(MAX(0,MIN(n_blocks-1,MAX(0,i_plane)/n_block)));
+}
+
+// Assign the listed particles to the grid.  With one thread they are
+//   done in order.  With more, they are sorted into blocks of x-planes,
+//   each wider than the kernel.  Particles in alternate blocks then
+//   never touch the same grid points (or slab buffer elements), so the
+//   even blocks and then the odd blocks can each be shared amongst the
+//   threads without locks.  Any slab buffer exchanges given are tested
+//   now and then so that MPI can progress them in the meantime.
+void map_to_grid_particles_local(map_to_grid_kernel_local_info *kernel,
+                                 interp_info                  **W_r_Daub_interp_thread,
+                                 int                            n_threads,
+                                 size_t                        *particle_list,
+                                 size_t                         n_list,
+                                 slab_exchange_info            *exchange,
+                                 int                            n_exchange,
+                                 pcounter_info                 *pcounter,
+                                 size_t                        *i_counter);
+void map_to_grid_particles_local(map_to_grid_kernel_local_info *kernel,
+                                 interp_info                  **W_r_Daub_interp_thread,
+                                 int                            n_threads,
+                                 size_t                        *particle_list,
+                                 size_t                         n_list,
+                                 slab_exchange_info            *exchange,
+                                 int                            n_exchange,
+                                 pcounter_info                 *pcounter,
+                                 size_t                        *i_counter){
+  size_t i_list;
+  int    i_exchange;
+  if(n_threads==1){
+    for(i_list=0;i_list<n_list;i_list++){
+      map_to_grid_particle_local(kernel,W_r_Daub_interp_thread[0],particle_list[i_list]);
+      if((i_list%4096)==4095){
+        for(i_exchange=0;i_exchange<n_exchange;i_exchange++)
+          test_exchange_slab_buffers(&(exchange[i_exchange]));
+      }
+      // Report the calculation's progress
+      SID_check_pcounter(pcounter,(*i_counter)++);
+    }
+  }
+#if USE_OPENMP
+  else{
+    field_info *field      =kernel->field;
+    int         W_search_lo=kernel->W_search_lo;
+    int         W_search_hi=kernel->W_search_hi;
+    int         i_plane_lo =field->i_R_start_local[0]-W_search_lo;
+    int         n_planes   =field->n_R_local[0]+W_search_lo+W_search_hi;
+    int         n_block    =MAX(W_search_lo+W_search_hi+1,n_planes/(8*n_threads));
+    int         n_blocks   =(n_planes+n_block-1)/n_block;
+    int         i_block;
+    size_t     *block_start=(size_t *)SID_calloc(sizeof(size_t)*(n_blocks+1));
+    size_t     *block_order=(size_t *)SID_malloc(sizeof(size_t)*MAX(1,n_list));
+    for(i_list=0;i_list<n_list;i_list++)
+      block_start[map_to_grid_block_local(kernel,particle_list[i_list],i_plane_lo,n_block,n_blocks)+1]++;
+    for(i_block=0;i_block<n_blocks;i_block++)
+      block_start[i_block+1]+=block_start[i_block];
+    size_t *block_next=(size_t *)SID_malloc(sizeof(size_t)*n_blocks);
+    memcpy(block_next,block_start,sizeof(size_t)*n_blocks);
+    for(i_list=0;i_list<n_list;i_list++)
+      block_order[block_next[map_to_grid_block_local(kernel,particle_list[i_list],i_plane_lo,n_block,n_blocks)]++]=particle_list[i_list];
+    SID_free(SID_FARG block_next);
+
+    #pragma omp parallel num_threads(n_threads) private(i_block)
+    {
+      interp_info *W_r_Daub_interp_i=W_r_Daub_interp_thread[omp_get_thread_num()];
+      int          i_parity;
+      for(i_parity=0;i_parity<2;i_parity++){
+        // (the implied barrier at the end of each pass keeps the two apart)
+        #pragma omp for schedule(dynamic,1)
+        for(i_block=i_parity;i_block<n_blocks;i_block+=2){
+          size_t i_order;
+          for(i_order=block_start[i_block];i_order<block_start[i_block+1];i_order++)
+            map_to_grid_particle_local(kernel,W_r_Daub_interp_i,block_order[i_order]);
+        }
+        #pragma omp master
+        {
+          int j_exchange;
+          for(j_exchange=0;j_exchange<n_exchange;j_exchange++)
+            test_exchange_slab_buffers(&(exchange[j_exchange]));
+        }
+      }
+    }
+    SID_free(SID_FARG block_start);
+    SID_free(SID_FARG block_order);
+    (*i_counter)+=n_list;
+  }
+#endif
+}
+
+// Finish a pencil's exchange of ghost planes (in x) and add what it
+//   receives to the planes at either end of the pencil.  Then exchange
+//   the ghost rows (in y) of its planes, which now include what the
+//   planes brought from the corners, and add those too.  The pencil is
+//   finally added to the (unpadded) field.
+void add_pencil_ghosts_local(field_info         *field,
+                             GBPREAL            *grid,
+                             GBPREAL            *receive_left,
+                             GBPREAL            *receive_right,
+                             slab_exchange_info *exchange,
+                             int                 W_search_lo,
+                             int                 W_search_hi);
+void add_pencil_ghosts_local(field_info         *field,
+                             GBPREAL            *grid,
+                             GBPREAL            *receive_left,
+                             GBPREAL            *receive_right,
+                             slab_exchange_info *exchange,
+                             int                 W_search_lo,
+                             int                 W_search_hi){
+  size_t W_lo     =(size_t)W_search_lo;
+  size_t W_hi     =(size_t)W_search_hi;
+  size_t n_x_local=(size_t)field->n_R_local[0];
+  size_t n_y_local=(size_t)field->n_R_local[1];
+  size_t n_z      =(size_t)field->n_R_local[2];
+  size_t n_y_grid =n_y_local+W_lo+W_hi;
+  size_t n_plane  =n_y_grid*n_z;
+  size_t i_b;
+  size_t i_x;
+  size_t i_y;
+  size_t i_z;
+
+  // The left pencil's right ghost planes go to the first planes of the
+  //   pencil and the right pencil's left ghost planes to its last
+  finish_exchange_slab_buffers(exchange);
+  GBPREAL *planes_lo=&(grid[W_lo*n_plane]);
+  GBPREAL *planes_hi=&(grid[n_x_local*n_plane]);
+  for(i_b=0;i_b<W_hi*n_plane;i_b++)
+    planes_lo[i_b]+=receive_left[i_b];
+  for(i_b=0;i_b<W_lo*n_plane;i_b++)
+    planes_hi[i_b]+=receive_right[i_b];
+
+  // Do the same with the ghost rows of each plane
+  size_t   n_rows_left    =n_x_local*W_lo*n_z;
+  size_t   n_rows_right   =n_x_local*W_hi*n_z;
+  GBPREAL *send_left      =(GBPREAL *)SID_malloc(sizeof(GBPREAL)*MAX(1,n_rows_left));
+  GBPREAL *send_right     =(GBPREAL *)SID_malloc(sizeof(GBPREAL)*MAX(1,n_rows_right));
+  GBPREAL *receive_left_y =(GBPREAL *)SID_malloc(sizeof(GBPREAL)*MAX(1,n_rows_right));
+  GBPREAL *receive_right_y=(GBPREAL *)SID_malloc(sizeof(GBPREAL)*MAX(1,n_rows_left));
+  for(i_x=0;i_x<n_x_local;i_x++){
+    GBPREAL *plane=&(grid[(W_lo+i_x)*n_plane]);
+    memcpy(&(send_left[i_x*W_lo*n_z]), plane,                           sizeof(GBPREAL)*W_lo*n_z);
+    memcpy(&(send_right[i_x*W_hi*n_z]),&(plane[(W_lo+n_y_local)*n_z]),sizeof(GBPREAL)*W_hi*n_z);
+  }
+  slab_exchange_info exchange_y;
+  start_exchange_slab_buffers(send_left,      sizeof(GBPREAL)*n_rows_left,
+                              receive_right_y,sizeof(GBPREAL)*n_rows_left,
+                              send_right,     sizeof(GBPREAL)*n_rows_right,
+                              receive_left_y, sizeof(GBPREAL)*n_rows_right,
+                              1,&(field->slab),&exchange_y);
+  finish_exchange_slab_buffers(&exchange_y);
+  for(i_x=0;i_x<n_x_local;i_x++){
+    GBPREAL *rows_lo=&(grid[(W_lo+i_x)*n_plane+W_lo*n_z]);
+    GBPREAL *rows_hi=&(grid[(W_lo+i_x)*n_plane+n_y_local*n_z]);
+    for(i_b=0;i_b<W_hi*n_z;i_b++)
+      rows_lo[i_b]+=receive_left_y[i_x*W_hi*n_z+i_b];
+    for(i_b=0;i_b<W_lo*n_z;i_b++)
+      rows_hi[i_b]+=receive_right_y[i_x*W_lo*n_z+i_b];
+  }
+  SID_free(SID_FARG send_left);
+  SID_free(SID_FARG send_right);
+  SID_free(SID_FARG receive_left_y);
+  SID_free(SID_FARG receive_right_y);
+
+  // Add the pencil to the field
+  for(i_x=0;i_x<n_x_local;i_x++){
+    for(i_y=0;i_y<n_y_local;i_y++){
+      GBPREAL *row      =&(grid[((W_lo+i_x)*n_y_grid+W_lo+i_y)*n_z]);
+      GBPREAL *row_field=&(field->field_local[(i_x*n_y_local+i_y)*n_z]);
+      for(i_z=0;i_z<n_z;i_z++)
+        row_field[i_z]+=row[i_z];
+    }
+  }
+}
 
 void map_to_grid(size_t      n_particles_local, 
                  GBPREAL    *x_particles_local,
@@ -23,18 +427,8 @@ void map_to_grid(size_t      n_particles_local,
   int         i_k;
   size_t      i_b;
   size_t      i_grid;
-  int         i_coord;
-  int         i_i[3];
-  int         j_i[3];
-  int         k_i[3];
   size_t      n_particles;
-  double      v_p;
-  double      w_p;
-  int         flag_valued_particles;
-  int         flag_weight_particles;
   int         flag_weight;
-  int         flag_active;
-  int         flag_viable;
   double      k_mag;
   double      dk;
   int         n_powspec;
@@ -50,15 +444,9 @@ void map_to_grid(size_t      n_particles_local,
   double      k_max;
   double      norm_local;
   double      normalization;
-  GBPREAL     x_i;
-  GBPREAL     x_particle_i;
-  GBPREAL     y_particle_i;
-  GBPREAL     z_particle_i;
-  double      kernal_offset;
+  double      kernal_offset=0.;
   int         W_search_lo;
   int         W_search_hi;
-  size_t      receive_left_size=0;
-  size_t      receive_right_size=0;
   size_t      index_best;
   int         n_buffer[3];
   size_t      n_send_left;
@@ -74,13 +462,12 @@ void map_to_grid(size_t      n_particles_local,
   GBPREAL    *receive_left_norm=NULL;
   GBPREAL    *receive_right_norm=NULL;
   double       r_i,r_min,r_i_max=0;
-  double       W_i;
   int          index_i;
   interp_info *P_k_interp;
-  double      *r_Daub;
-  double      *W_Daub;
+  double      *r_Daub=NULL;
+  double      *W_Daub=NULL;
   double       h_Hubble;
-  int          n_Daub;
+  int          n_Daub=0;
   interp_info *W_r_Daub_interp=NULL;
   int          i_rank;
   size_t       buffer_index;
@@ -116,18 +503,6 @@ void map_to_grid(size_t      n_particles_local,
   }
 
   // Set some variables
-  if(v_particles_local!=NULL)
-    flag_valued_particles=TRUE;
-  else{
-    flag_valued_particles=FALSE;
-    v_p=1.;
-  }
-  if(w_particles_local!=NULL)
-    flag_weight_particles=TRUE;
-  else{
-    flag_weight_particles=FALSE;
-    w_p=1.;
-  }
   h_Hubble=((double *)ADaPS_fetch(cosmo,"h_Hubble"))[0];
 
   // Initializing the mass assignment scheme
@@ -138,8 +513,6 @@ void map_to_grid(size_t      n_particles_local,
     kernal_offset=2.5;
     compute_Daubechies_scaling_fctns(20,5,&r_Daub,&W_Daub,&n_Daub);
     init_interpolate(r_Daub,W_Daub,n_Daub,gsl_interp_cspline,&W_r_Daub_interp);
-    SID_free(SID_FARG r_Daub);
-    SID_free(SID_FARG W_Daub);
     SID_log("(using D20 scale function kernal)...",SID_LOG_CONTINUE);
     break;
   case MAP2GRID_DIST_DWT12:
@@ -148,8 +521,6 @@ void map_to_grid(size_t      n_particles_local,
     kernal_offset=1.75;
     compute_Daubechies_scaling_fctns(12,5,&r_Daub,&W_Daub,&n_Daub);
     init_interpolate(r_Daub,W_Daub,(size_t)n_Daub,gsl_interp_cspline,&W_r_Daub_interp);
-    SID_free(SID_FARG r_Daub);
-    SID_free(SID_FARG W_Daub);
     SID_log("(using D12 scale function kernal)...",SID_LOG_CONTINUE);
     break;
   case MAP2GRID_DIST_TSC:
@@ -167,20 +538,54 @@ void map_to_grid(size_t      n_particles_local,
     break;
   }
 
-  // Initializing slab buffers
-  n_send_left    =(size_t)(field->n[0]*field->n[1]*W_search_lo);
-  n_send_right   =(size_t)(field->n[0]*field->n[1]*W_search_hi);
-  send_size_left =n_send_left *sizeof(GBPREAL);
-  send_size_right=n_send_right*sizeof(GBPREAL);
-  send_left      =(GBPREAL *)SID_calloc(send_size_left);
-  send_right     =(GBPREAL *)SID_calloc(send_size_right);
-  receive_left   =(GBPREAL *)SID_calloc(send_size_right);
-  receive_right  =(GBPREAL *)SID_calloc(send_size_left);
-  if(field_norm!=NULL){
-     send_left_norm      =(GBPREAL *)SID_calloc(send_size_left);
-     send_right_norm     =(GBPREAL *)SID_calloc(send_size_right);
-     receive_left_norm   =(GBPREAL *)SID_calloc(send_size_right);
-     receive_right_norm  =(GBPREAL *)SID_calloc(send_size_left);
+  // When interlacing, particles are shifted by half a cell along each
+  //   axis.  This can push them one plane further to the right.
+  GBPREAL grid_shift=0.;
+  if(check_mode_for_flag(mode,MAP2GRID_MODE_INTERLACE)){
+    grid_shift=0.5;
+    W_search_hi++;
+    SID_log("(interlaced)...",SID_LOG_CONTINUE);
+  }
+
+  // Initializing slab buffers.  Pencils instead get a grid that holds
+  //   their ghost planes and rows; its end planes are sent directly.
+  int      flag_pencil=field->flag_pencil;
+  int      n_x_grid   =field->n_R_local[0]+W_search_lo+W_search_hi;
+  int      n_y_grid   =field->n_R_local[1]+W_search_lo+W_search_hi;
+  size_t   n_plane    =(size_t)n_y_grid*(size_t)field->n_R_local[2];
+  GBPREAL *grid       =NULL;
+  GBPREAL *grid_norm  =NULL;
+  if(flag_pencil){
+     if(MIN(field->n_R_local[0],field->n_R_local[1])<MAX(W_search_lo,W_search_hi))
+        SID_trap_error("Pencils must be at least %d cells across for this kernel.",ERROR_LOGIC,MAX(W_search_lo,W_search_hi));
+     n_send_left    =n_plane*(size_t)W_search_lo;
+     n_send_right   =n_plane*(size_t)W_search_hi;
+     send_size_left =n_send_left *sizeof(GBPREAL);
+     send_size_right=n_send_right*sizeof(GBPREAL);
+     grid           =(GBPREAL *)SID_calloc(sizeof(GBPREAL)*n_plane*(size_t)n_x_grid);
+     receive_left   =(GBPREAL *)SID_calloc(send_size_right);
+     receive_right  =(GBPREAL *)SID_calloc(send_size_left);
+     if(field_norm!=NULL){
+        grid_norm         =(GBPREAL *)SID_calloc(sizeof(GBPREAL)*n_plane*(size_t)n_x_grid);
+        receive_left_norm =(GBPREAL *)SID_calloc(send_size_right);
+        receive_right_norm=(GBPREAL *)SID_calloc(send_size_left);
+     }
+  }
+  else{
+     n_send_left    =(size_t)(field->n[0]*field->n[1]*W_search_lo);
+     n_send_right   =(size_t)(field->n[0]*field->n[1]*W_search_hi);
+     send_size_left =n_send_left *sizeof(GBPREAL);
+     send_size_right=n_send_right*sizeof(GBPREAL);
+     send_left      =(GBPREAL *)SID_calloc(send_size_left);
+     send_right     =(GBPREAL *)SID_calloc(send_size_right);
+     receive_left   =(GBPREAL *)SID_calloc(send_size_right);
+     receive_right  =(GBPREAL *)SID_calloc(send_size_left);
+     if(field_norm!=NULL){
+        send_left_norm      =(GBPREAL *)SID_calloc(send_size_left);
+        send_right_norm     =(GBPREAL *)SID_calloc(send_size_right);
+        receive_left_norm   =(GBPREAL *)SID_calloc(send_size_right);
+        receive_right_norm  =(GBPREAL *)SID_calloc(send_size_left);
+     }
   }
 
   // Clear the field
@@ -200,174 +605,138 @@ void map_to_grid(size_t      n_particles_local,
   // Create the mass distribution
   SID_log("Performing grid assignment...",SID_LOG_OPEN|SID_LOG_TIMER);
 
-  // Loop over all the objects
+  // Set-up the assignment kernel
+  map_to_grid_kernel_local_info kernel;
+  kernel.distribution_scheme=distribution_scheme;
+  kernel.W_search_lo        =W_search_lo;
+  kernel.W_search_hi        =W_search_hi;
+  kernel.kernal_offset      =kernal_offset;
+  kernel.grid_shift         =grid_shift;
+  kernel.x_particles_local  =x_particles_local;
+  kernel.y_particles_local  =y_particles_local;
+  kernel.z_particles_local  =z_particles_local;
+  kernel.v_particles_local  =v_particles_local;
+  kernel.w_particles_local  =w_particles_local;
+  kernel.field              =field;
+  kernel.field_norm         =field_norm;
+  kernel.send_left          =send_left;
+  kernel.send_right         =send_right;
+  kernel.send_left_norm     =send_left_norm;
+  kernel.send_right_norm    =send_right_norm;
+  kernel.flag_pencil        =flag_pencil;
+  kernel.i_x_grid           =field->i_R_start_local[0]-W_search_lo;
+  kernel.i_y_grid           =field->i_R_start_local[1]-W_search_lo;
+  kernel.n_x_grid           =n_x_grid;
+  kernel.n_y_grid           =n_y_grid;
+  kernel.grid               =grid;
+  kernel.grid_norm          =grid_norm;
+
+  // Each thread needs its own interpolation object for the Daubechies kernels
+  int n_threads=1;
+#if USE_OPENMP
+  n_threads=omp_get_max_threads();
+#endif
+  int           i_thread;
+  interp_info **W_r_Daub_interp_thread=(interp_info **)SID_malloc(sizeof(interp_info *)*n_threads);
+  W_r_Daub_interp_thread[0]=W_r_Daub_interp;
+  for(i_thread=1;i_thread<n_threads;i_thread++){
+    W_r_Daub_interp_thread[i_thread]=NULL;
+    if(W_r_Daub_interp!=NULL)
+      init_interpolate(r_Daub,W_Daub,(size_t)n_Daub,gsl_interp_cspline,&(W_r_Daub_interp_thread[i_thread]));
+  }
+
+  // Particles whose kernels reach beyond the slab (or pencil) are
+  //   assigned first so that the slab buffers (or the ghost planes)
+  //   can be sent while the rest are assigned
+  size_t *particle_order=(size_t *)SID_malloc(sizeof(size_t)*MAX(1,n_particles_local));
+  size_t  n_edge        =0;
+  size_t  i_interior    =n_particles_local;
+  for(i_p=0;i_p<n_particles_local;i_p++){
+    int i_plane=(int)((GBPREAL)x_particles_local[i_p]/(GBPREAL)field->dR[0]+grid_shift);
+    int flag_edge=((i_plane-W_search_lo)<field->i_R_start_local[0] || (i_plane+W_search_hi)>field->i_R_stop_local[0]);
+    if(flag_pencil && !flag_edge){
+      int i_row=(int)((GBPREAL)y_particles_local[i_p]/(GBPREAL)field->dR[1]+grid_shift);
+      flag_edge=((i_row-W_search_lo)<field->i_R_start_local[1] || (i_row+W_search_hi)>field->i_R_stop_local[1]);
+    }
+    if(flag_edge)
+      particle_order[n_edge++]=i_p;
+    else
+      particle_order[--i_interior]=i_p;
+  }
+  if(n_threads>1)
+    SID_log("(using %d threads)...",SID_LOG_CONTINUE,n_threads);
   pcounter_info pcounter;
+  size_t        i_counter=0;
   SID_init_pcounter(&pcounter,n_particles_local,10);
-  for(i_p=0,norm_local=0.;i_p<n_particles_local;i_p++){
-    double norm_i;
-    double value_i;
-    if(flag_valued_particles)
-      v_p=(double)(v_particles_local[i_p]);
-    if(flag_weight_particles)
-      w_p=(double)(w_particles_local[i_p]);
-    norm_i =w_p;
-    value_i=v_p*norm_i;
-
-    // Particle's position
-    x_particle_i=(GBPREAL)x_particles_local[i_p];
-    y_particle_i=(GBPREAL)y_particles_local[i_p];
-    z_particle_i=(GBPREAL)z_particles_local[i_p];
-
-    // Quantize it onto the grid
-    x_particle_i/=(GBPREAL)field->dR[0];
-    y_particle_i/=(GBPREAL)field->dR[1];
-    z_particle_i/=(GBPREAL)field->dR[2];
-    i_i[0]=(int)x_particle_i; // position in grid-coordinates
-    i_i[1]=(int)y_particle_i; // position in grid-coordinates
-    i_i[2]=(int)z_particle_i; // position in grid-coordinates
-
-    // Apply the kernel
-    flag_viable=TRUE;
-    double x_i_effective;
-    for(j_i[0]=-W_search_lo;j_i[0]<=W_search_hi;j_i[0]++){
-      for(j_i[1]=-W_search_lo;j_i[1]<=W_search_hi;j_i[1]++){
-        for(j_i[2]=-W_search_lo;j_i[2]<=W_search_hi;j_i[2]++){
-          // Compute distance to each grid point being searched against ...
-          flag_active=TRUE;
-          for(i_coord=0,W_i=1.;i_coord<3;i_coord++){
-            switch(i_coord){
-            case 0:
-              x_i=(GBPREAL)(i_i[0]+j_i[0])-x_particle_i;
-              break;
-            case 1:
-              x_i=(GBPREAL)(i_i[1]+j_i[1])-y_particle_i;
-              break;
-            case 2:
-              x_i=(GBPREAL)(i_i[2]+j_i[2])-z_particle_i;
-              break;
-            }
-            switch(distribution_scheme){
-              // Distribute with a Daubechies wavelet transform of 12th or 20th order a la Cui et al '08
-            case MAP2GRID_DIST_DWT12:
-            case MAP2GRID_DIST_DWT20:
-              x_i_effective=x_i+kernal_offset;
-              if(x_i_effective>0.)
-                W_i*=interpolate(W_r_Daub_interp,x_i_effective);
-              else
-                flag_active=FALSE;
-              break;
-              // Distribute using the triangular shaped cloud (TSC) method
-            case MAP2GRID_DIST_TSC:
-              if(x_i<0.5)
-                W_i*=(0.75-x_i*x_i);
-              else if(x_i<1.5)
-                W_i*=0.5*(1.5-fabs(x_i))*(1.5-fabs(x_i));
-              else
-                flag_active=FALSE;
-              break;
-              // Distribute using the cloud-in-cell (CIC) method
-            case MAP2GRID_DIST_CIC:
-              if(fabs(x_i)<1.)
-                W_i*=(1.-fabs(x_i));
-              else
-                flag_active=FALSE;
-              break;
-              // Distribute using "nearest grid point" (NGP; ie. the simplest and default) method
-            case MAP2GRID_DIST_NGP:
-            default:
-              if(fabs(x_i)<=0.5 && flag_viable)
-                W_i*=1.;
-              else
-                flag_active=FALSE;
-              break;
-            }
-          }
-          if(flag_active){ // This flags-out regions of the kernal with no support to save some time
-            // Set the grid indices (enforce periodic BCs; do x-coordinate last) ...
-            //   ... y-coordinate ...
-            k_i[1]=(i_i[1]+j_i[1]);
-            if(k_i[1]<0)
-              k_i[1]+=field->n[1];
-            else
-              k_i[1]=k_i[1]%field->n[1];
-            //   ... z-coordinate ...
-            k_i[2]=i_i[2]+j_i[2];
-            if(k_i[2]<0)
-              k_i[2]+=field->n[2];
-            else 
-              k_i[2]=k_i[2]%field->n[2];
-            //   ... x-coordinate ... 
-            //     Depending on x-index, add contribution to the
-            //     local array or to the slab buffers.
-            k_i[0]=(i_i[0]+j_i[0]);
-            if(k_i[0]<field->i_R_start_local[0]){
-              k_i[0]-=(field->i_R_start_local[0]-W_search_lo);
-              if(k_i[0]<0)
-                 SID_trap_error("Left slab buffer limit exceeded by %d element(s).",ERROR_LOGIC,-k_i[0]);
-              send_left[index_FFT_R(field,k_i)]+=W_i*value_i;
-              if(field_norm!=NULL)
-                 send_left_norm[index_FFT_R(field_norm,k_i)]+=W_i*norm_i;
-            }
-            else if(k_i[0]>field->i_R_stop_local[0]){
-              k_i[0]-=(field->i_R_stop_local[0]+1);
-              if(k_i[0]>=W_search_hi)
-                 SID_trap_error("Right slab buffer limit exceeded by %d element(s).",ERROR_LOGIC,k_i[0]-W_search_hi+1);
-              else{
-                 send_right[index_FFT_R(field,k_i)]+=W_i*value_i;
-                 if(field_norm!=NULL)
-                    send_right_norm[index_FFT_R(field_norm,k_i)]+=W_i*norm_i;
-              }
-            }
-            else{
-              field->field_local[index_local_FFT_R(field,k_i)]+=W_i*value_i;
-              if(field_norm!=NULL)
-                 field_norm->field_local[index_local_FFT_R(field_norm,k_i)]+=W_i*norm_i;
-            }
-            flag_viable=FALSE;
-          }
-        }
-      }
+  map_to_grid_particles_local(&kernel,W_r_Daub_interp_thread,n_threads,
+                              particle_order,n_edge,
+                              NULL,0,
+                              &pcounter,&i_counter);
+
+  // Start sending the slab buffers ...
+  slab_exchange_info exchange[2];
+  int                n_exchange=1;
+  if(flag_pencil){
+    kernel.send_left =grid;
+    kernel.send_right=&(grid[n_plane*(size_t)(n_x_grid-W_search_hi)]);
+    if(field_norm!=NULL){
+      kernel.send_left_norm =grid_norm;
+      kernel.send_right_norm=&(grid_norm[n_plane*(size_t)(n_x_grid-W_search_hi)]);
     }
-    // Report the calculation's progress
-    SID_check_pcounter(&pcounter,i_p);
   }
+  start_exchange_slab_buffers(kernel.send_left, send_size_left,
+                              receive_right,    send_size_left,
+                              kernel.send_right,send_size_right,
+                              receive_left,     send_size_right,
+                              0,&(field->slab),&(exchange[0]));
+  if(field_norm!=NULL){
+    start_exchange_slab_buffers(kernel.send_left_norm, send_size_left,
+                                receive_right_norm,    send_size_left,
+                                kernel.send_right_norm,send_size_right,
+                                receive_left_norm,     send_size_right,
+                                0,&(field_norm->slab),&(exchange[1]));
+    n_exchange++;
+  }
+
+  // ... and assign the rest meanwhile
+  map_to_grid_particles_local(&kernel,W_r_Daub_interp_thread,n_threads,
+                              &(particle_order[n_edge]),n_particles_local-n_edge,
+                              exchange,n_exchange,
+                              &pcounter,&i_counter);
+  SID_free(SID_FARG particle_order);
+  for(i_thread=1;i_thread<n_threads;i_thread++){
+    if(W_r_Daub_interp_thread[i_thread]!=NULL)
+      free_interpolate(SID_FARG W_r_Daub_interp_thread[i_thread],NULL);
+  }
+  SID_free(SID_FARG W_r_Daub_interp_thread);
   SID_log("Done.",SID_LOG_CLOSE);
 
-  // Perform exchange of slab buffers and add them to the local mass distribution.
+  // Finish the exchange of slab buffers and add them to the local mass distribution.
   //    Note: it's important that the FFT field not be padded (see above, where
   //          this is set) for this to work the way it's done.
   SID_log("Adding-in the slab buffers...",SID_LOG_OPEN|SID_LOG_TIMER);
-  // Numerator first ...
-  exchange_slab_buffer_left(send_left,
-                            send_size_left,
-                            receive_right,
-                            &receive_right_size,
-                            &(field->slab));
-  exchange_slab_buffer_right(send_right,
-                             send_size_right,
-                             receive_left,
-                             &receive_left_size,
-                             &(field->slab));
-  for(i_b=0;i_b<n_send_right;i_b++)
-    field->field_local[i_b]+=receive_left[i_b];
-  for(i_b=0;i_b<n_send_left;i_b++)
-    field->field_local[field->n_field_R_local-n_send_left+i_b]+=receive_right[i_b];
-  // ... then denominator (if it's being used)
-  if(field_norm!=NULL){
-     exchange_slab_buffer_left(send_left_norm,
-                               send_size_left,
-                               receive_right_norm,
-                               &receive_right_size,
-                               &(field_norm->slab));
-     exchange_slab_buffer_right(send_right_norm,
-                                send_size_right,
-                                receive_left_norm,
-                                &receive_left_size,
-                                &(field_norm->slab));
+  if(flag_pencil){
+     add_pencil_ghosts_local(field,grid,receive_left,receive_right,&(exchange[0]),W_search_lo,W_search_hi);
+     if(field_norm!=NULL)
+        add_pencil_ghosts_local(field_norm,grid_norm,receive_left_norm,receive_right_norm,&(exchange[1]),W_search_lo,W_search_hi);
+     SID_free(SID_FARG grid);
+     SID_free(SID_FARG grid_norm);
+  }
+  else{
+     // Numerator first ...
+     finish_exchange_slab_buffers(&(exchange[0]));
      for(i_b=0;i_b<n_send_right;i_b++)
-       field_norm->field_local[i_b]+=receive_left_norm[i_b];
+       field->field_local[i_b]+=receive_left[i_b];
      for(i_b=0;i_b<n_send_left;i_b++)
-       field_norm->field_local[field_norm->n_field_R_local-n_send_left+i_b]+=receive_right[i_b];
+       field->field_local[field->n_field_R_local-n_send_left+i_b]+=receive_right[i_b];
+     // ... then denominator (if it's being used)
+     if(field_norm!=NULL){
+        finish_exchange_slab_buffers(&(exchange[1]));
+        for(i_b=0;i_b<n_send_right;i_b++)
+          field_norm->field_local[i_b]+=receive_left_norm[i_b];
+        for(i_b=0;i_b<n_send_left;i_b++)
+          field_norm->field_local[field_norm->n_field_R_local-n_send_left+i_b]+=receive_right_norm[i_b];
+     }
   }
   SID_free(SID_FARG send_left);
   SID_free(SID_FARG send_right);
@@ -407,8 +776,11 @@ void map_to_grid(size_t      n_particles_local,
      SID_log("Done.",SID_LOG_CLOSE,normalization);
   }
 
-  if(W_r_Daub_interp!=NULL)
+  if(W_r_Daub_interp!=NULL){
     free_interpolate(SID_FARG W_r_Daub_interp,NULL);
+    SID_free(SID_FARG r_Daub);
+    SID_free(SID_FARG W_Daub);
+  }
 
   SID_log("Done.",SID_LOG_CLOSE);
   
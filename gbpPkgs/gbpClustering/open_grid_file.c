@@ -0,0 +1,40 @@
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <gbpLib.h>
+#include <gbpMath.h>
+#include <gbpClustering.h>
+
+// Open a grid file written by write_grid() for reading with
+//   map_grid_slab().  Only the header is read; grids are mapped
+//   into memory a slab at a time as they are needed.
+void open_grid_file(const char *filename,grid_file_info *grid_file){
+  FILE *fp_in;
+  int   i_grid;
+
+  if((fp_in=fopen(filename,"r"))==NULL)
+     SID_trap_error("Could not open grid file {%s}.",ERROR_IO_OPEN,filename);
+  fread_verify(&(grid_file->n[0]),                 sizeof(int),   1,fp_in);
+  fread_verify(&(grid_file->n[1]),                 sizeof(int),   1,fp_in);
+  fread_verify(&(grid_file->n[2]),                 sizeof(int),   1,fp_in);
+  fread_verify(&(grid_file->L[0]),                 sizeof(double),1,fp_in);
+  fread_verify(&(grid_file->L[1]),                 sizeof(double),1,fp_in);
+  fread_verify(&(grid_file->L[2]),                 sizeof(double),1,fp_in);
+  fread_verify(&(grid_file->n_grids),              sizeof(int),   1,fp_in);
+  fread_verify(&(grid_file->mass_assignment_scheme),sizeof(int),  1,fp_in);
+  fclose(fp_in);
+
+  // Set the position of each grid's planes
+  grid_file->plane_size=(size_t)grid_file->n[1]*(size_t)grid_file->n[2]*sizeof(GBPREAL);
+  grid_file->offset    =(size_t *)SID_malloc(sizeof(size_t)*MAX(1,grid_file->n_grids));
+  for(i_grid=0;i_grid<grid_file->n_grids;i_grid++)
+     grid_file->offset[i_grid]=GRID_HEADER_SIZE+
+                               (size_t)i_grid*(GRID_IDENTIFIER_SIZE+(size_t)grid_file->n[0]*grid_file->plane_size)+
+                               GRID_IDENTIFIER_SIZE;
+
+  if((grid_file->fd=open(filename,O_RDONLY))<0)
+     SID_trap_error("Could not open grid file {%s}.",ERROR_IO_OPEN,filename);
+  grid_file->map     =NULL;
+  grid_file->map_size=0;
+}
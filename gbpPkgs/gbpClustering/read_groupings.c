@@ -187,9 +187,9 @@ void read_groupings(const char *filename_root,int grouping_number,plist_info *pl
            x_halos[n_halos_local] =(GBPREAL)x_in;
            y_halos[n_halos_local] =(GBPREAL)y_in;
            z_halos[n_halos_local] =(GBPREAL)z_in;
-           grab_real(line,vx_sub_column,&vx_in);
-           grab_real(line,vy_sys_column,&vy_in);
-           grab_real(line,vz_sys_column,&vz_in);
+           grab_real(line,vx_column,&vx_in);
+           grab_real(line,vy_column,&vy_in);
+           grab_real(line,vz_column,&vz_in);
            vx_halos[n_halos_local]=(GBPREAL)vx_in;
            vy_halos[n_halos_local]=(GBPREAL)vy_in;
            vz_halos[n_halos_local]=(GBPREAL)vz_in;
@@ -0,0 +1,40 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <gbpLib.h>
+#include <gbpMath.h>
+#include <gbpCosmo.h>
+#include <gbpSPH.h>
+#include <gbpClustering.h>
+
+// Return a species' particles to real space after a call to
+//   apply_zspace_plist(), restoring the coordinates it saved exactly.
+//   If the displacement moved particles between slabs (or pencils) and
+//   a slab is given, they are moved back to the ranks that hold them.
+void restore_zspace_plist(plist_info *plist,const char *species_name,slab_info *slab){
+  const char *x_names[]={"x_%s","y_%s","z_%s"};
+  size_t      n_particles_local;
+  int         i_coord;
+
+  if(!ADaPS_exist(plist->data,"i_zspace_%s",species_name))
+    SID_trap_error("The %s particles are not in redshift space.",ERROR_LOGIC,species_name);
+  SID_log("Restoring real-space positions to the %s particles...",SID_LOG_OPEN|SID_LOG_TIMER,species_name);
+
+  // Copy the saved coordinates back
+  i_coord          =((int    *)ADaPS_fetch(plist->data,"i_zspace_%s",species_name))[0];
+  n_particles_local=((size_t *)ADaPS_fetch(plist->data,"n_%s",species_name))[0];
+  if(n_particles_local>0)
+    memcpy(ADaPS_fetch(plist->data,x_names[i_coord],species_name),
+           ADaPS_fetch(plist->data,"zspace_real_%s",species_name),
+           sizeof(GBPREAL)*n_particles_local);
+
+  // Move the particles back to the ranks whose slabs or pencils hold them
+  if(slab!=NULL && SID.n_proc>1 && (i_coord==0 || (i_coord==1 && (slab->y_max_local-slab->y_min_local)<slab->y_max)))
+    exchange_slab_plist(plist,species_name,slab);
+
+  ADaPS_remove(&(plist->data),"zspace_real_%s",species_name);
+  ADaPS_remove(&(plist->data),"i_zspace_%s",   species_name);
+
+  SID_log("Done.",SID_LOG_CLOSE);
+}
@@ -65,26 +65,54 @@ def read_grid_header(fin):
     return n_cell, box_size, n_grids, ma_scheme
 
 def read_grids(fname):
-    """Read in a density grid from file `fname`."""
+    """Map the grids in file `fname` into memory.  Only the parts of them
+    that are sliced are read from disk, so the grids need not fit in
+    memory."""
     
     grid = {}
     
     with open(fname, "rb") as fin:
         n_cell, box_size, n_grids, ma_scheme = read_grid_header(fin)
-        n_elem = n_cell.cumprod()[-1]
-        if not PLOTVEL:
-            n_grids = 1
-        for i_grid in xrange(n_grids):
-            ident = np.fromfile(fin, 'S32', 1)[0]
-            print("Reading grid "+ident)
-            # For some reason numpy freaks out with a (1024,1024,1024)f4 read
-            # so we need to just read in raw elements and reshape the result...
-            grid[ident] = np.fromfile(fin, 'f4', n_elem)
-            grid[ident].shape = n_cell
+        offset = fin.tell()
+    n_elem = n_cell.cumprod()[-1]
+    if not PLOTVEL:
+        n_grids = 1
+    for i_grid in xrange(n_grids):
+        ident = np.memmap(fname, 'S32', 'r', offset, (1,))[0]
+        print("Mapping grid "+ident)
+        grid[ident] = np.memmap(fname, 'f4', 'r', offset+32, tuple(n_cell))
+        offset += 32+4*n_elem
     
     return grid, n_cell, box_size
 
 
+def density_range(rho):
+    """Find the smallest positive and the largest value of the density
+    grid `rho`, one plane at a time."""
+
+    min_density, max_density = np.inf, 0.
+    for plane in rho:
+        positive = plane[plane>0]
+        if positive.size>0:
+            min_density = min(min_density, positive.min())
+        max_density = max(max_density, plane.max())
+
+    return min_density*RHO_FACTOR, max_density*RHO_FACTOR
+
+
+def slice_grids(s):
+    """Return the density and the two in-plane velocity slices given by
+    `s`.  The velocities are masked where the density is zero."""
+
+    rho = grid['rho_r_dark'][s]*RHO_FACTOR
+    if not PLOTVEL:
+        return rho, None, None
+    mask = rho < min_density
+    v_1 = np.ma.masked_where(mask, grid['v_'+LABELS[(AXIS-1)%3]+'_r_dark'][s])
+    v_2 = np.ma.masked_where(mask, grid['v_'+LABELS[(AXIS+1)%3]+'_r_dark'][s])
+    return rho, v_1, v_2
+
+
 def animate(index):
     """This function is called for each new frame and updates the data being
     plotted."""
@@ -94,10 +122,10 @@ def animate(index):
     s[AXIS] = index
 
     # update the data in the density image and quivers
-    cax.set_data(grid['rho_r_dark'][s])
+    rho, v_1, v_2 = slice_grids(s)
+    cax.set_data(rho)
     if PLOTVEL:
-        quiver.set_UVC(grid['v_'+LABELS[(AXIS-1)%3]+'_r_dark'][s][quiver_s],
-                       grid['v_'+LABELS[(AXIS+1)%3]+'_r_dark'][s][quiver_s])
+        quiver.set_UVC(v_1[quiver_s], v_2[quiver_s])
 
     # update the figure title
     slice_pos = index*(cell_half_width[AXIS]*2.)+cell_half_width[AXIS]
@@ -114,21 +142,14 @@ def animate(index):
 
 
 
-# read in the grids
+# map the grids
 grid, n_cell, box_size = read_grids(GRID_FNAME)
 
 # We will use a log10 normalisation for the density field so multiply the
-# densities by 1e10 to get h^-1 Msol units.
-grid['rho_r_dark'] = grid['rho_r_dark']*1.e10
-min_density, max_density = grid['rho_r_dark'][grid['rho_r_dark']>0].min(), grid['rho_r_dark'].max()
-
-# mask the velocity fields to ignore zero density cells
-if PLOTVEL:
-    print "Masking the velocity fields to remove zero density cells..."
-    bool_arr = grid['rho_r_dark'] < min_density
-    for k in grid.iterkeys():
-        if k is not 'rho_r_dark':
-            grid[k] = np.ma.masked_where(bool_arr, grid[k], copy=False)
+# densities by 1e10 to get h^-1 Msol units.  This (and the masking of the
+# velocities where the density is zero) is done a slice at a time.
+RHO_FACTOR = 1.e10
+min_density, max_density = density_range(grid['rho_r_dark'])
 
 print "Plotting..."
 # set up the figure
@@ -157,7 +178,8 @@ palette = plt.cm.jet
 palette.set_bad('k')
 
 # note the transpose here!
-cax = plt.imshow(grid['rho_r_dark'][s].T, origin='lower', extent=extent,
+rho, v_1, v_2 = slice_grids(s)
+cax = plt.imshow(rho.T, origin='lower', extent=extent,
                  interpolation='bicubic',
                  vmin=min_density, vmax=max_density,
                  norm=LogNorm(),
@@ -179,8 +201,8 @@ if PLOTVEL:
         if n_cell[a]>64:
             quiver_s[i] = np.s_[::int(n_cell[a]/64)]
     quiver = ax.quiver(X[quiver_s],Y[quiver_s],
-                       grid['v_'+LABELS[(AXIS-1)%3]+'_r_dark'][s][quiver_s],
-                       grid['v_'+LABELS[(AXIS+1)%3]+'_r_dark'][s][quiver_s],
+                       v_1[quiver_s],
+                       v_2[quiver_s],
                        units='xy', scale=500,
                        color='w', alpha=0.6,
                        pivot='tail',
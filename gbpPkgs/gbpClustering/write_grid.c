@@ -1,6 +1,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <gbpLib.h>
 #include <gbpMath.h>
 #include <gbpCosmo.h>
@@ -8,6 +10,11 @@
 #include <gbpHalos.h>
 #include <gbpClustering.h>
 
+// Write grid i_grid of the n_grids written to {filename_out_root}_grid.dat.
+//   The header is written with the first grid.  Every grid's place in the
+//   file follows from the header (see open_grid_file()), so each rank
+//   writes its own planes there directly and in parallel with the others
+//   rather than passing them through the master rank.  Called collectively.
 void write_grid(field_info *field,const char *filename_out_root,int i_grid,int n_grids,int mass_assignment_scheme,const char *grid_identifier,double box_size){
    // Now that all 4 runs are done, let's write the results
    SID_log("Writing {%s} grid...",SID_LOG_OPEN,grid_identifier);
@@ -16,9 +23,13 @@ void write_grid(field_info *field,const char *filename_out_root,int i_grid,int n
    char filename_out[MAX_FILENAME_LENGTH];
    sprintf(filename_out,"%s_grid.dat",filename_out_root);
 
+   // Set where this grid goes
+   size_t plane_size =(size_t)field->n[1]*(size_t)field->n[2]*sizeof(fftw_real);
+   size_t offset_grid=GRID_HEADER_SIZE+(size_t)i_grid*(GRID_IDENTIFIER_SIZE+(size_t)field->n[0]*plane_size);
+
    // Write header if this is the first grid
-   FILE *fp_out=NULL;
    if(SID.I_am_Master){
+      FILE *fp_out=NULL;
       if(i_grid==0){
          fp_out=fopen(filename_out,"w");
          fwrite(&(field->n[0]),sizeof(int),   1,fp_out);
@@ -41,33 +52,30 @@ void write_grid(field_info *field,const char *filename_out_root,int i_grid,int n
          }
       }
       else
-         fp_out=fopen(filename_out,"a");
+         fp_out=fopen(filename_out,"r+");
+      if(fp_out==NULL)
+         SID_trap_error("Could not open {%s} for writing.",ERROR_IO_OPEN,filename_out);
+      fseeko(fp_out,(off_t)offset_grid,SEEK_SET);
       fwrite(grid_identifier,sizeof(char),GRID_IDENTIFIER_SIZE,fp_out);
+      fclose(fp_out);
    }
+   SID_Barrier(SID.COMM_WORLD);
 
-   // Append the grid to the file
-   void   *buffer=NULL;
-   int     i_rank;
-   size_t  alloc_size;
-   size_t  alloc_size_local;
-   alloc_size_local=(size_t)field->n_field_R_local*sizeof(fftw_real);
-   SID_Allreduce(&alloc_size_local,&alloc_size,1,SID_SIZE_T,SID_MAX,SID.COMM_WORLD);
-   buffer=SID_malloc(alloc_size);
-   SID_set_verbosity(SID_SET_VERBOSITY_RELATIVE,-1);
-   //remove_buffer_FFT_R(field);
-   SID_set_verbosity(SID_SET_VERBOSITY_DEFAULT);
-   for(i_rank=0;i_rank<SID.n_proc;i_rank++){
-      size_t alloc_size_i;
-      memcpy(buffer,field->field_local,alloc_size_local);
-      alloc_size_i=alloc_size_local;
-      SID_Bcast(&alloc_size_i,sizeof(size_t),i_rank,SID.COMM_WORLD);
-      SID_Bcast(buffer,alloc_size_i,i_rank,SID.COMM_WORLD);
-      if(SID.I_am_Master)
-         fwrite(buffer,alloc_size_i,1,fp_out);
-   }
-   SID_free(SID_FARG buffer);
-   if(SID.I_am_Master)
-      fclose(fp_out);
+   // Write the local planes.  The rows of each local plane are
+   //   contiguous in the file (for pencils as well as slabs).
+   int fd_out;
+   int i_x;
+   if((fd_out=open(filename_out,O_WRONLY))<0)
+      SID_trap_error("Could not open {%s} for writing.",ERROR_IO_OPEN,filename_out);
+   size_t n_plane_local=(size_t)field->n_R_local[1]*(size_t)field->n[2];
+   for(i_x=0;i_x<field->n_R_local[0];i_x++)
+      SID_pwrite_all(fd_out,
+                     &(field->field_local[(size_t)i_x*n_plane_local]),
+                     sizeof(fftw_real)*n_plane_local,
+                     offset_grid+GRID_IDENTIFIER_SIZE+
+                     (size_t)(field->i_R_start_local[0]+i_x)*plane_size+
+                     (size_t)field->i_R_start_local[1]*(size_t)field->n[2]*sizeof(fftw_real));
+   close(fd_out);
+   SID_Barrier(SID.COMM_WORLD);
    SID_log("Done.",SID_LOG_CLOSE);
 }
-
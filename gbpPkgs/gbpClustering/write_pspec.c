@@ -49,6 +49,8 @@ void write_pspec(pspec_info *pspec,const char *filename_out_root,plist_info *pli
       fprintf(fp_out,"# Redshift:               %5.3lf\n",        pspec->redshift);
       fprintf(fp_out,"# Box size:               %9.3le [Mpc/h]\n",pspec->box_size);
       fprintf(fp_out,"# Grid size:              %d^3\n",          pspec->grid_size);
+      if(pspec->flag_multipoles)
+         fprintf(fp_out,"# Multipoles:             line of sight along the projection axis (z for real-space)\n");
       int i_column=1;
       int i_run;
       fprintf(fp_out,"#\n");
@@ -75,6 +77,10 @@ void write_pspec(pspec_info *pspec,const char *filename_out_root,plist_info *pli
          if(pspec->flag_processed[i_run]){
             fprintf(fp_out,"#         (%02d) P(k)  [(Mpc/h)^3];  %s-space\n",i_column++,run_name);
             fprintf(fp_out,"#         (%02d) dP(k) [(Mpc/h)^3];  %s-space\n",i_column++,run_name);
+            if(pspec->flag_multipoles){
+               fprintf(fp_out,"#         (%02d) P_2(k) [(Mpc/h)^3]; %s-space\n",i_column++,run_name);
+               fprintf(fp_out,"#         (%02d) P_4(k) [(Mpc/h)^3]; %s-space\n",i_column++,run_name);
+            }
          }
       }
       fprintf(fp_out,"#\n");
@@ -88,8 +94,11 @@ void write_pspec(pspec_info *pspec,const char *filename_out_root,plist_info *pli
                k_max=pspec->k_max_1D;
             fprintf(fp_out,"%9.3le %9.3le %9.3le %8d ",k_min,pspec->k_1D[i_k],k_max,pspec->n_modes_1D[i_k]);
             for(i_run=0;i_run<4;i_run++){
-               if(pspec->flag_processed[i_run])
+               if(pspec->flag_processed[i_run]){
                   fprintf(fp_out,"  %le %le",pspec->P_k_1D[i_run][i_k],pspec->dP_k_1D[i_run][i_k]);
+                  if(pspec->flag_multipoles)
+                     fprintf(fp_out," %le %le",pspec->P_k_l2_1D[i_run][i_k],pspec->P_k_l4_1D[i_run][i_k]);
+               }
             }
             fprintf(fp_out,"\n");
             k_min=k_max;
@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gbpLib.h>
+#include <gbpSPH.h>
+#include <gbpRender.h>
+
+// Estimate the RAM (in bytes) used by a snapshot's particle arrays
+size_t snapshot_cache_data_size(render_info *render,ADaPS *data);
+size_t snapshot_cache_data_size(render_info *render,ADaPS *data){
+   const char *array_name[]={"x","y","z","vx","vy","vz","id","r_smooth","rho","sigma_v","mark"};
+   size_t      array_size[]={sizeof(GBPREAL),sizeof(GBPREAL),sizeof(GBPREAL),
+                             sizeof(GBPREAL),sizeof(GBPREAL),sizeof(GBPREAL),
+                             sizeof(size_t),
+                             sizeof(float),sizeof(float),sizeof(float),
+                             sizeof(char)};
+   int         n_array=sizeof(array_size)/sizeof(size_t);
+   size_t      size=0;
+   for(int i_type=0;i_type<N_GADGET_TYPE;i_type++){
+      const char *species=render->plist_list[0]->species[i_type];
+      if(ADaPS_exist(data,"n_%s",species)){
+         size_t n_species=((size_t *)ADaPS_fetch(data,"n_%s",species))[0];
+         for(int i_array=0;i_array<n_array;i_array++){
+            if(ADaPS_exist(data,"%s_%s",array_name[i_array],species))
+               size+=n_species*array_size[i_array];
+         }
+      }
+   }
+   return(size);
+}
+
+// Returns TRUE if a snapshot has been loaded for upcoming frames
+int snapshot_cache_pinned(render_info *render,int snap);
+int snapshot_cache_pinned(render_info *render,int snap){
+   int i_prefetch;
+   for(i_prefetch=0;i_prefetch<render->n_prefetch && render->snap_prefetch_list!=NULL;i_prefetch++){
+      if(render->snap_prefetch_list[i_prefetch]==snap)
+         return(TRUE);
+   }
+   return(FALSE);
+}
+
+// Place a snapshot which is no longer being rendered in the snapshot cache
+//   (or free it if there is no room), evicting the least-recently-used
+//   snapshots as needed to stay within the cache's size limit.  Decisions
+//   are made with sizes reduced over all ranks so that every rank caches
+//   the same snapshots.  Entries whose data has been taken by
+//   fetch_snapshot_cache() are being rendered; they do not count against
+//   the limit and are reused when the snapshot is returned.  Snapshots
+//   loaded ahead by prefetch_snapshots() are never evicted to make room.
+void add_snapshot_cache(render_info *render,int snap,ADaPS **data){
+   snapshot_cache_info *new_item;
+   snapshot_cache_info *new_item_last;
+   snapshot_cache_info *current;
+   snapshot_cache_info *last;
+   size_t               size_local;
+   size_t               size;
+   size_t               size_total;
+
+   if(snap<0){
+      ADaPS_free(SID_FARG (*data));
+      return;
+   }
+
+   // Look for an entry left by fetch_snapshot_cache()
+   for(new_item=render->snapshot_cache,new_item_last=NULL;new_item!=NULL;new_item_last=new_item,new_item=new_item->next){
+      if(new_item->snap==snap && new_item->data==NULL)
+         break;
+   }
+
+   // Determine the size of the snapshot
+   if((*data)!=NULL)
+      size_local=snapshot_cache_data_size(render,(*data));
+   else
+      size_local=0;
+   SID_Allreduce(&size_local,&size,1,SID_SIZE_T,SID_MAX,SID.COMM_WORLD);
+
+   // Evict least-recently-used snapshots until there is room.  Snapshots
+   //   loaded for upcoming frames (see prefetch_snapshots()) are not evicted.
+   int flag_fits=(size>0 && size<=render->snapshot_cache_size_max);
+   while(flag_fits){
+      snapshot_cache_info *lru     =NULL;
+      snapshot_cache_info *lru_last=NULL;
+      size_total=size;
+      for(current=render->snapshot_cache,last=NULL;current!=NULL;last=current,current=current->next){
+         if(current->data==NULL)
+            continue;
+         size_total+=current->size;
+         if(!snapshot_cache_pinned(render,current->snap) && (lru==NULL || current->last_used<lru->last_used)){
+            lru     =current;
+            lru_last=last;
+         }
+      }
+      if(size_total<=render->snapshot_cache_size_max)
+         break;
+      else if(lru==NULL)
+         flag_fits=FALSE;
+      else{
+         SID_log("Removing snapshot %d from the snapshot cache.",SID_LOG_COMMENT,lru->snap);
+         if(lru_last==NULL)
+            render->snapshot_cache=lru->next;
+         else
+            lru_last->next=lru->next;
+         ADaPS_free(SID_FARG lru->data);
+         SID_free(SID_FARG lru);
+      }
+   }
+
+   // Free it if it does not fit
+   if(!flag_fits){
+      ADaPS_free(SID_FARG (*data));
+      if(new_item!=NULL){
+         if(new_item_last==NULL)
+            render->snapshot_cache=new_item->next;
+         else
+            new_item_last->next=new_item->next;
+         SID_free(SID_FARG new_item);
+      }
+      return;
+   }
+
+   // Add the new snapshot (or return it to its entry)
+   if(new_item==NULL){
+      new_item      =(snapshot_cache_info *)SID_malloc(sizeof(snapshot_cache_info));
+      new_item->snap=snap;
+      new_item->next=render->snapshot_cache;
+      render->snapshot_cache=new_item;
+   }
+   new_item->data     =(*data);
+   new_item->size     =size;
+   new_item->last_used=render->snapshot_cache_clock++;
+   (*data)=NULL;
+   SID_log("Snapshot %d placed in the snapshot cache (%.1lf of %.1lf Mb used).",SID_LOG_COMMENT,snap,
+           (double)size_total/(double)SIZE_OF_MEGABYTE,(double)render->snapshot_cache_size_max/(double)SIZE_OF_MEGABYTE);
+}
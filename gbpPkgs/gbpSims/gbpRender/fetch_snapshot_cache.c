@@ -0,0 +1,24 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gbpLib.h>
+#include <gbpSPH.h>
+#include <gbpRender.h>
+
+// Take a snapshot from the snapshot cache and return it in data.  The
+//   entry is kept (with no data) while the snapshot is being rendered and
+//   its recency is refreshed, so that eviction order follows use rather
+//   than insertion.  Returns FALSE if the snapshot is not in the cache.
+int fetch_snapshot_cache(render_info *render,int snap,ADaPS **data){
+   snapshot_cache_info *current;
+   for(current=render->snapshot_cache;current!=NULL;current=current->next){
+      if(current->snap==snap && current->data!=NULL){
+         (*data)           =current->data;
+         current->data     =NULL;
+         current->last_used=render->snapshot_cache_clock++;
+         SID_log("Snapshot %d taken from the snapshot cache.",SID_LOG_COMMENT,snap);
+         return(TRUE);
+      }
+   }
+   return(FALSE);
+}
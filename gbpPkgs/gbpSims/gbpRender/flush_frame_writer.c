@@ -0,0 +1,30 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gbpLib.h>
+#include <gbpSPH.h>
+#include <gbpRender.h>
+
+// Wait for all frames queued with queue_frame() to be written and
+//   stop the frame writer.  Does nothing if no writer was started.
+void flush_frame_writer(render_info *render){
+#if USE_PTHREADS
+  frame_writer_info *writer=render->frame_writer;
+  if(writer!=NULL){
+     SID_log("Waiting for queued frames to be written...",SID_LOG_OPEN|SID_LOG_TIMER);
+     pthread_mutex_lock(&(writer->lock));
+     writer->flag_stop=TRUE;
+     pthread_cond_signal(&(writer->cond_queued));
+     pthread_mutex_unlock(&(writer->lock));
+     pthread_join(writer->thread,NULL);
+     pthread_mutex_destroy(&(writer->lock));
+     pthread_cond_destroy (&(writer->cond_queued));
+     pthread_cond_destroy (&(writer->cond_written));
+     for(int i_slot=0;i_slot<writer->n_slots;i_slot++)
+        free_camera(&(writer->slots[i_slot].camera));
+     SID_free(SID_FARG writer->slots);
+     SID_free(SID_FARG render->frame_writer);
+     SID_log("Done.",SID_LOG_CLOSE);
+  }
+#endif
+}
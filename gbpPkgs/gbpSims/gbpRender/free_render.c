@@ -12,6 +12,7 @@ void free_render(render_info **render){
   int i_snap;
   SID_log("Freeing render structure...",SID_LOG_OPEN);
   SID_set_verbosity(SID_SET_VERBOSITY_RELATIVE,-1);
+  flush_frame_writer(*render);
   free_camera(&((*render)->camera));
   free_scenes(&((*render)->scenes));
   if((*render)->plist_list!=NULL){
@@ -29,6 +30,15 @@ void free_render(render_info **render){
   SID_free(SID_FARG (*render)->kernel_radius);
   SID_free(SID_FARG (*render)->kernel_table);
   SID_free(SID_FARG (*render)->kernel_table_3d);
+  free_sph_kernel_stamps(&((*render)->kernel_stamps));
+  free_render_projection_cache(&((*render)->projection_cache));
+  while((*render)->snapshot_prefetch!=NULL){
+     snapshot_prefetch_info *next=(*render)->snapshot_prefetch->next;
+     free_snapshot_prefetch(&((*render)->snapshot_prefetch));
+     (*render)->snapshot_prefetch=next;
+  }
+  free_snapshot_cache(*render);
+  SID_free(SID_FARG (*render)->snap_prefetch_list);
   free_mark_arguments(&((*render)->mark_arg_first));
 
   // Free colour information
@@ -0,0 +1,19 @@
+#include <stdio.h>
+#include <gbpLib.h>
+#include <gbpRender.h>
+
+void free_render_projection_cache(render_projection_cache_info **cache){
+  if((*cache)!=NULL){
+    SID_free(SID_FARG (*cache)->snap_list);
+    SID_free(SID_FARG (*cache)->x);
+    SID_free(SID_FARG (*cache)->y);
+    SID_free(SID_FARG (*cache)->z);
+    SID_free(SID_FARG (*cache)->h_smooth);
+    SID_free(SID_FARG (*cache)->value);
+    SID_free(SID_FARG (*cache)->weight);
+    SID_free(SID_FARG (*cache)->colour);
+    SID_free(SID_FARG (*cache)->z_index);
+    SID_free(SID_FARG (*cache)->lod_nodes);
+    SID_free(SID_FARG (*cache));
+  }
+}
@@ -0,0 +1,19 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gbpLib.h>
+#include <gbpSPH.h>
+#include <gbpRender.h>
+
+void free_snapshot_cache(render_info *render){
+   snapshot_cache_info *current;
+   snapshot_cache_info *next;
+   current=render->snapshot_cache;
+   while(current!=NULL){
+      next=current->next;
+      ADaPS_free(SID_FARG current->data);
+      SID_free(SID_FARG current);
+      current=next;
+   }
+   render->snapshot_cache=NULL;
+}
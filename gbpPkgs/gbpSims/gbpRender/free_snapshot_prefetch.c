@@ -0,0 +1,26 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gbpLib.h>
+#include <gbpSPH.h>
+#include <gbpRender.h>
+
+// Free a snapshot prefetch, first waiting for its reading thread (if
+//   it is still running).  The prefetch must not be in a list.
+void free_snapshot_prefetch(snapshot_prefetch_info **prefetch){
+  file_image_info *current;
+  file_image_info *next;
+  if((*prefetch)!=NULL){
+#if USE_PTHREADS
+     if((*prefetch)->flag_thread)
+        pthread_join((*prefetch)->thread,NULL);
+     pthread_mutex_destroy(&((*prefetch)->lock));
+#endif
+     for(current=(*prefetch)->file_images;current!=NULL;current=next){
+        next=current->next;
+        SID_free(SID_FARG current->data);
+        SID_free(SID_FARG current);
+     }
+     SID_free(SID_FARG (*prefetch));
+  }
+}
@@ -0,0 +1,15 @@
+#include <stdio.h>
+#include <gbpLib.h>
+#include <gbpRender.h>
+
+void free_sph_kernel_stamps(sph_kernel_stamp_info **kernel_stamps){
+  if((*kernel_stamps)!=NULL){
+    SID_free(SID_FARG (*kernel_stamps)->n_lo);
+    SID_free(SID_FARG (*kernel_stamps)->width);
+    SID_free(SID_FARG (*kernel_stamps)->offset);
+    SID_free(SID_FARG (*kernel_stamps)->stamp);
+    SID_free(SID_FARG (*kernel_stamps)->extent);
+    SID_free(SID_FARG (*kernel_stamps)->h);
+    SID_free(SID_FARG (*kernel_stamps));
+  }
+}
@@ -10,6 +10,9 @@
   #include <avformat.h>
   #include <swscale.h>
 #endif
+#if USE_PTHREADS
+  #include <pthread.h>
+#endif
 
 #define MAKE_MAP_DEFAULT       0
 #define MAKE_MAP_LOG           TTTP01
@@ -22,10 +25,20 @@
 #define MAKE_MAP_INV_SIGMA     TTTP08
 
 #define N_KERNEL_TABLE      20000
+#define SPH_KERNEL_FILE_VERSION 2 // Increment when the layout of gbpRender_sph_kernel.dat changes
 #define SPH_KERNEL_2D       TTTP01
 #define SPH_KERNEL_GADGET   TTTP02
 #define SPH_KERNEL_GASOLINE TTTP03
 #define SPH_KERNEL_GAUSSIAN TTTP04
+#define SPH_KERNEL_STAMPS   TTTP05
+
+// Precomputed kernel stamps are used for particles with smoothing
+//   lengths (in pixels) in the range [KERNEL_STAMP_H_MIN,KERNEL_STAMP_H_MIN*2^KERNEL_STAMP_N_OCTAVES).
+//   Stamps are quantized logarithmically in smoothing length and linearly in sub-pixel position.
+#define KERNEL_STAMP_H_MIN         0.25
+#define KERNEL_STAMP_N_OCTAVES     4
+#define KERNEL_STAMP_N_PER_OCTAVE 16
+#define KERNEL_STAMP_N_SUB         8
 
 #define CAMERA_MONO            0
 #define CAMERA_STEREO          2
@@ -63,7 +76,105 @@
 
 #define RENDER_INVALID_SSIMPL_DIR ":%* invalid directory *%:"
 
+#define RENDER_N_THREADS_DEFAULT  1  // 0 means use all available threads
+#define RENDER_TILE_SIZE_DEFAULT 64  // Side length (in pixels) of the tiles used for threaded splatting
+
+#define RENDER_LOD_THRESHOLD_DEFAULT 0.  // Pixel-fraction error bound for LOD rendering; 0 means off
+#define RENDER_LOD_LEAF_SIZE         8   // Maximum number of particles in a LOD tree leaf
+#define RENDER_LOD_DEPTH_MAX         32  // Maximum depth of the LOD tree
+
+#define RENDER_SNAPSHOT_CACHE_SIZE_DEFAULT  ((size_t)(-1)) // Snapshot cache size if none is given; resolved by seal_render() ...
+#define RENDER_SNAPSHOT_CACHE_SIZE_PREFETCH 4096 // ... to this size [Mb] if prefetching, and to zero (no cache) if not
+#define RENDER_N_PREFETCH_DEFAULT          1   // Number of upcoming snapshots to load in the background
+#define RENDER_PREFETCH_LOOKAHEAD          500 // Number of frames to look ahead for upcoming snapshots
+
+#define RENDER_N_WRITE_QUEUE_DEFAULT 2 // Number of rendered frames which may wait to be written; 0 means write synchronously
+
 // Data structure which holds all info about an image
+typedef struct sph_kernel_stamp_info sph_kernel_stamp_info;
+struct sph_kernel_stamp_info{
+  int     n_h;          // Number of smoothing length levels
+  int     n_sub;        // Number of sub-pixel positions along each axis
+  double  h_min;        // Smoothing length (in pixels) of the first level
+  int    *n_lo;         // Stamps of level i span pixel offsets [-n_lo[i],n_lo[i]+1] ...
+  int    *width;        // ... which is width[i]=2*n_lo[i]+2 pixels along each axis
+  size_t *offset;       // Start of level i's stamps in stamp[]
+  double *stamp;        // Kernel values; x-major, n_sub*n_sub stamps per level
+  int    *extent;       // Non-zero pixel offsets (x_lo,x_hi,y_lo,y_hi) of each stamp
+  double *h;            // Smoothing length (in pixels) of each level
+};
+
+// Node of the level-of-detail octree built over a rank's cached particles.  Nodes
+//   are stored depth-first so a node's subtree is [i_node,i_next) and its
+//   particles are [i_first,i_first+n_particles) of the (reordered) cache.
+typedef struct render_lod_node_info render_lod_node_info;
+struct render_lod_node_info{
+  float  x;                 // Centroid, weighted by each particle's kernel integral
+  float  y;
+  float  z;
+  float  radius;            // Bounding radius of the particles about the centroid
+  float  h_smooth;          // Aggregated (rms) smoothing length ...
+  float  h_min;             // ... and the range it represents
+  float  h_max;
+  float  value;             // Aggregated value and weight (conserving the summed kernel integral)
+  float  weight;
+  char   colour;
+  char   flag_mixed_colour;
+  char   flag_leaf;
+  size_t i_first;
+  size_t n_particles;
+  size_t i_next;
+};
+
+// Particles distributed to this rank by a previous frame (used when rendering with
+//   'set frame_coherent').  Positions are stored before any camera transformation.
+typedef struct render_projection_cache_info render_projection_cache_info;
+struct render_projection_cache_info{
+  int     n_interpolate;
+  int    *snap_list;        // Snapshots (and interpolation factor) ...
+  double  f_interpolate;    // ... that the cached particles were taken from
+  size_t  key;              // Hash of the camera and transfer-function state they were set with ...
+  size_t  mark_generation;  // ... and the value of render->mark_generation when they were set
+  size_t  n_particles;
+  float  *x;
+  float  *y;
+  float  *z;
+  float  *h_smooth;
+  float  *value;
+  float  *weight;
+  char   *colour;
+  size_t *z_index;          // Depth ordering of the last frame rendered
+  size_t  n_lod_nodes;
+  render_lod_node_info *lod_nodes; // LOD tree (NULL if not built)
+};
+
+// Snapshots which have been read but which are not currently being rendered
+//   (data is NULL while a cached snapshot is taken out for rendering)
+typedef struct snapshot_cache_info snapshot_cache_info;
+struct snapshot_cache_info{
+  int                  snap;
+  ADaPS               *data;
+  size_t               size;      // Largest size (in bytes) of the snapshot on any rank
+  int                  last_used; // Cache clock at the last insert or hit
+  snapshot_cache_info *next;
+};
+
+// A snapshot whose files are being read into RAM (on the master rank) by a
+//   separate thread, ahead of being needed by an upcoming frame
+typedef struct snapshot_prefetch_info snapshot_prefetch_info;
+struct snapshot_prefetch_info{
+  int                     snap;
+  file_image_info        *file_images; // The snapshot and smooth files (master rank only)
+  int                     flag_done;   // Set by the reading thread when it is finished ...
+  int                     flag_failed; // ... and if any file could not be read
+#if USE_PTHREADS
+  int                     flag_thread; // TRUE if a reading thread was started
+  pthread_t               thread;
+  pthread_mutex_t         lock;
+#endif
+  snapshot_prefetch_info *next;
+};
+
 typedef struct image_info image_info;
 struct image_info{
   gdImagePtr       gd_ptr;
@@ -204,6 +315,32 @@ struct camera_info{
   image_info       *image_BY_right;
 };
 
+// A rendered frame waiting to be written by the frame writer
+typedef struct frame_writer_slot_info frame_writer_slot_info;
+struct frame_writer_slot_info{
+  int          frame;
+  int          mode;
+  char         filename_out_dir[256];
+  camera_info *camera;   // Copy of the camera's ranges and images
+};
+
+// Bounded queue of rendered frames which are colour-mapped and written
+//   by a separate thread while the next frame is rendered
+typedef struct frame_writer_info frame_writer_info;
+struct frame_writer_info{
+  int                     n_slots;
+  int                     i_head;     // Next frame to be written ...
+  int                     n_queued;   // ... and the number waiting (including the one being written)
+  int                     flag_stop;
+  frame_writer_slot_info *slots;
+#if USE_PTHREADS
+  pthread_t               thread;
+  pthread_mutex_t         lock;
+  pthread_cond_t          cond_queued;  // Signalled when a frame is queued ...
+  pthread_cond_t          cond_written; // ... and when one has been written
+#endif
+};
+
 typedef struct mark_arg_info mark_arg_info;
 struct mark_arg_info{
    char            species[32];
@@ -236,6 +373,21 @@ struct render_info{
   double         *kernel_table;
   double         *kernel_table_3d;
   double          kernel_table_avg;
+  sph_kernel_stamp_info *kernel_stamps;
+  int             flag_exact_kernel;
+  int             flag_frame_coherent;
+  double          lod_threshold;
+  render_projection_cache_info *projection_cache;
+  // Snapshot caching and prefetching
+  snapshot_cache_info *snapshot_cache;
+  size_t          snapshot_cache_size_max;
+  int             snapshot_cache_clock;
+  int             n_prefetch;
+  int            *snap_prefetch_list;
+  snapshot_prefetch_info *snapshot_prefetch;
+  // Frame output
+  int             n_write_queue;
+  frame_writer_info *frame_writer;
   camera_info    *camera;
   scene_info     *scenes;
   scene_info     *first_scene;
@@ -265,10 +417,14 @@ struct render_info{
   tree_info      *trees;
   mark_arg_info  *mark_arg_first;
   mark_arg_info  *mark_arg_last;
+  size_t          mark_generation; // Incremented whenever perform_marking() changes the particle marks
   double          h_Hubble;
   double          f_absorption;
   int             w_mode;
   int             v_mode;
+  // Splatting engine info
+  int             n_threads;
+  int             tile_size;
   // Colour info
   int             n_colour_list;
   char          **colour_name;
@@ -307,6 +463,9 @@ void seal_render(render_info *render);
 int  set_render_state(render_info *render,int frame,int mode);
 void parse_render_file(render_info **render, char *filename);
 void write_frame(render_info *render,int frame,int mode);
+void write_frame_images(camera_info *camera,const char *filename_out_dir,int frame,int mode);
+void queue_frame(render_info *render,int frame,int mode);
+void flush_frame_writer(render_info *render);
 void write_path_file(render_info *render,int frame);
 void read_frame(render_info *render,int frame);
 void set_frame(camera_info *camera);
@@ -358,17 +517,26 @@ void read_gadget_binary_render(char       *filename_root_in,
                                plist_info *plist,
                                int         mode);
 
-void set_sph_kernel(double **kernel_radius,
-                    double **kernel_table_3d,
-                    double **kernel_table_2d,
-                    double  *kernel_table_2d_average,
-                    int      mode);
+void set_sph_kernel(double                 **kernel_radius,
+                    double                 **kernel_table_3d,
+                    double                 **kernel_table_2d,
+                    double                  *kernel_table_2d_average,
+                    sph_kernel_stamp_info  **kernel_stamps,
+                    int                      mode);
+void free_sph_kernel_stamps(sph_kernel_stamp_info **kernel_stamps);
+void free_render_projection_cache(render_projection_cache_info **cache);
 
 void add_mark_argument   (render_info *render,const char *species,int value,const char *type,...);
 void create_mark_argument(render_info *render,mark_arg_info **new_arg);
 void free_mark_arguments(mark_arg_info **argument);
 void perform_marking     (render_info *render);
 void pick_best_snap(double a_search,double *snap_a_list,int n_snap_a_list,int *snap_best,double *snap_diff_best);
+void add_snapshot_cache  (render_info *render,int snap,ADaPS **data);
+int  fetch_snapshot_cache(render_info *render,int snap,ADaPS **data);
+void free_snapshot_cache (render_info *render);
+void prefetch_snapshots  (render_info *render,int frame);
+void free_snapshot_prefetch(snapshot_prefetch_info **prefetch);
+void read_render_snapshot(render_info *render,int snap,plist_info *plist);
 void process_SSimPL_halos(render_info *render,
                           int          i_snap,
                           int          i_pass,
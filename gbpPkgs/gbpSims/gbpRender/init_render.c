@@ -12,6 +12,7 @@ void init_render(render_info **render){
   int         flag_scatter;
   int         flag_no_velocities;
   SID_log("Initializing render structure...",SID_LOG_OPEN);
+  SID_push_memory_tag("render");
 
   // Allocate memory for rendering
   (*render)=(render_info *)SID_malloc(sizeof(render_info));
@@ -42,14 +43,30 @@ void init_render(render_info **render){
   (*render)->alpha_fade         = 2.;
   (*render)->v_mode             = MAKE_MAP_DEFAULT;
   (*render)->w_mode             = MAKE_MAP_DEFAULT;
+  (*render)->n_threads          = RENDER_N_THREADS_DEFAULT;
+  (*render)->tile_size          = RENDER_TILE_SIZE_DEFAULT;
   (*render)->plist_list         = NULL;
   (*render)->trees              = NULL;
   (*render)->mark_arg_first     = NULL;
   (*render)->mark_arg_last      = NULL;
+  (*render)->mark_generation    = 0;
   (*render)->kernel_radius      = NULL;
   (*render)->kernel_table       = NULL;
   (*render)->kernel_table_3d    = NULL;
   (*render)->kernel_table_avg   = 0.;
+  (*render)->kernel_stamps      = NULL;
+  (*render)->flag_exact_kernel  = FALSE;
+  (*render)->flag_frame_coherent= FALSE;
+  (*render)->lod_threshold      = RENDER_LOD_THRESHOLD_DEFAULT;
+  (*render)->projection_cache   = NULL;
+  (*render)->snapshot_cache     = NULL;
+  (*render)->snapshot_cache_size_max=RENDER_SNAPSHOT_CACHE_SIZE_DEFAULT;
+  (*render)->snapshot_cache_clock=0;
+  (*render)->n_prefetch         = RENDER_N_PREFETCH_DEFAULT;
+  (*render)->snap_prefetch_list = NULL;
+  (*render)->snapshot_prefetch  = NULL;
+  (*render)->n_write_queue      = RENDER_N_WRITE_QUEUE_DEFAULT;
+  (*render)->frame_writer       = NULL;
   (*render)->f_interpolate      = 0.;
 
   // Initialize colour information
@@ -74,6 +91,7 @@ void init_render(render_info **render){
   // Indicates that we haven't finalized this structure yet
   (*render)->sealed = FALSE;
 
+  SID_pop_memory_tag();
   SID_log("Done.",SID_LOG_CLOSE);
 }
 
@@ -207,6 +207,42 @@ void parse_render_file(render_info **render, char *filename){
         }
         else if(!strcmp(parameter,"force_periodic"))
           (*render)->flag_force_periodic=TRUE;
+        else if(!strcmp(parameter,"exact_kernel"))
+          (*render)->flag_exact_kernel=TRUE;
+        else if(!strcmp(parameter,"frame_coherent"))
+          (*render)->flag_frame_coherent=TRUE;
+        else if(!strcmp(parameter,"lod_threshold")){
+          grab_double(line,i_word++,&d_value);
+          if(d_value<0.)
+             SID_trap_error("lod_threshold has been set to %le but must be >=0.",ERROR_LOGIC,d_value);
+          (*render)->lod_threshold=d_value;
+        }
+        else if(!strcmp(parameter,"snapshot_cache_size")){
+          grab_double(line,i_word++,&d_value);
+          if(d_value<0.)
+             SID_trap_error("snapshot_cache_size has been set to %le [Mb] but must be >=0.",ERROR_LOGIC,d_value);
+          (*render)->snapshot_cache_size_max=(size_t)(d_value*SIZE_OF_MEGABYTE);
+        }
+        else if(!strcmp(parameter,"n_prefetch")){
+          grab_int(line,i_word++,&((*render)->n_prefetch));
+          if((*render)->n_prefetch<0)
+             SID_trap_error("n_prefetch has been set to %d but must be >=0.",ERROR_LOGIC,(*render)->n_prefetch);
+        }
+        else if(!strcmp(parameter,"n_write_queue")){
+          grab_int(line,i_word++,&((*render)->n_write_queue));
+          if((*render)->n_write_queue<0)
+             SID_trap_error("n_write_queue has been set to %d but must be >=0.",ERROR_LOGIC,(*render)->n_write_queue);
+        }
+        else if(!strcmp(parameter,"n_threads")){
+          grab_int(line,i_word++,&((*render)->n_threads));
+          if((*render)->n_threads<0)
+             SID_trap_error("n_threads has been set to %d but must be >=0.",ERROR_LOGIC,(*render)->n_threads);
+        }
+        else if(!strcmp(parameter,"tile_size")){
+          grab_int(line,i_word++,&((*render)->tile_size));
+          if((*render)->tile_size<1)
+             SID_trap_error("tile_size has been set to %d but must be >0.",ERROR_LOGIC,(*render)->tile_size);
+        }
         else if(!strcmp(parameter,"camera")){
           grab_word(line,i_word++,variable);
           if(!strcmp(variable,"size")){
@@ -659,15 +659,28 @@ void execute_marking_argument_local(render_info *render,mark_arg_info *arg){
    SID_log("Done.",SID_LOG_CLOSE);
 }
 
+// Apply the mark arguments to the loaded snapshots.  A snapshot's marks depend
+//   only on the snapshot and the mark arguments, so nothing is done if all of
+//   them have been marked already (eg. when they are reused from the snapshot
+//   cache).  Otherwise, render->mark_generation is incremented.
 void perform_marking(render_info *render){
    mark_arg_info *current_arg=render->mark_arg_first;
-   if(current_arg!=NULL){
+   int            flag_marked=TRUE;
+   for(int i_snap=0;i_snap<render->n_interpolate && flag_marked;i_snap++)
+      flag_marked=ADaPS_exist(render->plist_list[i_snap]->data,"flag_marked");
+   if(current_arg!=NULL && !flag_marked){
       SID_log("Performing particle marking...",SID_LOG_OPEN|SID_LOG_TIMER);
       while(current_arg!=NULL){
          // Perform marking
          execute_marking_argument_local(render,current_arg);
          current_arg=current_arg->next;
       }
+      flag_marked=TRUE;
+      for(int i_snap=0;i_snap<render->n_interpolate;i_snap++){
+         if(!ADaPS_exist(render->plist_list[i_snap]->data,"flag_marked"))
+            ADaPS_store(&(render->plist_list[i_snap]->data),(void *)(&flag_marked),"flag_marked",ADaPS_SCALAR_INT);
+      }
+      render->mark_generation++;
       SID_log("Done.",SID_LOG_CLOSE);
    }
 }
@@ -0,0 +1,262 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <gd.h>
+#include <gbpLib.h>
+#include <gbpSPH.h>
+#include <gbpRender.h>
+
+// Advise the OS that a file will be needed soon.  This is only a hint: it
+//   returns immediately and the kernel may or may not start reading the
+//   file into its page cache (it does nothing where posix_fadvise() is
+//   unavailable).  Used when a snapshot can not be loaded in the background.
+void prefetch_snapshot_file(const char *filename);
+void prefetch_snapshot_file(const char *filename){
+#ifdef POSIX_FADV_WILLNEED
+  int fd=open(filename,O_RDONLY);
+  if(fd>=0){
+     posix_fadvise(fd,0,0,POSIX_FADV_WILLNEED);
+     close(fd);
+  }
+#endif
+}
+
+// Add a file to a list of files to be read into RAM and return its size
+//   (or zero, in which case it is not added, if it does not exist).
+size_t add_snapshot_prefetch_file(file_image_info **file_images,const char *filename);
+size_t add_snapshot_prefetch_file(file_image_info **file_images,const char *filename){
+  struct stat      file_stat;
+  file_image_info *new_image;
+  if(stat(filename,&file_stat)!=0 || file_stat.st_size<=0)
+     return(0);
+  new_image      =(file_image_info *)SID_malloc(sizeof(file_image_info));
+  strcpy(new_image->filename,filename);
+  new_image->size=(size_t)file_stat.st_size;
+  new_image->data=NULL;
+  new_image->next=(*file_images);
+  (*file_images)=new_image;
+  return(new_image->size);
+}
+
+#if USE_PTHREADS
+// Read each of a prefetch's files into RAM.  Only stdio is used here;
+//   all SID and MPI calls stay on the calling thread.
+void *read_snapshot_prefetch_local(void *prefetch_in);
+void *read_snapshot_prefetch_local(void *prefetch_in){
+  snapshot_prefetch_info *prefetch   =(snapshot_prefetch_info *)prefetch_in;
+  file_image_info        *current;
+  int                     flag_failed=FALSE;
+  for(current=prefetch->file_images;current!=NULL && !flag_failed;current=current->next){
+     FILE *fp=fopen(current->filename,"r");
+     if(fp==NULL)
+        flag_failed=TRUE;
+     else{
+        if(fread(current->data,1,current->size,fp)!=current->size)
+           flag_failed=TRUE;
+        fclose(fp);
+     }
+  }
+  pthread_mutex_lock(&(prefetch->lock));
+  prefetch->flag_failed=flag_failed;
+  prefetch->flag_done  =TRUE;
+  pthread_mutex_unlock(&(prefetch->lock));
+  return(NULL);
+}
+#endif
+
+// Start loading a snapshot's files into RAM.  With POSIX threads, the
+//   master rank reads them in a separate thread and they are parsed (into
+//   the snapshot cache) once they are in.  If that is not possible, or if
+//   the files would not fit in the snapshot cache, the OS is just advised
+//   that they will be needed.  Called collectively.
+void start_snapshot_prefetch(render_info *render,int snap);
+void start_snapshot_prefetch(render_info *render,int snap){
+  gadget_read_info   fp_gadget;
+  smooth_header_info header_smooth;
+  file_image_info   *file_images=NULL;
+  file_image_info   *current;
+  file_image_info   *next;
+  char               filename[MAX_FILENAME_LENGTH];
+  int                i_file;
+  int                flag_multifile;
+  int                flag_file_type;
+  int                flag_load;
+  size_t             size_total =0;
+
+  // List the snapshot's files
+  if(init_gadget_read(render->snap_filename_root,snap,&fp_gadget) && SID.I_am_Master){
+     for(i_file=0;i_file<(fp_gadget.flag_multifile?MAX(1,fp_gadget.header.n_files):1);i_file++){
+        set_gadget_filename(&fp_gadget,i_file,filename);
+        size_total+=add_snapshot_prefetch_file(&file_images,filename);
+     }
+     if(init_smooth_read(render->smooth_filename_root,snap,&flag_multifile,&flag_file_type,&header_smooth)){
+        for(i_file=0;i_file<(flag_multifile?MAX(1,header_smooth.n_files):1);i_file++){
+           set_smooth_filename(render->smooth_filename_root,snap,i_file,flag_multifile,flag_file_type,filename);
+           size_total+=add_snapshot_prefetch_file(&file_images,filename);
+        }
+     }
+  }
+  SID_Bcast(&size_total,(int)sizeof(size_t),MASTER_RANK,SID.COMM_WORLD);
+#if USE_PTHREADS
+  flag_load=(size_total>0 && size_total<=render->snapshot_cache_size_max);
+#else
+  flag_load=FALSE;
+#endif
+
+  // Start the read ...
+  if(flag_load){
+     snapshot_prefetch_info *prefetch=(snapshot_prefetch_info *)SID_malloc(sizeof(snapshot_prefetch_info));
+     SID_log("Loading snapshot %d in the background...",SID_LOG_OPEN,snap);
+     prefetch->snap       =snap;
+     prefetch->file_images=file_images;
+     prefetch->flag_done  =FALSE;
+     prefetch->flag_failed=FALSE;
+     prefetch->next       =render->snapshot_prefetch;
+     render->snapshot_prefetch=prefetch;
+     for(current=file_images;current!=NULL;current=current->next)
+        current->data=(char *)SID_malloc(current->size);
+#if USE_PTHREADS
+     pthread_mutex_init(&(prefetch->lock),NULL);
+     prefetch->flag_thread=FALSE;
+     if(SID.I_am_Master){
+        if(pthread_create(&(prefetch->thread),NULL,read_snapshot_prefetch_local,(void *)prefetch)!=0)
+           SID_trap_error("Could not start the snapshot prefetch thread.",ERROR_LOGIC);
+        prefetch->flag_thread=TRUE;
+     }
+#endif
+     SID_log("Done.",SID_LOG_CLOSE);
+  }
+  // ... or just issue hints
+  else{
+     SID_log("Advising read-ahead of snapshot %d...",SID_LOG_OPEN,snap);
+     for(current=file_images;current!=NULL;current=next){
+        next=current->next;
+        prefetch_snapshot_file(current->filename);
+        SID_free(SID_FARG current);
+     }
+     SID_log("Done.",SID_LOG_CLOSE);
+  }
+}
+
+// Parse the snapshots which have finished loading in the background and
+//   place them in the snapshot cache.  Called collectively.
+void finish_snapshot_prefetches(render_info *render);
+void finish_snapshot_prefetches(render_info *render){
+  snapshot_prefetch_info *current;
+  snapshot_prefetch_info *next;
+  for(current=render->snapshot_prefetch;current!=NULL;current=next){
+     int snap     =current->snap;
+     int flag_done=FALSE;
+     next=current->next;
+#if USE_PTHREADS
+     if(current->flag_thread){
+        pthread_mutex_lock(&(current->lock));
+        flag_done=current->flag_done;
+        pthread_mutex_unlock(&(current->lock));
+     }
+#endif
+     SID_Bcast(&flag_done,(int)sizeof(int),MASTER_RANK,SID.COMM_WORLD);
+     if(flag_done){
+        plist_info plist;
+        SID_log("Placing snapshot %d in the snapshot cache...",SID_LOG_OPEN|SID_LOG_TIMER,snap);
+        init_plist(&plist,NULL,GADGET_LENGTH,GADGET_MASS,GADGET_VELOCITY);
+        read_render_snapshot(render,snap,&plist); // This frees current
+        add_snapshot_cache(render,snap,&(plist.data));
+        free_plist(&plist);
+        SID_log("Done.",SID_LOG_CLOSE);
+     }
+  }
+}
+
+// Determine the time that will be rendered at a given frame.
+//   Returns FALSE if no scene contains the frame.
+int prefetch_frame_time(render_info *render,int frame,double *time);
+int prefetch_frame_time(render_info *render,int frame,double *time){
+  scene_info *current_scene=render->scenes;
+  while(current_scene!=NULL){
+    if(frame==current_scene->first_frame){
+      (*time)=current_scene->first_perspective->time;
+      return(TRUE);
+    }
+    else if(frame==current_scene->last_frame){
+      (*time)=current_scene->last_perspective->time;
+      return(TRUE);
+    }
+    else if(frame>=current_scene->first_frame && frame<current_scene->last_frame){
+      (*time)=interpolate(current_scene->interp->time,(double)frame);
+      return(TRUE);
+    }
+    current_scene=current_scene->next;
+  }
+  return(FALSE);
+}
+
+// Load the next n_prefetch snapshots (ie. ones not already loaded, cached
+//   or loading) that upcoming frames will need, so that they are read while
+//   frames render, and move any that have finished loading into the
+//   snapshot cache.  This is called collectively by all ranks.
+void prefetch_snapshots(render_info *render,int frame){
+  int i_frame;
+  int i_prefetch;
+  int n_prefetch;
+  int snap_best;
+  int snap_lo;
+  int snap_hi;
+  int snap;
+  int i_snap;
+  int flag_skip;
+  double time;
+  double snap_diff_best;
+
+  if(render->n_prefetch<=0 || render->snap_a_list==NULL || render->n_snap_a_list<=0)
+     return;
+  if(render->snap_prefetch_list==NULL){
+     render->snap_prefetch_list=(int *)SID_malloc(sizeof(int)*render->n_prefetch);
+     for(i_prefetch=0;i_prefetch<render->n_prefetch;i_prefetch++)
+        render->snap_prefetch_list[i_prefetch]=-1;
+  }
+
+  // Cache the snapshots which have finished loading
+  finish_snapshot_prefetches(render);
+
+  // Find the snapshots needed by upcoming frames (every rank
+  //   makes the same decisions since they hold the same scenes)
+  int *snap_new=(int *)SID_malloc(sizeof(int)*render->n_prefetch);
+  for(i_frame=frame+1,n_prefetch=0;i_frame<=frame+RENDER_PREFETCH_LOOKAHEAD && n_prefetch<render->n_prefetch;i_frame++){
+     if(!prefetch_frame_time(render,i_frame,&time))
+        break;
+     pick_best_snap(time,render->snap_a_list,render->n_snap_a_list,&snap_best,&snap_diff_best);
+     snap_lo=MAX(0,snap_best-render->n_interpolate/2);
+     snap_hi=MIN(render->n_snap_a_list-1,snap_best+render->n_interpolate/2);
+     for(snap=snap_lo;snap<=snap_hi && n_prefetch<render->n_prefetch;snap++){
+        flag_skip=FALSE;
+        for(i_snap=0;i_snap<render->n_interpolate && render->snap_list!=NULL && !flag_skip;i_snap++)
+           flag_skip=(render->snap_list[i_snap]==snap);
+        for(i_prefetch=0;i_prefetch<render->n_prefetch && !flag_skip;i_prefetch++)
+           flag_skip=(render->snap_prefetch_list[i_prefetch]==snap);
+        for(i_prefetch=0;i_prefetch<n_prefetch && !flag_skip;i_prefetch++)
+           flag_skip=(snap_new[i_prefetch]==snap);
+        for(snapshot_cache_info *current=render->snapshot_cache;current!=NULL && !flag_skip;current=current->next)
+           flag_skip=(current->snap==snap);
+        for(snapshot_prefetch_info *current=render->snapshot_prefetch;current!=NULL && !flag_skip;current=current->next)
+           flag_skip=(current->snap==snap);
+        if(!flag_skip)
+           snap_new[n_prefetch++]=snap;
+     }
+  }
+
+  // Start loading them
+  for(i_prefetch=0;i_prefetch<n_prefetch;i_prefetch++)
+     start_snapshot_prefetch(render,snap_new[i_prefetch]);
+
+  // Remember what has been prefetched (most recent first)
+  for(i_prefetch=render->n_prefetch-1;i_prefetch>=n_prefetch;i_prefetch--)
+     render->snap_prefetch_list[i_prefetch]=render->snap_prefetch_list[i_prefetch-n_prefetch];
+  for(i_prefetch=0;i_prefetch<n_prefetch;i_prefetch++)
+     render->snap_prefetch_list[i_prefetch]=snap_new[i_prefetch];
+  SID_free(SID_FARG snap_new);
+}
@@ -118,11 +118,11 @@ void process_SSimPL_halos(render_info *render,
   SID_fp_buffer *fp_groups_offset_buffer   =NULL;
   SID_fp_buffer *fp_trees_in_buffer        =NULL;
   size_t n_bytes_trees                     =sizeof(int)*((8*(size_t)n_groups)+(7*(size_t)n_subgroups));
-  init_SID_fp_buffer(&fp_subgroups_length,(size_t)n_subgroups*sizeof(int),SIZE_OF_MEGABYTE,&fp_subgroups_length_buffer);
-  init_SID_fp_buffer(&fp_subgroups_offset,(size_t)n_subgroups*offset_size,SIZE_OF_MEGABYTE,&fp_subgroups_offset_buffer);
-  init_SID_fp_buffer(&fp_groups_length,   (size_t)n_groups   *sizeof(int),SIZE_OF_MEGABYTE,&fp_groups_length_buffer);
-  init_SID_fp_buffer(&fp_groups_offset,   (size_t)n_groups   *offset_size,SIZE_OF_MEGABYTE,&fp_groups_offset_buffer);
-  init_SID_fp_buffer(&fp_trees_in,        n_bytes_trees,                  SIZE_OF_MEGABYTE,&fp_trees_in_buffer);
+  init_SID_fp_buffer_read_ahead(&fp_subgroups_length,(size_t)n_subgroups*sizeof(int),SIZE_OF_MEGABYTE,&fp_subgroups_length_buffer);
+  init_SID_fp_buffer_read_ahead(&fp_subgroups_offset,(size_t)n_subgroups*offset_size,SIZE_OF_MEGABYTE,&fp_subgroups_offset_buffer);
+  init_SID_fp_buffer_read_ahead(&fp_groups_length,   (size_t)n_groups   *sizeof(int),SIZE_OF_MEGABYTE,&fp_groups_length_buffer);
+  init_SID_fp_buffer_read_ahead(&fp_groups_offset,   (size_t)n_groups   *offset_size,SIZE_OF_MEGABYTE,&fp_groups_offset_buffer);
+  init_SID_fp_buffer_read_ahead(&fp_trees_in,        n_bytes_trees,                  SIZE_OF_MEGABYTE,&fp_trees_in_buffer);
 
   // Open IDs file and initialize the IDs array
   int     flag_long_ids=TRUE;
@@ -153,9 +153,9 @@ void process_SSimPL_halos(render_info *render,
      ids=SID_malloc(id_byte_size*largest_group);
   int    *ids_i=(int    *)ids;
   size_t *ids_l=(size_t *)ids;
-  // Reset the group length pointer
-  SID_fseek(&fp_groups_length,sizeof(int),2,SID_SEEK_SET);
+  // Reset the group length pointer (the buffer first, so no read is pending when we seek)
   reset_SID_fp_buffer(&fp_groups_length_buffer);
+  SID_fseek(&fp_groups_length,sizeof(int),2,SID_SEEK_SET);
 
   // Initialize the datastructures which will hold the group and subgroup information
   process_halo_info group_i;
@@ -259,16 +259,16 @@ void process_SSimPL_halos(render_info *render,
   } // i_group
 
   // Free the buffers and perform sanity checks
-  SID_fclose(&fp_trees_in);
-  SID_fclose(&fp_groups_length);
-  SID_fclose(&fp_groups_offset);
-  SID_fclose(&fp_subgroups_length);
-  SID_fclose(&fp_subgroups_offset);
   free_SID_fp_buffer(&fp_trees_in_buffer);
   free_SID_fp_buffer(&fp_groups_length_buffer);
   free_SID_fp_buffer(&fp_groups_offset_buffer);
   free_SID_fp_buffer(&fp_subgroups_length_buffer);
   free_SID_fp_buffer(&fp_subgroups_offset_buffer);
+  SID_fclose(&fp_trees_in);
+  SID_fclose(&fp_groups_length);
+  SID_fclose(&fp_groups_offset);
+  SID_fclose(&fp_subgroups_length);
+  SID_fclose(&fp_subgroups_offset);
   if(i_pass){
      SID_fclose(&fp_ids);
      SID_free(SID_FARG ids);
@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <gd.h>
+#include <gbpLib.h>
+#include <gbpSPH.h>
+#include <gbpRender.h>
+
+#if USE_PTHREADS
+// Copy an image's values to the frame writer's copy of it (allocated on first use)
+static void copy_frame_writer_image(image_info *image,image_info **image_copy);
+static void copy_frame_writer_image(image_info *image,image_info **image_copy){
+  if(image==NULL)
+     free_image(image_copy);
+  else{
+     if((*image_copy)==NULL)
+        init_image(image->width,image->height,image->colourmapselect,image_copy);
+     memcpy((*image_copy)->values,image->values,sizeof(double)*image->n_pixels);
+  }
+}
+
+// Copy everything that write_frame_images() needs from a camera
+static void copy_frame_writer_camera(camera_info *camera,camera_info *camera_copy);
+static void copy_frame_writer_camera(camera_info *camera,camera_info *camera_copy){
+  camera_copy->width       =camera->width;
+  camera_copy->height      =camera->height;
+  camera_copy->RGB_mode    =camera->RGB_mode;
+  camera_copy->RGB_range[0]=camera->RGB_range[0];
+  camera_copy->RGB_range[1]=camera->RGB_range[1];
+  camera_copy->Y_range[0]  =camera->Y_range[0];
+  camera_copy->Y_range[1]  =camera->Y_range[1];
+  camera_copy->Z_range[0]  =camera->Z_range[0];
+  camera_copy->Z_range[1]  =camera->Z_range[1];
+  copy_frame_writer_image(camera->image_RGB,                &(camera_copy->image_RGB));
+  copy_frame_writer_image(camera->image_RGB_left,           &(camera_copy->image_RGB_left));
+  copy_frame_writer_image(camera->image_RGB_right,          &(camera_copy->image_RGB_right));
+  copy_frame_writer_image(camera->image_Y,                  &(camera_copy->image_Y));
+  copy_frame_writer_image(camera->image_Y_left,             &(camera_copy->image_Y_left));
+  copy_frame_writer_image(camera->image_Y_right,            &(camera_copy->image_Y_right));
+  copy_frame_writer_image(camera->image_RGBY,               &(camera_copy->image_RGBY));
+  copy_frame_writer_image(camera->image_RGBY_left,          &(camera_copy->image_RGBY_left));
+  copy_frame_writer_image(camera->image_RGBY_right,         &(camera_copy->image_RGBY_right));
+  copy_frame_writer_image(camera->image_RY,                 &(camera_copy->image_RY));
+  copy_frame_writer_image(camera->image_RY_left,            &(camera_copy->image_RY_left));
+  copy_frame_writer_image(camera->image_RY_right,           &(camera_copy->image_RY_right));
+  copy_frame_writer_image(camera->image_GY,                 &(camera_copy->image_GY));
+  copy_frame_writer_image(camera->image_GY_left,            &(camera_copy->image_GY_left));
+  copy_frame_writer_image(camera->image_GY_right,           &(camera_copy->image_GY_right));
+  copy_frame_writer_image(camera->image_BY,                 &(camera_copy->image_BY));
+  copy_frame_writer_image(camera->image_BY_left,            &(camera_copy->image_BY_left));
+  copy_frame_writer_image(camera->image_BY_right,           &(camera_copy->image_BY_right));
+  copy_frame_writer_image(camera->image_RGBY_3CHANNEL,      &(camera_copy->image_RGBY_3CHANNEL));
+  copy_frame_writer_image(camera->image_RGBY_3CHANNEL_left, &(camera_copy->image_RGBY_3CHANNEL_left));
+  copy_frame_writer_image(camera->image_RGBY_3CHANNEL_right,&(camera_copy->image_RGBY_3CHANNEL_right));
+  copy_frame_writer_image(camera->image_Z,                  &(camera_copy->image_Z));
+  copy_frame_writer_image(camera->image_Z_left,             &(camera_copy->image_Z_left));
+  copy_frame_writer_image(camera->image_Z_right,            &(camera_copy->image_Z_right));
+}
+
+// Write queued frames (in order) until told to stop and the queue is empty
+static void *frame_writer_thread(void *writer_in);
+static void *frame_writer_thread(void *writer_in){
+  frame_writer_info      *writer=(frame_writer_info *)writer_in;
+  frame_writer_slot_info *slot;
+  pthread_mutex_lock(&(writer->lock));
+  while(TRUE){
+     while(writer->n_queued==0 && !writer->flag_stop)
+        pthread_cond_wait(&(writer->cond_queued),&(writer->lock));
+     if(writer->n_queued==0)
+        break;
+     slot=&(writer->slots[writer->i_head]);
+     pthread_mutex_unlock(&(writer->lock));
+     write_frame_images(slot->camera,slot->filename_out_dir,slot->frame,slot->mode);
+     pthread_mutex_lock(&(writer->lock));
+     writer->i_head=(writer->i_head+1)%writer->n_slots;
+     writer->n_queued--;
+     pthread_cond_signal(&(writer->cond_written));
+  }
+  pthread_mutex_unlock(&(writer->lock));
+  return(NULL);
+}
+#endif
+
+// Hand a rendered frame to the frame writer, which colour-maps and writes
+//   it in a separate thread while the next frame is rendered.  At most
+//   render->n_write_queue frames may be waiting; beyond that this call
+//   blocks.  Frames are written synchronously (with write_frame()) if
+//   n_write_queue is zero or if USE_PTHREADS is off.  Master rank only;
+//   call flush_frame_writer() once the last frame has been queued.
+void queue_frame(render_info *render,int frame,int mode){
+#if USE_PTHREADS
+  if(render->n_write_queue>0){
+     frame_writer_info      *writer;
+     frame_writer_slot_info *slot;
+     int                     i_slot;
+
+     SID_log("Queueing rendered frame...",SID_LOG_OPEN|SID_LOG_TIMER);
+
+     // Create directory if needed
+     char filename_out_dir_raw[MAX_FILENAME_LENGTH];
+     sprintf(filename_out_dir_raw,"%s/raw",render->filename_out_dir);
+     mkdir(render->filename_out_dir,02755);
+     mkdir(filename_out_dir_raw,    02755);
+
+     // Write a set of files describing the details of the rendering
+     if(!check_mode_for_flag(render->mode,SET_RENDER_RESCALE))
+        write_path_file(render,frame);
+
+     // Start the writer thread on the first call
+     if(render->frame_writer==NULL){
+        writer          =(frame_writer_info *)SID_malloc(sizeof(frame_writer_info));
+        writer->n_slots =render->n_write_queue;
+        writer->i_head  =0;
+        writer->n_queued=0;
+        writer->flag_stop=FALSE;
+        writer->slots   =(frame_writer_slot_info *)SID_malloc(sizeof(frame_writer_slot_info)*writer->n_slots);
+        for(i_slot=0;i_slot<writer->n_slots;i_slot++)
+           writer->slots[i_slot].camera=(camera_info *)SID_calloc(sizeof(camera_info));
+        pthread_mutex_init(&(writer->lock),        NULL);
+        pthread_cond_init (&(writer->cond_queued), NULL);
+        pthread_cond_init (&(writer->cond_written),NULL);
+        if(pthread_create(&(writer->thread),NULL,frame_writer_thread,writer)!=0)
+           SID_trap_error("Could not start the frame writer thread.",ERROR_LOGIC);
+        render->frame_writer=writer;
+     }
+     writer=render->frame_writer;
+
+     // Wait for a free slot.  The writer thread never touches free slots,
+     //   so the frame can be copied without holding the lock.
+     pthread_mutex_lock(&(writer->lock));
+     while(writer->n_queued==writer->n_slots)
+        pthread_cond_wait(&(writer->cond_written),&(writer->lock));
+     slot=&(writer->slots[(writer->i_head+writer->n_queued)%writer->n_slots]);
+     pthread_mutex_unlock(&(writer->lock));
+     slot->frame=frame;
+     slot->mode =mode;
+     strcpy(slot->filename_out_dir,render->filename_out_dir);
+     copy_frame_writer_camera(render->camera,slot->camera);
+
+     // Queue it
+     pthread_mutex_lock(&(writer->lock));
+     writer->n_queued++;
+     pthread_cond_signal(&(writer->cond_queued));
+     pthread_mutex_unlock(&(writer->lock));
+
+     SID_log("Done.",SID_LOG_CLOSE);
+     return;
+  }
+#endif
+  write_frame(render,frame,mode);
+}
@@ -260,7 +260,7 @@ void read_gadget_binary_render(char       *filename_root_in,
             int flag_file_missing=FALSE;
             gadget_header_info header;
             if(SID.My_rank==read_rank){
-               fp=fopen(filename,"r");
+               fp=fopen_plist(plist,filename);
                if(fp!=NULL){
                   fread_verify(&record_length_open,4,1,fp);
                   fread_verify(&header,sizeof(gadget_header_info),1,fp);
@@ -410,7 +410,7 @@ void read_gadget_binary_render(char       *filename_root_in,
          int    record_length_positions=0;
          gadget_header_info header;
          if(SID.My_rank==read_rank){
-            fp=fopen(filename,"r");
+            fp=fopen_plist(plist,filename);
             if(fp!=NULL){
                fread_verify(&record_length_open,4,1,fp);
                fread_verify(&header,sizeof(gadget_header_info),1,fp);
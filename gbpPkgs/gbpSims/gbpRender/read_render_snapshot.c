@@ -0,0 +1,45 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gbpLib.h>
+#include <gbpSPH.h>
+#include <gbpRender.h>
+
+// Read a snapshot and its smoothing file into plist.  If the snapshot is
+//   being loaded in the background (see prefetch_snapshots()), wait for
+//   its files and read them from RAM instead of disk.  Called collectively.
+void read_render_snapshot(render_info *render,int snap,plist_info *plist){
+  snapshot_prefetch_info *prefetch;
+  snapshot_prefetch_info *last;
+
+  // Take this snapshot's prefetch (if any) out of the list
+  for(prefetch=render->snapshot_prefetch,last=NULL;prefetch!=NULL && prefetch->snap!=snap;last=prefetch,prefetch=prefetch->next);
+  if(prefetch!=NULL){
+     if(last==NULL)
+        render->snapshot_prefetch=prefetch->next;
+     else
+        last->next=prefetch->next;
+#if USE_PTHREADS
+     SID_log("Waiting for snapshot %d to finish loading...",SID_LOG_OPEN|SID_LOG_TIMER,snap);
+     if(prefetch->flag_thread){
+        pthread_join(prefetch->thread,NULL);
+        prefetch->flag_thread=FALSE;
+     }
+     SID_log("Done.",SID_LOG_CLOSE);
+#endif
+     if(prefetch->flag_failed)
+        SID_log("Snapshot %d could not be loaded in the background; reading it again.",SID_LOG_COMMENT,snap);
+     else
+        plist->file_images=prefetch->file_images;
+  }
+
+  // Perform the read
+  read_gadget_binary_render(render->snap_filename_root,snap,plist,READ_GADGET_RENDER_SCATTER);
+  if(render->n_interpolate>1)
+     read_smooth(plist,render->smooth_filename_root,snap,
+                 SMOOTH_DEFAULT|READ_SMOOTH_LOG_SIGMA|READ_SMOOTH_LOG_RHO); // this is to speed-up logarythmic interpolation
+  else
+     read_smooth(plist,render->smooth_filename_root,snap,SMOOTH_DEFAULT);
+  plist->file_images=NULL;
+  free_snapshot_prefetch(&prefetch);
+}
@@ -78,14 +78,18 @@ int main(int argc, char *argv[]){
     // Write output
     if(SID.I_am_Master){
       if(mode==SET_RENDER_RESCALE)
-        write_frame(render,i_frame,WRITE_IMAGE_DEFAULT&(~WRITE_IMAGE_RAW));
+        queue_frame(render,i_frame,WRITE_IMAGE_DEFAULT&(~WRITE_IMAGE_RAW));
       else
-        write_frame(render,i_frame,WRITE_IMAGE_DEFAULT);
+        queue_frame(render,i_frame,WRITE_IMAGE_DEFAULT);
     }
 
     SID_log("Done.",SID_LOG_CLOSE);
   }
   
+  // Wait for any queued frames to be written
+  if(SID.I_am_Master)
+    flush_frame_writer(render);
+
   // Clean-up 
   free_render(&render);
   
@@ -1,11 +1,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <math.h>
 #include <gbpLib.h>
 #include <gbpSPH.h>
 #include <gbpCosmo.h>
 #include <gbpRender.h>
+#if USE_OPENMP
+  #include <omp.h>
+#endif
 
 void rotate_particle(double   x_hat,
                      double   y_hat,
@@ -676,6 +680,596 @@ int check_if_particle_marked(char **mark,int i_species,size_t i_particle,char *c
    }
 }
 
+// Fold n_bytes of data into a running (64-bit FNV-1a) hash
+size_t hash_render_state(size_t hash,const void *data,size_t n_bytes);
+size_t hash_render_state(size_t hash,const void *data,size_t n_bytes){
+  const unsigned char *bytes=(const unsigned char *)data;
+  size_t               i_byte;
+  for(i_byte=0;i_byte<n_bytes;i_byte++){
+     hash^=(size_t)bytes[i_byte];
+     hash*=(size_t)1099511628211ULL;
+  }
+  return(hash);
+}
+
+// Fold a transfer function (or its absence) into a running hash
+size_t hash_render_transfer(size_t hash,interp_info *transfer,int flag_log);
+size_t hash_render_transfer(size_t hash,interp_info *transfer,int flag_log){
+  int flag_exist=(transfer!=NULL);
+  hash=hash_render_state(hash,&flag_exist,sizeof(int));
+  if(flag_exist){
+     hash=hash_render_state(hash,&flag_log,     sizeof(int));
+     hash=hash_render_state(hash,&(transfer->n),sizeof(size_t));
+     hash=hash_render_state(hash,transfer->x,   sizeof(double)*transfer->n);
+     hash=hash_render_state(hash,transfer->y,   sizeof(double)*transfer->n);
+  }
+  return(hash);
+}
+
+// Hash the state (other than the snapshots and the particle marks) that sets the
+//   quantities held in the projection cache: the camera's choice of quantities
+//   (and which of them goes to the RGB and Y channels) and the transfer functions
+//   applied to them
+size_t compute_render_projection_cache_key(render_info *render,map_quantities_info *mq);
+size_t compute_render_projection_cache_key(render_info *render,map_quantities_info *mq){
+  size_t hash=(size_t)14695981039346656037ULL;
+  hash=hash_render_state(hash,render->camera->RGB_param,              strlen(render->camera->RGB_param)+1);
+  hash=hash_render_state(hash,render->camera->Y_param,                strlen(render->camera->Y_param)+1);
+  hash=hash_render_state(hash,&(render->camera->flag_velocity_space),sizeof(int));
+  hash=hash_render_state(hash,&(mq->v_mode),                          sizeof(int));
+  hash=hash_render_state(hash,&(mq->w_mode),                          sizeof(int));
+  hash=hash_render_state(hash,mq->ptype_used,                         sizeof(int)*N_GADGET_TYPE);
+  hash=hash_render_transfer(hash,mq->transfer_rho,  mq->flag_transfer_rho_log);
+  hash=hash_render_transfer(hash,mq->transfer_sigma,mq->flag_transfer_sigma_log);
+  return(hash);
+}
+
+// Make sure that the projection cache holds this rank's share of the particles
+//   for the current render state.  The particles are only redistributed when the
+//   snapshots (or the interpolation between them), the camera's choice of
+//   quantities, the transfer functions or the particle marks have changed since
+//   the cache was last filled.
+void update_render_projection_cache(render_info         *render,
+                                    map_quantities_info *mq,
+                                    char               **mark,
+                                    int                  flag_mark_on,
+                                    float                box_size_float,
+                                    float                half_box);
+void update_render_projection_cache(render_info         *render,
+                                    map_quantities_info *mq,
+                                    char               **mark,
+                                    int                  flag_mark_on,
+                                    float                box_size_float,
+                                    float                half_box){
+  render_projection_cache_info *cache=render->projection_cache;
+  int    i_type;
+  int    i_rank;
+  int    i_snap;
+  size_t i_particle;
+  size_t j_particle;
+  size_t k_particle;
+  size_t n_particles_species;
+  char   c_i;
+
+  // Check if the cache is still valid (on all ranks)
+  size_t key             =compute_render_projection_cache_key(render,mq);
+  int    flag_valid_local=(cache!=NULL);
+  int    flag_valid;
+  if(flag_valid_local){
+     if(cache->n_interpolate!=render->n_interpolate || cache->f_interpolate!=render->f_interpolate ||
+        cache->key!=key || cache->mark_generation!=render->mark_generation)
+        flag_valid_local=FALSE;
+     for(i_snap=0;i_snap<render->n_interpolate && flag_valid_local;i_snap++){
+        if(cache->snap_list[i_snap]!=render->snap_list[i_snap])
+           flag_valid_local=FALSE;
+     }
+  }
+  SID_Allreduce(&flag_valid_local,&flag_valid,1,SID_INT,SID_MIN,SID.COMM_WORLD);
+  if(flag_valid){
+     SID_log("Particle distribution unchanged; skipping exchange.",SID_LOG_COMMENT);
+     return;
+  }
+
+  // (Re)initialize the cache
+  free_render_projection_cache(&(render->projection_cache));
+  cache=(render_projection_cache_info *)SID_malloc(sizeof(render_projection_cache_info));
+  cache->n_interpolate  =render->n_interpolate;
+  cache->f_interpolate  =render->f_interpolate;
+  cache->key            =key;
+  cache->mark_generation=render->mark_generation;
+  cache->snap_list      =(int *)SID_malloc(sizeof(int)*render->n_interpolate);
+  for(i_snap=0;i_snap<render->n_interpolate;i_snap++)
+     cache->snap_list[i_snap]=render->snap_list[i_snap];
+  cache->z_index    =NULL;
+  cache->n_lod_nodes=0;
+  cache->lod_nodes  =NULL;
+  render->projection_cache=cache;
+
+  // Count the number of (marked) particles going to each rank
+  size_t *n_rank      =(size_t *)SID_calloc(sizeof(size_t)*SID.n_proc);
+  size_t *n_rank_local=(size_t *)SID_calloc(sizeof(size_t)*SID.n_proc);
+  SID_log("Count particles...",SID_LOG_OPEN|SID_LOG_TIMER);
+  for(i_type=0,j_particle=0;i_type<N_GADGET_TYPE;i_type++){
+    if(mq->ptype_used[i_type] && ADaPS_exist(render->plist_list[0]->data,"n_%s",render->plist_list[0]->species[i_type])){
+      n_particles_species=((size_t *)ADaPS_fetch(render->plist_list[0]->data,"n_%s",render->plist_list[0]->species[i_type]))[0];
+      for(i_particle=0;i_particle<n_particles_species;i_particle++){
+         if(check_if_particle_marked(mark,i_type,i_particle,&c_i))
+            n_rank_local[i_particle%SID.n_proc]++;
+      }
+    }
+  }
+  SID_Allreduce(n_rank_local,n_rank,SID.n_proc,SID_SIZE_T,SID_SUM,SID.COMM_WORLD);
+  cache->n_particles=n_rank[SID.My_rank];
+  SID_log("Done.",SID_LOG_CLOSE);
+
+  // Determine the needed size of the comm buffers
+  size_t n_buffer;
+  calc_max(n_rank_local,&n_buffer,SID.n_proc,SID_SIZE_T,CALC_MODE_DEFAULT);
+
+  // Exchange particles
+  SID_log("Exchange particles...(buffer=%zd particles)...",SID_LOG_OPEN|SID_LOG_TIMER,n_buffer);
+  cache->x       =(float *)SID_malloc(sizeof(float)*cache->n_particles);
+  cache->y       =(float *)SID_malloc(sizeof(float)*cache->n_particles);
+  cache->z       =(float *)SID_malloc(sizeof(float)*cache->n_particles);
+  cache->h_smooth=(float *)SID_malloc(sizeof(float)*cache->n_particles);
+  cache->value   =(float *)SID_malloc(sizeof(float)*cache->n_particles);
+  cache->weight  =(float *)SID_malloc(sizeof(float)*cache->n_particles);
+  float *x_buffer=(float *)SID_malloc(sizeof(float)*n_buffer);
+  float *y_buffer=(float *)SID_malloc(sizeof(float)*n_buffer);
+  float *z_buffer=(float *)SID_malloc(sizeof(float)*n_buffer);
+  float *h_buffer=(float *)SID_malloc(sizeof(float)*n_buffer);
+  float *v_buffer=(float *)SID_malloc(sizeof(float)*n_buffer);
+  float *w_buffer=(float *)SID_malloc(sizeof(float)*n_buffer);
+  char  *c_buffer;
+  if(flag_mark_on){
+     cache->colour=(char *)SID_malloc(sizeof(char)*cache->n_particles);
+     c_buffer     =(char *)SID_malloc(sizeof(char)*n_buffer);
+  }
+  else{
+     cache->colour=NULL;
+     c_buffer     =NULL;
+  }
+  size_t j_particle_rank=0;
+  for(i_rank=0;i_rank<SID.n_proc;i_rank++){
+     size_t particle_index=0;
+     int    rank_to;
+     int    rank_from;
+     set_exchange_ring_ranks(&rank_to,&rank_from,i_rank);
+     for(i_type=0,j_particle=0;i_type<N_GADGET_TYPE;i_type++){
+       if(mq->ptype_used[i_type]){
+         n_particles_species=((size_t *)ADaPS_fetch(render->plist_list[0]->data,"n_%s",render->plist_list[0]->species[i_type]))[0];
+         for(i_particle=rank_to,k_particle=j_particle+rank_to;i_particle<n_particles_species;i_particle+=SID.n_proc,k_particle+=SID.n_proc){
+            if(check_if_particle_marked(mark,i_type,i_particle,&c_i)){
+               set_particle_map_quantities(render,mq,TRUE,k_particle,box_size_float,half_box,
+                                           &(x_buffer[particle_index]),
+                                           &(y_buffer[particle_index]),
+                                           &(z_buffer[particle_index]),
+                                           &(h_buffer[particle_index]),
+                                           &(v_buffer[particle_index]),
+                                           &(w_buffer[particle_index]));
+               if(c_buffer!=NULL)
+                  c_buffer[particle_index]=(char)c_i;
+               particle_index++;
+            }
+         }
+         j_particle+=n_particles_species;
+       }
+     }
+     if(particle_index!=n_rank_local[rank_to])
+        SID_trap_error("Buffer particle count does not equal desired exchange count (ie. %zd!=%zd)",ERROR_LOGIC,particle_index,n_rank_local[rank_to]);
+
+     // Perform exchanges
+     size_t n_exchange;
+     exchange_ring_buffer(x_buffer,sizeof(float),n_rank_local[rank_to],&(cache->x[j_particle_rank]),       &n_exchange,i_rank);
+     exchange_ring_buffer(y_buffer,sizeof(float),n_rank_local[rank_to],&(cache->y[j_particle_rank]),       &n_exchange,i_rank);
+     exchange_ring_buffer(z_buffer,sizeof(float),n_rank_local[rank_to],&(cache->z[j_particle_rank]),       &n_exchange,i_rank);
+     exchange_ring_buffer(h_buffer,sizeof(float),n_rank_local[rank_to],&(cache->h_smooth[j_particle_rank]),&n_exchange,i_rank);
+     exchange_ring_buffer(v_buffer,sizeof(float),n_rank_local[rank_to],&(cache->value[j_particle_rank]),   &n_exchange,i_rank);
+     exchange_ring_buffer(w_buffer,sizeof(float),n_rank_local[rank_to],&(cache->weight[j_particle_rank]),  &n_exchange,i_rank);
+     if(c_buffer!=NULL)
+        exchange_ring_buffer(c_buffer,sizeof(char),n_rank_local[rank_to],&(cache->colour[j_particle_rank]),&n_exchange,i_rank);
+     j_particle_rank+=n_exchange;
+  }
+  if(j_particle_rank!=cache->n_particles)
+     SID_trap_error("The wrong number of particles were received (ie. %zd!=%zd) on rank %d.",ERROR_LOGIC,
+                    j_particle_rank,cache->n_particles,SID.My_rank);
+  SID_log("Done.",SID_LOG_CLOSE);
+
+  // Clean-up
+  SID_free(SID_FARG n_rank);
+  SID_free(SID_FARG n_rank_local);
+  SID_free(SID_FARG x_buffer);
+  SID_free(SID_FARG y_buffer);
+  SID_free(SID_FARG z_buffer);
+  SID_free(SID_FARG h_buffer);
+  SID_free(SID_FARG v_buffer);
+  SID_free(SID_FARG w_buffer);
+  SID_free(SID_FARG c_buffer);
+}
+
+// Partition index[lo,hi) so that particles with coordinate<split come first.
+//   Returns the position of the first particle with coordinate>=split.
+size_t partition_render_lod_index(float *coord,size_t *index,size_t lo,size_t hi,double split);
+size_t partition_render_lod_index(float *coord,size_t *index,size_t lo,size_t hi,double split){
+  while(lo<hi){
+     if((double)coord[index[lo]]<split)
+        lo++;
+     else{
+        size_t swap=index[--hi];
+        index[hi]   =index[lo];
+        index[lo]   =swap;
+     }
+  }
+  return(lo);
+}
+
+// Sums used to set the aggregate properties of a LOD node from those of its
+//   members (particles or child nodes).  Members are weighted by their kernel
+//   integral (weight*h^2, which the aggregate conserves) or by their particle
+//   count if all of those are zero.
+typedef struct render_lod_sums_info render_lod_sums_info;
+struct render_lod_sums_info{
+  double M;                            // Kernel-integral weighted sums ...
+  double M_x,M_y,M_z,M_h2,M_v;
+  double N;                            // ... and particle-count weighted sums
+  double N_x,N_y,N_z,N_h2,N_v;
+  float  h_min;
+  float  h_max;
+  char   colour;
+  char   flag_mixed_colour;
+  int    flag_empty;
+};
+
+void add_render_lod_sums(render_lod_sums_info *sums,
+                         float x,float y,float z,float h_smooth,float h_min,float h_max,
+                         float value,float weight,char colour,char flag_mixed_colour,size_t n_particles);
+void add_render_lod_sums(render_lod_sums_info *sums,
+                         float x,float y,float z,float h_smooth,float h_min,float h_max,
+                         float value,float weight,char colour,char flag_mixed_colour,size_t n_particles){
+  double h2=(double)h_smooth*(double)h_smooth;
+  double m =(double)weight*h2;
+  double n =(double)n_particles;
+  if(sums->flag_empty){
+     memset(sums,0,sizeof(render_lod_sums_info));
+     sums->h_min =h_min;
+     sums->h_max =h_max;
+     sums->colour=colour;
+  }
+  sums->M   +=m;
+  sums->M_x +=m*(double)x;
+  sums->M_y +=m*(double)y;
+  sums->M_z +=m*(double)z;
+  sums->M_h2+=m*h2;
+  sums->M_v +=m*(double)value;
+  sums->N   +=n;
+  sums->N_x +=n*(double)x;
+  sums->N_y +=n*(double)y;
+  sums->N_z +=n*(double)z;
+  sums->N_h2+=n*h2;
+  sums->N_v +=n*(double)value;
+  sums->h_min=MIN(sums->h_min,h_min);
+  sums->h_max=MAX(sums->h_max,h_max);
+  if(flag_mixed_colour || colour!=sums->colour)
+     sums->flag_mixed_colour=TRUE;
+}
+
+void set_render_lod_node(render_lod_sums_info *sums,render_lod_node_info *node);
+void set_render_lod_node(render_lod_sums_info *sums,render_lod_node_info *node){
+  node->h_min            =sums->h_min;
+  node->h_max            =sums->h_max;
+  node->colour           =sums->colour;
+  node->flag_mixed_colour=sums->flag_mixed_colour;
+  node->radius           =0.;
+  if(sums->M>0. && sums->M_h2>0.){
+     node->x       =(float)(sums->M_x/sums->M);
+     node->y       =(float)(sums->M_y/sums->M);
+     node->z       =(float)(sums->M_z/sums->M);
+     node->h_smooth=(float)sqrt(sums->M_h2/sums->M);
+     node->value   =(float)(sums->M_v/sums->M);
+     node->weight  =(float)(sums->M*sums->M/sums->M_h2);
+  }
+  else{
+     node->x       =(float)(sums->N_x/sums->N);
+     node->y       =(float)(sums->N_y/sums->N);
+     node->z       =(float)(sums->N_z/sums->N);
+     node->h_smooth=(float)sqrt(sums->N_h2/sums->N);
+     node->value   =(float)(sums->N_v/sums->N);
+     node->weight  =0.;
+  }
+}
+
+// Expand a node's bounding radius to include a member of the given radius
+void add_render_lod_radius(render_lod_node_info *node,float x,float y,float z,float radius);
+void add_render_lod_radius(render_lod_node_info *node,float x,float y,float z,float radius){
+  double dx=(double)x-(double)node->x;
+  double dy=(double)y-(double)node->y;
+  double dz=(double)z-(double)node->z;
+  node->radius=MAX(node->radius,(float)(sqrt(dx*dx+dy*dy+dz*dz)+(double)radius));
+}
+
+// Recursively add particles index[i_first,i_first+n_particles) (which lie in the cube
+//   of half-width cell_half centred on cell_x,cell_y,cell_z) to the LOD tree
+void add_render_lod_node(render_projection_cache_info *cache,
+                         size_t                       *index,
+                         size_t                       *n_alloc,
+                         size_t                        i_first,
+                         size_t                        n_particles,
+                         double                        cell_x,
+                         double                        cell_y,
+                         double                        cell_z,
+                         double                        cell_half,
+                         int                           depth);
+void add_render_lod_node(render_projection_cache_info *cache,
+                         size_t                       *index,
+                         size_t                       *n_alloc,
+                         size_t                        i_first,
+                         size_t                        n_particles,
+                         double                        cell_x,
+                         double                        cell_y,
+                         double                        cell_z,
+                         double                        cell_half,
+                         int                           depth){
+  size_t               octant_start[9];
+  int                  i_octant;
+  int                  n_octant_used;
+  size_t               i_node;
+  size_t               i_child;
+  size_t               i_particle;
+  render_lod_sums_info sums;
+  int                  flag_leaf=(n_particles<=RENDER_LOD_LEAF_SIZE || depth>=RENDER_LOD_DEPTH_MAX);
+
+  // Split the particles into octants, descending (without adding
+  //   nodes) for as long as they all lie in the same one
+  while(!flag_leaf){
+     octant_start[0]=i_first;
+     octant_start[8]=i_first+n_particles;
+     octant_start[4]=partition_render_lod_index(cache->x,index,octant_start[0],octant_start[8],cell_x);
+     octant_start[2]=partition_render_lod_index(cache->y,index,octant_start[0],octant_start[4],cell_y);
+     octant_start[6]=partition_render_lod_index(cache->y,index,octant_start[4],octant_start[8],cell_y);
+     for(i_octant=0;i_octant<8;i_octant+=2)
+        octant_start[i_octant+1]=partition_render_lod_index(cache->z,index,octant_start[i_octant],octant_start[i_octant+2],cell_z);
+     for(i_octant=0,n_octant_used=0;i_octant<8;i_octant++){
+        if(octant_start[i_octant+1]>octant_start[i_octant])
+           n_octant_used++;
+     }
+     if(n_octant_used>1)
+        break;
+     for(i_octant=0;octant_start[i_octant+1]==octant_start[i_octant];i_octant++);
+     cell_half*=0.5;
+     cell_x   +=(i_octant&4)?cell_half:-cell_half;
+     cell_y   +=(i_octant&2)?cell_half:-cell_half;
+     cell_z   +=(i_octant&1)?cell_half:-cell_half;
+     if((++depth)>=RENDER_LOD_DEPTH_MAX)
+        flag_leaf=TRUE;
+  }
+
+  // Add this node
+  if(cache->n_lod_nodes>=(*n_alloc)){
+     (*n_alloc)      =MAX(1024,2*(*n_alloc));
+     cache->lod_nodes=(render_lod_node_info *)SID_realloc(cache->lod_nodes,sizeof(render_lod_node_info)*(*n_alloc));
+  }
+  i_node=cache->n_lod_nodes++;
+  cache->lod_nodes[i_node].i_first    =i_first;
+  cache->lod_nodes[i_node].n_particles=n_particles;
+  cache->lod_nodes[i_node].flag_leaf  =flag_leaf;
+  sums.flag_empty=TRUE;
+
+  // Set the node's aggregate properties from those of its particles ...
+  if(flag_leaf){
+     for(i_particle=i_first;i_particle<i_first+n_particles;i_particle++){
+        size_t j_particle=index[i_particle];
+        add_render_lod_sums(&sums,cache->x[j_particle],cache->y[j_particle],cache->z[j_particle],
+                            cache->h_smooth[j_particle],cache->h_smooth[j_particle],cache->h_smooth[j_particle],
+                            cache->value[j_particle],cache->weight[j_particle],
+                            (cache->colour!=NULL)?cache->colour[j_particle]:0,FALSE,1);
+     }
+     set_render_lod_node(&sums,&(cache->lod_nodes[i_node]));
+     for(i_particle=i_first;i_particle<i_first+n_particles;i_particle++){
+        size_t j_particle=index[i_particle];
+        add_render_lod_radius(&(cache->lod_nodes[i_node]),cache->x[j_particle],cache->y[j_particle],cache->z[j_particle],0.);
+     }
+  }
+  // ... or from those of its children
+  else{
+     for(i_octant=0;i_octant<8;i_octant++){
+        if(octant_start[i_octant+1]>octant_start[i_octant]){
+           i_child=cache->n_lod_nodes;
+           add_render_lod_node(cache,index,n_alloc,octant_start[i_octant],octant_start[i_octant+1]-octant_start[i_octant],
+                               cell_x+((i_octant&4)?0.5:-0.5)*cell_half,
+                               cell_y+((i_octant&2)?0.5:-0.5)*cell_half,
+                               cell_z+((i_octant&1)?0.5:-0.5)*cell_half,
+                               0.5*cell_half,depth+1);
+           render_lod_node_info *child=&(cache->lod_nodes[i_child]);
+           add_render_lod_sums(&sums,child->x,child->y,child->z,child->h_smooth,child->h_min,child->h_max,
+                               child->value,child->weight,child->colour,child->flag_mixed_colour,child->n_particles);
+        }
+     }
+     set_render_lod_node(&sums,&(cache->lod_nodes[i_node]));
+     for(i_child=i_node+1;i_child<cache->n_lod_nodes;i_child=cache->lod_nodes[i_child].i_next){
+        render_lod_node_info *child=&(cache->lod_nodes[i_child]);
+        add_render_lod_radius(&(cache->lod_nodes[i_node]),child->x,child->y,child->z,child->radius);
+     }
+  }
+  cache->lod_nodes[i_node].i_next=cache->n_lod_nodes;
+}
+
+// Build the level-of-detail tree over the particles in the projection cache.  The
+//   cached particles are reordered so that those of each node are contiguous.
+void build_render_lod_tree(render_projection_cache_info *cache);
+void build_render_lod_tree(render_projection_cache_info *cache){
+  size_t  i_particle;
+  size_t  n_alloc=0;
+  double  x_min,x_max;
+  double  y_min,y_max;
+  double  z_min,z_max;
+  size_t *index;
+
+  SID_log("Building LOD tree...",SID_LOG_OPEN|SID_LOG_TIMER);
+  cache->n_lod_nodes=0;
+  cache->lod_nodes  =NULL;
+  if(cache->n_particles>0){
+     // Find the bounding cube of the particles
+     x_min=x_max=(double)cache->x[0];
+     y_min=y_max=(double)cache->y[0];
+     z_min=z_max=(double)cache->z[0];
+     for(i_particle=1;i_particle<cache->n_particles;i_particle++){
+        x_min=MIN(x_min,(double)cache->x[i_particle]);
+        x_max=MAX(x_max,(double)cache->x[i_particle]);
+        y_min=MIN(y_min,(double)cache->y[i_particle]);
+        y_max=MAX(y_max,(double)cache->y[i_particle]);
+        z_min=MIN(z_min,(double)cache->z[i_particle]);
+        z_max=MAX(z_max,(double)cache->z[i_particle]);
+     }
+
+     // Build the tree
+     index=(size_t *)SID_malloc(sizeof(size_t)*cache->n_particles);
+     for(i_particle=0;i_particle<cache->n_particles;i_particle++)
+        index[i_particle]=i_particle;
+     add_render_lod_node(cache,index,&n_alloc,0,cache->n_particles,
+                         0.5*(x_min+x_max),0.5*(y_min+y_max),0.5*(z_min+z_max),
+                         0.5*MAX(x_max-x_min,MAX(y_max-y_min,z_max-z_min)),0);
+     cache->lod_nodes=(render_lod_node_info *)SID_realloc(cache->lod_nodes,sizeof(render_lod_node_info)*cache->n_lod_nodes);
+
+     // Put the particles in tree order
+     float *f_temp=(float *)SID_malloc(sizeof(float)*cache->n_particles);
+     float *f_list[6]={cache->x,cache->y,cache->z,cache->h_smooth,cache->value,cache->weight};
+     int    i_list;
+     for(i_list=0;i_list<6;i_list++){
+        for(i_particle=0;i_particle<cache->n_particles;i_particle++)
+           f_temp[i_particle]=f_list[i_list][index[i_particle]];
+        memcpy(f_list[i_list],f_temp,sizeof(float)*cache->n_particles);
+     }
+     SID_free(SID_FARG f_temp);
+     if(cache->colour!=NULL){
+        char *c_temp=(char *)SID_malloc(sizeof(char)*cache->n_particles);
+        for(i_particle=0;i_particle<cache->n_particles;i_particle++)
+           c_temp[i_particle]=cache->colour[index[i_particle]];
+        memcpy(cache->colour,c_temp,sizeof(char)*cache->n_particles);
+        SID_free(SID_FARG c_temp);
+     }
+     SID_free(SID_FARG index);
+  }
+  SID_log("Done. (%zd nodes)",SID_LOG_CLOSE,cache->n_lod_nodes);
+}
+
+// Camera-dependent quantities of one view (eg. one eye of a stereo pair).  Several
+//   views can be projected in one pass over the particles; the view-independent
+//   particle quantities (smoothing lengths, values, weights and colours) are shared.
+typedef struct render_view_info render_view_info;
+struct render_view_info{
+   double  stereo_offset;
+   double  xmin;
+   // Perspective transformation (set by init_make_map_noabs())
+   double  x_o;
+   double  y_o;
+   double  z_o;
+   double  x_hat;
+   double  y_hat;
+   double  z_hat;
+   double  theta;
+   double  theta_roll;
+   double  d_o;
+   double  d_image_plane;
+   // Projected particles (set by init_make_map_noabs())
+   float  *x;
+   float  *y;
+   float  *z;
+   float  *f_stretch;
+   size_t *z_index;
+};
+
+// Transform a particle to the render-coordinates of a view
+void transform_particle_view(render_view_info *view,
+                             GBPREAL          *x_i,
+                             GBPREAL          *y_i,
+                             GBPREAL          *z_i,
+                             double            box_size,
+                             double            expansion_factor,
+                             double            focus_shift_x,
+                             double            focus_shift_y,
+                             int               flag_comoving,
+                             int               flag_force_periodic);
+void transform_particle_view(render_view_info *view,
+                             GBPREAL          *x_i,
+                             GBPREAL          *y_i,
+                             GBPREAL          *z_i,
+                             double            box_size,
+                             double            expansion_factor,
+                             double            focus_shift_x,
+                             double            focus_shift_y,
+                             int               flag_comoving,
+                             int               flag_force_periodic){
+   transform_particle(x_i,
+                      y_i,
+                      z_i,
+                      view->x_o,
+                      view->y_o,
+                      view->z_o,
+                      view->x_hat,
+                      view->y_hat,
+                      view->z_hat,
+                      view->d_o,
+                      view->stereo_offset,
+                      view->theta,
+                      view->theta_roll,
+                      box_size,
+                      expansion_factor,
+                      focus_shift_x,
+                      focus_shift_y,
+                      flag_comoving,
+                      flag_force_periodic);
+}
+
+// Return TRUE if a particle lies beyond the near-field in any view
+int check_if_particle_visible_views(render_view_info *views,
+                                    int               n_views,
+                                    GBPREAL           x_i,
+                                    GBPREAL           y_i,
+                                    GBPREAL           z_i,
+                                    double            d_near_field,
+                                    double            box_size,
+                                    double            expansion_factor,
+                                    double            focus_shift_x,
+                                    double            focus_shift_y,
+                                    int               flag_comoving,
+                                    int               flag_force_periodic);
+int check_if_particle_visible_views(render_view_info *views,
+                                    int               n_views,
+                                    GBPREAL           x_i,
+                                    GBPREAL           y_i,
+                                    GBPREAL           z_i,
+                                    double            d_near_field,
+                                    double            box_size,
+                                    double            expansion_factor,
+                                    double            focus_shift_x,
+                                    double            focus_shift_y,
+                                    int               flag_comoving,
+                                    int               flag_force_periodic){
+   int i_view;
+   for(i_view=0;i_view<n_views;i_view++){
+      GBPREAL x_view=x_i;
+      GBPREAL y_view=y_i;
+      GBPREAL z_view=z_i;
+      transform_particle_view(&(views[i_view]),&x_view,&y_view,&z_view,
+                              box_size,expansion_factor,focus_shift_x,focus_shift_y,flag_comoving,flag_force_periodic);
+      if(z_view>d_near_field)
+         return(TRUE);
+   }
+   return(FALSE);
+}
+
+// Set the depth ordering of views 1..n_views-1 from that of view 0.  The views
+//   differ by small camera offsets so this ordering is a nearly-sorted start.
+void sort_render_views(render_view_info *views,int n_views,size_t n_particles);
+void sort_render_views(render_view_info *views,int n_views,size_t n_particles){
+   int i_view;
+   for(i_view=1;i_view<n_views;i_view++){
+      views[i_view].z_index=(size_t *)SID_malloc(sizeof(size_t)*n_particles);
+      memcpy(views[i_view].z_index,views[0].z_index,sizeof(size_t)*n_particles);
+      merge_sort_presorted(views[i_view].z,n_particles,views[i_view].z_index,SID_FLOAT);
+   }
+}
+
 void init_make_map_noabs(render_info *render,
                          double       x_o,
                          double       y_o,
@@ -689,7 +1283,6 @@ void init_make_map_noabs(render_info *render,
                          double       box_size,
                          double       FOV_x_in,
                          double       FOV_y_in,
-                         double       xmin,
                          double       ymin,
                          double       pixel_size_x,
                          double       pixel_size_y,
@@ -700,21 +1293,17 @@ void init_make_map_noabs(render_info *render,
                          double       focus_shift_x,
                          double       focus_shift_y,
                          double       d_near_field,
-                         double       stereo_offset,
+                         int          n_views,
+                         render_view_info *views,
                          int          flag_comoving,
                          int          flag_force_periodic,
                          int          camera_mode,
                          int         *flag_weigh,
                          int         *flag_line_integral,
-                         float       **x,
-                         float       **y,
-                         float       **z,
                          float       **h_smooth,
-                         float       **f_stretch,
                          float       **value,
                          float       **weight,
                          char        **colour,
-                         size_t      **z_index,
                          int          *i_x_min_local_return,
                          int          *i_x_max_local_return,
                          size_t       *n_particles);
@@ -731,7 +1320,6 @@ void init_make_map_noabs(render_info *render,
                          double       box_size,
                          double       FOV_x_in,
                          double       FOV_y_in,
-                         double       xmin,
                          double       ymin,
                          double       pixel_size_x,
                          double       pixel_size_y,
@@ -742,21 +1330,17 @@ void init_make_map_noabs(render_info *render,
                          double       focus_shift_x,
                          double       focus_shift_y,
                          double       d_near_field,
-                         double       stereo_offset,
+                         int          n_views,
+                         render_view_info *views,
                          int          flag_comoving,
                          int          flag_force_periodic,
                          int          camera_mode,
                          int         *flag_weigh,
                          int         *flag_line_integral,
-                         float       **x,
-                         float       **y,
-                         float       **z,
                          float       **h_smooth,
-                         float       **f_stretch,
                          float       **value,
                          float       **weight,
                          char        **colour,
-                         size_t      **z_index,
                          int          *i_x_min_local_return,
                          int          *i_x_max_local_return,
                          size_t       *n_particles){
@@ -774,15 +1358,9 @@ void init_make_map_noabs(render_info *render,
   float   *y_temp;
   float   *z_temp;
   float   *h_smooth_temp;
-  double   x_hat;
-  double   y_hat;
-  double   z_hat;
-  double   theta;
-  double   theta_roll;
   double   d_x_o;
   double   d_y_o;
   double   d_z_o;
-  double   d_o;
   double   d_hat;
   double   particle_radius;
   double   x_tmp,y_tmp,z_tmp;
@@ -817,41 +1395,48 @@ void init_make_map_noabs(render_info *render,
   (*flag_line_integral)=mq.flag_line_integral;
   ptype_used           =mq.ptype_used;
 
-  double x_o_in=x_o;
-  double y_o_in=y_o;
-  double z_o_in=z_o;
-  double x_c_in=x_c;
-  double y_c_in=y_c;
-  double z_c_in=z_c;
-  double FOV_x =FOV_x_in;
-  double FOV_y =FOV_y_in;
-  compute_perspective_transformation(x_o_in,
-                                     y_o_in,
-                                     z_o_in,
-                                     x_c_in,
-                                     y_c_in,
-                                     z_c_in,
-                                     unit_factor,
-                                     unit_text,
-                                     f_image_plane,
-                                     stereo_offset,
-                                     &FOV_x,
-                                     &FOV_y,
-                                     &d_o,
-                                     &x_o,
-                                     &y_o,
-                                     &z_o,
-                                     &x_c,
-                                     &y_c,
-                                     &z_c,
-                                     &x_hat,
-                                     &y_hat,
-                                     &z_hat,
-                                     &theta,
-                                     &theta_roll);
-
-  // The previous line sets d_o to the object distance.  Compute the distance to the image plane.
-  double d_image_plane=d_o*f_image_plane;
+  // Set the perspective transformation of each view
+  int i_view;
+  for(i_view=0;i_view<n_views;i_view++){
+     render_view_info *view=&(views[i_view]);
+     double FOV_x=FOV_x_in;
+     double FOV_y=FOV_y_in;
+     double x_c_out;
+     double y_c_out;
+     double z_c_out;
+     compute_perspective_transformation(x_o,
+                                        y_o,
+                                        z_o,
+                                        x_c,
+                                        y_c,
+                                        z_c,
+                                        unit_factor,
+                                        unit_text,
+                                        f_image_plane,
+                                        view->stereo_offset,
+                                        &FOV_x,
+                                        &FOV_y,
+                                        &(view->d_o),
+                                        &(view->x_o),
+                                        &(view->y_o),
+                                        &(view->z_o),
+                                        &x_c_out,
+                                        &y_c_out,
+                                        &z_c_out,
+                                        &(view->x_hat),
+                                        &(view->y_hat),
+                                        &(view->z_hat),
+                                        &(view->theta),
+                                        &(view->theta_roll));
+
+     // The previous call sets d_o to the object distance.  Compute the distance to the image plane.
+     view->d_image_plane=view->d_o*f_image_plane;
+     view->x            =NULL;
+     view->y            =NULL;
+     view->z            =NULL;
+     view->f_stretch    =NULL;
+     view->z_index      =NULL;
+  }
 
   // Set mark arrays
   int    flag_mark_on=FALSE;
@@ -865,13 +1450,220 @@ void init_make_map_noabs(render_info *render,
          mark[i_type]=NULL;
   }
 
+  // If rendering frame-coherently, reuse the particle distribution and
+  //   depth ordering of the previous frame wherever possible.  The interpolation
+  //   between snapshots changes every frame, so the cache would never be reused
+  //   for interpolated frames; it is only kept for them if levels-of-detail need it.
+  int flag_use_cache=(render->lod_threshold>0. || (render->flag_frame_coherent && render->n_interpolate==1));
+  if(render->flag_frame_coherent && !flag_use_cache)
+     SID_log("Frame-coherent rendering is not used for interpolated frames.",SID_LOG_COMMENT);
+  if(!flag_use_cache)
+     free_render_projection_cache(&(render->projection_cache));
+  if(flag_use_cache){
+     update_render_projection_cache(render,&mq,mark,flag_mark_on,box_size_float,half_box);
+     render_projection_cache_info *cache=render->projection_cache;
+
+     // If rendering with levels-of-detail, walk the LOD tree and substitute a
+     //   single pseudo-particle for any node whose spread in position and smoothing
+     //   length projects to less than lod_threshold pixels.  Nodes which can not
+     //   contribute to the image are skipped entirely.
+     if(render->lod_threshold>0.){
+        render_view_info *view=&(views[0]);
+        if(n_views!=1)
+           SID_trap_error("Level-of-detail rendering can not be used with %d views.",ERROR_LOGIC,n_views);
+        if(cache->lod_nodes==NULL)
+           build_render_lod_tree(cache);
+        SID_log("Transform particles (LOD; threshold=%.3lf pixels)...",SID_LOG_OPEN|SID_LOG_TIMER,render->lod_threshold);
+        render_lod_node_info *nodes        =cache->lod_nodes;
+        double                lod_size     =render->lod_threshold*MIN(pixel_size_x,pixel_size_y);
+        double                f_scale      =flag_comoving?1.:expansion_factor;
+        double                f_kernel     =MAX(1.,radius_kernel_max);
+        double                x_image_min  =view->xmin;
+        double                x_image_max  =view->xmin+(double)nx*pixel_size_x;
+        double                y_image_min  =ymin;
+        double                y_image_max  =ymin+(double)ny*pixel_size_y;
+        int                   flag_periodic=(!flag_comoving || flag_force_periodic);
+        size_t                n_out        =0;
+        size_t                n_nodes_used =0;
+        size_t                i_node       =0;
+        view->x        =(float *)SID_malloc(sizeof(float)*cache->n_particles);
+        view->y        =(float *)SID_malloc(sizeof(float)*cache->n_particles);
+        view->z        =(float *)SID_malloc(sizeof(float)*cache->n_particles);
+        (*h_smooth) =(float *)SID_malloc(sizeof(float)*cache->n_particles);
+        view->f_stretch=(float *)SID_malloc(sizeof(float)*cache->n_particles);
+        (*value)    =(float *)SID_malloc(sizeof(float)*cache->n_particles);
+        (*weight)   =(float *)SID_malloc(sizeof(float)*cache->n_particles);
+        if(cache->colour!=NULL)
+           (*colour)=(char *)SID_malloc(sizeof(char)*cache->n_particles);
+        else
+           (*colour)=NULL;
+        while(i_node<cache->n_lod_nodes){
+           render_lod_node_info *node=&(nodes[i_node]);
+           float x_i=node->x;
+           float y_i=node->y;
+           float z_i=node->z;
+           transform_particle_view(view,&x_i,&y_i,&z_i,box_size,expansion_factor,focus_shift_x,focus_shift_y,flag_comoving,flag_force_periodic);
+
+           // Nodes straddling the periodic wrap of the box are never aggregated or culled
+           int flag_whole=TRUE;
+           if(flag_periodic){
+              double d_x=(double)node->x-view->x_o;
+              double d_y=(double)node->y-view->y_o;
+              double d_z=(double)node->z-view->z_o;
+              d_x-=box_size*floor(d_x/box_size+0.5);
+              d_y-=box_size*floor(d_y/box_size+0.5);
+              d_z-=box_size*floor(d_z/box_size+0.5);
+              if(fabs(d_x)+(double)node->radius>=0.5*box_size ||
+                 fabs(d_y)+(double)node->radius>=0.5*box_size ||
+                 fabs(d_z)+(double)node->radius>=0.5*box_size)
+                 flag_whole=FALSE;
+           }
+           if(flag_whole){
+              double radius_i=(double)node->radius*f_scale;
+              double z_near  =(double)z_i-radius_i;
+              double z_far   =(double)z_i+radius_i;
+
+              // Skip nodes wholly inside the near-field ...
+              if(z_far<=d_near_field){
+                 i_node=node->i_next;
+                 continue;
+              }
+              // ... or wholly off the image
+              if(flag_plane_parallel || z_near>0.){
+                 double f_near =(double)compute_f_stretch(view->d_image_plane,(float)z_near,flag_plane_parallel);
+                 double f_far  =(double)compute_f_stretch(view->d_image_plane,(float)z_far, flag_plane_parallel);
+                 double r_reach=radius_i+f_kernel*(double)node->h_max;
+                 double x_lo   =(double)x_i-r_reach;
+                 double x_hi   =(double)x_i+r_reach;
+                 double y_lo   =(double)y_i-r_reach;
+                 double y_hi   =(double)y_i+r_reach;
+                 if(MAX(x_hi*f_near,x_hi*f_far)<x_image_min || MIN(x_lo*f_near,x_lo*f_far)>x_image_max ||
+                    MAX(y_hi*f_near,y_hi*f_far)<y_image_min || MIN(y_lo*f_near,y_lo*f_far)>y_image_max){
+                    i_node=node->i_next;
+                    continue;
+                 }
+              }
+              // Render the node as a single pseudo-particle if it is small enough
+              if(node->n_particles>1 && !node->flag_mixed_colour && z_near>d_near_field && (flag_plane_parallel || z_near>0.)){
+                 double f_near=(double)compute_f_stretch(view->d_image_plane,(float)z_near,flag_plane_parallel);
+                 if(2.*radius_i*f_near<=lod_size && (double)(node->h_max-node->h_min)*f_near<=lod_size){
+                    view->x[n_out]        =x_i;
+                    view->y[n_out]        =y_i;
+                    view->z[n_out]        =z_i;
+                    (*h_smooth)[n_out] =node->h_smooth;
+                    view->f_stretch[n_out]=(float)compute_f_stretch(view->d_image_plane,z_i,flag_plane_parallel);
+                    (*value)[n_out]    =node->value;
+                    (*weight)[n_out]   =node->weight;
+                    if((*colour)!=NULL)
+                       (*colour)[n_out]=node->colour;
+                    n_out++;
+                    n_nodes_used++;
+                    i_node=node->i_next;
+                    continue;
+                 }
+              }
+           }
+
+           // Descend into the node or, if it is a leaf, render its particles individually
+           if(!node->flag_leaf){
+              i_node++;
+              continue;
+           }
+           for(i_particle=node->i_first;i_particle<node->i_first+node->n_particles;i_particle++){
+              x_i=cache->x[i_particle];
+              y_i=cache->y[i_particle];
+              z_i=cache->z[i_particle];
+              transform_particle_view(view,&x_i,&y_i,&z_i,box_size,expansion_factor,focus_shift_x,focus_shift_y,flag_comoving,flag_force_periodic);
+              view->x[n_out]        =x_i;
+              view->y[n_out]        =y_i;
+              view->z[n_out]        =z_i;
+              (*h_smooth)[n_out] =cache->h_smooth[i_particle];
+              view->f_stretch[n_out]=(float)compute_f_stretch(view->d_image_plane,z_i,flag_plane_parallel);
+              (*value)[n_out]    =cache->value[i_particle];
+              (*weight)[n_out]   =cache->weight[i_particle];
+              if((*colour)!=NULL)
+                 (*colour)[n_out]=cache->colour[i_particle];
+              n_out++;
+           }
+           i_node=node->i_next;
+        }
+        (*n_particles)=n_out;
+        SID_log("%zd particles rendered as %zd (%zd LOD nodes used).",SID_LOG_COMMENT,cache->n_particles,n_out,n_nodes_used);
+        SID_log("Done.",SID_LOG_CLOSE);
+
+        // The set of rendered particles changes between frames so they are sorted from scratch
+        merge_sort(view->z,(size_t)(*n_particles),&(view->z_index),SID_FLOAT,SORT_COMPUTE_INDEX,FALSE);
+
+        // Clean-up
+        free_particle_map_quantities(&mq);
+        SID_free(SID_FARG mark);
+        (*i_x_min_local_return)=0;
+        (*i_x_max_local_return)=nx-1;
+        SID_log("Done.",SID_LOG_CLOSE);
+        return;
+     }
+
+     // Transform the cached particles to the render-coordinates of each view.
+     //   Particles behind the near-field are kept (so that the set does not
+     //   change between frames) but are skipped when the image is constructed.
+     //   The view-independent quantities are used from the cache directly.
+     SID_log("Transform particles...",SID_LOG_OPEN|SID_LOG_TIMER);
+     (*n_particles)=cache->n_particles;
+     for(i_view=0;i_view<n_views;i_view++){
+        views[i_view].x        =(float *)SID_malloc(sizeof(float)*cache->n_particles);
+        views[i_view].y        =(float *)SID_malloc(sizeof(float)*cache->n_particles);
+        views[i_view].z        =(float *)SID_malloc(sizeof(float)*cache->n_particles);
+        views[i_view].f_stretch=(float *)SID_malloc(sizeof(float)*cache->n_particles);
+     }
+     (*h_smooth)=cache->h_smooth;
+     (*value)   =cache->value;
+     (*weight)  =cache->weight;
+     (*colour)  =cache->colour;
+     for(i_particle=0;i_particle<cache->n_particles;i_particle++){
+        float x_p=cache->x[i_particle];
+        float y_p=cache->y[i_particle];
+        float z_p=cache->z[i_particle];
+        for(i_view=0;i_view<n_views;i_view++){
+           render_view_info *view=&(views[i_view]);
+           float x_i=x_p;
+           float y_i=y_p;
+           float z_i=z_p;
+           transform_particle_view(view,&x_i,&y_i,&z_i,box_size,expansion_factor,focus_shift_x,focus_shift_y,flag_comoving,flag_force_periodic);
+           view->x[i_particle]        =x_i;
+           view->y[i_particle]        =y_i;
+           view->z[i_particle]        =z_i;
+           view->f_stretch[i_particle]=(float)compute_f_stretch(view->d_image_plane,z_i,flag_plane_parallel);
+        }
+     }
+     SID_log("Done.",SID_LOG_CLOSE);
+
+     // Sort the particles by depth, starting from the last frame's ordering if we have it
+     if(cache->z_index==NULL)
+        merge_sort(views[0].z,(size_t)(*n_particles),&(cache->z_index),SID_FLOAT,SORT_COMPUTE_INDEX,FALSE);
+     else{
+        SID_log("Updating depth ordering...",SID_LOG_OPEN|SID_LOG_TIMER);
+        merge_sort_presorted(views[0].z,(size_t)(*n_particles),cache->z_index,SID_FLOAT);
+        SID_log("Done.",SID_LOG_CLOSE);
+     }
+     views[0].z_index=(size_t *)SID_malloc(sizeof(size_t)*cache->n_particles);
+     memcpy(views[0].z_index,cache->z_index,sizeof(size_t)*cache->n_particles);
+     sort_render_views(views,n_views,(*n_particles));
+
+     // Clean-up
+     free_particle_map_quantities(&mq);
+     SID_free(SID_FARG mark);
+     (*i_x_min_local_return)=0;
+     (*i_x_max_local_return)=nx-1;
+     SID_log("Done.",SID_LOG_CLOSE);
+     return;
+  }
+
   // Determine how many particles are contributing to each 
   //    column of the image
   float   x_i;
   float   y_i;
   float   z_i;
   float   h_i;
-  float   f_i;
   float   v_i;
   float   w_i;
   char    c_i;
@@ -900,29 +1692,10 @@ void init_make_map_noabs(render_info *render,
    
                // Set the preoperties of the particle to be mapped (mode is FALSE because we DON'T need the angular size of the particle)
                set_particle_map_quantities(render,&mq,FALSE,k_particle,box_size_float,half_box,&x_i,&y_i,&z_i,&h_i,&v_i,&w_i);
-   
-               // Transform particle to render-coordinates
-               transform_particle(&x_i,
-                                  &y_i,
-                                  &z_i,
-                                  x_o,
-                                  y_o,
-                                  z_o,
-                                  x_hat,
-                                  y_hat,
-                                  z_hat,
-                                  d_o,
-                                  stereo_offset,
-                                  theta,
-                                  theta_roll,
-                                  box_size,
-                                  expansion_factor,
-                                  focus_shift_x,
-                                  focus_shift_y,
-                                  flag_comoving,
-                                  flag_force_periodic);
-   
-               if(z_i>d_near_field){
+
+               // Keep the particle if it is in front of the near-field in any view
+               if(check_if_particle_visible_views(views,n_views,x_i,y_i,z_i,d_near_field,
+                                                  box_size,expansion_factor,focus_shift_x,focus_shift_y,flag_comoving,flag_force_periodic)){
                   n_rank_local[i_rank]++;
                   n_particles_visible_local++;
                }
@@ -962,18 +1735,20 @@ void init_make_map_noabs(render_info *render,
   float  *v_buffer;
   float  *w_buffer;
   char   *c_buffer;
-  (*x)        =(float *)SID_malloc(sizeof(float)*n_particles_local);
-  (*y)        =(float *)SID_malloc(sizeof(float)*n_particles_local);
-  (*z)        =(float *)SID_malloc(sizeof(float)*n_particles_local);
+  for(i_view=0;i_view<n_views;i_view++){
+     views[i_view].x        =(float *)SID_malloc(sizeof(float)*n_particles_local);
+     views[i_view].y        =(float *)SID_malloc(sizeof(float)*n_particles_local);
+     views[i_view].z        =(float *)SID_malloc(sizeof(float)*n_particles_local);
+     views[i_view].f_stretch=(float *)SID_malloc(sizeof(float)*n_particles_local);
+  }
   (*h_smooth) =(float *)SID_malloc(sizeof(float)*n_particles_local);
-  (*f_stretch)=(float *)SID_malloc(sizeof(float)*n_particles_local);
   (*value)    =(float *)SID_malloc(sizeof(float)*n_particles_local);
   (*weight)   =(float *)SID_malloc(sizeof(float)*n_particles_local);
-  x_buffer    =(float *)SID_malloc(sizeof(float)*n_buffer);
-  y_buffer    =(float *)SID_malloc(sizeof(float)*n_buffer);
-  z_buffer    =(float *)SID_malloc(sizeof(float)*n_buffer);
+  x_buffer    =(float *)SID_malloc(sizeof(float)*n_buffer*n_views); // One block of n_buffer per view
+  y_buffer    =(float *)SID_malloc(sizeof(float)*n_buffer*n_views);
+  z_buffer    =(float *)SID_malloc(sizeof(float)*n_buffer*n_views);
+  f_buffer    =(float *)SID_malloc(sizeof(float)*n_buffer*n_views);
   h_buffer    =(float *)SID_malloc(sizeof(float)*n_buffer);
-  f_buffer    =(float *)SID_malloc(sizeof(float)*n_buffer);
   v_buffer    =(float *)SID_malloc(sizeof(float)*n_buffer);
   w_buffer    =(float *)SID_malloc(sizeof(float)*n_buffer);
   if(flag_mark_on){
@@ -999,34 +1774,20 @@ void init_make_map_noabs(render_info *render,
                // Set the properties of the particle to be mapped 
                set_particle_map_quantities(render,&mq,TRUE,k_particle,box_size_float,half_box,&x_i,&y_i,&z_i,&h_i,&v_i,&w_i);
    
-               // Transform particle to render-coordinates
-               transform_particle(&x_i,
-                                  &y_i,
-                                  &z_i,
-                                  x_o,
-                                  y_o,
-                                  z_o,
-                                  x_hat,
-                                  y_hat,
-                                  z_hat,
-                                  d_o,
-                                  stereo_offset,
-                                  theta,
-                                  theta_roll,
-                                  box_size,
-                                  expansion_factor,
-                                  focus_shift_x,
-                                  focus_shift_y,
-                                  flag_comoving,
-                                  flag_force_periodic);
-   
-               if(z_i>d_near_field){
-                  f_i=(float)compute_f_stretch(d_image_plane,z_i,flag_plane_parallel);
-                  x_buffer[particle_index]=x_i;
-                  y_buffer[particle_index]=y_i;
-                  z_buffer[particle_index]=z_i;
+               // Transform particle to the render-coordinates of each view
+               if(check_if_particle_visible_views(views,n_views,x_i,y_i,z_i,d_near_field,
+                                                  box_size,expansion_factor,focus_shift_x,focus_shift_y,flag_comoving,flag_force_periodic)){
+                  for(i_view=0;i_view<n_views;i_view++){
+                     render_view_info *view=&(views[i_view]);
+                     size_t            pos =(size_t)i_view*n_buffer+particle_index;
+                     x_buffer[pos]=x_i;
+                     y_buffer[pos]=y_i;
+                     z_buffer[pos]=z_i;
+                     transform_particle_view(view,&(x_buffer[pos]),&(y_buffer[pos]),&(z_buffer[pos]),
+                                             box_size,expansion_factor,focus_shift_x,focus_shift_y,flag_comoving,flag_force_periodic);
+                     f_buffer[pos]=(float)compute_f_stretch(view->d_image_plane,z_buffer[pos],flag_plane_parallel);
+                  }
                   h_buffer[particle_index]=h_i;
-                  f_buffer[particle_index]=f_i;
                   w_buffer[particle_index]=w_i;
                   v_buffer[particle_index]=v_i;
                   if(c_buffer!=NULL)
@@ -1043,36 +1804,19 @@ void init_make_map_noabs(render_info *render,
 
      // Perform exchanges
      size_t n_exchange;
-     exchange_ring_buffer(x_buffer,
-                          sizeof(float),
-                          n_rank_local[rank_to],
-                          &((*x)[j_particle_rank]),
-                          &n_exchange,
-                          i_rank);
-     exchange_ring_buffer(y_buffer,
-                          sizeof(float),
-                          n_rank_local[rank_to],
-                          &((*y)[j_particle_rank]),
-                          &n_exchange,
-                          i_rank);
-     exchange_ring_buffer(z_buffer,
-                          sizeof(float),
-                          n_rank_local[rank_to],
-                          &((*z)[j_particle_rank]),
-                          &n_exchange,
-                          i_rank);
+     for(i_view=0;i_view<n_views;i_view++){
+        size_t pos=(size_t)i_view*n_buffer;
+        exchange_ring_buffer(&(x_buffer[pos]),sizeof(float),n_rank_local[rank_to],&(views[i_view].x[j_particle_rank]),        &n_exchange,i_rank);
+        exchange_ring_buffer(&(y_buffer[pos]),sizeof(float),n_rank_local[rank_to],&(views[i_view].y[j_particle_rank]),        &n_exchange,i_rank);
+        exchange_ring_buffer(&(z_buffer[pos]),sizeof(float),n_rank_local[rank_to],&(views[i_view].z[j_particle_rank]),        &n_exchange,i_rank);
+        exchange_ring_buffer(&(f_buffer[pos]),sizeof(float),n_rank_local[rank_to],&(views[i_view].f_stretch[j_particle_rank]),&n_exchange,i_rank);
+     }
      exchange_ring_buffer(h_buffer,
                           sizeof(float),
                           n_rank_local[rank_to],
                           &((*h_smooth)[j_particle_rank]),
                           &n_exchange,
                           i_rank);
-     exchange_ring_buffer(f_buffer,
-                          sizeof(float),
-                          n_rank_local[rank_to],
-                          &((*f_stretch)[j_particle_rank]),
-                          &n_exchange,
-                          i_rank);
      exchange_ring_buffer(w_buffer,
                           sizeof(float),
                           n_rank_local[rank_to],
@@ -1103,7 +1847,8 @@ void init_make_map_noabs(render_info *render,
   SID_log("Done.",SID_LOG_CLOSE);
 
   // Sort the local particles by position
-  merge_sort((*z),(size_t)(*n_particles),z_index,SID_FLOAT,SORT_COMPUTE_INDEX,FALSE);
+  merge_sort(views[0].z,(size_t)(*n_particles),&(views[0].z_index),SID_FLOAT,SORT_COMPUTE_INDEX,FALSE);
+  sort_render_views(views,n_views,(*n_particles));
 
   // Clean-up
   SID_free(SID_FARG n_rank);
@@ -1772,6 +2517,617 @@ void fetch_image_array(image_info *image,double **values){
       (*values)=NULL;
 }
 
+// Per-pixel accumulator channels.  The images being rendered are packed
+//   into one record per pixel (in this order) so that each kernel sample
+//   touches a single cache line instead of up to six separate arrays.
+#define SPLAT_CHANNEL_Y    0
+#define SPLAT_CHANNEL_V    1
+#define SPLAT_CHANNEL_Z    2
+#define SPLAT_CHANNEL_R    3
+#define SPLAT_CHANNEL_G    4
+#define SPLAT_CHANNEL_B    5
+#define SPLAT_N_CHANNEL_MAX 6
+
+// Frame-wide quantities needed to splat particles onto an image
+typedef struct splat_frame_info splat_frame_info;
+struct splat_frame_info{
+   render_info *render;
+   int          nx;
+   int          ny;
+   double       xmin;
+   double       ymin;
+   double       pixel_size_x;
+   double       pixel_size_y;
+   double       d_o;
+   double       d_near_field;
+   double       d_image_plane;
+   double       d_taper_field;
+   double       taper_width;
+   int          flag_fade;
+   double       alpha_fade;
+   double       f_absorption;
+   double      *kernel_radius;
+   double      *kernel_table;
+   double       radius_kernel_max;
+   double       radius_kernel_max2;
+   sph_kernel_stamp_info *kernel_stamps; // NULL if kernels are to be evaluated exactly
+   float       *x;
+   float       *y;
+   float       *z;
+   float       *h_smooth;
+   float       *f_stretch;
+   float       *value;
+   float       *weight;
+   char        *colour;
+   // Accumulator layout (set once per frame by set_splat_channels())
+   int          n_channels;
+   int          channel_source[SPLAT_N_CHANNEL_MAX]; // SPLAT_CHANNEL_XXX id of each record entry
+   double      *channel_image[SPLAT_N_CHANNEL_MAX];  // Image each record entry is written to
+};
+
+// Per-particle quantities needed to splat a particle onto an image
+typedef struct splat_particle_info splat_particle_info;
+struct splat_particle_info{
+   double part_pos_x;
+   double part_pos_y;
+   double radius2_norm;
+   double w_i;
+   double channel_value[SPLAT_N_CHANNEL_MAX]; // Dimmed value added to each record entry
+   double *stamp;                             // Precomputed kernel stamp (NULL for the exact path) ...
+   int     stamp_ix;                          // ... whose first entry lies at pixel (stamp_ix,stamp_iy) ...
+   int     stamp_iy;
+   int     stamp_width;                       // ... and which is stamp_width pixels on a side
+   int    kx_min;
+   int    kx_max;
+   int    ky_min;
+   int    ky_max;
+};
+
+// What is kept of a particle between binning it into tiles and rendering them
+typedef struct splat_tile_record_info splat_tile_record_info;
+struct splat_tile_record_info{
+   size_t i_particle;
+   int    kx_min;
+   int    kx_max;
+   int    ky_min;
+   int    ky_max;
+};
+
+// Choose the accumulator layout for this frame from the set of images being produced
+void set_splat_channels(splat_frame_info *frame,
+                        double           *Y_image,
+                        double           *temp_image,
+                        double           *z_image,
+                        double           *RY_image,
+                        double           *GY_image,
+                        double           *BY_image);
+void set_splat_channels(splat_frame_info *frame,
+                        double           *Y_image,
+                        double           *temp_image,
+                        double           *z_image,
+                        double           *RY_image,
+                        double           *GY_image,
+                        double           *BY_image){
+   double *image_list[SPLAT_N_CHANNEL_MAX];
+   int     i_channel;
+   image_list[SPLAT_CHANNEL_Y]=Y_image;
+   image_list[SPLAT_CHANNEL_V]=temp_image;
+   image_list[SPLAT_CHANNEL_Z]=z_image;
+   image_list[SPLAT_CHANNEL_R]=RY_image;
+   image_list[SPLAT_CHANNEL_G]=GY_image;
+   image_list[SPLAT_CHANNEL_B]=BY_image;
+   frame->n_channels=0;
+   for(i_channel=0;i_channel<SPLAT_N_CHANNEL_MAX;i_channel++){
+      if(image_list[i_channel]!=NULL){
+         frame->channel_source[frame->n_channels]=i_channel;
+         frame->channel_image[frame->n_channels] =image_list[i_channel];
+         frame->n_channels++;
+      }
+   }
+}
+
+// Set the pixel-space footprint and values of a particle.  Returns
+//   FALSE if the particle does not touch any pixel of the image.
+int set_splat_particle(splat_frame_info *frame,size_t i_particle,splat_particle_info *particle);
+int set_splat_particle(splat_frame_info *frame,size_t i_particle,splat_particle_info *particle){
+   double z_i          =(double)frame->z[i_particle];
+   double part_h_xy    =(double)frame->h_smooth[i_particle]*frame->f_stretch[i_particle];
+   double radius_kernel=part_h_xy;
+   if(fpclassify(radius_kernel)!=FP_NORMAL)
+      return(FALSE);
+   particle->radius2_norm=1./(part_h_xy*part_h_xy);
+   particle->part_pos_x  =(double)(frame->x[i_particle]*frame->f_stretch[i_particle]);
+   particle->part_pos_y  =(double)(frame->y[i_particle]*frame->f_stretch[i_particle]);
+   particle->stamp       =NULL;
+
+   // Use a precomputed stamp if this particle's smoothing length is in the range of the stamp
+   //   cache.  Stamps sample the kernel at pixel centres just as the exact path does, but for
+   //   a quantized smoothing length, so their weight is rescaled (by f_norm) by the ratio of
+   //   areas to match the flux the exact path would give the particle's true smoothing length.
+   double f_norm  =1.;
+   double h_pixels=part_h_xy/frame->pixel_size_x;
+   sph_kernel_stamp_info *stamps=frame->kernel_stamps;
+   if(stamps!=NULL && h_pixels>=stamps->h_min){
+      int i_h=(int)((double)KERNEL_STAMP_N_PER_OCTAVE*log2(h_pixels/stamps->h_min)+0.5);
+      if(i_h<stamps->n_h){
+         double u_x    =(particle->part_pos_x-frame->xmin)/frame->pixel_size_x;
+         double u_y    =(particle->part_pos_y-frame->ymin)/frame->pixel_size_y;
+         double ix_f   =floor(u_x);
+         double iy_f   =floor(u_y);
+         int    i_sub_x=MIN(stamps->n_sub-1,(int)((u_x-ix_f)*(double)stamps->n_sub));
+         int    i_sub_y=MIN(stamps->n_sub-1,(int)((u_y-iy_f)*(double)stamps->n_sub));
+         // Make sure that the pixel range is representable
+         if(fabs(ix_f)<(double)INT_MAX/2 && fabs(iy_f)<(double)INT_MAX/2){
+            int *extent          =&(stamps->extent[4*((i_h*stamps->n_sub+i_sub_x)*stamps->n_sub+i_sub_y)]);
+            f_norm               =(h_pixels*h_pixels)/(stamps->h[i_h]*stamps->h[i_h]);
+            particle->stamp_width=stamps->width[i_h];
+            particle->stamp_ix   =(int)ix_f-stamps->n_lo[i_h];
+            particle->stamp_iy   =(int)iy_f-stamps->n_lo[i_h];
+            particle->stamp      =&(stamps->stamp[stamps->offset[i_h]+
+                                                  (size_t)(i_sub_x*stamps->n_sub+i_sub_y)*
+                                                  (size_t)(particle->stamp_width*particle->stamp_width)]);
+            particle->kx_min     =MAX(0,          (int)ix_f+extent[0]);
+            particle->kx_max     =MIN(frame->nx-1,(int)ix_f+extent[1]);
+            particle->ky_min     =MAX(0,          (int)iy_f+extent[2]);
+            particle->ky_max     =MIN(frame->ny-1,(int)iy_f+extent[3]);
+         }
+      }
+   }
+   if(particle->stamp==NULL){
+      particle->kx_min=MAX(0,          (int)((particle->part_pos_x-radius_kernel-frame->xmin)/frame->pixel_size_x));
+      particle->kx_max=MIN(frame->nx-1,(int)((particle->part_pos_x+radius_kernel-frame->xmin)/frame->pixel_size_x+ONE_HALF));
+      particle->ky_min=MAX(0,          (int)((particle->part_pos_y-radius_kernel-frame->ymin)/frame->pixel_size_y));
+      particle->ky_max=MIN(frame->ny-1,(int)((particle->part_pos_y+radius_kernel-frame->ymin)/frame->pixel_size_y+ONE_HALF));
+   }
+   if(particle->kx_min>particle->kx_max || particle->ky_min>particle->ky_max)
+      return(FALSE);
+
+   // Compute any potential fading
+   // alpha_fade=2 for normal inverse-square fading past the image plane
+   double f_fade;
+   if(frame->flag_fade && z_i>frame->d_o)
+      f_fade=pow(frame->d_image_plane/z_i,-frame->alpha_fade);
+   else
+      f_fade=1;
+
+   // Compute any potential tapering
+   double f_taper;
+   if(frame->taper_width>0. && z_i<frame->d_taper_field)
+      f_taper=(z_i-frame->d_near_field)/frame->taper_width;
+   else
+      f_taper=1;
+
+   // Combine dimming factors into one
+   double f_dim;
+   f_dim=f_taper*f_fade;
+
+   // Set the particle weight and the (dimmed) value added to each channel
+   int i_channel;
+   particle->w_i=f_norm*(double)frame->weight[i_particle];
+   for(i_channel=0;i_channel<frame->n_channels;i_channel++){
+      switch(frame->channel_source[i_channel]){
+         case SPLAT_CHANNEL_Y:
+            particle->channel_value[i_channel]=f_dim;
+            break;
+         case SPLAT_CHANNEL_V:
+            particle->channel_value[i_channel]=f_dim*(double)frame->value[i_particle];
+            break;
+         case SPLAT_CHANNEL_Z:
+            particle->channel_value[i_channel]=f_dim*z_i;
+            break;
+         case SPLAT_CHANNEL_R:
+         case SPLAT_CHANNEL_G:
+         case SPLAT_CHANNEL_B:
+            if(frame->colour!=NULL)
+               particle->channel_value[i_channel]=f_dim*RGB_lookup(frame->render,
+                                                                   frame->colour[i_particle],
+                                                                   frame->channel_source[i_channel]-SPLAT_CHANNEL_R);
+            else
+               particle->channel_value[i_channel]=f_dim;
+            break;
+      }
+   }
+   return(TRUE);
+}
+
+// Kernel loop over a particle's footprint.  N_CHANNELS must be a constant
+//   so that the compiler can unroll the per-channel update (ACCUMULATE),
+//   which is applied to each channel's entry (TARGET) of pixel pos.
+#define SPLAT_KERNEL_LOOP(N_CHANNELS,ACCUMULATE,TARGET) \
+   for(kx=kx_min;kx<=kx_max;kx++){ \
+     double pixel_pos_x=frame->xmin+((double)kx+0.5)*frame->pixel_size_x; \
+     double dx2        =(pixel_pos_x-part_pos_x)*(pixel_pos_x-part_pos_x); \
+     size_t pos        =(size_t)(ky_min-iy_lo)+(size_t)(kx-ix_lo)*(size_t)n_y_buffer; \
+     for(ky=ky_min;ky<=ky_max;ky++,pos++){ \
+       double pixel_pos_y=frame->ymin+((double)ky+0.5)*frame->pixel_size_y; \
+       double radius2    =(dx2+(pixel_pos_y-part_pos_y)*(pixel_pos_y-part_pos_y))*radius2_norm; \
+       if(radius2<radius_kernel_max2){ \
+         double  f_table=sqrt(radius2)/radius_kernel_max; \
+         int     i_table=(int)(f_table*(double)N_KERNEL_TABLE); \
+         double  w_k    =w_i*(kernel_table[i_table]+ \
+                              (kernel_table[i_table+1]-kernel_table[i_table])* \
+                              (f_table-kernel_radius[i_table])*(double)N_KERNEL_TABLE); \
+         int     i_channel; \
+         for(i_channel=0;i_channel<(N_CHANNELS);i_channel++) \
+            ACCUMULATE(TARGET); \
+         mask[pos]=TRUE; \
+       } \
+     } \
+   }
+// Stamp loop over a particle's footprint.  Written so that the inner
+//   (contiguous) loop can be vectorized by the compiler.
+#define SPLAT_STAMP_LOOP(N_CHANNELS,ACCUMULATE,TARGET) \
+   for(kx=kx_min;kx<=kx_max;kx++){ \
+     double *stamp_row=&(stamp[(size_t)(kx-stamp_ix)*(size_t)stamp_width+(size_t)(ky_min-stamp_iy)]); \
+     size_t  pos      =(size_t)(ky_min-iy_lo)+(size_t)(kx-ix_lo)*(size_t)n_y_buffer; \
+     for(ky=ky_min;ky<=ky_max;ky++,pos++,stamp_row++){ \
+       if((*stamp_row)>0.){ \
+         double  w_k   =w_i*(*stamp_row); \
+         int     i_channel; \
+         for(i_channel=0;i_channel<(N_CHANNELS);i_channel++) \
+            ACCUMULATE(TARGET); \
+         mask[pos]=TRUE; \
+       } \
+     } \
+   }
+#define SPLAT_ACCUMULATE_ABS(TARGET)   TARGET+=(channel_value[i_channel]-f_absorption*(TARGET))*w_k
+#define SPLAT_ACCUMULATE_NOABS(TARGET) TARGET+=channel_value[i_channel]*w_k
+#define SPLAT_RECORD(N_CHANNELS)       accumulator[pos*(N_CHANNELS)+(size_t)i_channel]
+#define SPLAT_IMAGE                    frame->channel_image[i_channel][pos]
+#define SPLAT_LOOPS(N_CHANNELS,TARGET) \
+      if(stamp!=NULL){ \
+         if(flag_absorption) \
+            SPLAT_STAMP_LOOP(N_CHANNELS,SPLAT_ACCUMULATE_ABS,TARGET) \
+         else \
+            SPLAT_STAMP_LOOP(N_CHANNELS,SPLAT_ACCUMULATE_NOABS,TARGET) \
+      } \
+      else{ \
+         if(flag_absorption) \
+            SPLAT_KERNEL_LOOP(N_CHANNELS,SPLAT_ACCUMULATE_ABS,TARGET) \
+         else \
+            SPLAT_KERNEL_LOOP(N_CHANNELS,SPLAT_ACCUMULATE_NOABS,TARGET) \
+      }
+#define SPLAT_KERNEL_CASE(N_CHANNELS) \
+   case N_CHANNELS: \
+      SPLAT_LOOPS(N_CHANNELS,SPLAT_RECORD(N_CHANNELS)) \
+      break;
+
+// Add a particle's kernel to the pixels in [ix_lo,ix_hi]x[iy_lo,iy_hi].  The accumulator
+//   holds only this window and record (ky-iy_lo)+(kx-ix_lo)*n_y_buffer is that of pixel (kx,ky).
+//   If accumulator is NULL, the window must be the whole frame and the particle is added
+//   to the images directly.
+void splat_particle(splat_frame_info    *frame,
+                    splat_particle_info *particle,
+                    int                  ix_lo,
+                    int                  ix_hi,
+                    int                  iy_lo,
+                    int                  iy_hi,
+                    int                  n_y_buffer,
+                    double              *accumulator,
+                    char                *mask);
+void splat_particle(splat_frame_info    *frame,
+                    splat_particle_info *particle,
+                    int                  ix_lo,
+                    int                  ix_hi,
+                    int                  iy_lo,
+                    int                  iy_hi,
+                    int                  n_y_buffer,
+                    double              *accumulator,
+                    char                *mask){
+   double *kernel_radius     =frame->kernel_radius;
+   double *kernel_table      =frame->kernel_table;
+   double  radius_kernel_max =frame->radius_kernel_max;
+   double  radius_kernel_max2=frame->radius_kernel_max2;
+   double  f_absorption      =frame->f_absorption;
+   int     flag_absorption   =(f_absorption>0.);
+   double  part_pos_x        =particle->part_pos_x;
+   double  part_pos_y        =particle->part_pos_y;
+   double  radius2_norm      =particle->radius2_norm;
+   double  w_i               =particle->w_i;
+   double *channel_value     =particle->channel_value;
+   double *stamp             =particle->stamp;
+   int     stamp_ix          =particle->stamp_ix;
+   int     stamp_iy          =particle->stamp_iy;
+   int     stamp_width       =particle->stamp_width;
+   int     kx_min            =MAX(particle->kx_min,ix_lo);
+   int     kx_max            =MIN(particle->kx_max,ix_hi);
+   int     ky_min            =MAX(particle->ky_min,iy_lo);
+   int     ky_max            =MIN(particle->ky_max,iy_hi);
+   int     kx;
+   int     ky;
+   if(accumulator==NULL){
+      int n_channels=frame->n_channels;
+      SPLAT_LOOPS(n_channels,SPLAT_IMAGE)
+      return;
+   }
+   switch(frame->n_channels){
+      SPLAT_KERNEL_CASE(0) // Mask only
+      SPLAT_KERNEL_CASE(1)
+      SPLAT_KERNEL_CASE(2)
+      SPLAT_KERNEL_CASE(3)
+      SPLAT_KERNEL_CASE(4)
+      SPLAT_KERNEL_CASE(5)
+      SPLAT_KERNEL_CASE(6)
+      default:
+         SID_trap_error("Invalid number of accumulator channels (%d) in splat_particle().",ERROR_LOGIC,frame->n_channels);
+         break;
+   }
+}
+
+// Copy the accumulator records of the pixels in [ix_lo,ix_hi]x[iy_lo,iy_hi] into the images
+void unpack_splat_accumulator(splat_frame_info *frame,
+                              int               ix_lo,
+                              int               ix_hi,
+                              int               iy_lo,
+                              int               iy_hi,
+                              int               n_y_buffer,
+                              double           *accumulator,
+                              char             *mask_buffer,
+                              char             *mask);
+void unpack_splat_accumulator(splat_frame_info *frame,
+                              int               ix_lo,
+                              int               ix_hi,
+                              int               iy_lo,
+                              int               iy_hi,
+                              int               n_y_buffer,
+                              double           *accumulator,
+                              char             *mask_buffer,
+                              char             *mask){
+   int n_channels=frame->n_channels;
+   int i_channel;
+   int kx;
+   int ky;
+   for(kx=ix_lo;kx<=ix_hi;kx++){
+      size_t pos_buffer=(size_t)(kx-ix_lo)*(size_t)n_y_buffer;
+      size_t pos       =(size_t)iy_lo+(size_t)kx*(size_t)frame->ny;
+      for(ky=iy_lo;ky<=iy_hi;ky++,pos_buffer++,pos++){
+         if(mask_buffer[pos_buffer]){
+            double *record=&(accumulator[pos_buffer*(size_t)n_channels]);
+            mask[pos]=TRUE;
+            for(i_channel=0;i_channel<n_channels;i_channel++)
+               frame->channel_image[i_channel][pos]=record[i_channel];
+         }
+      }
+   }
+}
+
+// Splat particles by binning them into screen-space tiles and
+//   rendering the tiles on a pool of threads.  Each tile accumulates
+//   into its own small buffer, so no frame-sized accumulator is needed,
+//   and particles are added to each tile's list in back-to-front order,
+//   so absorption gives exactly the same result as projecting the
+//   particles one at a time.
+void splat_particles_tiled(splat_frame_info *frame,
+                           size_t           *z_index,
+                           size_t            n_particles,
+                           int               tile_size,
+                           int               n_threads,
+                           char             *mask,
+                           size_t           *n_particles_used_local);
+void splat_particles_tiled(splat_frame_info *frame,
+                           size_t           *z_index,
+                           size_t            n_particles,
+                           int               tile_size,
+                           int               n_threads,
+                           char             *mask,
+                           size_t           *n_particles_used_local){
+   size_t              ii_particle;
+   size_t              i_particle;
+   size_t              i_splat;
+   size_t              n_splat;
+   int                 i_tile;
+   int                 i_tile_x;
+   int                 i_tile_y;
+   int                 nx          =frame->nx;
+   int                 ny          =frame->ny;
+   int                 n_tiles_x   =(nx+tile_size-1)/tile_size;
+   int                 n_tiles_y   =(ny+tile_size-1)/tile_size;
+   int                 n_tiles     =n_tiles_x*n_tiles_y;
+   size_t              n_tile_pixels=(size_t)tile_size*(size_t)tile_size;
+
+   // Count the particles in front of the near field
+   (*n_particles_used_local)=0;
+   for(ii_particle=0;ii_particle<n_particles;ii_particle++){
+      if((double)frame->z[z_index[ii_particle]]>frame->d_near_field)
+         (*n_particles_used_local)++;
+   }
+
+   // Set the footprint of each of these particles and count the number of
+   //   particles touching each tile.  Only the particle's index and clipped
+   //   pixel bounds are kept; the rest is recomputed in each tile it touches.
+   //   Particles are stored in back-to-front order.
+   splat_tile_record_info *records    =(splat_tile_record_info *)SID_malloc(sizeof(splat_tile_record_info)*MAX(1,(*n_particles_used_local)));
+   size_t                 *tile_offset=(size_t *)SID_calloc(sizeof(size_t)*(n_tiles+1));
+   pcounter_info           pcounter;
+   SID_log("Binning particles into %dx%d tiles...",SID_LOG_OPEN|SID_LOG_TIMER,n_tiles_x,n_tiles_y);
+   SID_init_pcounter(&pcounter,n_particles,10);
+   for(ii_particle=0,n_splat=0;ii_particle<n_particles;ii_particle++){
+      i_particle=z_index[n_particles-1-ii_particle];
+      if((double)frame->z[i_particle]>frame->d_near_field){
+         splat_particle_info particle;
+         if(set_splat_particle(frame,i_particle,&particle)){
+            splat_tile_record_info *record=&(records[n_splat]);
+            record->i_particle=i_particle;
+            record->kx_min    =particle.kx_min;
+            record->kx_max    =particle.kx_max;
+            record->ky_min    =particle.ky_min;
+            record->ky_max    =particle.ky_max;
+            for(i_tile_x=record->kx_min/tile_size;i_tile_x<=record->kx_max/tile_size;i_tile_x++)
+               for(i_tile_y=record->ky_min/tile_size;i_tile_y<=record->ky_max/tile_size;i_tile_y++)
+                  tile_offset[i_tile_x*n_tiles_y+i_tile_y+1]++;
+            n_splat++;
+         }
+      }
+      SID_check_pcounter(&pcounter,ii_particle);
+   }
+   for(i_tile=0;i_tile<n_tiles;i_tile++)
+      tile_offset[i_tile+1]+=tile_offset[i_tile];
+
+   // Build the tile lists.  Particles are added in back-to-front order.
+   size_t *tile_fill=(size_t *)SID_malloc(sizeof(size_t)*n_tiles);
+   size_t *tile_list=(size_t *)SID_malloc(sizeof(size_t)*MAX(1,tile_offset[n_tiles]));
+   for(i_tile=0;i_tile<n_tiles;i_tile++)
+      tile_fill[i_tile]=tile_offset[i_tile];
+   for(i_splat=0;i_splat<n_splat;i_splat++){
+      splat_tile_record_info *record=&(records[i_splat]);
+      for(i_tile_x=record->kx_min/tile_size;i_tile_x<=record->kx_max/tile_size;i_tile_x++)
+         for(i_tile_y=record->ky_min/tile_size;i_tile_y<=record->ky_max/tile_size;i_tile_y++)
+            tile_list[tile_fill[i_tile_x*n_tiles_y+i_tile_y]++]=i_splat;
+   }
+   SID_free(SID_FARG tile_fill);
+   SID_log("Done.",SID_LOG_CLOSE);
+
+   // Allocate an accumulator and a mask for each thread's tiles
+   int     n_channels =frame->n_channels;
+   double *tile_buffer=(double *)SID_malloc(sizeof(double)*n_tile_pixels*(size_t)n_channels*(size_t)n_threads);
+   char   *tile_mask  =(char   *)SID_malloc(sizeof(char)  *n_tile_pixels*(size_t)n_threads);
+
+   // Render the tiles
+   SID_log("Rendering %d tiles with %d thread(s)...",SID_LOG_OPEN|SID_LOG_TIMER,n_tiles,n_threads);
+#if USE_OPENMP
+   #pragma omp parallel for schedule(dynamic) num_threads(n_threads)
+#endif
+   for(i_tile=0;i_tile<n_tiles;i_tile++){
+      int    i_thread=0;
+      size_t i_list;
+      #if USE_OPENMP
+         i_thread=omp_get_thread_num();
+      #endif
+      int     ix_lo     =(i_tile/n_tiles_y)*tile_size;
+      int     iy_lo     =(i_tile%n_tiles_y)*tile_size;
+      int     ix_hi     =MIN(ix_lo+tile_size,nx)-1;
+      int     iy_hi     =MIN(iy_lo+tile_size,ny)-1;
+      int     n_y_tile  =iy_hi-iy_lo+1;
+      size_t  n_pix_tile=(size_t)(ix_hi-ix_lo+1)*(size_t)n_y_tile;
+      double *buffer    =&(tile_buffer[n_tile_pixels*(size_t)n_channels*(size_t)i_thread]);
+      char   *mask_tile =&(tile_mask[n_tile_pixels*(size_t)i_thread]);
+      memset(buffer,   0,sizeof(double)*n_pix_tile*(size_t)n_channels);
+      memset(mask_tile,0,sizeof(char)  *n_pix_tile);
+
+      // Splat this tile's particles (back-to-front)
+      for(i_list=tile_offset[i_tile];i_list<tile_offset[i_tile+1];i_list++){
+         splat_particle_info particle;
+         set_splat_particle(frame,records[tile_list[i_list]].i_particle,&particle);
+         splat_particle(frame,&particle,ix_lo,ix_hi,iy_lo,iy_hi,n_y_tile,buffer,mask_tile);
+      }
+
+      // Copy the tile into the images.  Tiles don't overlap so no locking is needed.
+      unpack_splat_accumulator(frame,ix_lo,ix_hi,iy_lo,iy_hi,n_y_tile,buffer,mask_tile,mask);
+   }
+   SID_log("Done.",SID_LOG_CLOSE);
+
+   // Clean-up
+   SID_free(SID_FARG tile_buffer);
+   SID_free(SID_FARG tile_mask);
+   SID_free(SID_FARG tile_list);
+   SID_free(SID_FARG tile_offset);
+   SID_free(SID_FARG records);
+}
+
+// Sum the images (and combine the masks) of all ranks.  Only the tiles which have
+//   been touched on some rank are exchanged and the mask is sent along with the
+//   images, so a frame needs just two collectives: one for the (small) tile
+//   bitmap and one for the data.  Pixels outside the mask are zero on all ranks.
+void reduce_image_tiles(double **image_list,
+                        int      n_image_list,
+                        char    *mask,
+                        int      nx,
+                        int      ny,
+                        int      tile_size);
+void reduce_image_tiles(double **image_list,
+                        int      n_image_list,
+                        char    *mask,
+                        int      nx,
+                        int      ny,
+                        int      tile_size){
+   int     n_tiles_x=(nx+tile_size-1)/tile_size;
+   int     n_tiles_y=(ny+tile_size-1)/tile_size;
+   int     n_tiles  =n_tiles_x*n_tiles_y;
+   int     n_tiles_dirty;
+   int     i_tile;
+   int     i_image;
+   int     n_images;
+   int     kx;
+   int     ky;
+   size_t  n_buffer;
+   size_t  i_buffer;
+   double *images[SPLAT_N_CHANNEL_MAX+1];
+   int    *tile_dirty;
+   double *buffer;
+
+   if(SID.n_proc<=1)
+      return;
+
+   // Mark the tiles touched by this rank and combine the bitmaps of all ranks
+   tile_dirty=(int *)SID_calloc(sizeof(int)*n_tiles);
+   for(kx=0;kx<nx;kx++){
+      char *mask_column=&(mask[(size_t)kx*(size_t)ny]);
+      int  *tile_column=&(tile_dirty[(kx/tile_size)*n_tiles_y]);
+      for(ky=0;ky<ny;ky++){
+         if(mask_column[ky])
+            tile_column[ky/tile_size]=TRUE;
+      }
+   }
+   SID_Allreduce(SID_IN_PLACE,tile_dirty,n_tiles,SID_INT,SID_MAX,SID.COMM_WORLD);
+
+   // Pack the dirty tiles (mask included) into one buffer ...
+   for(i_image=0,n_images=0;i_image<n_image_list;i_image++){
+      if(image_list[i_image]!=NULL)
+         images[n_images++]=image_list[i_image];
+   }
+   for(i_tile=0,n_tiles_dirty=0,n_buffer=0;i_tile<n_tiles;i_tile++){
+      if(tile_dirty[i_tile]){
+         int ix_lo=(i_tile/n_tiles_y)*tile_size;
+         int iy_lo=(i_tile%n_tiles_y)*tile_size;
+         n_buffer+=(size_t)(MIN(ix_lo+tile_size,nx)-ix_lo)*(size_t)(MIN(iy_lo+tile_size,ny)-iy_lo);
+         n_tiles_dirty++;
+      }
+   }
+   n_buffer*=(size_t)(n_images+1);
+   buffer=(double *)SID_malloc(sizeof(double)*n_buffer);
+   for(i_tile=0,i_buffer=0;i_tile<n_tiles;i_tile++){
+      if(tile_dirty[i_tile]){
+         int ix_lo=(i_tile/n_tiles_y)*tile_size;
+         int iy_lo=(i_tile%n_tiles_y)*tile_size;
+         int ix_hi=MIN(ix_lo+tile_size,nx)-1;
+         int iy_hi=MIN(iy_lo+tile_size,ny)-1;
+         int n_y  =iy_hi-iy_lo+1;
+         for(kx=ix_lo;kx<=ix_hi;kx++){
+            size_t pos=(size_t)iy_lo+(size_t)kx*(size_t)ny;
+            for(i_image=0;i_image<n_images;i_image++,i_buffer+=n_y)
+               memcpy(&(buffer[i_buffer]),&(images[i_image][pos]),sizeof(double)*n_y);
+            for(ky=0;ky<n_y;ky++,i_buffer++)
+               buffer[i_buffer]=(double)mask[pos+ky];
+         }
+      }
+   }
+
+   // ... reduce it ...
+   SID_Allreduce(SID_IN_PLACE,buffer,(int)n_buffer,SID_DOUBLE,SID_SUM,SID.COMM_WORLD);
+
+   // ... and unpack it
+   for(i_tile=0,i_buffer=0;i_tile<n_tiles;i_tile++){
+      if(tile_dirty[i_tile]){
+         int ix_lo=(i_tile/n_tiles_y)*tile_size;
+         int iy_lo=(i_tile%n_tiles_y)*tile_size;
+         int ix_hi=MIN(ix_lo+tile_size,nx)-1;
+         int iy_hi=MIN(iy_lo+tile_size,ny)-1;
+         int n_y  =iy_hi-iy_lo+1;
+         for(kx=ix_lo;kx<=ix_hi;kx++){
+            size_t pos=(size_t)iy_lo+(size_t)kx*(size_t)ny;
+            for(i_image=0;i_image<n_images;i_image++,i_buffer+=n_y)
+               memcpy(&(images[i_image][pos]),&(buffer[i_buffer]),sizeof(double)*n_y);
+            for(ky=0;ky<n_y;ky++,i_buffer++)
+               mask[pos+ky]=(buffer[i_buffer]>0.);
+         }
+      }
+   }
+   SID_log("Reduced %d of %d image tiles.",SID_LOG_COMMENT,n_tiles_dirty,n_tiles);
+
+   SID_free(SID_FARG tile_dirty);
+   SID_free(SID_FARG buffer);
+}
+
 void render_frame(render_info  *render){
   size_t     i_particle;
   size_t     j_particle;
@@ -1880,17 +3236,31 @@ void render_frame(render_info  *render){
   double       d_near_field;
   double       d_taper_field;
   double       stereo_offset;
-  int          i_x,i_y;
-  int         *mask_buffer;
 
   int          i_image;
   int          camera_mode;
 
   double       f_absorption;
+
+  SID_push_memory_tag("render");
   f_absorption=render->f_absorption;
   if(f_absorption<0.)
      f_absorption=0.;
 
+  // Set the number of threads used for splatting
+  int n_threads=render->n_threads;
+#if USE_OPENMP
+  if(n_threads<=0)
+     n_threads=omp_get_max_threads();
+#else
+  if(n_threads!=1){
+     SID_log_warning("n_threads=%d requested but OpenMP support is not compiled-in.  Using 1 thread.",SID_WARNING_DEFAULT,n_threads);
+     n_threads=1;
+  }
+#endif
+  if(n_threads>1)
+     SID_log("Splatting with %d threads (tile size=%d pixels).",SID_LOG_COMMENT,n_threads,render->tile_size);
+
   x_o          =render->camera->perspective->p_o[0];
   y_o          =render->camera->perspective->p_o[1];
   z_o          =render->camera->perspective->p_o[2];
@@ -1965,6 +3335,10 @@ void render_frame(render_info  *render){
   if(d_near_field>0. || d_taper_field>0.)
      SID_log("Image plane  = %le [%s]",SID_LOG_COMMENT,d_image_plane*unit_factor,unit_text);
   SID_log("f_absorption = %le",SID_LOG_COMMENT,f_absorption);
+  if(render->flag_frame_coherent && flag_add_absorption)
+     SID_log_warning("Frame-coherent rendering is not supported with absorption and will not be used.",SID_WARNING_DEFAULT);
+  if(render->lod_threshold>0. && flag_add_absorption)
+     SID_log_warning("Level-of-detail rendering is not supported with absorption and will not be used.",SID_WARNING_DEFAULT);
   if(nx>=ny){
     FOV_y_object_plane=FOV;
     FOV_x_object_plane=FOV_y_object_plane*(double)nx/(double)ny;    
@@ -1976,6 +3350,14 @@ void render_frame(render_info  *render){
   FOV_x_image_plane=FOV_x_object_plane*f_image_plane;
   FOV_y_image_plane=FOV_y_object_plane*f_image_plane;
 
+  // Without absorption (or LOD rendering, whose particle set depends on the view)
+  //   both images of a stereo pair are projected in a single pass over the particles
+  render_view_info views[2];
+  int              n_views;
+  int              flag_batch_views=(check_mode_for_flag(camera_mode,CAMERA_STEREO) && !flag_add_absorption && render->lod_threshold<=0.);
+  if(flag_batch_views)
+     SID_log("Projecting both stereo images in one pass.",SID_LOG_COMMENT);
+
   // Loop over the left/right stereo pair (if necessary)
   if(check_mode_for_flag(camera_mode,CAMERA_STEREO))
     i_image =0;
@@ -2043,7 +3425,8 @@ void render_frame(render_info  *render){
                    &(render->kernel_table_3d),
                    &(render->kernel_table),
                    &(render->kernel_table_avg),
-                   kernel_flag|SPH_KERNEL_2D);
+                   &(render->kernel_stamps),
+                   kernel_flag|SPH_KERNEL_2D|(render->flag_exact_kernel?0:SPH_KERNEL_STAMPS));
     kernel_radius     =render->kernel_radius;
     kernel_table      =render->kernel_table;
     kernel_table_avg  =render->kernel_table_avg;
@@ -2096,8 +3479,8 @@ void render_frame(render_info  *render){
                                        &theta_roll);
 
     // Initialize make_map
-    int i_x_min_local;
-    int i_x_max_local;
+    int i_x_min_local=0;
+    int i_x_max_local=nx-1;
     if(flag_add_absorption)
        init_make_map_abs(render,
                          x_o,y_o,z_o,
@@ -2129,153 +3512,130 @@ void render_frame(render_info  *render){
                          &i_x_min_local,
                          &i_x_max_local,
                          &n_particles);
-    else
-       init_make_map_noabs(render,
-                           x_o,y_o,z_o,
-                           x_c,y_c,z_c,
-                           unit_factor,unit_text,
-                           f_image_plane,
-                           box_size,FOV_x_object_plane,FOV_y_object_plane,
-                           xmin,ymin,
-                           pixel_size_x,pixel_size_y,
-                           radius_kernel_max,
-                           nx,ny,
-                           expansion_factor,
-                           focus_shift_x,
-                           focus_shift_y,
-                           d_near_field,
-                           stereo_offset,
-                           flag_comoving,
-                           flag_force_periodic,
-                           camera_mode,
-                           &flag_weigh,
-                           &flag_line_integral,
-                           &x,&y,&z,
-                           &h_smooth,
-                           &f_stretch,
-                           &value,
-                           &weight,
-                           &colour,
-                           &z_index,
-                           &i_x_min_local,
-                           &i_x_max_local,
-                           &n_particles);
+    else{
+       // Set the views to project (both images of a stereo pair at once, if batching)
+       if(!flag_batch_views || i_image==0){
+          if(flag_batch_views){
+             n_views=2;
+             views[0].stereo_offset=-d_image_plane/render->camera->stereo_ratio;
+             views[1].stereo_offset= d_image_plane/render->camera->stereo_ratio;
+          }
+          else{
+             n_views=1;
+             views[0].stereo_offset=stereo_offset;
+          }
+          for(int i_view=0;i_view<n_views;i_view++)
+             views[i_view].xmin=-FOV_x_image_plane/2.-views[i_view].stereo_offset;
+          init_make_map_noabs(render,
+                              x_o,y_o,z_o,
+                              x_c,y_c,z_c,
+                              unit_factor,unit_text,
+                              f_image_plane,
+                              box_size,FOV_x_object_plane,FOV_y_object_plane,
+                              ymin,
+                              pixel_size_x,pixel_size_y,
+                              radius_kernel_max,
+                              nx,ny,
+                              expansion_factor,
+                              focus_shift_x,
+                              focus_shift_y,
+                              d_near_field,
+                              n_views,
+                              views,
+                              flag_comoving,
+                              flag_force_periodic,
+                              camera_mode,
+                              &flag_weigh,
+                              &flag_line_integral,
+                              &h_smooth,
+                              &value,
+                              &weight,
+                              &colour,
+                              &i_x_min_local,
+                              &i_x_max_local,
+                              &n_particles);
+       }
+       render_view_info *view=&(views[flag_batch_views?i_image:0]);
+       x        =view->x;
+       y        =view->y;
+       z        =view->z;
+       f_stretch=view->f_stretch;
+       z_index  =view->z_index;
+    }
 
     // Initialize image arrays
-    mask=(char *)SID_malloc(sizeof(char)*n_pixels);
-    for(i_pixel=0;i_pixel<n_pixels;i_pixel++){
-      if(RGB_image!=NULL)
-         RGB_image[i_pixel]=0.;
-      if(temp_image!=NULL)
-         temp_image[i_pixel]=0.;
-      if(Y_image!=NULL)
-         Y_image[i_pixel]=0.;
-      if(z_image!=NULL)
-        z_image[i_pixel]=0.;
-      if(RY_image!=NULL)
-        RY_image[i_pixel]=0.;
-      if(GY_image!=NULL)
-        GY_image[i_pixel]=0.;
-      if(BY_image!=NULL)
-        BY_image[i_pixel]=0.;
-      mask[i_pixel]=FALSE;
-    }
+    mask=(char *)SID_calloc(sizeof(char)*n_pixels);
+    if(RGB_image!=NULL)  memset(RGB_image, 0,sizeof(double)*n_pixels);
+    if(temp_image!=NULL) memset(temp_image,0,sizeof(double)*n_pixels);
+    if(Y_image!=NULL)    memset(Y_image,   0,sizeof(double)*n_pixels);
+    if(z_image!=NULL)    memset(z_image,   0,sizeof(double)*n_pixels);
+    if(RY_image!=NULL)   memset(RY_image,  0,sizeof(double)*n_pixels);
+    if(GY_image!=NULL)   memset(GY_image,  0,sizeof(double)*n_pixels);
+    if(BY_image!=NULL)   memset(BY_image,  0,sizeof(double)*n_pixels);
+
+    // Set the frame-wide quantities needed for splatting
+    splat_frame_info frame;
+    frame.render            =render;
+    frame.nx                =nx;
+    frame.ny                =ny;
+    frame.xmin              =xmin;
+    frame.ymin              =ymin;
+    frame.pixel_size_x      =pixel_size_x;
+    frame.pixel_size_y      =pixel_size_y;
+    frame.d_o               =d_o;
+    frame.d_near_field      =d_near_field;
+    frame.d_image_plane     =d_image_plane;
+    frame.d_taper_field     =d_taper_field;
+    frame.taper_width       =taper_width;
+    frame.flag_fade         =flag_fade;
+    frame.alpha_fade        =alpha_fade;
+    frame.f_absorption      =f_absorption;
+    frame.kernel_radius     =kernel_radius;
+    frame.kernel_table      =kernel_table;
+    frame.radius_kernel_max =radius_kernel_max;
+    frame.radius_kernel_max2=radius_kernel_max2;
+    // Stamps assume square pixels
+    if(fabs((pixel_size_x-pixel_size_y)/pixel_size_x)>1e-4)
+       frame.kernel_stamps  =NULL;
+    else
+       frame.kernel_stamps  =render->kernel_stamps;
+    frame.x                 =x;
+    frame.y                 =y;
+    frame.z                 =z;
+    frame.h_smooth          =h_smooth;
+    frame.f_stretch         =f_stretch;
+    frame.value             =value;
+    frame.weight            =weight;
+    frame.colour            =colour;
+    set_splat_channels(&frame,Y_image,temp_image,z_image,RY_image,GY_image,BY_image);
 
     // Perform projection
     size_t        n_particles_used_local=0;
     size_t        n_particles_used      =0;
-    pcounter_info pcounter;
-    SID_init_pcounter(&pcounter,n_particles,10);
     SID_log("Performing projection...",SID_LOG_OPEN|SID_LOG_TIMER);
-    n_particles_used_local=0;
-    for(size_t ii_particle=0;ii_particle<n_particles;ii_particle++){
-      i_particle=z_index[n_particles-1-ii_particle];
-      z_i       =(double)z[i_particle];
-
-      if(z_i>d_near_field){
-        n_particles_used_local++;
-
-        // Set pixel space ranges and positions
-        part_h_z     =(double)h_smooth[i_particle];
-        part_h_xy    =part_h_z*f_stretch[i_particle];
-        radius_kernel=part_h_xy;
-        if(fpclassify(radius_kernel)==FP_NORMAL){
-           radius2_norm =1./(part_h_xy*part_h_xy);
-           part_pos_x   =(double)(x[i_particle]*f_stretch[i_particle]);
-           part_pos_y   =(double)(y[i_particle]*f_stretch[i_particle]);
-           kx_min=(int)((part_pos_x-radius_kernel-xmin)/pixel_size_x);
-           kx_max=(int)((part_pos_x+radius_kernel-xmin)/pixel_size_x+ONE_HALF);
-           ky_min=(int)((part_pos_y-radius_kernel-ymin)/pixel_size_y);
-           ky_max=(int)((part_pos_y+radius_kernel-ymin)/pixel_size_y+ONE_HALF);
-
-           // Compute any potential fading
-           // alpha_fade=2 for normal inverse-square fading past the image plane
-           double f_fade;
-           if(flag_fade && z_i>d_o)
-              f_fade=pow(d_image_plane/z_i,-alpha_fade);
-           else
-              f_fade=1;
-
-           // Compute any potential tapering
-           double f_taper;
-           if(taper_width>0. && z_i<d_taper_field)
-              f_taper=(z_i-d_near_field)/taper_width;
-           else
-              f_taper=1;
-
-           // Combine dimming factors into one
-           double f_dim;
-           f_dim=f_taper*f_fade;
-
-           // Set the particle values and weights
-           double v_i =(double)value[i_particle];
-           double w_i =(double)weight[i_particle];
-           double R_i =1.;
-           double G_i =1.;
-           double B_i =1.;
-           if(colour!=NULL){
-              R_i =RGB_lookup(render,colour[i_particle],0);
-              G_i =RGB_lookup(render,colour[i_particle],1);
-              B_i =RGB_lookup(render,colour[i_particle],2);
-           }
-           double vw_i=v_i*w_i;
-           double zw_i=z_i*w_i;
-
-           // Loop over the kernal
-           for(kx=kx_min,pixel_pos_x=xmin+(kx_min+0.5)*pixel_size_x;kx<=kx_max;kx++,pixel_pos_x+=pixel_size_x){
-             if(kx>=0 && kx<nx){
-               for(ky=ky_min,pixel_pos_y=ymin+(ky_min+0.5)*pixel_size_y;ky<=ky_max;ky++,pixel_pos_y+=pixel_size_y){
-                 if(ky>=0 && ky<ny){
-                   radius2=
-                     (pixel_pos_x-part_pos_x)*(pixel_pos_x-part_pos_x)+
-                     (pixel_pos_y-part_pos_y)*(pixel_pos_y-part_pos_y);
-                   radius2*=radius2_norm;
-                   // Construct images here
-                   if(radius2<radius_kernel_max2){
-                     pos    =ky+kx*ny;
-                     f_table=sqrt(radius2)/radius_kernel_max;
-                     i_table=(int)(f_table*(double)N_KERNEL_TABLE);
-                     kernel =kernel_table[i_table]+
-                       (kernel_table[i_table+1]-kernel_table[i_table])*
-                       (f_table-kernel_radius[i_table])*(double)N_KERNEL_TABLE;
-                     double w_k=w_i*kernel;
-                     // Perform addition
-                     if(Y_image!=NULL)    Y_image[pos]   +=(f_dim    -f_absorption*   Y_image[pos])*w_k;
-                     if(temp_image!=NULL) temp_image[pos]+=(f_dim*v_i-f_absorption*temp_image[pos])*w_k;
-                     if(z_image!=NULL)    z_image[pos]   +=(f_dim*z_i-f_absorption*   z_image[pos])*w_k;
-                     if(RY_image!=NULL)   RY_image[pos]  +=(f_dim*R_i-f_absorption*  RY_image[pos])*w_k;
-                     if(GY_image!=NULL)   GY_image[pos]  +=(f_dim*G_i-f_absorption*  GY_image[pos])*w_k;
-                     if(BY_image!=NULL)   BY_image[pos]  +=(f_dim*B_i-f_absorption*  BY_image[pos])*w_k;
-                     mask[pos]=TRUE;
-                   }
-                 }
-               } // loop over kernel
-             } 
-           } // loop over kernel
-         } // check on fp_classify
-      } // near-field selection
-      SID_check_pcounter(&pcounter,ii_particle);
-    } // loop over particles
+    if(n_threads>1)
+       splat_particles_tiled(&frame,
+                             z_index,
+                             n_particles,
+                             render->tile_size,
+                             n_threads,
+                             mask,
+                             &n_particles_used_local);
+    else{
+       // With one thread, stream the particles (back-to-front) straight into the images
+       splat_particle_info particle;
+       pcounter_info       pcounter;
+       SID_init_pcounter(&pcounter,n_particles,10);
+       for(size_t ii_particle=0;ii_particle<n_particles;ii_particle++){
+         i_particle=z_index[n_particles-1-ii_particle];
+         if((double)z[i_particle]>d_near_field){
+           n_particles_used_local++;
+           if(set_splat_particle(&frame,i_particle,&particle))
+              splat_particle(&frame,&particle,0,nx-1,0,ny-1,ny,NULL,mask);
+         }
+         SID_check_pcounter(&pcounter,ii_particle);
+       } // loop over particles
+    }
     SID_Barrier(SID.COMM_WORLD);
     SID_Allreduce(&n_particles_used_local,&n_particles_used,1,SID_SIZE_T,SID_SUM,SID.COMM_WORLD);
     SID_log("n_particles_used=%zd",SID_LOG_COMMENT,n_particles_used);
@@ -2304,30 +3664,9 @@ void render_frame(render_info  *render){
        }
     }
 
-    // Join mask results.  The MPI 1.1 standard does not specify MPI_SUM 
-    //   on MPI_CHAR types so we need to do this awkward thing for the mask array ...
-#if USE_MPI
-    mask_buffer=(int *)SID_malloc(sizeof(int)*nx);
-    for(i_y=0;i_y<ny;i_y++){
-      for(i_x=0,i_pixel=i_y*nx;i_x<nx;i_x++,i_pixel++)
-        mask_buffer[i_x]=(int)mask[i_pixel];
-      SID_Allreduce(SID_IN_PLACE,mask_buffer,nx,SID_INT,SID_MAX,SID.COMM_WORLD);
-      for(i_x=0,i_pixel=i_y*nx;i_x<nx;i_x++,i_pixel++){
-         if(mask_buffer[i_x])
-           mask[i_pixel]=TRUE;
-      }
-    }
-    SID_free(SID_FARG mask_buffer);
-#endif
-    SID_Allreduce(SID_IN_PLACE,temp_image,n_pixels,SID_DOUBLE,SID_SUM,SID.COMM_WORLD);
-    SID_Allreduce(SID_IN_PLACE,Y_image,   n_pixels,SID_DOUBLE,SID_SUM,SID.COMM_WORLD);
-    if(z_image!=NULL)
-      SID_Allreduce(SID_IN_PLACE,z_image,n_pixels,SID_DOUBLE,SID_SUM,SID.COMM_WORLD);
-    if(RY_image!=NULL){
-      SID_Allreduce(SID_IN_PLACE,RY_image,n_pixels,SID_DOUBLE,SID_SUM,SID.COMM_WORLD);
-      SID_Allreduce(SID_IN_PLACE,GY_image,n_pixels,SID_DOUBLE,SID_SUM,SID.COMM_WORLD);
-      SID_Allreduce(SID_IN_PLACE,BY_image,n_pixels,SID_DOUBLE,SID_SUM,SID.COMM_WORLD);
-    }
+    // ... then sum the (touched parts of the) images and masks
+    double *image_list[]={temp_image,Y_image,z_image,RY_image,GY_image,BY_image};
+    reduce_image_tiles(image_list,6,mask,nx,ny,render->tile_size);
 
     // Create final normalized images and clear the temp_image which has been used as a buffer
     if(RGB_image!=NULL){
@@ -2463,19 +3802,25 @@ void render_frame(render_info  *render){
     else
       SID_log("IMAGE IS EMPTY.",SID_LOG_COMMENT);
 
-    // Clean-up
+    // Clean-up (the view-independent particle quantities are kept until
+    //   the last view that uses them; those held by the projection cache
+    //   are left to it)
     SID_free(SID_FARG x);
     SID_free(SID_FARG y);
     SID_free(SID_FARG z);
-    SID_free(SID_FARG h_smooth);
     SID_free(SID_FARG f_stretch);
-    SID_free(SID_FARG value);
-    SID_free(SID_FARG weight);
-    SID_free(SID_FARG colour);
     SID_free(SID_FARG z_index);
     SID_free(SID_FARG mask);
+    if((!flag_batch_views || i_image==1) &&
+       (render->projection_cache==NULL || h_smooth!=render->projection_cache->h_smooth)){
+       SID_free(SID_FARG h_smooth);
+       SID_free(SID_FARG value);
+       SID_free(SID_FARG weight);
+       SID_free(SID_FARG colour);
+    }
   
     SID_log("Done.",SID_LOG_CLOSE);
   }
+  SID_pop_memory_tag();
 }
 
@@ -15,6 +15,14 @@ void seal_render(render_info *render){
   seal_scenes(render->scenes);
   seal_render_camera(render);
   render->n_frames=render->last_scene->last_frame+1;
+  // Snapshots loaded in the background are held in the snapshot
+  //   cache, so it is on by default only if prefetching
+  if(render->snapshot_cache_size_max==RENDER_SNAPSHOT_CACHE_SIZE_DEFAULT){
+     if(render->n_prefetch>0)
+        render->snapshot_cache_size_max=(size_t)RENDER_SNAPSHOT_CACHE_SIZE_PREFETCH*SIZE_OF_MEGABYTE;
+     else
+        render->snapshot_cache_size_max=0;
+  }
   render->sealed=TRUE;
 
   SID_log("Done.",SID_LOG_CLOSE);
@@ -118,10 +118,11 @@ int set_render_state(render_info *render,int frame,int mode){
     // Move currently loaded snapshots to new locations in the list if necessary
     for(i_snap=0;i_snap<render->n_interpolate;i_snap++){
        if(snap_list[i_snap]!=render->snap_list[i_snap]){
-          // Free plists we are done with before loading a new one to avoid
-          //   unnecessarily doubling-up on RAM usage
+          // Cache (or free, if the cache is full) plists we are done with
+          //   before loading a new one to avoid unnecessarily doubling-up
+          //   on RAM usage
           if(render->plist_list[i_snap]!=NULL)
-             ADaPS_free(SID_FARG render->plist_list[i_snap]->data);
+             add_snapshot_cache(render,render->snap_list[i_snap],&(render->plist_list[i_snap]->data));
           render->snap_list[i_snap]=-1;
           for(j_snap=i_snap+1;j_snap<render->n_interpolate;j_snap++){
              if(snap_list[i_snap]==render->snap_list[j_snap]){
@@ -138,16 +139,16 @@ int set_render_state(render_info *render,int frame,int mode){
     for(i_snap=0;i_snap<render->n_interpolate;i_snap++){
        if(render->snap_list[i_snap]<0){
           render->snap_list[i_snap]=snap_list[i_snap];
-          read_gadget_binary_render(render->snap_filename_root,render->snap_list[i_snap],render->plist_list[i_snap],READ_GADGET_RENDER_SCATTER);
-          if(render->n_interpolate>1)
-             read_smooth(render->plist_list[i_snap],render->smooth_filename_root,render->snap_list[i_snap],
-                         SMOOTH_DEFAULT|READ_SMOOTH_LOG_SIGMA|READ_SMOOTH_LOG_RHO); // this is to speed-up logarythmic interpolation
-          else
-             read_smooth(render->plist_list[i_snap],render->smooth_filename_root,render->snap_list[i_snap],SMOOTH_DEFAULT);
+          if(fetch_snapshot_cache(render,render->snap_list[i_snap],&(render->plist_list[i_snap]->data)))
+             continue;
+          read_render_snapshot(render,render->snap_list[i_snap],render->plist_list[i_snap]);
        }
     }
     SID_free(SID_FARG snap_list);
 
+    // Start loading the snapshots needed by upcoming frames
+    prefetch_snapshots(render,frame);
+
     // Convert [Mpc/h] -> SI
     if(render->plist_list!=NULL){
        if(ADaPS_exist(render->plist_list[0]->data,"h_Hubble"))
@@ -2,11 +2,12 @@
 #include <gbpLib.h>
 #include <gbpRender.h>
 
-void set_sph_kernel(double **kernel_radius,
-                    double **kernel_table_3d,
-                    double **kernel_table_2d,
-                    double  *kernel_table_2d_average,
-                    int      mode){
+void set_sph_kernel(double                 **kernel_radius,
+                    double                 **kernel_table_3d,
+                    double                 **kernel_table_2d,
+                    double                  *kernel_table_2d_average,
+                    sph_kernel_stamp_info  **kernel_stamps,
+                    int                      mode){
   int          i_table;
   int          j_table;
   int          n_temp;
@@ -29,15 +30,19 @@ void set_sph_kernel(double **kernel_radius,
     char filename_kernel[64];
     sprintf(filename_kernel,"gbpRender_sph_kernel.dat");
     
-    // Read it if so ...
+    // Read it if so (stamps are not stored in the file, so they
+    //   don't need to match) ...
+    int   mode_file     =mode&(~SPH_KERNEL_STAMPS);
     int   flag_recompute=TRUE;
     FILE *fp_in=fopen(filename_kernel,"r");
     if(fp_in!=NULL){
+       int version_in;
        int n_k_in;
        int mode_in;
-       fread_verify(&n_k_in, sizeof(int),1,fp_in);
-       fread_verify(&mode_in,sizeof(int),1,fp_in);
-       if(n_k_in==N_KERNEL_TABLE && mode_in==mode){
+       fread_verify(&version_in,sizeof(int),1,fp_in);
+       fread_verify(&n_k_in,    sizeof(int),1,fp_in);
+       fread_verify(&mode_in,   sizeof(int),1,fp_in);
+       if(version_in==SPH_KERNEL_FILE_VERSION && n_k_in==N_KERNEL_TABLE && mode_in==mode_file){
           SID_log("Reading SPH kernel...",SID_LOG_OPEN|SID_LOG_TIMER);
           (*kernel_radius)  =(double *)SID_malloc(sizeof(double)*(N_KERNEL_TABLE+1));
           (*kernel_table_3d)=(double *)SID_malloc(sizeof(double)*(N_KERNEL_TABLE+1));
@@ -139,10 +144,12 @@ void set_sph_kernel(double **kernel_radius,
        }
 
        // Write a kernel file (to possibly save some time with another run in this directory)
-       FILE *fp_out =fopen(filename_kernel,"w");
-       int   n_k_out=N_KERNEL_TABLE;
+       FILE *fp_out     =fopen(filename_kernel,"w");
+       int   version_out=SPH_KERNEL_FILE_VERSION;
+       int   n_k_out    =N_KERNEL_TABLE;
+       fwrite(&version_out,              sizeof(int),   1,               fp_out);
        fwrite(&n_k_out,                  sizeof(int),   1,               fp_out);
-       fwrite(&mode,                     sizeof(int),   1,               fp_out);
+       fwrite(&mode_file,                sizeof(int),   1,               fp_out);
        fwrite((*kernel_radius),          sizeof(double),N_KERNEL_TABLE+1,fp_out);
        fwrite((*kernel_table_3d),        sizeof(double),N_KERNEL_TABLE+1,fp_out);
        if(check_mode_for_flag(mode,SPH_KERNEL_2D)){
@@ -154,5 +161,83 @@ void set_sph_kernel(double **kernel_radius,
 
     SID_log("Done.",SID_LOG_CLOSE);
   } // skip
+
+  // Build a cache of projected kernel stamps (if requested).  Each stamp holds the
+  //   2D kernel evaluated at pixel centres (in the same way as render_frame()'s exact
+  //   path) for a particle with a quantized smoothing length and sub-pixel position.
+  if(flag_compute_2d && check_mode_for_flag(mode,SPH_KERNEL_STAMPS) && (*kernel_stamps)==NULL){
+    SID_log("Computing SPH kernel stamps...",SID_LOG_OPEN|SID_LOG_TIMER);
+    double                 radius_kernel_max =(*kernel_radius)[N_KERNEL_TABLE];
+    double                 radius_kernel_max2=radius_kernel_max*radius_kernel_max;
+    sph_kernel_stamp_info *stamps;
+    int                    i_h;
+    int                    i_sub_x;
+    int                    i_sub_y;
+    int                    dx;
+    int                    dy;
+    stamps        =(sph_kernel_stamp_info *)SID_malloc(sizeof(sph_kernel_stamp_info));
+    stamps->n_h   =KERNEL_STAMP_N_OCTAVES*KERNEL_STAMP_N_PER_OCTAVE+1;
+    stamps->n_sub =KERNEL_STAMP_N_SUB;
+    stamps->h_min =KERNEL_STAMP_H_MIN;
+    stamps->n_lo  =(int    *)SID_malloc(sizeof(int)   *stamps->n_h);
+    stamps->width =(int    *)SID_malloc(sizeof(int)   *stamps->n_h);
+    stamps->h     =(double *)SID_malloc(sizeof(double)*stamps->n_h);
+    stamps->offset=(size_t *)SID_malloc(sizeof(size_t)*(stamps->n_h+1));
+    stamps->offset[0]=0;
+    for(i_h=0;i_h<stamps->n_h;i_h++){
+      double h_pixels   =stamps->h_min*pow(2.,(double)i_h/(double)KERNEL_STAMP_N_PER_OCTAVE);
+      stamps->h[i_h]    =h_pixels;
+      stamps->n_lo[i_h] =(int)ceil(h_pixels);
+      stamps->width[i_h]=2*stamps->n_lo[i_h]+2;
+      stamps->offset[i_h+1]=stamps->offset[i_h]+(size_t)(stamps->n_sub*stamps->n_sub)*(size_t)(stamps->width[i_h]*stamps->width[i_h]);
+    }
+    stamps->stamp =(double *)SID_malloc(sizeof(double)*stamps->offset[stamps->n_h]);
+    stamps->extent=(int    *)SID_malloc(sizeof(int)*4*stamps->n_h*stamps->n_sub*stamps->n_sub);
+    for(i_h=0;i_h<stamps->n_h;i_h++){
+      double h_pixels=stamps->h[i_h];
+      int    n_lo    =stamps->n_lo[i_h];
+      int    width   =stamps->width[i_h];
+      for(i_sub_x=0;i_sub_x<stamps->n_sub;i_sub_x++){
+        double f_x  =((double)i_sub_x+0.5)/(double)stamps->n_sub;
+        int    dx_lo=(int)floor(f_x-h_pixels);
+        int    dx_hi=(int)floor(f_x+h_pixels+ONE_HALF);
+        for(i_sub_y=0;i_sub_y<stamps->n_sub;i_sub_y++){
+          double  f_y  =((double)i_sub_y+0.5)/(double)stamps->n_sub;
+          int     dy_lo=(int)floor(f_y-h_pixels);
+          int     dy_hi=(int)floor(f_y+h_pixels+ONE_HALF);
+          double *stamp =&(stamps->stamp[stamps->offset[i_h]+(size_t)(i_sub_x*stamps->n_sub+i_sub_y)*(size_t)(width*width)]);
+          int    *extent=&(stamps->extent[4*((i_h*stamps->n_sub+i_sub_x)*stamps->n_sub+i_sub_y)]);
+          extent[0]= n_lo+1;
+          extent[1]=-n_lo;
+          extent[2]= n_lo+1;
+          extent[3]=-n_lo;
+          for(dx=-n_lo;dx<=n_lo+1;dx++){
+            for(dy=-n_lo;dy<=n_lo+1;dy++){
+              double radius2=(((double)dx+0.5-f_x)*((double)dx+0.5-f_x)+((double)dy+0.5-f_y)*((double)dy+0.5-f_y))/(h_pixels*h_pixels);
+              double value  =0.;
+              if(dx>=dx_lo && dx<=dx_hi && dy>=dy_lo && dy<=dy_hi && radius2<radius_kernel_max2){
+                double f_table=sqrt(radius2)/radius_kernel_max;
+                int    i_table=(int)(f_table*(double)N_KERNEL_TABLE);
+                value=(*kernel_table_2d)[i_table]+
+                      ((*kernel_table_2d)[i_table+1]-(*kernel_table_2d)[i_table])*
+                      (f_table-(*kernel_radius)[i_table])*(double)N_KERNEL_TABLE;
+              }
+              stamp[(dx+n_lo)*width+(dy+n_lo)]=value;
+              if(value>0.){
+                extent[0]=MIN(extent[0],dx);
+                extent[1]=MAX(extent[1],dx);
+                extent[2]=MIN(extent[2],dy);
+                extent[3]=MAX(extent[3],dy);
+              }
+            }
+          }
+        }
+      }
+    }
+    (*kernel_stamps)=stamps;
+    SID_log("Done. (%zd stamps; %.1lf Mb)",SID_LOG_CLOSE,
+            (size_t)stamps->n_h*(size_t)(stamps->n_sub*stamps->n_sub),
+            (double)(sizeof(double)*stamps->offset[stamps->n_h])/(1024.*1024.));
+  }
 }
 
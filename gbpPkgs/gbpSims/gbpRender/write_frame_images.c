@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <gd.h>
+#include <gbpLib.h>
+#include <gbpSPH.h>
+#include <gbpRender.h>
+
+// Colour-map and write the images of a rendered frame.  This does no
+//   logging or SID allocation, so that it can be called from the
+//   frame writer thread (see queue_frame()).
+void write_frame_images(camera_info *camera,const char *filename_out_dir,int frame,int mode){
+  char filename_RGB[MAX_FILENAME_LENGTH];
+  char filename_Y[MAX_FILENAME_LENGTH];
+  char filename_Z[MAX_FILENAME_LENGTH];
+  char filename_RGBY[MAX_FILENAME_LENGTH];
+  char filename_RGBY_3CHANNEL[MAX_FILENAME_LENGTH];
+  char filename_RY[MAX_FILENAME_LENGTH];
+  char filename_GY[MAX_FILENAME_LENGTH];
+  char filename_BY[MAX_FILENAME_LENGTH];
+
+  set_frame(camera);
+
+  // Write mono-images
+  for(int i_set=0;i_set<3;i_set++){
+     // Set image set filesnames
+     image_info *image_RGB          =NULL;
+     image_info *image_RGBY         =NULL;
+     image_info *image_RGBY_3CHANNEL=NULL;
+     image_info *image_Y            =NULL;
+     image_info *image_Z            =NULL;
+     image_info *image_RY           =NULL;
+     image_info *image_GY           =NULL;
+     image_info *image_BY           =NULL;
+     char set_label[8];
+     if(i_set==0){
+        sprintf(set_label,"L");
+        image_RGB          =camera->image_RGB_left;
+        image_RGBY         =camera->image_RGBY_left;
+        image_Y            =camera->image_Y_left;
+        image_Z            =camera->image_Z_left;
+        image_RY           =camera->image_RY_left;
+        image_GY           =camera->image_GY_left;
+        image_BY           =camera->image_BY_left;
+        image_RGBY_3CHANNEL=camera->image_RGBY_3CHANNEL_left;
+     }
+     else if(i_set==1){
+        sprintf(set_label,"R");
+        image_RGB          =camera->image_RGB_right;
+        image_RGBY         =camera->image_RGBY_right;
+        image_Y            =camera->image_Y_right;
+        image_Z            =camera->image_Z_right;
+        image_RY           =camera->image_RY_right;
+        image_GY           =camera->image_GY_right;
+        image_BY           =camera->image_BY_right;
+        image_RGBY_3CHANNEL=camera->image_RGBY_3CHANNEL_right;
+     }
+     else if(i_set==2){
+        sprintf(set_label,"M");
+        image_RGB          =camera->image_RGB;
+        image_RGBY         =camera->image_RGBY;
+        image_Y            =camera->image_Y;
+        image_Z            =camera->image_Z;
+        image_RY           =camera->image_RY;
+        image_GY           =camera->image_GY;
+        image_BY           =camera->image_BY;
+        image_RGBY_3CHANNEL=camera->image_RGBY_3CHANNEL;
+     }
+     else
+        SID_trap_error("Undefined image set index in write_frame_images().",ERROR_LOGIC);
+     sprintf(filename_RGB,          "RGB_%s_%05d",          set_label,frame);
+     sprintf(filename_Y,            "Y_%s_%05d",            set_label,frame);
+     sprintf(filename_Z,            "Z_%s_%05d",            set_label,frame);
+     sprintf(filename_RGBY,         "RGBY_%s_%05d",         set_label,frame);
+     sprintf(filename_RY,           "RY_%s_%05d",           set_label,frame);
+     sprintf(filename_GY,           "GY_%s_%05d",           set_label,frame);
+     sprintf(filename_BY,           "BY_%s_%05d",           set_label,frame);
+     sprintf(filename_RGBY_3CHANNEL,"RGBY_3CHANNEL_%s_%05d",set_label,frame);
+     if(check_mode_for_flag(camera->RGB_mode,CAMERA_RGB_MODE_1CHANNEL)){
+        write_image(image_RGB, filename_out_dir,filename_RGB, mode);
+        write_image(image_Y,   filename_out_dir,filename_Y,   mode);
+        write_image(image_RGBY,filename_out_dir,filename_RGBY,mode);
+     }
+     if(check_mode_for_flag(camera->RGB_mode,CAMERA_RGB_MODE_3CHANNEL)){
+        write_image(image_RY,           filename_out_dir,filename_RY,           mode&(~WRITE_IMAGE_PNG));
+        write_image(image_GY,           filename_out_dir,filename_GY,           mode&(~WRITE_IMAGE_PNG));
+        write_image(image_BY,           filename_out_dir,filename_BY,           mode&(~WRITE_IMAGE_PNG));
+        write_image(image_RGBY_3CHANNEL,filename_out_dir,filename_RGBY_3CHANNEL,mode);
+     }
+     write_image(image_Z,filename_out_dir,filename_Z,mode);
+  }
+}
@@ -0,0 +1,17 @@
+#include <stdio.h>
+#include <string.h>
+#include <gbpLib.h>
+#include <gbpSPH.h>
+
+// Open a file for reading.  If a copy of the file has already been
+//   read into RAM (ie. it is in plist->file_images) the returned
+//   stream reads from that copy; otherwise the file is opened as usual.
+//   Either way, the stream is closed with fclose().
+FILE *fopen_plist(plist_info *plist,const char *filename){
+  file_image_info *current;
+  for(current=plist->file_images;current!=NULL;current=current->next){
+     if(!strcmp(current->filename,filename) && current->size>0)
+        return(fmemopen(current->data,current->size,"r"));
+  }
+  return(fopen(filename,"r"));
+}
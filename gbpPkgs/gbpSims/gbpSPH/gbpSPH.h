@@ -117,6 +117,15 @@ struct AbIL_info{
   double       velocity_unit;
 };
 
+// A file which has already been read into RAM (see fopen_plist())
+typedef struct file_image_info file_image_info;
+struct file_image_info{
+  char             filename[MAX_FILENAME_LENGTH];
+  char            *data;
+  size_t           size;
+  file_image_info *next;
+};
+
 // Structure to store particle info 
 typedef struct plist_info plist_info;
 struct plist_info{
@@ -141,6 +150,7 @@ struct plist_info{
   double      d_beta;
   double      d_gamma;
   ADaPS      *data;
+  file_image_info *file_images; // Files to be read from RAM rather than disk (NULL if none)
 };
 
 typedef struct markfile_header_info markfile_header_info;
@@ -278,6 +288,7 @@ void allocate_gadget_particles(plist_info *plist,
                                int         flag_long_IDs);
 void init_plist(plist_info *plist, slab_info *slab,double length_unit,double mass_unit, double velocity_unit); 
 void free_plist(plist_info *plist);
+FILE *fopen_plist(plist_info *plist,const char *filename);
 void standard_to_system(plist_info *plist, char *species_name);
 void close_plist(plist_info *plist);
 void translate_sph(plist_info *plist,
@@ -10,6 +10,7 @@ void init_plist(plist_info *plist,
 
   // Data library
   ADaPS_init(&(plist->data));
+  plist->file_images=NULL;
 
   // Species types and names
   plist->n_species=N_GADGET_TYPE;
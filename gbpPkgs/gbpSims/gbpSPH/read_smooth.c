@@ -137,7 +137,7 @@ void read_smooth(plist_info *plist,
      SID_init_pcounter(&pcounter,n_particles_total,10);
      for(i_file=0;i_file<n_files;i_file++){
        set_smooth_filename(filename_root_in,snapshot_number,i_file,flag_multifile,flag_file_type,filename);
-       if((fp=fopen(filename,"r"))!=NULL){
+       if((fp=fopen_plist(plist,filename))!=NULL){
           fread_verify(&(header.n_particles_file), sizeof(int),      1,fp);
           fread_verify(&(header.offset),           sizeof(int),      1,fp);
           fread_verify(&(header.n_particles_total),sizeof(long long),1,fp);
@@ -91,7 +91,7 @@ SID_trap_error("This function is not working yet.  It needs to be debugged.",ERR
       int            bytes_per_marker=4;
       int            bytes_per_halo  =n_markers*bytes_per_marker;
       SID_fp_buffer *fp_in_buffer    =NULL;
-      init_SID_fp_buffer(&fp_in,(size_t)(bytes_per_halo*n_halos_total[i_snap])*sizeof(int),SIZE_OF_MEGABYTE,&fp_in_buffer);
+      init_SID_fp_buffer_read_ahead(&fp_in,(size_t)(bytes_per_halo*n_halos_total[i_snap])*sizeof(int),SIZE_OF_MEGABYTE,&fp_in_buffer);
       for(int i_halo=0;i_halo<n_halos_total[i_snap];i_halo++){
          int                flag_keep    =FALSE;
          size_t             i_found_index=file_index_local_index[i_snap][i_found];
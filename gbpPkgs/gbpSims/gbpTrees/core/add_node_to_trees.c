@@ -23,7 +23,7 @@ int add_node_to_trees(tree_info        *trees,                 // The tree datas
   int rval=TRUE;
 
   // Create new node
-  (*new_node)=(tree_node_info *)SID_malloc(sizeof(tree_node_info));
+  (*new_node)=(tree_node_info *)SID_arena_alloc(&(trees->node_arenas[halo_snap]),sizeof(tree_node_info));
 
   int flag_processing_group=(parent_top==NULL); // Are we adding a group or subgroup?
 
@@ -26,7 +26,7 @@ int add_node_to_vertical_tree(tree_vertical_info  *tree,
   tree_vertical_node_info *group_halo_list;
 
   // Create new node
-  new_node=(tree_vertical_node_info *)SID_malloc(sizeof(tree_vertical_node_info));
+  new_node=(tree_vertical_node_info *)SID_arena_alloc(&(tree->node_arena),sizeof(tree_vertical_node_info));
 
   // Copy halo properties into new node
   memcpy(&(new_node->halo),properties,sizeof(halo_properties_SAGE_info));
@@ -121,9 +121,9 @@ void compute_trees_horizontal(char        *filename_halo_root_in,
   tree_horizontal_info **groups;
   tree_horizontal_info **halos;
   tree_horizontal_info  *halos_i;
-  match_info           **back_matches_groups;
-  match_info           **back_matches_subgroups;
-  match_info           **back_matches;
+  SID_arena             *back_matches_groups;
+  SID_arena             *back_matches_subgroups;
+  SID_arena             *back_matches;
 
   int     n_files;
   int     n_subgroups_max;
@@ -156,6 +156,7 @@ void compute_trees_horizontal(char        *filename_halo_root_in,
   int   i_column;
 
   SID_log("Constructing horizontal merger trees for snapshots #%d->#%d (step=%d)...",SID_LOG_OPEN|SID_LOG_TIMER,i_read_start,i_read_stop,i_read_step);
+  SID_push_memory_tag("trees");
 
   if(n_search<1)
     SID_trap_error("n_search=%d but must be at least 1",ERROR_LOGIC,n_search);
@@ -235,14 +236,14 @@ void compute_trees_horizontal(char        *filename_halo_root_in,
   subgroups             =(tree_horizontal_info **)SID_malloc(sizeof(tree_horizontal_info *)*n_wrap);
   groups                =(tree_horizontal_info **)SID_malloc(sizeof(tree_horizontal_info *)*n_wrap);
   n_subgroups_group     =(int                  **)SID_malloc(sizeof(int                  *)*n_wrap);
-  back_matches_subgroups=(match_info           **)SID_malloc(sizeof(match_info *)          *n_wrap);
-  back_matches_groups   =(match_info           **)SID_malloc(sizeof(match_info *)          *n_wrap);
+  back_matches_subgroups=(SID_arena             *)SID_malloc(sizeof(SID_arena)           *n_wrap);
+  back_matches_groups   =(SID_arena             *)SID_malloc(sizeof(SID_arena)           *n_wrap);
   for(i_search=0;i_search<n_wrap;i_search++){
      subgroups[i_search]             =(tree_horizontal_info *)SID_calloc(sizeof(tree_horizontal_info)*n_subgroups_max);
      groups[i_search]                =(tree_horizontal_info *)SID_calloc(sizeof(tree_horizontal_info)*n_groups_max);       
      n_subgroups_group[i_search]     =(int                  *)SID_calloc(sizeof(int)                 *n_groups_max);       
-     back_matches_subgroups[i_search]=NULL;
-     back_matches_groups[i_search]   =NULL;
+     SID_arena_init(&(back_matches_subgroups[i_search]),0);
+     SID_arena_init(&(back_matches_groups[i_search]),   0);
   }
   SID_log("Done.",SID_LOG_CLOSE);
 
@@ -516,10 +517,10 @@ void compute_trees_horizontal(char        *filename_halo_root_in,
   for(i_search=0;i_search<n_wrap;i_search++){
      // Free subgroup information
      SID_free(SID_FARG subgroups[i_search]);
-     SID_free(SID_FARG back_matches_subgroups[i_search]);
+     SID_arena_free(&(back_matches_subgroups[i_search]));
      // Free group information
      SID_free(SID_FARG groups[i_search]);
-     SID_free(SID_FARG back_matches_groups[i_search]);
+     SID_arena_free(&(back_matches_groups[i_search]));
   }
   SID_free(SID_FARG subgroups);
   SID_free(SID_FARG groups);
@@ -594,6 +595,7 @@ void compute_trees_horizontal(char        *filename_halo_root_in,
   // Construct tree->forest mappings
   compute_forests(filename_output_dir,n_search_forests);
 
+  SID_pop_memory_tag();
   SID_log("Done.",SID_LOG_CLOSE);
 }
 
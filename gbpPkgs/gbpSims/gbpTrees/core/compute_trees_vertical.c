@@ -15,6 +15,7 @@ void compute_trees_vertical(char   *filename_SSimPL_dir,
                             double  box_size,
                             int     n_dim_files){
   SID_log("Constructing vertical merger trees...",SID_LOG_OPEN|SID_LOG_TIMER);
+  SID_push_memory_tag("trees");
 
   char filename_trees_root[MAX_FILENAME_LENGTH];
   char filename_halos_root[MAX_FILENAME_LENGTH];
@@ -44,6 +45,7 @@ void compute_trees_vertical(char   *filename_SSimPL_dir,
   // Clean-up
   free_trees(&trees);
 
+  SID_pop_memory_tag();
   SID_log("Done.",SID_LOG_CLOSE);
 }
 
@@ -28,25 +28,9 @@ void free_trees(tree_info **trees){
 
   // Free nodes
   int i_snap;
-  for(i_snap=0;i_snap<(*trees)->n_snaps;i_snap++){
-     tree_node_info *current;
-     tree_node_info *next;
-     if((*trees)->first_neighbour_groups!=NULL){
-        next=(*trees)->first_neighbour_groups[i_snap];
-        while(next!=NULL){
-           current=next;
-           next   =current->next_neighbour;
-           SID_free(SID_FARG current);
-        }
-     }
-     if((*trees)->first_neighbour_subgroups!=NULL){
-        next=(*trees)->first_neighbour_subgroups[i_snap];
-        while(next!=NULL){
-           current=next;
-           next   =current->next_neighbour;
-           SID_free(SID_FARG current);
-        }
-     }
+  if((*trees)->node_arenas!=NULL){
+     for(i_snap=0;i_snap<(*trees)->n_snaps;i_snap++)
+        SID_arena_free(&((*trees)->node_arenas[i_snap]));
   }
 
   // Free match scores
@@ -78,6 +62,7 @@ void free_trees(tree_info **trees){
   SID_free(SID_FARG (*trees)->first_neighbour_subgroups);
   SID_free(SID_FARG (*trees)->last_neighbour_groups);
   SID_free(SID_FARG (*trees)->last_neighbour_subgroups);
+  SID_free(SID_FARG (*trees)->node_arenas);
   SID_free(SID_FARG (*trees)->first_in_forest_groups);
   SID_free(SID_FARG (*trees)->first_in_forest_subgroups);
   SID_free(SID_FARG (*trees)->last_in_forest_groups);
@@ -10,15 +10,8 @@
 #include <gbpTrees_build.h>
 
 void free_trees_vertical(tree_vertical_info **tree){
-  tree_vertical_node_info *next_node;
-  tree_vertical_node_info *last_node;
   // Free nodes
-  next_node=(*tree)->root;
-  while(next_node!=NULL){
-    last_node=next_node;
-    next_node=last_node->next;
-    SID_free(SID_FARG last_node);
-  }
+  SID_arena_free(&((*tree)->node_arena));
   // Free neighbour list arrays
   SID_free(SID_FARG (*tree)->n_neighbours);
   SID_free(SID_FARG (*tree)->neighbour_halos);
@@ -11,6 +11,10 @@
 #define K_MATCH_SUBGROUPS 0
 #define K_MATCH_GROUPS    1
 
+// Largest number of nodes in each block of the tree node arenas
+#define TREE_NODE_ARENA_BLOCK_SIZE          4096
+#define TREE_VERTICAL_NODE_ARENA_BLOCK_SIZE 256
+
 // Tree finalization and reading modes
 #define TREE_READ_DEFAULT                                0
 #define TREE_SUBSTRUCTURE_ORDER_DEFAULT                  TTTP00
@@ -277,6 +281,7 @@ struct tree_vertical_node_info{
 
 typedef struct tree_vertical_info tree_vertical_info;
 struct tree_vertical_info{
+  SID_arena                 node_arena;
   tree_vertical_node_info  *root;
   tree_vertical_node_info  *last_leaf;
   int                      *n_neighbours;
@@ -407,6 +412,9 @@ struct tree_info{
   tree_node_info **first_in_forest_subgroups;
   tree_node_info **last_in_forest_groups;
   tree_node_info **last_in_forest_subgroups;
+  // Nodes are allocated from one arena per snapshot, so that each
+  //   snapshot's nodes sit together in memory and are freed together
+  SID_arena       *node_arenas;
   // Look-up table stuff for tieing file indices to stored halo structures
   //   (mostly needed just for reading)
   int             **group_indices;
@@ -619,7 +627,7 @@ void init_trees_horizontal_roots(tree_horizontal_info **groups,
                                  int    *max_id_subgroup,
                                  int    *max_tree_id_subgroup);
 void init_trees_horizontal_snapshot(tree_horizontal_info *halos,
-                                    match_info          **back_matches,
+                                    SID_arena            *back_matches,
                                     int                   i_read,
                                     int                   i_file,
                                     int                   n_groups,
@@ -648,7 +656,7 @@ void read_halo_sizes(tree_horizontal_info **halos,
                      int     flag_match_subgroups);
 void identify_back_matches(tree_horizontal_info **halos,
                            tree_horizontal_info  *halos_i,
-                           match_info           **back_matches_i,
+                           SID_arena             *back_matches_i,
                            int     n_halos_i,
                            int    *match_id,
                            float  *match_score,
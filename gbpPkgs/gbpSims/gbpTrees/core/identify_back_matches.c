@@ -8,7 +8,7 @@
 
 void identify_back_matches(tree_horizontal_info **halos,
                            tree_horizontal_info  *halos_i,
-                           match_info           **back_matches_i,
+                           SID_arena             *back_matches_i,
                            int     n_halos_i,
                            int    *match_id,
                            float  *match_score,
@@ -334,16 +334,17 @@ void identify_back_matches(tree_horizontal_info **halos,
     SID_free(SID_FARG empty_match);
 
     // Because we've (likely) overallocated previously, reallocate and repopulate the back match array here to save RAM ...
+    //    The lists are taken from the snapshot's arena, which is reset when its slot is reused.
     n_allocate_backmatch=0;
     for(i_halo=0;i_halo<n_halos_2_matches;i_halo++)
        n_allocate_backmatch+=halos_i[i_halo].n_back_matches;
-    (*back_matches_i)=(match_info *)SID_calloc(sizeof(match_info)*n_allocate_backmatch);
+    match_info *back_matches_list=(match_info *)SID_arena_alloc(back_matches_i,sizeof(match_info)*n_allocate_backmatch);
     for(i_halo=0,k_halo=0;i_halo<n_halos_2_matches;i_halo++){
        l_halo=k_halo;
        tree_horizontal_info *halo_i=&(halos_i[i_halo]);
        for(j_halo=0;j_halo<halos_i[i_halo].n_back_matches;j_halo++,k_halo++)
-          memcpy(&((*back_matches_i)[k_halo]),&(halo_i->back_matches[j_halo]),sizeof(match_info));
-       halo_i->back_matches=&((*back_matches_i)[l_halo]);
+          memcpy(&(back_matches_list[k_halo]),&(halo_i->back_matches[j_halo]),sizeof(match_info));
+       halo_i->back_matches=&(back_matches_list[l_halo]);
     }
     SID_free(SID_FARG back_matches_i_temp);
 
@@ -2,7 +2,7 @@
 #include <gbpTrees_build.h>
 
 void init_trees_horizontal_snapshot(tree_horizontal_info *halos,
-                                    match_info          **back_matches,
+                                    SID_arena            *back_matches,
                                     int                   i_read,
                                     int                   i_file,
                                     int                   n_groups,
@@ -65,7 +65,7 @@ void init_trees_horizontal_snapshot(tree_horizontal_info *halos,
       halos[i_halo].n_particles_largest_descendant= 0;
       halos[i_halo].n_progenitors                 = 0;
    }
-   // Erase back-match array
-   SID_free(SID_FARG (*back_matches));
+   // Erase back-match lists, keeping their memory for this snapshot's
+   SID_arena_reset(back_matches);
 }
 
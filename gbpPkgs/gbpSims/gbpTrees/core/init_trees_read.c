@@ -39,6 +39,7 @@ void init_trees_read(const char  *filename_SSimPL_dir,
   (*tree)->first_in_forest_subgroups   =NULL;
   (*tree)->last_in_forest_groups       =NULL;
   (*tree)->last_in_forest_subgroups    =NULL;
+  (*tree)->node_arenas                 =NULL;
   (*tree)->tree2forest_mapping_group   =NULL;
   (*tree)->tree2forest_mapping_subgroup=NULL;
 
@@ -193,6 +194,7 @@ void init_trees_read(const char  *filename_SSimPL_dir,
   (*tree)->first_in_forest_subgroups  =NULL;
   (*tree)->last_in_forest_groups      =NULL;
   (*tree)->last_in_forest_subgroups   =NULL;
+  (*tree)->node_arenas                =NULL;
   (*tree)->n_groups_forest_local      =NULL;
   (*tree)->n_subgroups_forest_local   =NULL;
   (*tree)->trees_reference            =NULL;
@@ -247,6 +249,7 @@ void init_trees_read(const char  *filename_SSimPL_dir,
      (*tree)->first_neighbour_subgroups=(tree_node_info **)SID_malloc(sizeof(tree_node_info *)*n_snaps);
      (*tree)->last_neighbour_groups    =(tree_node_info **)SID_malloc(sizeof(tree_node_info *)*n_snaps);
      (*tree)->last_neighbour_subgroups =(tree_node_info **)SID_malloc(sizeof(tree_node_info *)*n_snaps);
+     (*tree)->node_arenas              =(SID_arena       *)SID_malloc(sizeof(SID_arena)       *n_snaps);
      (*tree)->first_in_forest_groups   =(tree_node_info **)SID_malloc(sizeof(tree_node_info *)*n_forests_local);
      (*tree)->first_in_forest_subgroups=(tree_node_info **)SID_malloc(sizeof(tree_node_info *)*n_forests_local);
      (*tree)->last_in_forest_groups    =(tree_node_info **)SID_malloc(sizeof(tree_node_info *)*n_forests_local);
@@ -264,6 +267,7 @@ void init_trees_read(const char  *filename_SSimPL_dir,
        (*tree)->first_neighbour_subgroups[i_snap]=NULL;
        (*tree)->last_neighbour_groups[i_snap]    =NULL;
        (*tree)->last_neighbour_subgroups[i_snap] =NULL;
+       SID_arena_init(&((*tree)->node_arenas[i_snap]),sizeof(tree_node_info)*TREE_NODE_ARENA_BLOCK_SIZE);
      }
      for(i_forest=0;i_forest<n_forests_local;i_forest++){
        (*tree)->n_groups_forest_local[i_forest]    =0;
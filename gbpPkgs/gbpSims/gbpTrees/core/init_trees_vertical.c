@@ -20,6 +20,7 @@ void init_trees_vertical(int n_snaps,tree_vertical_info **tree){
     (*tree)->neighbour_halos[i_search]    =NULL;
     (*tree)->neighbour_halo_last[i_search]=NULL;
   }
+  SID_arena_init(&((*tree)->node_arena),sizeof(tree_vertical_node_info)*TREE_VERTICAL_NODE_ARENA_BLOCK_SIZE);
   (*tree)->root     =NULL;
   (*tree)->last_leaf=NULL;
 }
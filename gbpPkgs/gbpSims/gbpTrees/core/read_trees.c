@@ -41,6 +41,7 @@ void read_trees(const char *filename_SSimPL_root,
 
   // We need i_read_start,i_read_stop,i_read_step from above before we can write this status message
   SID_log("Reading merger trees for snapshots #%d->#%d (step=%d)...",SID_LOG_OPEN|SID_LOG_TIMER,i_read_start_temp,i_read_stop_temp,i_read_step_temp);
+  SID_push_memory_tag("trees");
 
   // Initialize tree data structure and populate it
   //   with various pieces of header information
@@ -230,11 +231,11 @@ void read_trees(const char *filename_SSimPL_root,
     SID_fp_buffer *fp_groups_in_buffer   =NULL;
     SID_fp_buffer *fp_trees_in_buffer    =NULL;
     size_t n_bytes_trees                 =sizeof(int)*((8*(size_t)n_groups)+(7*(size_t)n_subgroups));
-    init_SID_fp_buffer(&fp_subgroups_in,(size_t)n_subgroups*sizeof(int),SIZE_OF_MEGABYTE,&fp_subgroups_in_buffer);
-    init_SID_fp_buffer(&fp_groups_in,   (size_t)n_groups   *sizeof(int),SIZE_OF_MEGABYTE,&fp_groups_in_buffer);
-    init_SID_fp_buffer(&fp_trees_in,    n_bytes_trees,                  SIZE_OF_MEGABYTE,&fp_trees_in_buffer);
+    init_SID_fp_buffer_read_ahead(&fp_subgroups_in,(size_t)n_subgroups*sizeof(int),SIZE_OF_MEGABYTE,&fp_subgroups_in_buffer);
+    init_SID_fp_buffer_read_ahead(&fp_groups_in,   (size_t)n_groups   *sizeof(int),SIZE_OF_MEGABYTE,&fp_groups_in_buffer);
+    init_SID_fp_buffer_read_ahead(&fp_trees_in,    n_bytes_trees,                  SIZE_OF_MEGABYTE,&fp_trees_in_buffer);
     if(flag_read_sub_pointers)
-       init_SID_fp_buffer(&fp_hierarchy_in,(size_t)n_subgroups*sizeof(int),SIZE_OF_MEGABYTE,&fp_hierarchy_in_buffer);
+       init_SID_fp_buffer_read_ahead(&fp_hierarchy_in,(size_t)n_subgroups*sizeof(int),SIZE_OF_MEGABYTE,&fp_hierarchy_in_buffer);
 
     // Read each group in turn
     int    n_groups_unused        =0;
@@ -394,15 +395,15 @@ void read_trees(const char *filename_SSimPL_root,
     } // i_group
 
     // Free the buffers and perform sanity checks
-    SID_fclose(&fp_trees_in);
-    SID_fclose(&fp_groups_in);
-    SID_fclose(&fp_subgroups_in);
     free_SID_fp_buffer(&fp_subgroups_in_buffer);
     free_SID_fp_buffer(&fp_groups_in_buffer);
     free_SID_fp_buffer(&fp_trees_in_buffer);
+    SID_fclose(&fp_trees_in);
+    SID_fclose(&fp_groups_in);
+    SID_fclose(&fp_subgroups_in);
     if(flag_read_sub_pointers){
-       SID_fclose(&fp_hierarchy_in);
        free_SID_fp_buffer(&fp_hierarchy_in_buffer);
+       SID_fclose(&fp_hierarchy_in);
     }
 
     // Update the temporary look-up arrays
@@ -471,6 +472,7 @@ void read_trees(const char *filename_SSimPL_root,
   if(!check_mode_for_flag((*trees)->mode,TREE_MODE_REFERENCE))
      free_trees_lookup((*trees));
 
+  SID_pop_memory_tag();
   SID_log("Done.",SID_LOG_CLOSE);
 }
 